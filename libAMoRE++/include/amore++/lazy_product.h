@@ -0,0 +1,165 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __amore_lazy_product_h__
+# define __amore_lazy_product_h__
+
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <amore++/finite_automaton.h>
+
+namespace amore {
+
+// an automaton without epsilon-transitions, as flat arrays. the successors
+// of (state, label) are targets[offsets[state * alphabet_size + label] ...
+// offsets[state * alphabet_size + label + 1]), sorted and epsilon-closed.
+class flat_automaton {
+	public:
+		int alphabet_size;
+		int state_count;
+		std::vector<unsigned int> offsets;
+		std::vector<int> targets;
+		// epsilon-closure of the initial states, sorted
+		std::vector<int> initial;
+		// epsilon-closure of state contains a final state
+		std::vector<bool> final;
+
+	public:
+		// alphabet_size may be larger than the one of the automaton.
+		flat_automaton(const finite_automaton & a, int alphabet_size);
+		// a single state accepting everything
+		flat_automaton(int alphabet_size);
+};
+
+// sets of states, each stored only once (hash-consing). a set is identified
+// by its number.
+class state_set_table {
+	protected:
+		std::vector<int> elements;
+		std::vector<unsigned int> offsets;
+		std::vector<uint32_t> hashes;
+		// open addressing, -1 is empty. size is a power of 2.
+		std::vector<int> slots;
+
+	public:
+		state_set_table();
+
+		// returns the number of the sorted set [begin, end), adding it if new.
+		int intern(const int * begin, const int * end);
+
+		unsigned int size() const
+		{ return offsets.size() - 1; }
+		const int * begin(int set) const
+		{ return &elements[0] + offsets[set]; }
+		const int * end(int set) const
+		{ return &elements[0] + offsets[set+1]; }
+
+	protected:
+		void grow();
+};
+
+/*
+ * lazy_product - on-the-fly product of two automata that only explores the
+ * reachable product states.
+ *
+ * a product state holds a single state of the left automaton, so it is
+ * never determinized. with INTERSECTION, it holds a single state of the
+ * right automaton as well. with DIFFERENCE, it holds the set of states the
+ * right automaton can be in (which is needed to complement it), but this
+ * is only computed for reachable product states, not as a full subset
+ * construction. state sets are hash-consed, so a product state is a pair
+ * of integers.
+ *
+ * find_accepting() stops at the first accepting product state. thus
+ * emptiness, inclusion and disjointness are decided without building the
+ * product. construct() builds the reachable part of the product.
+ */
+class lazy_product {
+	public: // types
+		enum operation {
+			INTERSECTION = 0, // L(left) and L(right)
+			DIFFERENCE = 1    // L(left) and not L(right)
+		};
+
+	protected: // data
+		enum operation op;
+		flat_automaton left;
+		flat_automaton right;
+		int alphabet_size;
+
+		state_set_table right_sets;
+		// does a set of right_sets contain a final state?
+		std::vector<bool> right_set_final;
+
+		// product states, in the order they were found (breadth-first)
+		std::vector<int> left_state;
+		std::vector<int> right_state; // state (INTERSECTION) or set (DIFFERENCE) of right
+		std::vector<int> parent;
+		std::vector<int> label;
+		std::vector<bool> accepting;
+		unsigned int initial_count;
+		unsigned int explored; // states whose successors were added
+		// open addressing on (left_state, right_state), -1 is empty
+		std::vector<int> slots;
+
+		std::vector<int> post;
+
+	public: // methods
+		lazy_product(const finite_automaton & left, const finite_automaton & right, enum operation op);
+		// product with the universal language, i.e. only left is explored.
+		lazy_product(const finite_automaton & left);
+
+		// get a shortest word in the language of the product. returns
+		// false if it is empty.
+		bool find_accepting(std::list<int> & word);
+		bool is_empty()
+		{ std::list<int> word; return !find_accepting(word); }
+
+		// the reachable product as new nondeterministic automaton.
+		finite_automaton * construct();
+
+		unsigned int get_state_count() const
+		{ return left_state.size(); }
+
+	protected: // methods
+		void add_initial_states();
+		// add the successors of state. if transitions is given, they are
+		// stored there. returns true if an accepting product state was added.
+		bool explore(int state, std::map<int, std::map<int, std::set<int> > > * transitions);
+		// returns the product state (l, r), adding it with the given
+		// parent and label if it is new.
+		int find_or_add(int l, int r, int from, int sigma, bool & added);
+		void grow();
+		int right_set(const int * begin, const int * end);
+};
+
+}; // end namespace amore
+
+#endif
+
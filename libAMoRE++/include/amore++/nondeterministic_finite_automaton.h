@@ -119,7 +119,15 @@ class nondeterministic_finite_automaton : public finite_automaton {
 
 		virtual bool is_deterministic() const;
 		virtual nondeterministic_finite_automaton * nondeterminize() const;
+		// determinize in the calling thread. the result is identical to
+		// the one of AMoRE's nfa2dfa().
 		virtual finite_automaton * determinize() const;
+		// determinize with the given number of threads (0: one per online
+		// processor). with minimize, the minimal automaton is constructed
+		// directly, without the non-minimal one.
+		virtual finite_automaton * determinize(unsigned int threads, bool minimize = false) const;
+		// determinize with AMoRE's nfa2dfa()
+		virtual finite_automaton * amore_determinize() const;
 
 		virtual std::basic_string<int32_t> serialize() const;
 		virtual bool deserialize(std::basic_string<int32_t>::const_iterator &it, std::basic_string<int32_t>::const_iterator limit);
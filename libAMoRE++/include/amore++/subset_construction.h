@@ -0,0 +1,117 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __amore_subset_construction_h__
+# define __amore_subset_construction_h__
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <amore++/finite_automaton.h>
+
+namespace amore {
+
+/*
+ * subset_construction - determinization of a nondeterministic automaton,
+ * the same as AMoRE's enfa2nfa() and nfa2dfa(), but with several threads.
+ *
+ * sets of states of the nondeterministic automaton are bitsets, stored
+ * once in a hash table that is split into stripes with a lock each. the
+ * sets are explored breadth-first: each level of new sets is divided
+ * among the threads, and a thread that is done takes work from the others.
+ *
+ * states of the result are numbered in the order they were found. as
+ * that depends on the threads, get_amore_order() gives the numbering
+ * nfa2dfa() would use (depth-first with a stack, letters in ascending
+ * order), so the result can be made identical to nfa2dfa().
+ *
+ * run_minimal() constructs the minimal automaton instead (Brzozowski:
+ * determinize the reverse of the determinized reverse), without
+ * constructing the possibly much larger non-minimal one.
+ */
+class subset_construction {
+	protected: // data
+		// the nondeterministic automaton without epsilon-transitions.
+		// successors of (state, label) are targets[offsets[state *
+		// alphabet_size + label] ... offsets[state * alphabet_size +
+		// label + 1]), sorted.
+		int alphabet_size;
+		int nfa_state_count;
+		unsigned int words; // 64 bit words per set of states
+		std::vector<unsigned int> offsets;
+		std::vector<int> targets;
+		std::vector<uint64_t> initial;
+		std::vector<uint64_t> final;
+
+		unsigned int thread_count;
+
+		// the constructed automaton. state 0 is initial.
+		int state_count;
+		std::vector<int> delta; // successor of state * alphabet_size + label
+		std::vector<bool> accepting;
+
+	public: // methods
+		// states 0 .. state_count-1, labels 0 .. alphabet_size-1 and -1
+		// for epsilon. transitions are (source, label, destination)
+		// triples. epsilon-transitions are removed as enfa2nfa() does.
+		subset_construction(int alphabet_size, int state_count, const std::vector<int> & transitions,
+				const std::vector<int> & initial_states, const std::vector<int> & final_states);
+		subset_construction(const finite_automaton & a);
+
+		// 0 uses one thread per online processor (the default).
+		void set_thread_count(unsigned int threads);
+
+		// construct the reachable part of the deterministic automaton
+		void run();
+		// construct the minimal deterministic automaton
+		void run_minimal();
+
+		int get_alphabet_size() const
+		{ return alphabet_size; }
+		int get_state_count() const
+		{ return state_count; }
+		int get_successor(int state, int label) const
+		{ return delta[state * alphabet_size + label]; }
+		bool is_accepting(int state) const
+		{ return accepting[state]; }
+
+		// number[state] is the number of state in nfa2dfa()
+		void get_amore_order(std::vector<int> & number) const;
+
+	protected: // methods
+		void init(int alphabet_size, int state_count, const std::vector<int> & transitions,
+				const std::vector<int> & initial_states, const std::vector<int> & final_states);
+		// set the successors from bitsets, rows[(label * nfa_state_count + state) * words ...]
+		void set_rows(const std::vector<uint64_t> & rows);
+		// the automaton with all transitions inverted and initial and final states swapped
+		void reverse_input();
+		// the reverse of the constructed automaton as new input
+		void reverse_result();
+};
+
+}; // end namespace amore
+
+#endif
+
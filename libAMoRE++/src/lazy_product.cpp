@@ -0,0 +1,375 @@
+/* vim: fdm=syntax foldlevel=1 foldnestmax=2
+ * $Id$
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <amore++/lazy_product.h>
+
+namespace amore {
+
+using namespace std;
+
+static inline uint32_t hash_int(uint32_t h, uint32_t v)
+{
+	h ^= v;
+	h *= 16777619U; // FNV prime
+	return h ^ (h >> 15);
+}
+
+static int max_alphabet_size(const finite_automaton & a, const finite_automaton & b)
+{
+	return max(a.get_alphabet_size(), b.get_alphabet_size());
+}
+
+flat_automaton::flat_automaton(const finite_automaton & a, int alphabet_size)
+{
+	map<int, map<int, set<int> > > transitions;
+	map<int, map<int, set<int> > >::const_iterator mmsi;
+	map<int, set<int> >::const_iterator msi;
+	set<int> s, final_states;
+	set<int>::const_iterator si;
+
+	this->alphabet_size = alphabet_size;
+	state_count = a.get_state_count();
+
+	// one pass over the transitions of a, instead of one per query
+	a.get_transitions(transitions);
+	final_states = a.get_final_states();
+
+	s = a.get_initial_states();
+	a.epsilon_closure(s);
+	initial.assign(s.begin(), s.end());
+
+	final.assign(state_count, false);
+	offsets.assign(state_count * alphabet_size + 1, 0);
+
+	for(int q = 0; q < state_count; ++q) {
+		set<int> closure;
+		closure.insert(q);
+		a.epsilon_closure(closure);
+
+		for(si = closure.begin(); si != closure.end(); ++si)
+			if(final_states.find(*si) != final_states.end())
+				final[q] = true;
+
+		for(int sigma = 0; sigma < alphabet_size; ++sigma) {
+			s.clear();
+			for(si = closure.begin(); si != closure.end(); ++si) {
+				mmsi = transitions.find(*si);
+				if(mmsi == transitions.end())
+					continue;
+				msi = mmsi->second.find(sigma);
+				if(msi != mmsi->second.end())
+					s.insert(msi->second.begin(), msi->second.end());
+			}
+			a.epsilon_closure(s);
+			targets.insert(targets.end(), s.begin(), s.end());
+			offsets[q * alphabet_size + sigma + 1] = targets.size();
+		}
+	}
+}
+
+flat_automaton::flat_automaton(int alphabet_size)
+{
+	this->alphabet_size = alphabet_size;
+	state_count = 1;
+	initial.push_back(0);
+	final.push_back(true);
+	for(int sigma = 0; sigma <= alphabet_size; ++sigma)
+		offsets.push_back(sigma);
+	targets.assign(alphabet_size, 0);
+}
+
+
+
+state_set_table::state_set_table()
+{
+	// a dummy element, so begin() is valid for the empty set
+	elements.push_back(-1);
+	offsets.push_back(1);
+	slots.assign(64, -1);
+}
+
+int state_set_table::intern(const int * begin, const int * end)
+{
+	uint32_t h = 2166136261U;
+	unsigned int mask, i;
+	const int * p;
+
+	for(p = begin; p != end; ++p)
+		h = hash_int(h, *p);
+
+	mask = slots.size() - 1;
+	for(i = h & mask; slots[i] >= 0; i = (i + 1) & mask) {
+		int set = slots[i];
+		if(hashes[set] == h && (int)(offsets[set+1] - offsets[set]) == end - begin
+				&& equal(begin, end, elements.begin() + offsets[set]))
+			return set;
+	}
+
+	slots[i] = size();
+	hashes.push_back(h);
+	elements.insert(elements.end(), begin, end);
+	offsets.push_back(elements.size());
+
+	if(2 * size() > slots.size())
+		grow();
+
+	return size() - 1;
+}
+
+void state_set_table::grow()
+{
+	unsigned int mask, i;
+
+	slots.assign(2 * slots.size(), -1);
+	mask = slots.size() - 1;
+	for(unsigned int set = 0; set < size(); ++set) {
+		for(i = hashes[set] & mask; slots[i] >= 0; i = (i + 1) & mask)
+			;
+		slots[i] = set;
+	}
+}
+
+
+
+lazy_product::lazy_product(const finite_automaton & left, const finite_automaton & right, enum operation op)
+	: op(op), left(left, max_alphabet_size(left, right)), right(right, max_alphabet_size(left, right))
+{
+	alphabet_size = this->left.alphabet_size;
+	add_initial_states();
+}
+
+lazy_product::lazy_product(const finite_automaton & left)
+	: op(INTERSECTION), left(left, left.get_alphabet_size()), right(left.get_alphabet_size())
+{
+	alphabet_size = this->left.alphabet_size;
+	add_initial_states();
+}
+
+void lazy_product::add_initial_states()
+{
+	vector<int>::const_iterator li, ri;
+	bool added;
+
+	slots.assign(64, -1);
+	explored = 0;
+
+	for(li = left.initial.begin(); li != left.initial.end(); ++li) {
+		if(op == INTERSECTION) {
+			for(ri = right.initial.begin(); ri != right.initial.end(); ++ri)
+				find_or_add(*li, *ri, -1, -1, added);
+		} else {
+			const int * b = right.initial.empty() ? NULL : &right.initial[0];
+			find_or_add(*li, right_set(b, b + right.initial.size()), -1, -1, added);
+		}
+	}
+
+	initial_count = left_state.size();
+}
+
+int lazy_product::right_set(const int * begin, const int * end)
+{
+	int set = right_sets.intern(begin, end);
+
+	if(set == (int)right_set_final.size()) {
+		bool f = false;
+		for(const int * p = begin; p != end; ++p)
+			if(right.final[*p])
+				f = true;
+		right_set_final.push_back(f);
+	}
+
+	return set;
+}
+
+int lazy_product::find_or_add(int l, int r, int from, int sigma, bool & added)
+{
+	unsigned int mask, i;
+	int state;
+
+	mask = slots.size() - 1;
+	for(i = hash_int(hash_int(2166136261U, l), r) & mask; slots[i] >= 0; i = (i + 1) & mask) {
+		state = slots[i];
+		if(left_state[state] == l && right_state[state] == r) {
+			added = false;
+			return state;
+		}
+	}
+
+	state = left_state.size();
+	slots[i] = state;
+	left_state.push_back(l);
+	right_state.push_back(r);
+	parent.push_back(from);
+	label.push_back(sigma);
+	if(op == INTERSECTION)
+		accepting.push_back(left.final[l] && right.final[r]);
+	else
+		accepting.push_back(left.final[l] && !right_set_final[r]);
+
+	if(2 * left_state.size() > slots.size())
+		grow();
+
+	added = true;
+	return state;
+}
+
+void lazy_product::grow()
+{
+	unsigned int mask, i;
+
+	slots.assign(2 * slots.size(), -1);
+	mask = slots.size() - 1;
+	for(unsigned int state = 0; state < left_state.size(); ++state) {
+		for(i = hash_int(hash_int(2166136261U, left_state[state]), right_state[state]) & mask; slots[i] >= 0; i = (i + 1) & mask)
+			;
+		slots[i] = state;
+	}
+}
+
+bool lazy_product::explore(int state, map<int, map<int, set<int> > > * transitions)
+{
+	bool found = false;
+	bool added;
+	int l = left_state[state];
+	int r = right_state[state];
+
+	for(int sigma = 0; sigma < alphabet_size; ++sigma) {
+		unsigned int lt = l * alphabet_size + sigma;
+		unsigned int rt;
+		int succ;
+
+		if(left.offsets[lt] == left.offsets[lt+1])
+			continue;
+
+		if(op == INTERSECTION) {
+			rt = r * alphabet_size + sigma;
+			for(unsigned int i = left.offsets[lt]; i < left.offsets[lt+1]; ++i) {
+				for(unsigned int j = right.offsets[rt]; j < right.offsets[rt+1]; ++j) {
+					succ = find_or_add(left.targets[i], right.targets[j], state, sigma, added);
+					if(added && accepting[succ])
+						found = true;
+					if(transitions)
+						(*transitions)[state][sigma].insert(succ);
+				}
+			}
+		} else {
+			// successor set of right, sorted and without duplicates
+			post.clear();
+			for(const int * p = right_sets.begin(r); p != right_sets.end(r); ++p) {
+				rt = *p * alphabet_size + sigma;
+				post.insert(post.end(), right.targets.begin() + right.offsets[rt], right.targets.begin() + right.offsets[rt+1]);
+			}
+			sort(post.begin(), post.end());
+			post.erase(unique(post.begin(), post.end()), post.end());
+			const int * b = post.empty() ? NULL : &post[0];
+			int set = right_set(b, b + post.size());
+
+			for(unsigned int i = left.offsets[lt]; i < left.offsets[lt+1]; ++i) {
+				succ = find_or_add(left.targets[i], set, state, sigma, added);
+				if(added && accepting[succ])
+					found = true;
+				if(transitions)
+					(*transitions)[state][sigma].insert(succ);
+			}
+		}
+	}
+
+	return found;
+}
+
+bool lazy_product::find_accepting(list<int> & word)
+{
+	int state = -1;
+
+	word.clear();
+
+	// states found so far, breadth-first
+	for(unsigned int s = 0; s < left_state.size(); ++s) {
+		if(accepting[s]) {
+			state = s;
+			break;
+		}
+	}
+
+	while(state < 0 && explored < left_state.size()) {
+		unsigned int first_new = left_state.size();
+		if(explore(explored, NULL)) {
+			for(unsigned int s = first_new; s < left_state.size(); ++s) {
+				if(accepting[s]) {
+					state = s;
+					break;
+				}
+			}
+		}
+		explored++;
+	}
+
+	if(state < 0)
+		return false;
+
+	while(parent[state] >= 0) {
+		word.push_front(label[state]);
+		state = parent[state];
+	}
+	return true;
+}
+
+finite_automaton * lazy_product::construct()
+{
+	map<int, map<int, set<int> > > transitions;
+	set<int> initial, final;
+	int state_count;
+
+	// transitions are only recorded now, so start over
+	left_state.clear();
+	right_state.clear();
+	parent.clear();
+	label.clear();
+	accepting.clear();
+	add_initial_states();
+
+	for(explored = 0; explored < left_state.size(); ++explored)
+		explore(explored, &transitions);
+
+	for(unsigned int s = 0; s < initial_count; ++s)
+		initial.insert(s);
+	for(unsigned int s = 0; s < left_state.size(); ++s)
+		if(accepting[s])
+			final.insert(s);
+
+	// AMoRE needs at least one state
+	state_count = left_state.size();
+	if(state_count == 0)
+		state_count = 1;
+
+	return construct_amore_automaton(false, alphabet_size, state_count, initial, final, transitions);
+}
+
+}; // end namespace amore
+
@@ -26,6 +26,7 @@
 #include <queue>
 #include <stdio.h>
 #include <set>
+#include <vector>
 
 #include <ostream>
 #include <fstream>
@@ -40,6 +41,8 @@
 # define LIBAMORE_LIBRARY_COMPILATION
 # include "amore++/nondeterministic_finite_automaton.h"
 # include "amore++/deterministic_finite_automaton.h"
+# include "amore++/lazy_product.h"
+# include "amore++/subset_construction.h"
 
 # include <amore/nfa.h>
 # include <amore/dfa.h>
@@ -232,11 +235,10 @@ unsigned int nondeterministic_finite_automaton::get_state_count() const
 
 bool nondeterministic_finite_automaton::is_empty() const
 {
-	bool ret;
 	// libAMoRE-1.0 has empty_full_lan(), but it requires
 	// a minimized DFA as input
-	get_sample_word(ret);
-	return ret;
+	lazy_product p(*this);
+	return p.is_empty();
 }
 
 bool nondeterministic_finite_automaton::is_universal() const
@@ -541,29 +543,17 @@ bool nondeterministic_finite_automaton::operator==(const finite_automaton &other
 }
 
 bool nondeterministic_finite_automaton::lang_subset_of(const finite_automaton &other) const
+// stops at the first word in L(this) \ L(other), only other is determinized (on the fly)
 {
-	bool ret;
-
-	finite_automaton * d;
-
-	d = this->determinize();
-	ret = d->lang_subset_of(other);
-	delete d;
-
-	return ret;
+	lazy_product p(*this, other, lazy_product::DIFFERENCE);
+	return p.is_empty();
 }
 
 bool nondeterministic_finite_automaton::lang_disjoint_to(const finite_automaton &other) const
+// stops at the first common word, neither automaton is determinized
 {
-	bool ret;
-
-	finite_automaton * d;
-
-	d = this->determinize();
-	ret = d->lang_disjoint_to(other);
-	delete d;
-
-	return ret;
+	lazy_product p(*this, other, lazy_product::INTERSECTION);
+	return p.is_empty();
 }
 
 void nondeterministic_finite_automaton::epsilon_closure(set<int> & states) const
@@ -751,6 +741,8 @@ nondeterministic_finite_automaton * nondeterministic_finite_automaton::lang_unio
 }
 
 finite_automaton * nondeterministic_finite_automaton::lang_intersect(const finite_automaton &other) const
+// building the whole product, lazy_product::construct() is slower than
+// this from about 12 states on (see testsuites/lazy_product).
 {
 	finite_automaton * ret;
 	finite_automaton * d;
@@ -763,6 +755,7 @@ finite_automaton * nondeterministic_finite_automaton::lang_intersect(const finit
 }
 
 finite_automaton * nondeterministic_finite_automaton::lang_difference(const finite_automaton &other) const
+// see lang_intersect()
 {
 	finite_automaton * ret;
 	finite_automaton * d;
@@ -987,7 +980,76 @@ nfaa_deserialization_failed_fast:
 bool nondeterministic_finite_automaton::is_deterministic() const
 { return false; };
 
+// the transitions and initial and final states of a, in the form subset_construction takes them
+static void get_nfa_transitions(nfa a, vector<int> & transitions, vector<int> & initial, vector<int> & final)
+{
+	unsigned int letter, state, goal;
+
+	for(letter = (a->is_eps ? 0 : 1); letter <= a->alphabet_size; letter++) {
+		for(state = 0; state <= a->highest_state; state++) {
+			for(goal = 0; goal <= a->highest_state; goal++) {
+				if(testcon(a->delta, letter, state, goal)) {
+					transitions.push_back(state);
+					transitions.push_back((int)letter - 1);
+					transitions.push_back(goal);
+				}
+			}
+		}
+	}
+	for(state = 0; state <= a->highest_state; state++) {
+		if(isinit(a->infin[state]))
+			initial.push_back(state);
+		if(isfinal(a->infin[state]))
+			final.push_back(state);
+	}
+}
+
+// the constructed automaton, numbered as by nfa2dfa()
+static dfa subsets2dfa(const subset_construction & s, bool minimal)
+{
+	vector<int> number;
+	dfa d;
+	int state, label;
+
+	s.get_amore_order(number);
+
+	d = newdfa();
+	d->highest_state = s.get_state_count() - 1;
+	d->init = 0;
+	d->alphabet_size = s.get_alphabet_size();
+	d->final = newfinal(d->highest_state);
+	d->delta = newddelta(d->alphabet_size, d->highest_state);
+	for(state = 0; state < s.get_state_count(); state++) {
+		d->final[number[state]] = s.is_accepting(state) ? TRUE : FALSE;
+		for(label = 0; label < s.get_alphabet_size(); label++)
+			d->delta[label + 1][number[state]] = number[s.get_successor(state, label)];
+	}
+	d->minimal = minimal ? TRUE : FALSE;
+
+	return d;
+}
+
 finite_automaton * nondeterministic_finite_automaton::determinize() const
+{
+	return determinize(1, false);
+}
+
+finite_automaton * nondeterministic_finite_automaton::determinize(unsigned int threads, bool minimize) const
+{
+	vector<int> transitions, initial, final;
+
+	get_nfa_transitions(nfa_p, transitions, initial, final);
+	subset_construction s(nfa_p->alphabet_size, nfa_p->highest_state + 1, transitions, initial, final);
+	s.set_thread_count(threads);
+	if(minimize)
+		s.run_minimal();
+	else
+		s.run();
+
+	return new deterministic_finite_automaton(subsets2dfa(s, minimize));
+}
+
+finite_automaton * nondeterministic_finite_automaton::amore_determinize() const
 {
 	deterministic_finite_automaton *a;
 
@@ -0,0 +1,628 @@
+/* vim: fdm=syntax foldlevel=1 foldnestmax=2
+ * $Id$
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <string.h>
+
+#ifndef _WIN32
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+#include <amore++/subset_construction.h>
+
+namespace amore {
+
+using namespace std;
+
+// the hash table is split into 2^STRIPE_BITS stripes
+#define STRIPE_BITS 8
+// sets a thread takes from a level at once
+#define CHUNK_SIZE 64
+// a level is explored by one more thread for each MIN_SETS_PER_THREAD sets
+#define MIN_SETS_PER_THREAD 256
+
+static inline uint64_t hash_set(const uint64_t * set, unsigned int words)
+{
+	uint64_t h = 14695981039346656037ULL; // FNV offset basis
+	for(unsigned int i = 0; i < words; ++i) {
+		h ^= set[i];
+		h *= 1099511628211ULL; // FNV prime
+		h ^= h >> 31;
+	}
+	return h;
+}
+
+static inline bool intersects(const uint64_t * a, const uint64_t * b, unsigned int words)
+{
+	for(unsigned int i = 0; i < words; ++i)
+		if(a[i] & b[i])
+			return true;
+	return false;
+}
+
+// one stripe of the table of sets of states
+class set_stripe {
+	public:
+		vector<uint64_t> sets;
+		vector<uint64_t> hashes;
+		vector<int> ids;
+		// open addressing on entries, -1 is empty. size is a power of 2.
+		vector<int> slots;
+#ifndef _WIN32
+		pthread_mutex_t lock;
+#endif
+
+	public:
+		set_stripe()
+		{
+			slots.assign(16, -1);
+#ifndef _WIN32
+			pthread_mutex_init(&lock, NULL);
+#endif
+		}
+		~set_stripe()
+		{
+#ifndef _WIN32
+			pthread_mutex_destroy(&lock);
+#endif
+		}
+
+		void grow()
+		{
+			unsigned int e, slot, mask;
+
+			slots.assign(slots.size() * 2, -1);
+			mask = slots.size() - 1;
+			for(e = 0; e < ids.size(); ++e) {
+				slot = hashes[e] & mask;
+				while(slots[slot] != -1)
+					slot = (slot + 1) & mask;
+				slots[slot] = e;
+			}
+		}
+};
+
+// sets of states, each stored once. the number of a set is given when it
+// is added, so it is unique but depends on the order the threads add sets.
+class set_table {
+	protected:
+		unsigned int words;
+		set_stripe stripes[1 << STRIPE_BITS];
+		int size;
+
+	public:
+		set_table(unsigned int words)
+		{
+			this->words = words;
+			size = 0;
+		}
+
+		// returns the number of set. if it is new, the stripe and entry
+		// it was stored at are returned as well.
+		int intern(const uint64_t * set, bool & added, int & stripe, int & entry)
+		{
+			uint64_t h = hash_set(set, words);
+			set_stripe & s = stripes[h >> (64 - STRIPE_BITS)];
+			unsigned int slot, mask;
+			int e, id;
+
+#ifndef _WIN32
+			pthread_mutex_lock(&s.lock);
+#endif
+			mask = s.slots.size() - 1;
+			for(slot = h & mask; (e = s.slots[slot]) != -1; slot = (slot + 1) & mask) {
+				if(s.hashes[e] == h && 0 == memcmp(set, &s.sets[(size_t)e * words], words * sizeof(uint64_t))) {
+					id = s.ids[e];
+#ifndef _WIN32
+					pthread_mutex_unlock(&s.lock);
+#endif
+					added = false;
+					return id;
+				}
+			}
+			e = s.ids.size();
+			id = __sync_fetch_and_add(&size, 1);
+			s.sets.insert(s.sets.end(), set, set + words);
+			s.hashes.push_back(h);
+			s.ids.push_back(id);
+			s.slots[slot] = e;
+			if(2 * s.ids.size() > s.slots.size())
+				s.grow();
+#ifndef _WIN32
+			pthread_mutex_unlock(&s.lock);
+#endif
+			added = true;
+			stripe = h >> (64 - STRIPE_BITS);
+			entry = e;
+			return id;
+		}
+
+		int get_size() const
+		{ return size; }
+		int get_id(int stripe, int entry) const
+		{ return stripes[stripe].ids[entry]; }
+		const uint64_t * get_set(int stripe, int entry) const
+		{ return &stripes[stripe].sets[(size_t)entry * words]; }
+};
+
+// a part of the current level. next is taken atomically by the thread the
+// range belongs to and by threads stealing from it.
+class level_range {
+	public:
+		volatile unsigned int next;
+		unsigned int limit;
+};
+
+class level_explorer;
+
+class level_worker {
+	public:
+		level_explorer * level;
+		unsigned int index;
+		// (stripe, entry) of the sets this worker added to the table
+		vector<pair<int, int> > found;
+#ifndef _WIN32
+		pthread_t thread;
+#endif
+};
+
+// a level of the breadth-first search, and what is needed to explore it
+class level_explorer {
+	public:
+		int alphabet_size;
+		unsigned int words;
+		const unsigned int * offsets;
+		const int * targets;
+		set_table * table;
+		int * delta;
+
+		// sets of the level and their numbers
+		const uint64_t * sets;
+		const int * ids;
+
+		vector<level_range> ranges;
+		vector<level_worker> workers;
+};
+
+static void * explore_level(void * arg)
+{
+	level_worker * worker = (level_worker*) arg;
+	level_explorer * level = worker->level;
+	unsigned int words = level->words;
+	int alphabet_size = level->alphabet_size;
+	vector<uint64_t> next(words);
+	unsigned int r, i, w, first, limit, j;
+	int label, stripe, entry;
+	bool added;
+
+	// first own range, then steal from the others
+	for(r = 0; r < level->ranges.size(); ++r) {
+		level_range & range = level->ranges[(worker->index + r) % level->ranges.size()];
+		while((first = __sync_fetch_and_add(&range.next, CHUNK_SIZE)) < range.limit) {
+			limit = min(first + CHUNK_SIZE, range.limit);
+			for(i = first; i < limit; ++i) {
+				const uint64_t * set = level->sets + (size_t)i * words;
+				int * successors = level->delta + (size_t)level->ids[i] * alphabet_size;
+				for(label = 0; label < alphabet_size; ++label) {
+					fill(next.begin(), next.end(), 0);
+					for(w = 0; w < words; ++w) {
+						uint64_t bits = set[w];
+						while(bits) {
+							unsigned int b = (w * 64 + __builtin_ctzll(bits)) * alphabet_size + label;
+							bits &= bits - 1;
+							for(j = level->offsets[b]; j < level->offsets[b+1]; ++j)
+								next[level->targets[j] >> 6] |= 1ULL << (level->targets[j] & 63);
+						}
+					}
+					successors[label] = level->table->intern(&next[0], added, stripe, entry);
+					if(added)
+						worker->found.push_back(pair<int, int>(stripe, entry));
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+subset_construction::subset_construction(int alphabet_size, int state_count, const vector<int> & transitions,
+		const vector<int> & initial_states, const vector<int> & final_states)
+{
+	thread_count = 0;
+	init(alphabet_size, state_count, transitions, initial_states, final_states);
+}
+
+subset_construction::subset_construction(const finite_automaton & a)
+{
+	map<int, map<int, set<int> > > t;
+	map<int, map<int, set<int> > >::const_iterator mmsi;
+	map<int, set<int> >::const_iterator msi;
+	set<int>::const_iterator si;
+	vector<int> transitions;
+	set<int> initial_states, final_states;
+
+	a.get_transitions(t);
+	for(mmsi = t.begin(); mmsi != t.end(); ++mmsi) {
+		for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
+			for(si = msi->second.begin(); si != msi->second.end(); ++si) {
+				transitions.push_back(mmsi->first);
+				transitions.push_back(msi->first);
+				transitions.push_back(*si);
+			}
+		}
+	}
+	initial_states = a.get_initial_states();
+	final_states = a.get_final_states();
+
+	thread_count = 0;
+	init(a.get_alphabet_size(), a.get_state_count(), transitions,
+			vector<int>(initial_states.begin(), initial_states.end()),
+			vector<int>(final_states.begin(), final_states.end()));
+}
+
+void subset_construction::init(int alphabet_size, int state_count, const vector<int> & transitions,
+		const vector<int> & initial_states, const vector<int> & final_states)
+{
+	vector<int> epsilon;
+	vector<unsigned int> position;
+	unsigned int i, j, b, buckets, begin, end, out;
+
+	this->alphabet_size = alphabet_size;
+	nfa_state_count = state_count;
+	words = (state_count + 63) / 64;
+	if(words == 0)
+		words = 1;
+	this->state_count = 0;
+	delta.clear();
+	accepting.clear();
+
+	initial.assign(words, 0);
+	for(i = 0; i < initial_states.size(); ++i)
+		initial[initial_states[i] >> 6] |= 1ULL << (initial_states[i] & 63);
+	final.assign(words, 0);
+	for(i = 0; i < final_states.size(); ++i)
+		final[final_states[i] >> 6] |= 1ULL << (final_states[i] & 63);
+
+	for(i = 0; i + 2 < transitions.size(); i += 3) {
+		if(transitions[i+1] < 0) {
+			epsilon.push_back(transitions[i]);
+			epsilon.push_back(transitions[i+2]);
+		}
+	}
+
+	if(!epsilon.empty()) {
+		// enfa2nfa() changes the rows of its transition table in place,
+		// and thus does not add all transitions of the epsilon-closure.
+		// to get the same automaton, do the same, but with bitsets.
+		vector<uint64_t> rows((size_t)alphabet_size * state_count * words, 0);
+		vector<uint64_t> closure((size_t)state_count * words, 0);
+		vector<unsigned int> eps_offsets(state_count + 1, 0);
+		vector<int> eps_targets(epsilon.size() / 2);
+		vector<int> stack;
+		vector<uint64_t> via(words), reach(words);
+		int s, c, label;
+		unsigned int w;
+
+		for(i = 0; i + 2 < transitions.size(); i += 3)
+			if(transitions[i+1] >= 0)
+				rows[((size_t)transitions[i+1] * state_count + transitions[i]) * words + (transitions[i+2] >> 6)]
+					|= 1ULL << (transitions[i+2] & 63);
+
+		// reflexive and transitive epsilon-closure of each state
+		for(i = 0; i < epsilon.size(); i += 2)
+			eps_offsets[epsilon[i] + 1]++;
+		for(s = 0; s < state_count; ++s)
+			eps_offsets[s+1] += eps_offsets[s];
+		position.assign(eps_offsets.begin(), eps_offsets.end() - 1);
+		for(i = 0; i < epsilon.size(); i += 2)
+			eps_targets[position[epsilon[i]]++] = epsilon[i+1];
+		for(s = 0; s < state_count; ++s) {
+			uint64_t * row = &closure[(size_t)s * words];
+			row[s >> 6] |= 1ULL << (s & 63);
+			stack.push_back(s);
+			while(!stack.empty()) {
+				c = stack.back();
+				stack.pop_back();
+				for(j = eps_offsets[c]; j < eps_offsets[c+1]; ++j) {
+					int t = eps_targets[j];
+					if(!(row[t >> 6] & (1ULL << (t & 63)))) {
+						row[t >> 6] |= 1ULL << (t & 63);
+						stack.push_back(t);
+					}
+				}
+			}
+		}
+
+		// an initial state that reaches a final state via epsilon becomes final
+		for(s = 0; s < state_count; ++s)
+			if((initial[s >> 6] & (1ULL << (s & 63))) && intersects(&closure[(size_t)s * words], &final[0], words))
+				final[s >> 6] |= 1ULL << (s & 63);
+
+		// goal is added to the row of state if there is a cut with an
+		// epsilon-path from state to cut and (cut, label, goal) or with
+		// (state, label, cut) and an epsilon-path from cut to goal. rows
+		// of cuts < state already have their additions, rows of cuts >
+		// state not. goals are visited in ascending order, so additions
+		// to the row of state count only for greater goals.
+		for(label = 0; label < alphabet_size; ++label) {
+			uint64_t * letter_rows = &rows[(size_t)label * state_count * words];
+			for(s = 0; s < state_count; ++s) {
+				uint64_t * row = letter_rows + (size_t)s * words;
+				const uint64_t * cl = &closure[(size_t)s * words];
+
+				fill(via.begin(), via.end(), 0);
+				fill(reach.begin(), reach.end(), 0);
+				for(w = 0; w < words; ++w) {
+					uint64_t bits = cl[w];
+					while(bits) {
+						c = w * 64 + __builtin_ctzll(bits);
+						bits &= bits - 1;
+						if(c != s)
+							for(j = 0; j < words; ++j)
+								via[j] |= letter_rows[(size_t)c * words + j];
+					}
+					bits = row[w];
+					while(bits) {
+						c = w * 64 + __builtin_ctzll(bits);
+						bits &= bits - 1;
+						for(j = 0; j < words; ++j)
+							reach[j] |= closure[(size_t)c * words + j];
+					}
+				}
+				for(w = 0; w < words; ++w) {
+					uint64_t done = 0, m;
+					while(0 != (m = (via[w] | reach[w]) & ~row[w] & ~done)) {
+						uint64_t bit = m & (~m + 1);
+						c = w * 64 + __builtin_ctzll(m);
+						done |= bit | (bit - 1);
+						row[w] |= bit;
+						for(j = 0; j < words; ++j)
+							reach[j] |= closure[(size_t)c * words + j];
+					}
+				}
+			}
+		}
+
+		set_rows(rows);
+		return;
+	}
+
+	// sort transitions into (state, label) buckets, then sort and unify each bucket
+	buckets = state_count * alphabet_size;
+	offsets.assign(buckets + 1, 0);
+	for(i = 0; i + 2 < transitions.size(); i += 3)
+		offsets[transitions[i] * alphabet_size + transitions[i+1] + 1]++;
+	for(b = 0; b < buckets; ++b)
+		offsets[b+1] += offsets[b];
+	targets.resize(offsets[buckets]);
+	position.assign(offsets.begin(), offsets.end() - 1);
+	for(i = 0; i + 2 < transitions.size(); i += 3)
+		targets[position[transitions[i] * alphabet_size + transitions[i+1]]++] = transitions[i+2];
+
+	out = 0;
+	begin = 0;
+	for(b = 0; b < buckets; ++b) {
+		end = offsets[b+1];
+		sort(targets.begin() + begin, targets.begin() + end);
+		end = unique(targets.begin() + begin, targets.begin() + end) - targets.begin();
+		offsets[b] = out;
+		for(j = begin; j < end; ++j)
+			targets[out++] = targets[j];
+		begin = offsets[b+1];
+	}
+	offsets[buckets] = out;
+	targets.resize(out);
+}
+
+void subset_construction::set_rows(const vector<uint64_t> & rows)
+{
+	int s, label;
+	unsigned int w;
+
+	offsets.assign((size_t)nfa_state_count * alphabet_size + 1, 0);
+	targets.clear();
+	for(s = 0; s < nfa_state_count; ++s) {
+		for(label = 0; label < alphabet_size; ++label) {
+			const uint64_t * row = &rows[((size_t)label * nfa_state_count + s) * words];
+			for(w = 0; w < words; ++w) {
+				uint64_t bits = row[w];
+				while(bits) {
+					targets.push_back(w * 64 + __builtin_ctzll(bits));
+					bits &= bits - 1;
+				}
+			}
+			offsets[s * alphabet_size + label + 1] = targets.size();
+		}
+	}
+}
+
+void subset_construction::set_thread_count(unsigned int threads)
+{
+	thread_count = threads;
+}
+
+void subset_construction::run()
+{
+	set_table * table = new set_table(words);
+	level_explorer level;
+	vector<uint64_t> sets, next_sets;
+	vector<int> ids, next_ids;
+	unsigned int threads, used, i, j, started;
+	int stripe, entry, id;
+	bool added;
+
+	threads = thread_count;
+#ifdef _WIN32
+	threads = 1;
+#else
+	if(threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? cpus : 1;
+	}
+#endif
+
+	// the initial set is state 0 (even if empty)
+	table->intern(&initial[0], added, stripe, entry);
+	state_count = 1;
+	delta.assign(alphabet_size, 0);
+	accepting.assign(1, intersects(&initial[0], &final[0], words));
+	sets = initial;
+	ids.assign(1, 0);
+
+	level.alphabet_size = alphabet_size;
+	level.words = words;
+	level.offsets = &offsets[0];
+	level.targets = targets.empty() ? NULL : &targets[0];
+	level.table = table;
+
+	while(!ids.empty()) {
+		used = min(threads, (unsigned int)(ids.size() / MIN_SETS_PER_THREAD));
+		if(used == 0)
+			used = 1;
+
+		level.delta = &delta[0];
+		level.sets = &sets[0];
+		level.ids = &ids[0];
+		level.ranges.resize(used);
+		level.workers.resize(used);
+		for(i = 0; i < used; ++i) {
+			level.ranges[i].next = (unsigned long long int)ids.size() * i / used;
+			level.ranges[i].limit = (unsigned long long int)ids.size() * (i+1) / used;
+			level.workers[i].level = &level;
+			level.workers[i].index = i;
+			level.workers[i].found.clear();
+		}
+
+		// the calling thread is worker 0. ranges of workers that could
+		// not be started are taken by the others.
+		started = 1;
+#ifndef _WIN32
+		for(/* -- */; started < used; ++started)
+			if(0 != pthread_create(&level.workers[started].thread, NULL, explore_level, &level.workers[started]))
+				break;
+#endif
+		explore_level(&level.workers[0]);
+#ifndef _WIN32
+		for(i = 1; i < started; ++i)
+			pthread_join(level.workers[i].thread, NULL);
+#endif
+
+		// the sets found form the next level
+		state_count = table->get_size();
+		delta.resize((size_t)state_count * alphabet_size);
+		accepting.resize(state_count);
+		next_sets.clear();
+		next_ids.clear();
+		for(i = 0; i < started; ++i) {
+			vector<pair<int, int> > & found = level.workers[i].found;
+			for(j = 0; j < found.size(); ++j) {
+				const uint64_t * set = table->get_set(found[j].first, found[j].second);
+				id = table->get_id(found[j].first, found[j].second);
+				next_ids.push_back(id);
+				next_sets.insert(next_sets.end(), set, set + words);
+				accepting[id] = intersects(set, &final[0], words);
+			}
+		}
+		sets.swap(next_sets);
+		ids.swap(next_ids);
+	}
+
+	delete table;
+}
+
+void subset_construction::run_minimal()
+{
+	reverse_input();
+	run();
+	reverse_result();
+	run();
+}
+
+void subset_construction::reverse_input()
+{
+	vector<int> transitions, initial_states, final_states;
+	int s, label;
+	unsigned int j;
+
+	for(s = 0; s < nfa_state_count; ++s) {
+		for(label = 0; label < alphabet_size; ++label) {
+			for(j = offsets[s * alphabet_size + label]; j < offsets[s * alphabet_size + label + 1]; ++j) {
+				transitions.push_back(targets[j]);
+				transitions.push_back(label);
+				transitions.push_back(s);
+			}
+		}
+		if(initial[s >> 6] & (1ULL << (s & 63)))
+			final_states.push_back(s);
+		if(final[s >> 6] & (1ULL << (s & 63)))
+			initial_states.push_back(s);
+	}
+	init(alphabet_size, nfa_state_count, transitions, initial_states, final_states);
+}
+
+void subset_construction::reverse_result()
+{
+	vector<int> transitions, initial_states, final_states;
+	int s, label;
+
+	for(s = 0; s < state_count; ++s) {
+		for(label = 0; label < alphabet_size; ++label) {
+			transitions.push_back(delta[s * alphabet_size + label]);
+			transitions.push_back(label);
+			transitions.push_back(s);
+		}
+		if(accepting[s])
+			initial_states.push_back(s);
+	}
+	final_states.push_back(0);
+	init(alphabet_size, state_count, transitions, initial_states, final_states);
+}
+
+void subset_construction::get_amore_order(vector<int> & number) const
+{
+	vector<int> stack;
+	int state, label, next = 0;
+
+	number.assign(state_count, -1);
+	number[0] = 0;
+	stack.push_back(0);
+	while(!stack.empty()) {
+		state = stack.back();
+		stack.pop_back();
+		for(label = 0; label < alphabet_size; ++label) {
+			int s = delta[state * alphabet_size + label];
+			if(number[s] < 0) {
+				number[s] = ++next;
+				stack.push_back(s);
+			}
+		}
+	}
+}
+
+}; // end namespace amore
+
@@ -0,0 +1,87 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+
+// regression test for inclusion() of libAMoRE (testBinary.c), which backs
+// lang_subset_of(), lang_disjoint_to() and operator== of
+// deterministic_finite_automaton. it used to skip the pair of initial
+// states, so a counterexample that is the empty word went unnoticed.
+
+#include <iostream>
+#include <map>
+#include <set>
+
+#include <amore++/deterministic_finite_automaton.h>
+
+using namespace std;
+using namespace amore;
+
+// over {0,1}: accepts only the empty word if epsilon is set, else nothing.
+// both have a sink, so transitions are total.
+finite_automaton * small_dfa(bool epsilon)
+{{{
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	initial.insert(0);
+	if(epsilon)
+		final.insert(0);
+	for(int l = 0; l < 2; ++l) {
+		transitions[0][l].insert(1);
+		transitions[1][l].insert(1);
+	}
+
+	return construct_amore_automaton(true, 2, 2, initial, final, transitions);
+}}}
+
+int check(const char * what, bool result, bool expected)
+{{{
+	cout << what << ": " << (result ? "true" : "false");
+	if(result != expected) {
+		cout << ", expected " << (expected ? "true" : "false") << "!\n";
+		return 1;
+	}
+	cout << "\n";
+	return 0;
+}}}
+
+int main()
+{{{
+	int errors = 0;
+	finite_automaton * eps = small_dfa(true);
+	finite_automaton * none = small_dfa(false);
+
+	errors += check("{e} subset of {}", eps->lang_subset_of(*none), false);
+	errors += check("{} subset of {e}", none->lang_subset_of(*eps), true);
+	errors += check("{e} subset of {e}", eps->lang_subset_of(*eps), true);
+	errors += check("{e} disjoint to {e}", eps->lang_disjoint_to(*eps), false);
+	errors += check("{e} disjoint to {}", eps->lang_disjoint_to(*none), true);
+	errors += check("{e} == {}", *eps == *none, false);
+	errors += check("{e} == {e}", *eps == *eps, true);
+
+	delete eps;
+	delete none;
+
+	return errors ? 1 : 0;
+}}}
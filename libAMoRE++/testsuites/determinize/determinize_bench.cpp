@@ -0,0 +1,167 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// compares determinize() of nondeterministic_finite_automaton (subset
+// construction with several threads) against AMoRE's nfa2dfa() on random
+// NFAs, with and without epsilon-transitions. the automata have to be
+// identical, including the numbering of states. the minimal automaton
+// constructed directly has to be equivalent to the minimized one.
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <liblangen/nfa_randomgenerator.h>
+#include <liblangen/prng.h>
+
+#include <amore++/nondeterministic_finite_automaton.h>
+#include <amore++/deterministic_finite_automaton.h>
+
+using namespace std;
+using namespace amore;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+nondeterministic_finite_automaton * random_nfa(nfa_randomgenerator & rg, int alphabet_size, int state_count, bool epsilon)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, 2, 0.2, 0.3, is_dfa, asize, states, initial, final, transitions);
+	if(epsilon)
+		for(int i = 0; i < states / 4; ++i)
+			transitions[prng::random_int(states)][-1].insert(prng::random_int(states));
+	return dynamic_cast<nondeterministic_finite_automaton*>(construct_amore_automaton(false, asize, states, initial, final, transitions));
+}}}
+
+bool identical(finite_automaton * a, finite_automaton * b)
+{{{
+	map<int, map<int, set<int> > > ta, tb;
+
+	if(a->get_state_count() != b->get_state_count())
+		return false;
+	if(a->get_initial_states() != b->get_initial_states())
+		return false;
+	if(a->get_final_states() != b->get_final_states())
+		return false;
+	a->get_transitions(ta);
+	b->get_transitions(tb);
+	return ta == tb;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 3;
+	int max_states = 48;
+	unsigned int threads = 4;
+	int errors = 0;
+	nfa_randomgenerator rg;
+
+	if(argc == 4) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+		threads       = atoi(argv[3]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states\n"
+			"\t3: number of threads\n";
+		return 1;
+	}
+
+	printf("states  eps    dfa states   nfa2dfa us   1 thread us  %2u threads us   min states  minimize us  Brzozowski us\n", threads);
+
+	for(int state_count = 4; state_count <= max_states; state_count += 4) {
+		for(int epsilon = 0; epsilon < 2; ++epsilon) {
+			unsigned long long int start, t[5];
+			nondeterministic_finite_automaton * n;
+			finite_automaton *classic, *single, *parallel, *minimized, *minimal;
+
+			n = random_nfa(rg, alphabet_size, state_count, epsilon);
+
+			start = usecs();
+			classic = n->amore_determinize();
+			t[0] = usecs() - start;
+
+			start = usecs();
+			single = n->determinize(1);
+			t[1] = usecs() - start;
+
+			start = usecs();
+			parallel = n->determinize(threads);
+			t[2] = usecs() - start;
+
+			if(!identical(classic, single)) {
+				printf("determinize() with 1 thread differs from nfa2dfa()!\n");
+				errors++;
+			}
+			if(!identical(classic, parallel)) {
+				printf("determinize() with %u threads differs from nfa2dfa()!\n", threads);
+				errors++;
+			}
+
+			start = usecs();
+			minimized = classic->clone();
+			minimized->minimize();
+			t[3] = usecs() - start;
+
+			start = usecs();
+			minimal = n->determinize(threads, true);
+			t[4] = usecs() - start;
+
+			if(minimal->get_state_count() != minimized->get_state_count() || !(*minimal == *minimized)) {
+				printf("minimal automaton differs!\n");
+				errors++;
+			}
+
+			printf("%6d  %3s  %12d  %11llu  %12llu  %13llu  %11d  %11llu  %13llu\n",
+					state_count, epsilon ? "yes" : "no", classic->get_state_count(),
+					t[0], t[1], t[2], minimized->get_state_count(), t[0] + t[3], t[4]);
+			fflush(stdout);
+
+			delete minimal;
+			delete minimized;
+			delete parallel;
+			delete single;
+			delete classic;
+			delete n;
+		}
+	}
+
+	return errors ? 1 : 0;
+}}}
+
@@ -0,0 +1,179 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libAMoRE++
+ *
+ * libAMoRE++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libAMoRE++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libAMoRE++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// compares the lazy product (lang_subset_of(), lang_disjoint_to() and
+// is_empty() of nondeterministic_finite_automaton, and
+// lazy_product::construct() for intersection and difference) against the
+// classic way via determinize() on random NFAs. both have to agree.
+// emptiness is checked on the intersection, which may be empty.
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <liblangen/nfa_randomgenerator.h>
+
+#include <amore++/nondeterministic_finite_automaton.h>
+#include <amore++/deterministic_finite_automaton.h>
+#include <amore++/lazy_product.h>
+
+using namespace std;
+using namespace amore;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+finite_automaton * random_nfa(nfa_randomgenerator & rg, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, 2, 0.2, 0.3, is_dfa, asize, states, initial, final, transitions);
+	return construct_amore_automaton(false, asize, states, initial, final, transitions);
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 20;
+	int errors = 0;
+	nfa_randomgenerator rg;
+
+	if(argc == 3) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states\n";
+		return 1;
+	}
+
+	printf("states   subset lazy us  classic us   disjoint lazy us  classic us   intersect lazy us  classic us"
+		"   empty lazy us  classic us   difference lazy us  classic us\n");
+
+	for(int state_count = 4; state_count <= max_states; state_count += 4) {
+		unsigned long long int start, t[10];
+		bool lazy, classic;
+		finite_automaton *a, *b, *d, *i;
+
+		a = random_nfa(rg, alphabet_size, state_count);
+		b = random_nfa(rg, alphabet_size, state_count);
+
+		// inclusion
+		start = usecs();
+		lazy = a->lang_subset_of(*b);
+		t[0] = usecs() - start;
+		start = usecs();
+		d = a->determinize();
+		classic = d->lang_subset_of(*b);
+		delete d;
+		t[1] = usecs() - start;
+		if(lazy != classic) {
+			printf("lang_subset_of() differs!\n");
+			errors++;
+		}
+
+		// disjointness
+		start = usecs();
+		lazy = a->lang_disjoint_to(*b);
+		t[2] = usecs() - start;
+		start = usecs();
+		d = a->determinize();
+		classic = d->lang_disjoint_to(*b);
+		delete d;
+		t[3] = usecs() - start;
+		if(lazy != classic) {
+			printf("lang_disjoint_to() differs!\n");
+			errors++;
+		}
+
+		// intersection, compared as languages
+		start = usecs();
+		i = lazy_product(*a, *b, lazy_product::INTERSECTION).construct();
+		t[4] = usecs() - start;
+		start = usecs();
+		d = a->determinize();
+		finite_automaton * ci = d->lang_intersect(*b);
+		delete d;
+		t[5] = usecs() - start;
+		if(!(*ci == *i)) {
+			printf("lang_intersect() differs!\n");
+			errors++;
+		}
+		delete ci;
+
+		// emptiness of the intersection
+		start = usecs();
+		lazy = i->is_empty();
+		t[6] = usecs() - start;
+		start = usecs();
+		d = i->determinize();
+		classic = d->is_empty();
+		delete d;
+		t[7] = usecs() - start;
+		if(lazy != classic) {
+			printf("is_empty() differs!\n");
+			errors++;
+		}
+		delete i;
+
+		// difference, compared as languages
+		start = usecs();
+		i = lazy_product(*a, *b, lazy_product::DIFFERENCE).construct();
+		t[8] = usecs() - start;
+		start = usecs();
+		d = a->determinize();
+		ci = d->lang_difference(*b);
+		delete d;
+		t[9] = usecs() - start;
+		if(!(*ci == *i)) {
+			printf("lang_difference() differs!\n");
+			errors++;
+		}
+		delete ci;
+		delete i;
+
+		printf("%6d   %15llu %11llu   %16llu %11llu   %17llu %11llu   %13llu %11llu   %18llu %11llu\n", state_count,
+				t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], t[8], t[9]);
+		fflush(stdout);
+
+		delete a;
+		delete b;
+	}
+
+	return errors ? 1 : 0;
+}}}
@@ -128,7 +128,12 @@ boole inclusion(dfa dfa1, dfa dfa2, boole inclusion)
 	actuel = 1 + q1 + (q2 * (dfa1->highest_state + 1));
 	last = actuel;
 	mark[last] = max;	/* mark (q1,q2) */
-	while(actuel && result) {
+	/* the initial pair is not reached by a letter */
+	if(inclusion)
+		result = !(dfa1->final[q1] && (!dfa2->final[q2]));
+	else
+		result = !(dfa1->final[q1] && dfa2->final[q2]);
+	while((actuel != max) && result) {
 		for (letter = 1; letter <= dfa1->alphabet_size; letter++) {
 
 			r1 = dfa1->delta[letter][q1];
@@ -42,8 +42,10 @@ namespace amore_alf_glue {
 inline amore::finite_automaton * automaton_libalf2amore(libalf::finite_automaton & automaton)
 {{{
 	std::set<int> final_states;
+	std::map<int, std::map<int, std::set<int> > > transitions;
 	automaton.get_final_states(final_states);
-	return amore::construct_amore_automaton(automaton.is_deterministic, automaton.input_alphabet_size, automaton.state_count, automaton.initial_states, final_states, automaton.transitions);
+	automaton.get_transitions(transitions); // also for flat storage
+	return amore::construct_amore_automaton(automaton.is_deterministic, automaton.input_alphabet_size, automaton.state_count, automaton.initial_states, final_states, transitions);
 }}}
 
 inline libalf::finite_automaton * automaton_amore2libalf(amore::finite_automaton & automaton)
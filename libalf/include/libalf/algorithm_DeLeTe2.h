@@ -148,6 +148,7 @@ class DeLeTe2 : public learning_algorithm<answer> {
 			}
 		}}}
 
+		using learning_algorithm<answer>::add_counterexample;
 		// stubs for counterexample will throw a warning to the logger
 		virtual bool add_counterexample(std::list<int>)
 		{{{
@@ -26,6 +26,7 @@
 # define __libalf_algorithm_NLstar_h__
 
 #include <list>
+#include <iterator>
 #include <vector>
 #include <string>
 #include <ostream>
@@ -39,6 +40,8 @@
 #include <libalf/answer.h>
 #include <libalf/learning_algorithm.h>
 #include <libalf/serialize.h>
+#include <libalf/packed_acceptances.h>
+#include <libalf/parallel_fill.h>
 
 namespace libalf {
 
@@ -49,61 +52,38 @@ namespace libalf {
  *	  http://www.lsv.ens-cachan.fr/Publis/RAPPORTS_LSV/PDF/rr-lsv-2008-28.pdf
  *
  * NOTE: this version does only support bool as <answer>.
+ *
+ * rows are stored as row_acceptances, by default bit-packed for bool (see
+ * packed_acceptances.h), so that covering and joining rows work on whole
+ * machine words.
+ *
+ * with set_fill_threads(n), n > 1, missing columns are first looked up in the
+ * knowledgebase by n threads (see parallel_fill.h).
  */
 
-template <class answer>
+template <class answer, class row_acceptances = typename acceptances_for<answer>::type>
 class NLstar_table : public learning_algorithm<answer> {
 	public:
 		typedef std::list< std::list<int> > columnlist;
 
 		class table_row {
 			public:
-				typedef std::vector<answer> acceptances;
+				typedef row_acceptances acceptances;
 			public:
 				std::list<int> index;
 				acceptances acceptance;
 			public:
 				bool __attribute__((const)) covers(table_row & other) const
 				{{{
-					typename acceptances::const_iterator ai1, ai2;
-					for(ai1 = this->acceptance.begin(), ai2 = other.acceptance.begin(); ai1 != this->acceptance.end() && ai2 != other.acceptance.end(); ai1++, ai2++)
-						if(*ai1 == false && *ai2 == true)
-							return false;
-
-					return ( ai1 == this->acceptance.end() && ai2 == other.acceptance.end() );
+					return acceptances_cover(this->acceptance, other.acceptance);
 				}}}
 				bool __attribute__((const)) mutual_noncover(table_row & other) const
 				{{{
-					typename acceptances::const_iterator ai1, ai2;
-					bool tNCo = false, oNCt = false;
-					for(ai1 = this->acceptance.begin(), ai2 = other.acceptance.begin(); ai1 != this->acceptance.end() && ai2 != other.acceptance.end(); ai1++, ai2++) {
-						if(*ai1 == false && *ai2 == true) {
-							if(oNCt)
-								return true;
-							else
-								tNCo = true;
-						}
-						if(*ai1 == true && *ai2 == false) {
-							if(tNCo)
-								return true;
-							else
-								oNCt = true;
-						}
-					}
-
-					if( ai1 == this->acceptance.end() && ai2 == other.acceptance.end() )
-						return tNCo && oNCt;
-					else
-						return false;
+					return acceptances_mutual_noncover(this->acceptance, other.acceptance);
 				}}}
 				bool __attribute__((const)) operator==(table_row & other) const
 				{{{
-					typename acceptances::const_iterator ai1, ai2;
-					for(ai1 = this->acceptance.begin(), ai2 = other.acceptance.begin(); ai1 != this->acceptance.end() && ai2 != other.acceptance.end(); ai1++, ai2++)
-						if(*ai1 != *ai2)
-							return false;
-
-					return ( ai1 == this->acceptance.end() && ai2 == other.acceptance.end() );
+					return this->acceptance == other.acceptance;
 				}}}
 				bool __attribute__((const)) operator!=(table_row & other) const
 				{{{
@@ -113,10 +93,7 @@ class NLstar_table : public learning_algorithm<answer> {
 				// join other row into this row
 				void operator|=(table_row & other)
 				{{{
-					typename acceptances::iterator ai1, ai2;
-					for(ai1 = this->acceptance.begin(), ai2 = other.acceptance.begin(); ai1 != this->acceptance.end() && ai2 != other.acceptance.end(); ai1++, ai2++)
-						if(*ai2 == true)
-							*ai1 = true;
+					acceptances_join(this->acceptance, other.acceptance);
 				}}}
 
 				std::basic_string<int32_t> serialize() const
@@ -161,7 +138,7 @@ fail:
 					std::list< std::list<int> >::const_iterator acci;
 
 					s = sizeof(std::list<int>) + sizeof(int) * index.size();
-					s += sizeof(acceptances) + sizeof(answer) * acceptance.size();
+					s += acceptances_memory_usage(acceptance);
 
 					return s;
 				}}}
@@ -177,6 +154,11 @@ fail:
 
 		bool initialized;
 
+		// number of threads for fill_missing_columns()
+		unsigned int fill_threads;
+		// missing cells a table needs per fill thread
+		unsigned int fill_min_cells;
+
 	public:
 		NLstar_table(knowledgebase<answer> *base, logger *log, int alphabet_size)
 		{{{
@@ -184,8 +166,23 @@ fail:
 			this->set_logger(log);
 			this->set_knowledge_source(base);
 			initialized = false;
+			fill_threads = 1;
+			fill_min_cells = parallel_table_filler<answer, table>::default_min_cells_per_thread;
 		}}}
 
+		// fill missing columns with this many threads (1: serially). a
+		// table gets one thread per min_cells missing cells at most.
+		// the knowledgebase must not be used by others during advance().
+		void set_fill_threads(unsigned int threads, unsigned int min_cells = parallel_table_filler<answer, table>::default_min_cells_per_thread)
+		{{{
+			fill_threads = (threads > 0) ? threads : 1;
+			fill_min_cells = min_cells;
+		}}}
+		unsigned int get_fill_threads() const
+		{ return fill_threads; }
+		unsigned int get_fill_min_cells() const
+		{ return fill_min_cells; }
+
 		virtual enum learning_algorithm_type get_type() const
 		{ return ALG_NL_STAR; };
 
@@ -338,6 +335,7 @@ deserialization_failed:
 			return initialized && columns_filled() && is_closed() && is_consistent();
 		}}}
 
+		using learning_algorithm<answer>::add_counterexample;
 		virtual bool add_counterexample(std::list<int> w)
 		{{{
 			if(this->my_knowledge == NULL) {
@@ -393,14 +391,12 @@ deserialization_failed:
 //			(*this->my_logger)(LOGGER_DEBUG, "\tchecking if %s is prime:\n", s.c_str());
 			table_row merge;
 			int cn = column_names.size();
-			int i;
 			bool joined = false; // avoid taking a pure "-" row as non prime
 
 			// initialize merge-row
 			answer a_false;
 			a_false = false;
-			for(i = 0; i < cn; i++)
-				merge.acceptance.push_back(a_false);
+			merge.acceptance.assign(cn, a_false);
 
 			// join all covered rows into merge-row
 			typename table::iterator ti;
@@ -527,41 +523,58 @@ deserialization_failed:
 			typename table::iterator ti;
 			bool complete = true;
 
-			// upper table
-			for(ti = t.begin(); ti != t.end(); ti++) {
-				if(ti->acceptance.size() < column_names.size()) {
-					if(!ti->index.empty() && ti->index.front() == BOTTOM_CHAR) {
-						int delta = column_names.size() - ti->acceptance.size();
-						answer a;
-						a = false;
-						for(/* -- */; delta > 0; delta--)
+			if(fill_threads > 1) {
+				// look up all cells in parallel, add the queries serially
+				parallel_table_filler<answer, table> filler(*this->my_knowledge, t, column_names);
+
+				filler.set_min_cells_per_thread(fill_min_cells);
+				complete = filler.complete(filler.fill(fill_threads));
+			} else {
+				for(ti = t.begin(); ti != t.end(); ti++)
+					if(!fill_missing_columns(ti))
+						complete = false;
+			}
+
+			return complete;
+		}}}
+
+		// fill the missing columns of a single row. return value as above.
+		virtual bool fill_missing_columns(typename table::iterator ti)
+		{{{
+			bool complete = true;
+
+			if(ti->acceptance.size() < column_names.size()) {
+				if(!ti->index.empty() && ti->index.front() == BOTTOM_CHAR) {
+					int delta = column_names.size() - ti->acceptance.size();
+					answer a;
+					a = false;
+					for(/* -- */; delta > 0; delta--)
+						ti->acceptance.push_back(a);
+				} else {
+					// fill in missing acceptance information
+					columnlist::iterator ci;
+					ci = column_names.begin();
+					for(int i = ti->acceptance.size(); i > 0; i--)
+						ci++;
+					bool column_skipped = false;
+					for(/* -- */; ci != column_names.end(); ci++) {
+						if(!ci->empty() && ci->front() == BOTTOM_CHAR) {
+							answer a;
+							a = false;
 							ti->acceptance.push_back(a);
-					} else {
-						// fill in missing acceptance information
-						columnlist::iterator ci;
-						ci = column_names.begin();
-						for(int i = ti->acceptance.size(); i > 0; i--)
-							ci++;
-						bool column_skipped = false;
-						for(/* -- */; ci != column_names.end(); ci++) {
-							if(!ci->empty() && ci->front() == BOTTOM_CHAR) {
-								answer a;
-								a = false;
-								ti->acceptance.push_back(a);
+						} else {
+							std::list<int> *w;
+							w = concat(ti->index, *ci);
+							answer a;
+							if(this->my_knowledge->resolve_or_add_query(*w, a)) {
+								if(!column_skipped)
+									ti->acceptance.push_back(a);
 							} else {
-								std::list<int> *w;
-								w = concat(ti->index, *ci);
-								answer a;
-								if(this->my_knowledge->resolve_or_add_query(*w, a)) {
-									if(!column_skipped)
-										ti->acceptance.push_back(a);
-								} else {
-									column_skipped = true;
-									complete = false;
-								}
-
-								delete w;
+								column_skipped = true;
+								complete = false;
 							}
+
+							delete w;
 						}
 					}
 				}
@@ -596,7 +609,6 @@ deserialization_failed:
 			typename table::iterator ti;
 			std::list<typename table::iterator> upper_primes;
 			// prepare merge row
-			int i;
 			int cn = column_names.size();
 			bool first = true;
 			table_row merge;
@@ -609,8 +621,7 @@ deserialization_failed:
 
 			first = true;
 			a_false = false;
-			for(i = 0; i < cn; i++)
-				merge.acceptance.push_back(a_false);
+			merge.acceptance.assign(cn, a_false);
 
 			// now check closed-ness of lower table
 			for(ti = lower_table.begin(); ti != lower_table.end(); ti++) {
@@ -618,8 +629,7 @@ deserialization_failed:
 				if(first)
 					first = false;
 				else
-					for(i = 0; i < cn; i++)
-						merge.acceptance[i] = a_false;
+					merge.acceptance.assign(cn, a_false);
 
 				bool joined = false;
 				typename std::list<typename table::iterator>::iterator pri;
@@ -648,7 +658,6 @@ deserialization_failed:
 			typename table::iterator ti;
 			std::list<typename table::iterator> upper_primes;
 			// prepare merge row
-			int i;
 			int cn = column_names.size();
 			bool first = true;
 			table_row merge;
@@ -664,8 +673,7 @@ deserialization_failed:
 
 			first = true;
 			a_false = false;
-			for(i = 0; i < cn; i++)
-				merge.acceptance.push_back(a_false);
+			merge.acceptance.assign(cn, a_false);
 
 //			(*this->my_logger)(LOGGER_DEBUG, "close() finding non-prime-covered rows in lower table:\n");
 			// now check closed-ness of lower table
@@ -676,8 +684,7 @@ deserialization_failed:
 				if(first)
 					first = false;
 				else
-					for(i = 0; i < cn; i++)
-						merge.acceptance[i] = a_false;
+					merge.acceptance.assign(cn, a_false);
 
 				bool joined = false;
 				typename std::list<typename table::iterator>::iterator pri;
@@ -770,17 +777,15 @@ deserialization_failed:
 				suffix2 = search_tables(w2);
 				w2.pop_back();
 
-				typename table_row::acceptances::iterator ai1, ai2;
-				columnlist::iterator ci;
-				for(ai1 = suffix1->acceptance.begin(), ai2 = suffix2->acceptance.begin(), ci = column_names.begin();
-				    ai1 != suffix1->acceptance.end(); ++ai1, ++ai2, ++ci) {
-					if(*ai1 == false && *ai2 == true) {
-						std::list<int> new_suffix;
-						new_suffix = *ci;
-						new_suffix.push_front(sigma);
-						add_column(new_suffix);
-						return false;
-					}
+				int col = acceptances_first_noncover(suffix1->acceptance, suffix2->acceptance);
+				if(col >= 0) {
+					columnlist::iterator ci = column_names.begin();
+					std::list<int> new_suffix;
+					std::advance(ci, col);
+					new_suffix = *ci;
+					new_suffix.push_front(sigma);
+					add_column(new_suffix);
+					return false;
 				}
 			}
 			return true;
@@ -33,6 +33,7 @@
 #include <typeinfo>
 
 #include <stdio.h>
+#include <stdint.h>
 
 #ifdef _WIN32
 #include <winsock.h>
@@ -43,6 +44,8 @@
 #include <libalf/alphabet.h>
 #include <libalf/logger.h>
 #include <libalf/learning_algorithm.h>
+#include <libalf/packed_acceptances.h>
+#include <libalf/parallel_fill.h>
 
 namespace libalf {
 
@@ -76,6 +79,287 @@ namespace algorithm_angluin {
 			int id;
 			typename table::iterator tableentry;
 	};
+
+	// hash of a word, for row_index
+	inline size_t hash_word(const std::list<int> & word)
+	{{{
+		size_t h = 2166136261u;
+		std::list<int>::const_iterator wi;
+
+		for(wi = word.begin(); wi != word.end(); ++wi) {
+			h ^= (uint32_t)*wi;
+			h *= 16777619u;
+		}
+
+		return h;
+	}}}
+
+	// hash of a single answer, for signature_index. `exact' tells if
+	// operator== on <answer> is an equivalence relation. if it is not
+	// (as for weak_bool), rows can not be grouped into classes and the
+	// table falls back to pairwise comparison.
+	// the generic version hashes the serialized answer. it is
+	// specialized for the answer types that are shipped with libalf.
+	template <class answer>
+	class answer_hash {
+		public:
+			enum { exact = 1 };
+			static size_t hash(const answer & a)
+			{{{
+				std::basic_string<int32_t> s = ::serialize(a);
+				typename std::basic_string<int32_t>::const_iterator si;
+				size_t h = 0;
+				for(si = s.begin(); si != s.end(); ++si)
+					h = h * 31 + (uint32_t)*si;
+				return h;
+			}}}
+	};
+	template <>
+	class answer_hash<bool> {
+		public:
+			enum { exact = 1 };
+			static size_t hash(bool a)
+			{ return a ? 1 : 0; }
+	};
+	template <>
+	class answer_hash<int> {
+		public:
+			enum { exact = 1 };
+			static size_t hash(int a)
+			{ return (uint32_t)a; }
+	};
+	template <>
+	class answer_hash<char> {
+		public:
+			enum { exact = 1 };
+			static size_t hash(char a)
+			{ return (unsigned char)a; }
+	};
+	template <>
+	class answer_hash<extended_bool> {
+		public:
+			enum { exact = 1 };
+			static size_t hash(const extended_bool & a)
+			{ return a.value; }
+	};
+	template <>
+	class answer_hash<weak_bool> {
+		public:
+			enum { exact = 0 };
+			static size_t hash(const weak_bool &)
+			{ return 0; }
+	};
+
+	// hash of an acceptance row, for signature_index
+	template <class answer, class acceptances>
+	class acceptances_hash {
+		public:
+			static size_t hash(const acceptances & acc)
+			{{{
+				size_t h = acc.size();
+				typename acceptances::const_iterator ai;
+
+				for(ai = acc.begin(); ai != acc.end(); ++ai)
+					h = h * 1000003 + answer_hash<answer>::hash(*ai);
+
+				return h;
+			}}}
+	};
+	template <class answer>
+	class acceptances_hash<answer, packed_acceptances<answer> > {
+		public:
+			static size_t hash(const packed_acceptances<answer> & acc)
+			{ return acc.hash(); }
+	};
+
+	// hash index from row word (table::iterator->index) to all rows of a
+	// table with this word, in the order they were inserted. the table
+	// has to keep its iterators valid on insertion and removal of other
+	// rows (as std::list does).
+	// a new, cleared or copied index is invalid (copies would point into
+	// the original table) until it is filled and validate()d.
+	template <class table>
+	class row_index {
+		protected: // types
+			class entry {
+				public:
+					size_t hash;
+					typename table::iterator row;
+			};
+			typedef std::vector<entry> bucket;
+		protected: // data
+			std::vector<bucket> buckets;
+			unsigned int count;
+			bool valid;
+		public: // methods
+			row_index()
+			{ count = 0; valid = false; }
+
+			row_index(const row_index &)
+			{ count = 0; valid = false; }
+
+			row_index & operator=(const row_index &)
+			{ clear(); return *this; }
+
+			void clear()
+			{{{
+				buckets.clear();
+				count = 0;
+				valid = false;
+			}}}
+
+			bool is_valid() const
+			{ return valid; }
+
+			void validate()
+			{ valid = true; }
+
+			unsigned int size() const
+			{ return count; }
+
+			void insert(typename table::iterator row)
+			{{{
+				if(count >= buckets.size())
+					rehash(buckets.size() < 16 ? 32 : buckets.size() * 2);
+
+				entry e;
+				e.hash = hash_word(row->index);
+				e.row = row;
+				buckets[e.hash & (buckets.size() - 1)].push_back(e);
+				count++;
+			}}}
+
+			void erase(typename table::iterator row)
+			{{{
+				if(buckets.empty())
+					return;
+
+				bucket & b = buckets[hash_word(row->index) & (buckets.size() - 1)];
+				typename bucket::iterator bi;
+				for(bi = b.begin(); bi != b.end(); ++bi) {
+					if(bi->row == row) {
+						b.erase(bi);
+						count--;
+						return;
+					}
+				}
+			}}}
+
+			// first inserted row with this word, or false
+			bool find(const std::list<int> & word, typename table::iterator & row) const
+			{{{
+				if(buckets.empty())
+					return false;
+
+				size_t h = hash_word(word);
+				const bucket & b = buckets[h & (buckets.size() - 1)];
+				typename bucket::const_iterator bi;
+				for(bi = b.begin(); bi != b.end(); ++bi) {
+					if(bi->hash == h && bi->row->index == word) {
+						row = bi->row;
+						return true;
+					}
+				}
+				return false;
+			}}}
+
+		protected:
+			void rehash(unsigned int size)
+			{{{
+				std::vector<bucket> old;
+				typename std::vector<bucket>::iterator oi;
+				typename bucket::iterator bi;
+
+				old.swap(buckets);
+				buckets.resize(size);
+				// entries with equal words share a bucket, so their
+				// order is kept.
+				for(oi = old.begin(); oi != old.end(); ++oi)
+					for(bi = oi->begin(); bi != oi->end(); ++bi)
+						buckets[bi->hash & (size - 1)].push_back(*bi);
+			}}}
+	};
+
+	// index from row signature (acceptance) to an equivalence class id.
+	// class ids are given in order of insertion, beginning with 0, so
+	// inserting the upper table in order numbers the classes like the
+	// states of the derived conjecture.
+	template <class answer, class table, class acceptances>
+	class signature_index {
+		protected: // types
+			class entry {
+				public:
+					size_t hash;
+					typename table::iterator representative;
+					int id;
+			};
+			typedef std::vector<entry> bucket;
+		protected: // data
+			std::vector<bucket> buckets;
+			std::vector<typename table::iterator> representatives;
+		public: // methods
+			static size_t hash_signature(const typename table::value_type & row)
+			{ return acceptances_hash<answer, acceptances>::hash(row.acceptance); }
+
+			void clear()
+			{{{
+				buckets.clear();
+				representatives.clear();
+			}}}
+
+			// number of classes
+			int size() const
+			{ return representatives.size(); }
+
+			// first inserted row of class id
+			typename table::iterator representative(int id) const
+			{ return representatives[id]; }
+
+			// class id of this row's signature, or -1
+			int find(const typename table::value_type & row) const
+			{{{
+				if(buckets.empty())
+					return -1;
+
+				size_t h = hash_signature(row);
+				const bucket & b = buckets[h & (buckets.size() - 1)];
+				typename bucket::const_iterator bi;
+				for(bi = b.begin(); bi != b.end(); ++bi)
+					if(bi->hash == h && *(bi->representative) == row)
+						return bi->id;
+				return -1;
+			}}}
+
+			// class id of row, creating a new class if required
+			int insert(typename table::iterator row)
+			{{{
+				int id = find(*row);
+				if(id >= 0)
+					return id;
+
+				if(representatives.size() >= buckets.size()) {
+					std::vector<bucket> old;
+					typename std::vector<bucket>::iterator oi;
+					typename bucket::iterator bi;
+					unsigned int size = buckets.size() < 16 ? 32 : buckets.size() * 2;
+
+					old.swap(buckets);
+					buckets.resize(size);
+					for(oi = old.begin(); oi != old.end(); ++oi)
+						for(bi = oi->begin(); bi != oi->end(); ++bi)
+							buckets[bi->hash & (size - 1)].push_back(*bi);
+				}
+
+				entry e;
+				e.hash = hash_signature(*row);
+				e.representative = row;
+				e.id = representatives.size();
+				buckets[e.hash & (buckets.size() - 1)].push_back(e);
+				representatives.push_back(row);
+
+				return e.id;
+			}}}
+	};
 };
 
 /*
@@ -104,7 +388,18 @@ class angluin_table : public learning_algorithm<answer> {
 	 *	bool table::iterator->deserialize(std::basic_string<int32_t>::iterator it, std::basic_string<int32_t>::iterator limit);
 	 *	(see implementation notes on serialization members)
 	 *
-	 *	note: acceptance can e.g. be a member std::vector<answer> of the *(table::iterator) type
+	 *	note: acceptance can e.g. be a member std::vector<answer> of the *(table::iterator) type,
+	 *	or a packed_acceptances<answer> (as angluin_simple_table uses for bool and extended_bool)
+	 *
+	 *	rows are found through a hash index on their word (see row_index). thus table
+	 *	has to be a std::list (rows are moved between the tables with splice()),
+	 *	and derived classes that add rows to or remove rows from
+	 *	the tables without add_word_to_upper_table() have to call invalidate_index().
+	 *	closedness and consistency are checked on classes of rows with equal
+	 *	acceptance (see signature_index) if use_row_classes().
+	 *
+	 *	with set_fill_threads(n), n > 1, missing columns are first looked up in
+	 *	the knowledgebase by n threads (see parallel_table_filler).
 	\*/
 
 	public: // types
@@ -116,8 +411,17 @@ class angluin_table : public learning_algorithm<answer> {
 		table upper_table;
 		table lower_table;
 
+		// word -> row, for each table
+		algorithm_angluin::row_index<table> upper_index;
+		algorithm_angluin::row_index<table> lower_index;
+
 		bool initialized;
 
+		// number of threads for fill_missing_columns()
+		unsigned int fill_threads;
+		// missing cells a table needs per fill thread
+		unsigned int fill_min_cells;
+
 	public: // methods
 		angluin_table()
 		{{{
@@ -126,8 +430,23 @@ class angluin_table : public learning_algorithm<answer> {
 			this->set_normalizer(NULL);
 			this->set_alphabet_size(0);
 			initialized = false;
+			fill_threads = 1;
+			fill_min_cells = parallel_table_filler<answer, table>::default_min_cells_per_thread;
 		}}}
 
+		// fill missing columns with this many threads (1: serially). a
+		// table gets one thread per min_cells missing cells at most.
+		// the knowledgebase must not be used by others during advance().
+		void set_fill_threads(unsigned int threads, unsigned int min_cells = parallel_table_filler<answer, table>::default_min_cells_per_thread)
+		{{{
+			fill_threads = (threads > 0) ? threads : 1;
+			fill_min_cells = min_cells;
+		}}}
+		unsigned int get_fill_threads() const
+		{ return fill_threads; }
+		unsigned int get_fill_min_cells() const
+		{ return fill_min_cells; }
+
 		virtual enum learning_algorithm_type get_basic_compatible_type() const
 		{ return ALG_ANGLUIN; };
 
@@ -264,6 +583,7 @@ class angluin_table : public learning_algorithm<answer> {
 			return initialized && columns_filled() && is_closed() && is_consistent();
 		}}}
 
+		using learning_algorithm<answer>::add_counterexample;
 		virtual bool add_counterexample(std::list<int> word)
 		{{{
 #ifdef DEBUG_ANGLUIN
@@ -334,15 +654,65 @@ class angluin_table : public learning_algorithm<answer> {
 		virtual void initialize_table() = 0;
 		virtual void add_word_to_upper_table(std::list<int> word, bool check_uniq = true) = 0;
 
+		// drop the row index. it is rebuilt on the next search.
+		virtual void invalidate_index()
+		{{{
+			upper_index.clear();
+			lower_index.clear();
+		}}}
+
+		virtual void build_index()
+		{{{
+			typename table::iterator ti;
+
+			upper_index.clear();
+			lower_index.clear();
+			for(ti = upper_table.begin(); ti != upper_table.end(); ti++)
+				upper_index.insert(ti);
+			for(ti = lower_table.begin(); ti != lower_table.end(); ti++)
+				lower_index.insert(ti);
+			upper_index.validate();
+			lower_index.validate();
+		}}}
+
+		// append row to upper/lower table and index it
+		virtual typename table::iterator push_upper_row(const typename table::value_type & row)
+		{{{
+			typename table::iterator ti;
+			ti = upper_table.insert(upper_table.end(), row);
+			if(upper_index.is_valid())
+				upper_index.insert(ti);
+			return ti;
+		}}}
+		virtual typename table::iterator push_lower_row(const typename table::value_type & row)
+		{{{
+			typename table::iterator ti;
+			ti = lower_table.insert(lower_table.end(), row);
+			if(lower_index.is_valid())
+				lower_index.insert(ti);
+			return ti;
+		}}}
+
+		// move a row from the lower to the end of the upper table
+		virtual void move_row_up(typename table::iterator lti)
+		{{{
+			if(lower_index.is_valid())
+				lower_index.erase(lti);
+			upper_table.splice(upper_table.end(), lower_table, lti);
+			if(upper_index.is_valid())
+				upper_index.insert(lti);
+		}}}
+
 		// this expects a NORMALIZED word!
 		virtual typename table::iterator search_upper_table(const std::list<int> &word)
 		{{{
 			typename table::iterator uti;
 
-			for(uti = upper_table.begin(); uti != upper_table.end(); uti++) {
-				if(word == uti->index)
-					return uti;
-			}
+			if(!upper_index.is_valid() || !lower_index.is_valid())
+				build_index();
+
+			if(upper_index.find(word, uti))
+				return uti;
 			return upper_table.end();
 		}}}
 
@@ -365,9 +735,11 @@ class angluin_table : public learning_algorithm<answer> {
 		{{{
 			typename table::iterator lti;
 
-			for(lti = lower_table.begin(); lti != lower_table.end(); lti++)
-				if(word == lti->index)
-					return lti;
+			if(!upper_index.is_valid() || !lower_index.is_valid())
+				build_index();
+
+			if(lower_index.find(word, lti))
+				return lti;
 			return lower_table.end();
 		}}}
 
@@ -451,42 +823,59 @@ class angluin_table : public learning_algorithm<answer> {
 			typename table::iterator ti;
 			bool complete = true;
 
-			// upper table
-			for(ti = t.begin(); ti != t.end(); ti++) {
-				if(ti->acceptance.size() < column_names.size()) {
-					if(!ti->index.empty() && ti->index.front() == BOTTOM_CHAR) {
-						int delta = column_names.size() - ti->acceptance.size();
-						answer a;
-						a = false;
-						for(/* -- */; delta > 0; delta--)
-							ti->acceptance.push_back(a);
-					} else {
-						// fill in missing acceptance information
-						columnlist::iterator ci;
-						ci = column_names.begin();
-						ci += ti->acceptance.size();
-						bool column_skipped = false;
-						for(/* -- */; ci != column_names.end(); ci++) {
-							if(!ci->empty() && ci->front() == BOTTOM_CHAR) {
-								answer a;
-								a = false;
+			if(fill_threads > 1) {
+				// look up all cells in parallel, add the queries serially
+				parallel_table_filler<answer, table> filler(*this->my_knowledge, t, column_names);
+
+				filler.set_min_cells_per_thread(fill_min_cells);
+				complete = filler.complete(filler.fill(fill_threads));
+			} else {
+				for(ti = t.begin(); ti != t.end(); ti++)
+					if(!fill_missing_columns(ti))
+						complete = false;
+			}
+
+			return complete;
+		}}}
+
+		// fill the missing columns of a single row. return value as above.
+		virtual bool fill_missing_columns(typename table::iterator ti)
+		{{{
+			bool complete = true;
+
+			if(ti->acceptance.size() < column_names.size()) {
+				if(!ti->index.empty() && ti->index.front() == BOTTOM_CHAR) {
+					int delta = column_names.size() - ti->acceptance.size();
+					answer a;
+					a = false;
+					for(/* -- */; delta > 0; delta--)
+						ti->acceptance.push_back(a);
+				} else {
+					// fill in missing acceptance information
+					columnlist::iterator ci;
+					ci = column_names.begin();
+					ci += ti->acceptance.size();
+					bool column_skipped = false;
+					for(/* -- */; ci != column_names.end(); ci++) {
+						if(!ci->empty() && ci->front() == BOTTOM_CHAR) {
+							answer a;
+							a = false;
 //printf("query for %s::%s: BOTTOM\n", word2string(ti->index).c_str(), word2string(*ci).c_str());
-								ti->acceptance.push_back(a);
-							} else {
-								std::list<int> *w;
-								w = concat(ti->index, *ci);
-								answer a;
-								if(this->my_knowledge->resolve_or_add_query(*w, a)) {
-									if(!column_skipped)
-										ti->acceptance.push_back(a);
+							ti->acceptance.push_back(a);
+						} else {
+							std::list<int> *w;
+							w = concat(ti->index, *ci);
+							answer a;
+							if(this->my_knowledge->resolve_or_add_query(*w, a)) {
+								if(!column_skipped)
+									ti->acceptance.push_back(a);
 //printf("query for %s: %d\n", word2string(*w).c_str(), (int)a);
-								} else {
-									column_skipped = true;
-									complete = false;
-								}
-
-								delete w;
+							} else {
+								column_skipped = true;
+								complete = false;
 							}
+
+							delete w;
 						}
 					}
 				}
@@ -515,6 +904,7 @@ class angluin_table : public learning_algorithm<answer> {
 					(*this->my_logger)(LOGGER_WARN, "angluin_table: sync_to_knowledgebase: columns are empty after sync! resetting table.\n");
 					upper_table.clear();
 					lower_table.clear();
+					invalidate_index();
 					initialized = false;
 					return false;
 				}
@@ -529,6 +919,8 @@ class angluin_table : public learning_algorithm<answer> {
 
 			now = this->my_knowledge->get_timestamp();
 
+			invalidate_index();
+
 			uti = upper_table.begin();
 			while(uti != upper_table.end()) {
 				if(uti->ut_timestamp >= now) {
@@ -621,6 +1013,16 @@ class angluin_table : public learning_algorithm<answer> {
 		virtual bool is_closed()
 		{{{
 			typename table::iterator uti, lti;
+
+			if(use_row_classes()) {
+				algorithm_angluin::signature_index<answer, table, acceptances> classes;
+				classify_upper_table(classes);
+				for(lti = lower_table.begin(); lti != lower_table.end(); lti++)
+					if(classes.find(*lti) < 0)
+						return false;
+				return true;
+			}
+
 			for(lti = lower_table.begin(); lti != lower_table.end(); lti++) {
 				bool match_found = false;
 
@@ -642,14 +1044,23 @@ class angluin_table : public learning_algorithm<answer> {
 		virtual bool close()
 		{{{
 			typename table::iterator uti, lti, tmplti;
+			algorithm_angluin::signature_index<answer, table, acceptances> classes;
+			bool exact = use_row_classes();
+
+			if(exact)
+				classify_upper_table(classes);
 
 			for(lti = lower_table.begin(); lti != lower_table.end(); lti++) {
 				bool match_found = false;
 
-				for(uti = upper_table.begin(); uti != upper_table.end(); uti++) {
-					if(*lti == *uti) {
-						match_found = true;
-						break;
+				if(exact) {
+					match_found = (classes.find(*lti) >= 0);
+				} else {
+					for(uti = upper_table.begin(); uti != upper_table.end(); uti++) {
+						if(*lti == *uti) {
+							match_found = true;
+							break;
+						}
 					}
 				}
 				if(!match_found) {
@@ -665,66 +1076,67 @@ class angluin_table : public learning_algorithm<answer> {
 			return true;
 		}}}
 
-		//  for all _equal_ rows in upper table: all +1 successors over all
-		//  members of alphabet have to have equal rows
-		virtual bool is_consistent()
+		// true if rows with equal acceptance may be grouped into classes,
+		// i.e. if operator== on <answer> is an equivalence relation.
+		// otherwise, all pairs of rows are compared.
+		virtual bool use_row_classes()
+		{ return algorithm_angluin::answer_hash<answer>::exact; }
+
+		// insert all rows of the upper table into classes, in table order
+		virtual void classify_upper_table(algorithm_angluin::signature_index<answer, table, acceptances> & classes)
 		{{{
-			bool urow_ok[upper_table.size()];
-			typename table::iterator uti_1, uti_2, ut_last_row;
-			unsigned int i,j;
+			typename table::iterator uti;
 
-			for(i = 0; i < upper_table.size(); i++)
-				urow_ok[i] = false;
+			for(uti = upper_table.begin(); uti != upper_table.end(); uti++)
+				classes.insert(uti);
+		}}}
 
-			ut_last_row = upper_table.end();
-			ut_last_row--;
+		// rows of the upper table, grouped by equal acceptance.
+		// classes and their members are in table order.
+		virtual void get_upper_table_classes(std::vector< std::vector<typename table::iterator> > & members)
+		{{{
+			algorithm_angluin::signature_index<answer, table, acceptances> classes;
+			typename table::iterator uti;
 
-			for(i = 0, uti_1 = upper_table.begin(); uti_1 != ut_last_row; i++, uti_1++) {
-				if(urow_ok[i])
-					continue;
-				urow_ok[i] = true;
-				uti_2 = uti_1;
-				uti_2++;
-				for(j=i+1; uti_2 != upper_table.end(); uti_2++, j++) {
-					if(urow_ok[j])
-						continue;
-					if(*uti_1 == *uti_2) {
-						// uti_1->acceptance == uti_2->acceptance
-						// -> test if all equal suffixes result in equal acceptance as well
-						std::list<int> word1 = uti_1->index;
-						std::list<int> word2 = uti_2->index;
-						typename table::iterator w1succ, w2succ;
-						int sigma;
-						for(sigma = 0; sigma < this->get_alphabet_size(); sigma++) {
-							if(word1.front() != BOTTOM_CHAR)
-								word1.push_back(sigma);
-							if(word2.front() != BOTTOM_CHAR)
-								word2.push_back(sigma);
-
-							if(this->norm) {
-								bool bottom;
-								std::list<int> w1n, w2n;
-								w1n = this->norm->prefix_normal_form(word1, bottom);
-								w2n = this->norm->prefix_normal_form(word2, bottom);
-								w1succ = search_tables(w1n);
-								w2succ = search_tables(w2n);
-							} else {
-								w1succ = search_tables(word1);
-								w2succ = search_tables(word2);
-							}
+			members.clear();
+			for(uti = upper_table.begin(); uti != upper_table.end(); uti++) {
+				unsigned int id = classes.insert(uti);
+				if(id == members.size())
+					members.push_back(std::vector<typename table::iterator>());
+				members[id].push_back(uti);
+			}
+		}}}
 
-							if(word1.front() != BOTTOM_CHAR)
-								word1.pop_back();
-							if(word2.front() != BOTTOM_CHAR)
-								word2.pop_back();
+		// row of word.sigma (normalized, if a normalizer is set).
+		// word is left unchanged.
+		virtual typename table::iterator search_successor(std::list<int> & word, int sigma)
+		{{{
+			typename table::iterator ti;
+			bool changed_word = false;
 
-							if(*w1succ != *w2succ)
-								return false;
-						}
-					}
-				}
+			if(word.size() == 0 || word.front() != BOTTOM_CHAR) {
+				changed_word = true;
+				word.push_back(sigma);
 			}
-			return true;
+			if(this->norm) {
+				bool bottom;
+				std::list<int> nw;
+				nw = this->norm->prefix_normal_form(word, bottom);
+				ti = search_tables(nw);
+			} else {
+				ti = search_tables(word);
+			}
+			if(changed_word)
+				word.pop_back();
+
+			return ti;
+		}}}
+
+		//  for all _equal_ rows in upper table: all +1 successors over all
+		//  members of alphabet have to have equal rows
+		virtual bool is_consistent()
+		{{{
+			return find_inconsistency(NULL);
 		}}}
 
 		// make table consistent: perform operations to do that.
@@ -732,6 +1144,52 @@ class angluin_table : public learning_algorithm<answer> {
 		// returns false if table was changed (and thus needs to be filled)
 		virtual bool make_consistent()
 		{{{
+			return find_inconsistency(&angluin_table<answer, table, acceptances>::add_separating_column);
+		}}}
+
+		// search the first pair of equal upper rows (in table order) with
+		// different successors. if there is one and separate is given,
+		// call it for the successors.
+		// returns true if table was consistent.
+		virtual bool find_inconsistency(bool (angluin_table<answer, table, acceptances>::*separate)(typename table::iterator, typename table::iterator, int, const std::list<int> &, const std::list<int> &))
+		{{{
+			typename table::iterator w1_succ, w2_succ;
+			int sigma;
+
+			if(use_row_classes()) {
+				// equality of rows is transitive: it suffices to compare
+				// each row to the first one of its class. the first pair
+				// found this way is the same as for the pairwise search.
+				std::vector< std::vector<typename table::iterator> > members;
+				std::vector<typename table::iterator> first_succ(this->get_alphabet_size());
+				unsigned int c, m;
+
+				get_upper_table_classes(members);
+				for(c = 0; c < members.size(); c++) {
+					if(members[c].size() < 2)
+						continue;
+					std::list<int> word1 = members[c][0]->index;
+					for(sigma = 0; sigma < this->get_alphabet_size(); sigma++)
+						first_succ[sigma] = search_successor(word1, sigma);
+
+					for(m = 1; m < members[c].size(); m++) {
+						std::list<int> word2 = members[c][m]->index;
+						for(sigma = 0; sigma < this->get_alphabet_size(); sigma++) {
+							w1_succ = first_succ[sigma];
+							w2_succ = search_successor(word2, sigma);
+							if(*w1_succ != *w2_succ) {
+								if(separate == NULL)
+									return false;
+								if((this->*separate)(w1_succ, w2_succ, sigma, word1, word2))
+									return false;
+							}
+						}
+					}
+				}
+
+				return true;
+			}
+
 			bool urow_ok[upper_table.size()];
 			typename table::iterator uti_1, uti_2, ut_last_row;
 			unsigned int i,j;
@@ -756,76 +1214,15 @@ class angluin_table : public learning_algorithm<answer> {
 						// -> test if all equal suffixes result in equal acceptance as well
 						std::list<int> word1 = uti_1->index;
 						std::list<int> word2 = uti_2->index;
-						typename table::iterator w1_succ, w2_succ;
-						for(int sigma = 0; sigma < this->get_alphabet_size(); sigma++) {
-							bool changed_word1 = false;
-							bool changed_word2 = false;
-							if(word1.size() == 0 || word1.front() != BOTTOM_CHAR) {
-								changed_word1 = true;
-								word1.push_back(sigma);
-							}
-							if(word2.size() == 0 || word2.front() != BOTTOM_CHAR) {
-								changed_word2 = true;
-								word2.push_back(sigma);
-							}
-							if(this->norm) {
-								bool bottom;
-								std::list<int> w1n, w2n;
-								w1n = this->norm->prefix_normal_form(word1, bottom);
-								w2n = this->norm->prefix_normal_form(word2, bottom);
-								w1_succ = search_tables(w1n);
-								w2_succ = search_tables(w2n);
-							} else {
-								w1_succ = search_tables(word1);
-								w2_succ = search_tables(word2);
-							}
-							if(changed_word1)
-								word1.pop_back();
-							if(changed_word2)
-								word2.pop_back();
+						for(sigma = 0; sigma < this->get_alphabet_size(); sigma++) {
+							w1_succ = search_successor(word1, sigma);
+							w2_succ = search_successor(word2, sigma);
 
 							if(*w1_succ != *w2_succ) {
-								if(w1_succ->acceptance.size() == w2_succ->acceptance.size()) {
-									// add suffixes resulting in different states to column_names
-									typename columnlist::iterator ci;
-									int cindex = 0;
-									typename acceptances::iterator w1_acc_it, w2_acc_it;
-
-									ci = column_names.begin();
-									w1_acc_it = w1_succ->acceptance.begin();
-									w2_acc_it = w2_succ->acceptance.begin();
-
-									while(w1_acc_it != w1_succ->acceptance.end()) {
-										if(*w1_acc_it != *w2_acc_it) {
-											std::list<int> newsuffix;
-											// generate and add suffix
-											newsuffix = *ci;
-											newsuffix.push_front(sigma);
-											if(add_column(newsuffix)) {
-#ifdef DEBUG_ANGLUIN
-												(*this->my_logger)(LOGGER_DEBUG, "angluin_table: making consistent: new suffix %s to separate %s and %s\n",
-														word2string(newsuffix).c_str(),
-														word2string(word1).c_str(),
-														word2string(word2).c_str()
-															);
-#else
-												/* nothing */
-#endif
-											} else {
-												(*this->my_logger)(LOGGER_ERROR, "angluin_table: adding column %s in make_consistent(), "
-																"but it already existed! trying to ignore.\n",
-																word2string(newsuffix).c_str());
-											}
-											ci = column_names.begin();
-
-											return false;
-										}
-										w1_acc_it++;
-										w2_acc_it++;
-										ci++;
-										cindex++;
-									}
-								}
+								if(separate == NULL)
+									return false;
+								if((this->*separate)(w1_succ, w2_succ, sigma, word1, word2))
+									return false;
 							}
 						}
 					}
@@ -835,6 +1232,56 @@ class angluin_table : public learning_algorithm<answer> {
 			return true;
 		}}}
 
+		// add a column sigma.v that separates rows word1 and word2, where v
+		// separates their sigma-successors w1_succ and w2_succ.
+		// returns true if the table was changed.
+		virtual bool add_separating_column(typename table::iterator w1_succ, typename table::iterator w2_succ, int sigma,
+						   const std::list<int> & word1, const std::list<int> & word2)
+		{{{
+			if(w1_succ->acceptance.size() != w2_succ->acceptance.size())
+				return false;
+
+			// add suffixes resulting in different states to column_names
+			typename columnlist::iterator ci;
+			typename acceptances::iterator w1_acc_it, w2_acc_it;
+
+			ci = column_names.begin();
+			w1_acc_it = w1_succ->acceptance.begin();
+			w2_acc_it = w2_succ->acceptance.begin();
+
+			while(w1_acc_it != w1_succ->acceptance.end()) {
+				if(*w1_acc_it != *w2_acc_it) {
+					std::list<int> newsuffix;
+					// generate and add suffix
+					newsuffix = *ci;
+					newsuffix.push_front(sigma);
+					if(add_column(newsuffix)) {
+#ifdef DEBUG_ANGLUIN
+						(*this->my_logger)(LOGGER_DEBUG, "angluin_table: making consistent: new suffix %s to separate %s and %s\n",
+								word2string(newsuffix).c_str(),
+								word2string(word1).c_str(),
+								word2string(word2).c_str()
+									);
+#else
+						(void)word1;
+						(void)word2;
+#endif
+					} else {
+						(*this->my_logger)(LOGGER_ERROR, "angluin_table: adding column %s in make_consistent(), "
+										"but it already existed! trying to ignore.\n",
+										word2string(newsuffix).c_str());
+					}
+
+					return true;
+				}
+				w1_acc_it++;
+				w2_acc_it++;
+				ci++;
+			}
+
+			return false;
+		}}}
+
 		// complete table, so an automaton can be derived
 		// returns true, if automaton may be derived.
 		// returns false if new knowledge is required (in case of knowledgebase).
@@ -897,13 +1344,21 @@ class angluin_table : public learning_algorithm<answer> {
 #ifdef DEBUG_ANGLUIN
 			(*this->my_logger)(LOGGER_DEBUG, "angluin_table: state/row assignment for hypothesis:\n");
 #endif
+			algorithm_angluin::signature_index<answer, table, acceptances> classes;
+			bool exact = use_row_classes();
+
 			for(uti = upper_table.begin(); uti != upper_table.end(); uti++) {
 				bool known = false;
-				for(state_it = states.begin(); state_it != states.end(); state_it++) {
-					if(*uti == *(state_it->tableentry)) {
-						// state is already known. skip.
-						known = true;
-						break;
+				if(exact) {
+					// class ids are given in the same order as state ids
+					known = (classes.insert(uti) < state.id);
+				} else {
+					for(state_it = states.begin(); state_it != states.end(); state_it++) {
+						if(*uti == *(state_it->tableentry)) {
+							// state is already known. skip.
+							known = true;
+							break;
+						}
 					}
 				}
 				if(known)
@@ -948,6 +1403,12 @@ class angluin_table : public learning_algorithm<answer> {
 					index.pop_back();
 
 					// find matching state for successor
+					if(exact) {
+						int id = classes.find(*ti);
+						if(id >= 0)
+							ret->transitions[state_it->id][i].insert(id);
+						continue;
+					}
 					for(state_it2 = states.begin(); state_it2 != states.end(); state_it2++) {
 						if(*ti == *(state_it2->tableentry)) {
 							ret->transitions[state_it->id][i].insert(state_it2->id);
@@ -1039,7 +1500,12 @@ class angluin_table : public learning_algorithm<answer> {
 // this is the classical table-base angluin learning algorithm, L*,
 // implemented in a table-fashion: prefix-closed rows and suffix-closed columns
 template <class answer>
-class angluin_simple_table : public angluin_table<answer, std::list< algorithm_angluin::simple_row<answer, std::vector<answer> > >, std::vector<answer> > {
+class angluin_simple_table : public angluin_table<answer, std::list< algorithm_angluin::simple_row<answer, typename acceptances_for<answer>::type> >, typename acceptances_for<answer>::type> {
+	public: // types
+		// rows of bool and extended_bool are bit-packed (see packed_acceptances.h)
+		typedef typename acceptances_for<answer>::type acceptances_t;
+		typedef algorithm_angluin::simple_row<answer, acceptances_t> row_t;
+		typedef std::list<row_t> table_t;
 	public:
 		angluin_simple_table()
 		{{{
@@ -1062,8 +1528,8 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 		{{{
 			int c, ut, lt, bytes;
 
-			typename angluin_table<answer, std::list< algorithm_angluin::simple_row<answer, std::vector<answer> > >, std::vector<answer> >::columnlist::const_iterator ci;
-			typename std::list< algorithm_angluin::simple_row<answer, std::vector<answer> > >::const_iterator ti;
+			typename angluin_table<answer, table_t, acceptances_t>::columnlist::const_iterator ci;
+			typename table_t::const_iterator ti;
 
 			c = this->column_names.size();
 			ut = this->upper_table.size();
@@ -1079,14 +1545,12 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 			bytes += sizeof(std::vector<int>);
 			for(ci = this->column_names.begin(); ci != this->column_names.end(); ci++)
 				bytes += sizeof(int) * ci->size() + sizeof(std::list<int>);
-			// upper table bare rows
+			// upper table rows and fields
 			for(ti = this->upper_table.begin(); ti != this->upper_table.end(); ti++)
-				bytes += sizeof(algorithm_angluin::simple_row<answer, std::vector<answer> >) + sizeof(int) * ti->index.size();
-			// lower table bare rows
+				bytes += sizeof(row_t) - sizeof(acceptances_t) + sizeof(int) * ti->index.size() + acceptances_memory_usage(ti->acceptance);
+			// lower table rows and fields
 			for(ti = this->lower_table.begin(); ti != this->lower_table.end(); ti++)
-				bytes += sizeof(algorithm_angluin::simple_row<answer, std::vector<answer> >) + sizeof(int) * ti->index.size();
-			// table fields
-			bytes += sizeof(answer) * c * (ut+lt);
+				bytes += sizeof(row_t) - sizeof(acceptances_t) + sizeof(int) * ti->index.size() + acceptances_memory_usage(ti->acceptance);
 
 			this->statistics["memory.bytes"] = bytes;
 		}}}
@@ -1102,6 +1566,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 
 			this->upper_table.clear();
 			this->lower_table.clear();
+			this->invalidate_index();
 
 			if(serial.current == serial.limit) goto deserialization_failed;
 
@@ -1155,7 +1620,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 			// rows for upper table
 			serial.current++; size--; if(size <= 0 || serial.current == serial.limit) goto deserialization_failed;
 			for(/* -- */; count > 0; count--) {
-				algorithm_angluin::simple_row<answer, std::vector<answer> > row;
+				row_t row;
 				// peek size
 				if(serial.current == serial.limit) goto deserialization_failed;
 				size -= ntohl(*serial.current);
@@ -1176,7 +1641,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 			// rows for lower table
 			serial.current++; size--; if(size <= 0 || serial.current == serial.limit) goto deserialization_failed;
 			for(/* -- */; count > 0; count--) {
-				algorithm_angluin::simple_row<answer, std::vector<answer> > row;
+				row_t row;
 				// peek size
 				if(serial.current == serial.limit) goto deserialization_failed;
 				size -= ntohl(*serial.current);
@@ -1207,8 +1672,8 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 			if(new_asize <= this->get_alphabet_size())
 				return;
 
-			typename std::list< algorithm_angluin::simple_row<answer, std::vector<answer> > >::iterator uti;
-			algorithm_angluin::simple_row<answer, std::vector<answer> > row;
+			typename table_t::iterator uti;
+			row_t row;
 
 			if(this->norm) {
 				// for all words in the upper table,
@@ -1221,7 +1686,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 						w.push_back(new_suffix);
 						row.index = this->norm->prefix_normal_form(w, bottom);
 						w.pop_back();
-						this->lower_table.push_back(row);
+						this->push_lower_row(row);
 					}
 				}
 			} else {
@@ -1232,7 +1697,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 					// add them suffixed with the new characters into the lower table.
 					for(int new_suffix = this->get_alphabet_size(); new_suffix < new_asize; new_suffix++) {
 						row.index.push_back(new_suffix);
-						this->lower_table.push_back(row);
+						this->push_lower_row(row);
 						row.index.pop_back();
 					}
 				}
@@ -1260,7 +1725,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 		virtual void add_word_to_upper_table(std::list<int> word, bool check_uniq = true)
 		{{{
 			std::list<int> nw;
-			algorithm_angluin::simple_row<answer, std::vector<answer> > row;
+			row_t row;
 			bool done = false;
 			bool bottom = false;
 
@@ -1277,7 +1742,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 				}
 				if(!bottom) {
 					// check if in lower table. if so, move up.
-					typename std::list< algorithm_angluin::simple_row<answer, std::vector<answer> > >::iterator ti;
+					typename table_t::iterator ti;
 //printf("scanning for %s in lower.\n", word2string(nw).c_str());
 					ti = this->search_lower_table(nw);
 					if(ti != this->lower_table.end()) {
@@ -1286,8 +1751,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 							ti->ut_timestamp = this->my_knowledge->get_timestamp();
 						else
 							ti->ut_timestamp = 0;
-						this->upper_table.push_back(*ti);
-						this->lower_table.erase(ti);
+						this->move_row_up(ti);
 					}
 				}
 			}
@@ -1302,7 +1766,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 					row.ut_timestamp = 0;
 					row.lt_timestamp = 0;
 				}
-				this->upper_table.push_back(row);
+				this->push_upper_row(row);
 			}
 
 			if(bottom) // no suffixes required, they would be bottom again.
@@ -1335,7 +1799,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 							row.ut_timestamp = 0;
 							row.lt_timestamp = 0;
 						}
-						this->lower_table.push_back(row);
+						this->push_lower_row(row);
 					}
 				} else {
 					if(this->search_upper_table(word) == this->upper_table.end()) {
@@ -1347,7 +1811,7 @@ class angluin_simple_table : public angluin_table<answer, std::list< algorithm_a
 							row.ut_timestamp = 0;
 							row.lt_timestamp = 0;
 						}
-						this->upper_table.push_back(row);
+						this->push_upper_row(row);
 					}
 				}
 			}
@@ -1383,6 +1847,7 @@ class angluin_col_table : public angluin_simple_table<answer> {
 
 		// (still compatible to ALG_ANGLUIN)
 
+		using angluin_simple_table<answer>::add_counterexample;
 		virtual bool add_counterexample(std::list<int> word)
 		{{{
 			typename std::vector< std::list<int> >::iterator ci;
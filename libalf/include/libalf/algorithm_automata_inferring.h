@@ -33,13 +33,18 @@
 #include <list>
 #include <map>
 #include <set>
+#include <vector>
 #include <assert.h>
 
+#include <pthread.h>
+#include <unistd.h>
+
 // libALF includes
 #include "libalf/knowledgebase.h"
 #include "libalf/learning_algorithm.h"
 #include "libalf/conjecture.h"
 #include "libalf/prefix_tree.h"
+#include "libalf/red_blue_premerging.h"
 
 
 namespace libalf {
@@ -47,8 +52,178 @@ namespace libalf {
 template <class answer>
 class automata_inferring : public learning_algorithm<answer> {
 
+	public:
+
+	/**
+	 * An encoding of the inference problem that is kept alive from one number
+	 * of states to the next. Variables and clauses for additional states are
+	 * added on top of the encoding for fewer states, and everything the solver
+	 * has learnt is kept. It is created for one prefix tree, which has to
+	 * outlive it.
+	 */
+	class incremental_inference {
+
+		public:
+
+		virtual ~incremental_inference() { }
+
+		/**
+		 * Computes a conjecture with n states, or returns NULL if there is
+		 * none. The search methods call this method at most once for each n.
+		 */
+		virtual conjecture * infer(unsigned int n) = 0;
+
+	};
+
 	protected:
 
+	/**
+	 * Stops a solver that is running in another thread, e.g., a Z3 context.
+	 */
+	class interrupter {
+
+		public:
+
+		virtual ~interrupter() { }
+
+		virtual void interrupt() = 0;
+
+	};
+
+	/**
+	 * An interrupter for solver contexts with an interrupt() method, such as
+	 * z3::context.
+	 */
+	template <class context>
+	class context_interrupter : public interrupter {
+
+		public:
+
+		context & c;
+
+		context_interrupter(context & c) : c(c) { }
+
+		virtual void interrupt() {
+			c.interrupt();
+		}
+
+	};
+
+	/**
+	 * The state of infer_parallel(), shared by all threads. A number of states
+	 * is "open" as long as it is greater than unsat (there is no conjecture
+	 * with unsat states) and less than sat (there is a conjecture with sat
+	 * states, 0 if none is known yet).
+	 */
+	class size_search {
+
+		public:
+
+		/**
+		 * A number of states some thread is computing a conjecture for.
+		 * cancel becomes true when the result is not needed anymore. A
+		 * solver that does not poll cancel registers an interrupter while
+		 * it runs (see register_interrupter()), which is called then.
+		 */
+		class job {
+			public:
+			unsigned int n;
+			volatile bool cancel;
+			interrupter * solver;
+			size_search * search;
+		};
+
+		const automata_inferring * algorithm;
+		const prefix_tree<answer> & t;
+
+		pthread_mutex_t lock;
+		unsigned int unsat;
+		unsigned int sat;
+		conjecture * result;
+		unsigned int next;
+		std::list<job*> running;
+
+		size_search(const automata_inferring * algorithm, const prefix_tree<answer> & t) : t(t) {
+			this->algorithm = algorithm;
+			pthread_mutex_init(&lock, NULL);
+			unsat = 0;
+			sat = 0;
+			result = NULL;
+			next = 1;
+		}
+
+		~size_search() {
+			pthread_mutex_destroy(&lock);
+		}
+
+		/**
+		 * Computes conjectures for the smallest open number of states that no
+		 * other thread works on, until no such number is left.
+		 */
+		void work() {
+
+			pthread_mutex_lock(&lock);
+
+			while(true) {
+
+				if(next <= unsat) {
+					next = unsat + 1;
+				}
+				if(sat != 0 && next >= sat) {
+					break;
+				}
+
+				job j;
+				j.n = next++;
+				j.cancel = false;
+				j.solver = NULL;
+				j.search = this;
+				running.push_back(&j);
+
+				pthread_mutex_unlock(&lock);
+				conjecture * cj = algorithm->__infer_cancelable(t, j.n, &j);
+				pthread_mutex_lock(&lock);
+
+				running.remove(&j);
+
+				if(cj != NULL) {
+
+					if(sat == 0 || j.n < sat) {
+						delete result;
+						result = cj;
+						sat = j.n;
+					} else {
+						delete cj;
+					}
+
+				} else if(!j.cancel && j.n > unsat) {
+					unsat = j.n;
+				}
+
+				// Cancel all jobs that are not open anymore
+				typename std::list<job*>::iterator it;
+				for(it = running.begin(); it != running.end(); it++) {
+					if(!(*it)->cancel && ((*it)->n <= unsat || (sat != 0 && (*it)->n >= sat))) {
+						(*it)->cancel = true;
+						if((*it)->solver != NULL) {
+							(*it)->solver->interrupt();
+						}
+					}
+				}
+
+			}
+
+			pthread_mutex_unlock(&lock);
+
+		}
+
+		static void * run(void * arg) {
+			((size_search*)arg)->work();
+			return NULL;
+		}
+
+	};
+
 	/**
 	 * The default output of a conjecture Moore machine (or DFA) on states that
 	 * are not determined by the sample, i.e., because the sample specifies no
@@ -56,8 +231,35 @@ class automata_inferring : public learning_algorithm<answer> {
 	 */
 	answer default_output;
 
+	/**
+	 * Indicates whether infer_linear() uses one incremental encoding for all
+	 * sizes (if the algorithm supports it).
+	 */
+	bool incremental;
+
+	/**
+	 * Indicates whether the sample is copied into a prefix tree with compact
+	 * edges (see prefix_tree).
+	 */
+	bool compact_prefix_tree;
+
+	/**
+	 * Indicates whether the nodes of the prefix tree are merged before the
+	 * inference (if the algorithm supports it), see set_premerging().
+	 */
+	bool premerging;
+
+	/**
+	 * The minimal score of a merge, see set_premerging_evidence().
+	 */
+	unsigned int premerging_evidence;
+
 	automata_inferring() : learning_algorithm<answer>() {
 		default_output = answer();
+		incremental = false;
+		compact_prefix_tree = false;
+		premerging = false;
+		premerging_evidence = 3;
 	}
 
 	public:
@@ -74,7 +276,7 @@ class automata_inferring : public learning_algorithm<answer> {
 	virtual conjecture * infer(unsigned int n) const {
 
 		// Copy the data from the knowledgebase into our own internal data structure
-		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size);
+		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size, compact_prefix_tree);
 
 		// Check whether we can easily compute a conjecture
 		conjecture * simple_conjecture = infer_simple_conjecture(t);
@@ -82,6 +284,21 @@ class automata_inferring : public learning_algorithm<answer> {
 			return simple_conjecture;
 		}
 
+		// A conjecture for the quotient is one for the tree. Otherwise, only
+		// the tree itself can tell.
+		unsigned int lower_bound;
+		prefix_tree<answer> * quotient = premerge(t, lower_bound);
+		if(quotient != NULL) {
+
+			conjecture * result = n < lower_bound ? NULL : __infer(*quotient, n);
+			delete quotient;
+
+			if(result != NULL || n < lower_bound) {
+				return result;
+			}
+
+		}
+
 		return __infer(t, n);
 
 	}
@@ -95,7 +312,7 @@ class automata_inferring : public learning_algorithm<answer> {
 		}
 
 		// Copy the data from the knowledgebase into our own internal data structure
-		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size);
+		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size, compact_prefix_tree);
 
 		// Check whether we can easily compute a conjecture
 		conjecture * simple_conjecture = infer_simple_conjecture(t);
@@ -103,46 +320,103 @@ class automata_inferring : public learning_algorithm<answer> {
 			return simple_conjecture;
 		}
 
-		unsigned int left = 1;
-		unsigned int right = 1;
+		unsigned int lower_bound;
+		prefix_tree<answer> * quotient = premerge(t, lower_bound);
 
-		// First, increase the size until the problem is satisfiable
-		conjecture * result = NULL;
-		while(result == NULL) {
+		unsigned int size;
+		conjecture * result = search_linear(quotient != NULL ? *quotient : t, increment, lower_bound, size);
 
-			//std::cout << "left=" << left << ", right= " << right << std::endl;
+		if(quotient != NULL) {
+			delete quotient;
+			result = check_premerged(t, lower_bound, result, size);
+		}
 
-			result = __infer(t, right);
+		assert(result != NULL);
+		return result;
 
-			if(result == NULL) {
+	}
 
-				left = right + 1;
-				right += increment;
+	virtual conjecture * infer_binarysearch() const {
 
-			}
+		// Copy the data from the knowledgebase into our own internal data structure
+		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size, compact_prefix_tree);
 
+		// Check whether we can easily compute a conjecture
+		conjecture * simple_conjecture = infer_simple_conjecture(t);
+		if(simple_conjecture != NULL) {
+			return simple_conjecture;
 		}
 
-		// Now, use a binary search to find the minimal value
-		while(left < right) {
+		unsigned int lower_bound;
+		prefix_tree<answer> * quotient = premerge(t, lower_bound);
 
-			unsigned int mid = left + (right - left) / 2;
+		unsigned int size;
+		conjecture * result = search_binary(quotient != NULL ? *quotient : t, lower_bound, size);
 
-			//std::cout << "left=" << left << ", right= " << right << ", mid=" << mid << std::endl;
+		if(quotient != NULL) {
+			delete quotient;
+			result = check_premerged(t, lower_bound, result, size);
+		}
 
-			conjecture * tmp_result = __infer(t, mid);
+		assert(result != NULL);
+		return result;
 
-			if(tmp_result == NULL) {
-				left = mid + 1;
-			} else {
+	}
 
-				delete result;
-				result = tmp_result;
-				tmp_result = NULL;
+	/**
+	 * Searches the minimal number of states with several threads. Each thread
+	 * computes a conjecture for the smallest number of states that is not yet
+	 * known to be too small or large enough and that no other thread works on.
+	 * A conjecture with n states makes all computations for n or more states
+	 * useless, no conjecture with n states all computations for up to n states.
+	 * These are canceled (see __infer_cancelable()).
+	 *
+	 * @param threads The number of threads, or 0 for one thread per online
+	 *                processor
+	 *
+	 * @return Returns a conjecture with a minimal number of states.
+	 */
+	virtual conjecture * infer_parallel(unsigned int threads = 0) const {
 
-				right = mid;
+		// Copy the data from the knowledgebase into our own internal data structure
+		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size, compact_prefix_tree);
+
+		// Check whether we can easily compute a conjecture
+		conjecture * simple_conjecture = infer_simple_conjecture(t);
+		if(simple_conjecture != NULL) {
+			return simple_conjecture;
+		}
+
+		if(threads == 0) {
+			long processors = sysconf(_SC_NPROCESSORS_ONLN);
+			threads = processors > 0 ? processors : 1;
+		}
+
+		unsigned int lower_bound;
+		prefix_tree<answer> * quotient = premerge(t, lower_bound);
+
+		size_search search(this, quotient != NULL ? *quotient : t);
+		search.unsat = lower_bound - 1;
+
+		// The calling thread works as well
+		std::vector<pthread_t> workers(threads);
+		unsigned int started;
+		for(started = 1; started < threads; started++) {
+			if(0 != pthread_create(&workers[started], NULL, size_search::run, &search)) {
+				break;
 			}
+		}
+		search.work();
+		for(unsigned int i = 1; i < started; i++) {
+			pthread_join(workers[i], NULL);
+		}
+
+		(*this->my_logger)(LOGGER_ALGORITHM, "Parallel search with %u threads found a conjecture with %u states.\n", started, search.sat);
 
+		conjecture * result = search.result;
+		if(quotient != NULL) {
+			delete quotient;
+			result = check_premerged(t, lower_bound, result, search.sat);
 		}
 
 		assert(result != NULL);
@@ -150,19 +424,303 @@ class automata_inferring : public learning_algorithm<answer> {
 
 	}
 
-	virtual conjecture * infer_binarysearch() const {
+	/**
+	 * Returns the default output used for conjectures if the output of a state
+	 * is not determined by the given sample.
+	 *
+	 * @return Returns the default output used for conjectures.
+	 */
+	answer get_default_output() {
+		return default_output;
+	}
 
-		// Copy the data from the knowledgebase into our own internal data structure
-		prefix_tree<answer> t(*this->my_knowledge, this->alphabet_size);
+	/**
+	 * Sets the default output used for conjectures if the output of a state
+	 * is not determined by the given sample.
+	 *
+	 * @param new_default_output The new default output used for conjectures
+	 */
+	void set_default_output(answer new_default_output) {
+		this->default_output = new_default_output;
+	}
 
-		// Check whether we can easily compute a conjecture
-		conjecture * simple_conjecture = infer_simple_conjecture(t);
-		if(simple_conjecture != NULL) {
-			return simple_conjecture;
+	/**
+	 * Returns whether infer_linear() uses one incremental encoding for all
+	 * sizes.
+	 *
+	 * @return Returns whether incremental inference is used.
+	 */
+	bool is_incremental() const {
+		return incremental;
+	}
+
+	/**
+	 * Sets whether infer_linear() uses one incremental encoding for all sizes
+	 * instead of a new one for each size. Algorithms that do not support this
+	 * always use a new encoding. Incremental inference is off by default.
+	 *
+	 * infer_binarysearch() ignores this: its doubling phase overshoots, so
+	 * every later solve would carry the encoding of the largest size tried
+	 * (e.g., for one sample of a random DFA with 8 states, 2.5 s instead of
+	 * 663 ms with a new encoding per size).
+	 *
+	 * @param incremental Indicates whether to use incremental inference
+	 */
+	void set_incremental(bool incremental) {
+		this->incremental = incremental;
+	}
+
+	/**
+	 * Returns whether the sample is copied into a prefix tree with compact
+	 * edges.
+	 *
+	 * @return Returns whether compact prefix trees are used.
+	 */
+	bool uses_compact_prefix_tree() const {
+		return compact_prefix_tree;
+	}
+
+	/**
+	 * Sets whether the sample is copied into a prefix tree with compact edges
+	 * instead of a table with one entry per node and letter. Compact trees
+	 * need much less memory for large alphabets, but looking up an edge is
+	 * slower.
+	 *
+	 * @param compact_prefix_tree Indicates whether to use compact prefix trees
+	 */
+	void set_compact_prefix_tree(bool compact_prefix_tree) {
+		this->compact_prefix_tree = compact_prefix_tree;
+	}
+
+	/**
+	 * Returns whether the nodes of the prefix tree are merged before the
+	 * inference.
+	 *
+	 * @return Returns whether premerging is used.
+	 */
+	bool uses_premerging() const {
+		return premerging;
+	}
+
+	/**
+	 * Sets whether the nodes of the prefix tree are merged before the
+	 * inference (see red_blue_premerging). The encoding is then built for
+	 * the quotient, which has far fewer nodes than the tree on large samples,
+	 * and the search for the minimal number of states starts at a lower bound
+	 * found by the merging.
+	 *
+	 * Merges can be wrong, such that the quotient needs more states than the
+	 * tree. Therefore, the tree itself is checked for a conjecture with one
+	 * state less than the one found (unless the lower bound rules this out),
+	 * and searched further if there is one. The result is thus always minimal.
+	 *
+	 * Algorithms whose encoding requires a tree (nfa_inferring_MiniSat) do
+	 * not merge.
+	 *
+	 * @param premerging Indicates whether to merge nodes before the inference
+	 */
+	void set_premerging(bool premerging) {
+		this->premerging = premerging;
+	}
+
+	/**
+	 * Returns the minimal score of a merge.
+	 *
+	 * @return Returns the minimal score of a merge.
+	 */
+	unsigned int get_premerging_evidence() const {
+		return premerging_evidence;
+	}
+
+	/**
+	 * Sets the minimal score of a merge, i.e., the number of outputs that
+	 * have to agree after merging two nodes. Higher values lead to fewer but
+	 * more reliable merges. The default is 3.
+	 *
+	 * @param premerging_evidence The minimal score of a merge
+	 */
+	void set_premerging_evidence(unsigned int premerging_evidence) {
+		this->premerging_evidence = premerging_evidence;
+	}
+
+	private:
+
+	virtual conjecture * __infer(const prefix_tree<answer> & t, unsigned int n) const = 0;
+
+	/**
+	 * Computes a conjecture with n states like __infer(), but may give up and
+	 * return NULL as soon as job->cancel becomes true. This is used by
+	 * infer_parallel(), where cancel is set by another thread.
+	 *
+	 * This method ignores the job. Derived classes whose solver can be
+	 * interrupted should override this method: the MiniSat-based algorithms
+	 * poll job->cancel, the Z3 and CSP-Z3 based ones register their context
+	 * with register_interrupter().
+	 *
+	 * @param t The prefix tree
+	 * @param n The number of states
+	 * @param job The job of infer_parallel(), or NULL
+	 *
+	 * @return Returns a conjecture with n states or NULL.
+	 */
+	virtual conjecture * __infer_cancelable(const prefix_tree<answer> & t, unsigned int n, __attribute__ ((__unused__)) typename size_search::job * job) const {
+
+		return __infer(t, n);
+
+	}
+
+	/**
+	 * Creates an incremental encoding for the given prefix tree. The caller
+	 * has to delete it.
+	 *
+	 * This method always returns NULL, i.e., incremental inference is not
+	 * supported. Derived classes that support it need to override this method.
+	 *
+	 * @param t The prefix tree to create the encoding for
+	 *
+	 * @return Returns a new incremental encoding or NULL.
+	 */
+	virtual incremental_inference * create_incremental_inference(__attribute__ ((__unused__)) const prefix_tree<answer> & t) const {
+
+		return NULL;
+
+	}
+
+	/**
+	 * Returns whether __infer() accepts the quotient of a prefix tree, i.e.,
+	 * whether the encoding only requires that each node has at most one
+	 * successor per letter, but not that the nodes form a tree.
+	 *
+	 * This method always returns false. Derived classes whose encoding
+	 * accepts quotients should override this method.
+	 *
+	 * @return Returns whether premerging is supported.
+	 */
+	virtual bool supports_premerging() const {
+
+		return false;
+
+	}
+
+	/**
+	 * Merges the nodes of a prefix tree if premerging is enabled and
+	 * supported. The caller has to delete the quotient.
+	 *
+	 * @param t The prefix tree
+	 * @param lower_bound Becomes a lower bound on the number of states (1 if
+	 *                    there is no quotient)
+	 *
+	 * @return Returns the quotient or NULL.
+	 */
+	prefix_tree<answer> * premerge(const prefix_tree<answer> & t, unsigned int & lower_bound) const {
+
+		lower_bound = 1;
+
+		if(!premerging || !supports_premerging()) {
+			return NULL;
 		}
 
-		unsigned int left = 1;
-		unsigned int right = 1;
+		red_blue_premerging<answer> merging(t, premerging_evidence);
+		prefix_tree<answer> * quotient = merging.create_quotient();
+		lower_bound = merging.get_lower_bound();
+
+		(*this->my_logger)(LOGGER_ALGORITHM, "Premerging: %u merges and %u red nodes reduced %u nodes to %u. A conjecture has at least %u states.\n",
+				merging.get_merge_count(), merging.get_red_count(), t.node_count, quotient->node_count, lower_bound);
+
+		return quotient;
+
+	}
+
+	/**
+	 * Makes the result of a search on a quotient minimal for the tree. If the
+	 * lower bound does not show that it is minimal, the tree is checked for a
+	 * conjecture with one state less and searched further if there is one.
+	 *
+	 * @param t The prefix tree
+	 * @param lower_bound A lower bound on the number of states
+	 * @param result A conjecture with size states for the quotient
+	 * @param size The minimal number of states for the quotient
+	 *
+	 * @return Returns a conjecture with a minimal number of states.
+	 */
+	conjecture * check_premerged(const prefix_tree<answer> & t, unsigned int lower_bound, conjecture * result, unsigned int size) const {
+
+		if(size <= lower_bound) {
+			return result;
+		}
+
+		conjecture * smaller = __infer(t, size - 1);
+		if(smaller == NULL) {
+			return result;
+		}
+
+		(*this->my_logger)(LOGGER_ALGORITHM, "The quotient needs more states than the prefix tree. Searching the prefix tree below %u states.\n", size);
+
+		delete result;
+		size--;
+		return search_minimum(t, NULL, lower_bound, size, smaller);
+
+	}
+
+	/**
+	 * Searches the minimal number of states by increasing the number of
+	 * states by increment until there is a conjecture and then using a binary
+	 * search.
+	 *
+	 * @param t The prefix tree
+	 * @param increment The increment
+	 * @param left The number of states to start with
+	 * @param size Becomes the minimal number of states
+	 *
+	 * @return Returns a conjecture with a minimal number of states.
+	 */
+	conjecture * search_linear(const prefix_tree<answer> & t, unsigned int increment, unsigned int left, unsigned int & size) const {
+
+		incremental_inference * inc = incremental ? create_incremental_inference(t) : NULL;
+
+		unsigned int right = left;
+
+		// First, increase the size until the problem is satisfiable
+		conjecture * result = NULL;
+		while(result == NULL) {
+
+			//std::cout << "left=" << left << ", right= " << right << std::endl;
+
+			result = infer_size(t, inc, right);
+
+			if(result == NULL) {
+
+				left = right + 1;
+				right += increment;
+
+			}
+
+		}
+
+		// Now, use a binary search to find the minimal value
+		result = search_minimum(t, inc, left, right, result);
+		size = right;
+
+		delete inc;
+
+		return result;
+
+	}
+
+	/**
+	 * Searches the minimal number of states by doubling the number of states
+	 * until there is a conjecture and then using a binary search. It always
+	 * uses a new encoding for each size (see set_incremental()).
+	 *
+	 * @param t The prefix tree
+	 * @param left The number of states to start with
+	 * @param size Becomes the minimal number of states
+	 *
+	 * @return Returns a conjecture with a minimal number of states.
+	 */
+	conjecture * search_binary(const prefix_tree<answer> & t, unsigned int left, unsigned int & size) const {
+
+		unsigned int right = left;
 
 		// First, double the size until the problem is satisfiable
 		conjecture * result = NULL;
@@ -180,11 +738,35 @@ class automata_inferring : public learning_algorithm<answer> {
 		}
 
 		// Now, use a binary search to find the minimal value
+		result = search_minimum(t, NULL, left, right, result);
+		size = right;
+
+		return result;
+
+	}
+
+	/**
+	 * Searches the minimal number of states between left and right with a
+	 * binary search.
+	 *
+	 * @param t The prefix tree
+	 * @param inc The incremental encoding or NULL
+	 * @param left The smallest number of states that is possible
+	 * @param right The number of states of result. Becomes the minimal number
+	 *              of states.
+	 * @param result A conjecture with right states
+	 *
+	 * @return Returns a conjecture with a minimal number of states.
+	 */
+	conjecture * search_minimum(const prefix_tree<answer> & t, incremental_inference * inc, unsigned int left, unsigned int & right, conjecture * result) const {
+
 		while(left < right) {
 
 			unsigned int mid = left + (right - left) / 2;
 
-			conjecture * tmp_result = __infer(t, mid);
+			//std::cout << "left=" << left << ", right= " << right << ", mid=" << mid << std::endl;
+
+			conjecture * tmp_result = infer_size(t, inc, mid);
 
 			if(tmp_result == NULL) {
 				left = mid + 1;
@@ -199,34 +781,23 @@ class automata_inferring : public learning_algorithm<answer> {
 
 		}
 
-		assert(result != NULL);
 		return result;
 
 	}
 
 	/**
-	 * Returns the default output used for conjectures if the output of a state
-	 * is not determined by the given sample.
-	 *
-	 * @return Returns the default output used for conjectures.
-	 */
-	answer get_default_output() {
-		return default_output;
-	}
-
-	/**
-	 * Sets the default output used for conjectures if the output of a state
-	 * is not determined by the given sample.
-	 *
-	 * @param new_default_output The new default output used for conjectures
+	 * Computes a conjecture with n states, using the incremental encoding if
+	 * there is one.
 	 */
-	void set_default_output(answer new_default_output) {
-		this->default_output = new_default_output;
-	}
+	conjecture * infer_size(const prefix_tree<answer> & t, incremental_inference * inc, unsigned int n) const {
 
-	private:
+		if(inc != NULL) {
+			return inc->infer(n);
+		} else {
+			return __infer(t, n);
+		}
 
-	virtual conjecture * __infer(const prefix_tree<answer> & t, unsigned int n) const = 0;
+	}
 
 	/**
 	 * This method constructs a "simple" conjecture from a prefix tree with only
@@ -250,6 +821,51 @@ class automata_inferring : public learning_algorithm<answer> {
 
 	protected:
 
+	/**
+	 * Makes job->cancel interrupt the given solver until
+	 * unregister_interrupter() is called. Nothing happens if job is NULL.
+	 *
+	 * @param job The job of infer_parallel(), or NULL
+	 * @param solver The interrupter of the solver
+	 *
+	 * @return Returns false if the job is already canceled, i.e., the solver
+	 *         should not be started.
+	 */
+	bool register_interrupter(typename size_search::job * job, interrupter * solver) const {
+
+		if(job == NULL) {
+			return true;
+		}
+
+		pthread_mutex_lock(&job->search->lock);
+		bool canceled = job->cancel;
+		if(!canceled) {
+			job->solver = solver;
+		}
+		pthread_mutex_unlock(&job->search->lock);
+
+		return !canceled;
+
+	}
+
+	/**
+	 * Removes the interrupter registered with register_interrupter(). Has to
+	 * be called before the solver is destroyed.
+	 *
+	 * @param job The job of infer_parallel(), or NULL
+	 */
+	void unregister_interrupter(typename size_search::job * job) const {
+
+		if(job == NULL) {
+			return;
+		}
+
+		pthread_mutex_lock(&job->search->lock);
+		job->solver = NULL;
+		pthread_mutex_unlock(&job->search->lock);
+
+	}
+
 	/**
 	 * This method constructs a one-state Moore machine from a prefix tree with
 	 * only don't cares or with don't cares and only one other output. The
@@ -441,6 +1057,7 @@ class automata_inferring : public learning_algorithm<answer> {
 		return true;
 	}
 
+	using learning_algorithm<answer>::add_counterexample;
 	bool add_counterexample(std::list<int>) {
 		(*this->my_logger)(LOGGER_WARN, "This is an offline-algorithm. Please add the counter-example directly to the knowledgebase and rerun the algorithm.\n");
 		return false;
@@ -254,6 +254,7 @@ class basic_biermann : public learning_algorithm<answer> {
 			};
 		}}}
 
+		using learning_algorithm<answer>::add_counterexample;
 		// stubs for counterexample will throw a warning to the logger
 		virtual bool add_counterexample(std::list<int>)
 		{{{
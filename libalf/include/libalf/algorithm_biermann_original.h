@@ -100,6 +100,7 @@ std::cerr << "original_biermann constructed.\n";
 		return true;
 	}
 
+	using learning_algorithm<answer>::add_counterexample;
 	bool add_counterexample(std::list<int>) {
 		(*this->my_logger)(LOGGER_ERROR, "biermann does not support counter-examples, as it is an offline-algorithm. Please add the counter-example directly to the knowledgebase and rerun the algorithm.\n");
 		return false;
@@ -119,6 +119,7 @@ class counterexample_learning : public learning_algorithm<bool> {
 		
 	}
 	
+	using learning_algorithm<bool>::add_counterexample;
 	/**
 	 * Adds a counter-example to the knowledgebase. The algorithm itself does
 	 * not have internal data about words and their classification.
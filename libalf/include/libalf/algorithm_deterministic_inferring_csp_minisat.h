@@ -122,8 +122,22 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 
 	private:
 
+	virtual bool supports_premerging() const {
+
+		return true;
+
+	}
+
 	virtual conjecture * __infer(const prefix_tree<answer> & t, unsigned int n) const {
 
+		return __infer_cancelable(t, n, NULL);
+
+	}
+
+	virtual conjecture * __infer_cancelable(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job) const {
+
+		const volatile bool * cancel = job != NULL ? &job->cancel : NULL;
+
 		// Check value for n
 		if(n == 0) {
 			(*this->my_logger)(LOGGER_ERROR, "The number 'n' of states has to be greater than 0.\n");
@@ -132,9 +146,9 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 
 		// Decide which encoding to use
 		if(unary_encoding) {
-			return infer_unary_MiniSat(t, n);
+			return infer_unary_MiniSat(t, n, cancel);
 		} else {
-			return infer_binary_MiniSat(t, n);
+			return infer_binary_MiniSat(t, n, cancel);
 		}
 
 	}
@@ -145,7 +159,7 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_unary_MiniSat(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_unary_MiniSat(const prefix_tree<answer> & t, unsigned int n, const volatile bool * cancel = NULL) const {
 
 		/*========================================
 		 *
@@ -173,6 +187,7 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 		 *
 		 *========================================*/
 		MiniSat::Solver solver;
+		solver.interrupt = cancel;
 
 
 		/*========================================
@@ -302,7 +317,7 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u variables and %u clauses.\n", var_count, clause_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ... ");
 		if(!solver.solve()) {
-			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
+			(*this->my_logger)(LOGGER_ALGORITHM, solver.interrupted() ? "Canceled.\n" : "Formula is unsatisfiable.\n");
 			return NULL;
 		} else {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is satisfiable.\n");
@@ -466,7 +481,7 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_binary_MiniSat(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_binary_MiniSat(const prefix_tree<answer> & t, unsigned int n, const volatile bool * cancel = NULL) const {
 
 		/*========================================
 		 *
@@ -506,6 +521,7 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 		 *
 		 *========================================*/
 		MiniSat::Solver solver;
+		solver.interrupt = cancel;
 
 
 		/*========================================
@@ -652,7 +668,7 @@ class deterministic_inferring_csp_MiniSat : public automata_inferring<answer> {
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u variables and %u clauses.\n", var_count, clause_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ... ");
 		if(!solver.solve()) {
-			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
+			(*this->my_logger)(LOGGER_ALGORITHM, solver.interrupted() ? "Canceled.\n" : "Formula is unsatisfiable.\n");
 			return NULL;
 		} else {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is satisfiable.\n");
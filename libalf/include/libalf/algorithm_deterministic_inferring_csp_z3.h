@@ -135,8 +135,20 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 
 	private:
 
+	virtual bool supports_premerging() const {
+
+		return true;
+
+	}
+
 	virtual conjecture * __infer(const prefix_tree<answer> & t, unsigned int n) const {
 
+		return __infer_cancelable(t, n, NULL);
+
+	}
+
+	virtual conjecture * __infer_cancelable(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job) const {
+
 		// Check value for n
 		if(n == 0) {
 			(*this->my_logger)(LOGGER_ERROR, "The number 'n' of states has to be greater than 0.\n");
@@ -145,13 +157,13 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 
 		// Decide which encoding of the formula we want to use
 		if(!use_variables && !use_enum) {
-			return infer_CSP_Z3(t, n);
+			return infer_CSP_Z3(t, n, job);
 		} else if(use_variables && !use_enum) {
-			return infer_CSP_variables_Z3(t, n);
+			return infer_CSP_variables_Z3(t, n, job);
 		} else if(!use_variables && use_enum) {
-			return infer_CSP_enum_Z3(t, n);
+			return infer_CSP_enum_Z3(t, n, job);
 		} else {
-			return infer_CSP_variables_enum_Z3(t, n);
+			return infer_CSP_variables_enum_Z3(t, n, job);
 		}
 
 	}
@@ -162,7 +174,7 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_CSP_Z3(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_CSP_Z3(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -257,7 +269,13 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -358,7 +376,7 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_CSP_variables_Z3(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_CSP_variables_Z3(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -462,7 +480,13 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -563,7 +587,7 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_CSP_enum_Z3(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_CSP_enum_Z3(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -669,7 +693,13 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -826,7 +856,7 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_CSP_variables_enum_Z3(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_CSP_variables_enum_Z3(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -939,7 +969,13 @@ class deterministic_inferring_csp_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -43,6 +43,7 @@
 #include "libalf/conjecture.h"
 #include "libalf/prefix_tree.h"
 #include "libalf/algorithm_automata_inferring.h"
+#include "libalf/minisat_bfs_symmetry_breaking.h"
 
 // MiniSat includes
 #include "libalf/minisat/Solver.h"
@@ -60,6 +61,12 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 	 */
 	bool symmetry_breaking;
 
+	/**
+	 * Indicates whether the states of conjectures have to be numbered in BFS
+	 * order (see minisat_bfs_symmetry_breaking.h).
+	 */
+	bool bfs_symmetry_breaking;
+
 	/**
 	 * Indicates whether the computed model should be logged (to the algorithm loglevel)
 	 */
@@ -77,6 +84,7 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 		this->set_knowledge_source(base);
 
 		this->symmetry_breaking = symmetry_breaking;
+		this->bfs_symmetry_breaking = false;
 
 		this->log_model = false;
 	}
@@ -103,6 +111,29 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 		this->symmetry_breaking = symmetry_breaking;
 	}
 
+	/**
+	 * Returns whether the states of conjectures have to be numbered in BFS
+	 * order.
+	 *
+	 * @return Returns whether BFS symmetry breaking is used.
+	 */
+	bool uses_bfs_symmetry_breaking() {
+		return bfs_symmetry_breaking;
+	}
+
+	/**
+	 * Sets whether the states of conjectures have to be numbered in the order
+	 * a breadth-first search visits them. This removes the symmetries between
+	 * different numberings of the same automaton from the encoding and mostly
+	 * speeds up proving that there is no conjecture with fewer states.
+	 *
+	 * @param bfs_symmetry_breaking Indicates whether to use BFS symmetry
+	 *                              breaking
+	 */
+	void set_bfs_symmetry_breaking(bool bfs_symmetry_breaking) {
+		this->bfs_symmetry_breaking = bfs_symmetry_breaking;
+	}
+
 	bool is_logging_model() {
 		return log_model;
 	}
@@ -115,21 +146,36 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 
 		os << "(Minimal) Moore machine inferring algorithm via transitions encoding using the MiniSat SAT Solver. ";
 		os << "Alphabet size is " << this->alphabet_size;
-		os << (symmetry_breaking ? " using symmetry breaking" : "") << ".";
+		os << (symmetry_breaking ? " using symmetry breaking" : "");
+		os << (bfs_symmetry_breaking ? " with BFS order" : "") << ".";
 
 	}
 
 	private:
 
+	virtual bool supports_premerging() const {
+
+		return true;
+
+	}
+
 	virtual conjecture * __infer(const prefix_tree<answer> & t, unsigned int n) const {
 
+		return __infer_cancelable(t, n, NULL);
+
+	}
+
+	virtual conjecture * __infer_cancelable(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job) const {
+
+		const volatile bool * cancel = job != NULL ? &job->cancel : NULL;
+
 		// Check value for n
 		if(n == 0) {
 			(*this->my_logger)(LOGGER_ERROR, "The number 'n' of states has to be greater than 0.\n");
 			return NULL;
 		}
 
-		return infer_MiniSat(t, n);
+		return infer_MiniSat(t, n, cancel);
 
 	}
 
@@ -139,7 +185,7 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_MiniSat(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_MiniSat(const prefix_tree<answer> & t, unsigned int n, const volatile bool * cancel = NULL) const {
 
 		/*========================================
 		 *
@@ -176,6 +222,7 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 		 *
 		 *========================================*/
 		MiniSat::Solver solver;
+		solver.interrupt = cancel;
 
 
 		/*========================================
@@ -372,6 +419,11 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 
 		} // End adding redundant clauses
 
+		// BFS symmetry breaking
+		if(bfs_symmetry_breaking) {
+			add_bfs_symmetry_breaking(solver, x[0], d, n, this->alphabet_size, var_count, clause_count);
+		}
+
 		/*========================================
 		 *
 		 * Solve
@@ -380,7 +432,7 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u variables and %u clauses.\n", var_count, clause_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ... ");
 		if(!solver.solve()) {
-			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
+			(*this->my_logger)(LOGGER_ALGORITHM, solver.interrupted() ? "Canceled.\n" : "Formula is unsatisfiable.\n");
 			return NULL;
 		} else {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is satisfiable.\n");
@@ -616,6 +668,14 @@ class deterministic_inferring_MiniSat : public automata_inferring<answer> {
 				if(serial.empty()) return false;
 				set_symmetry_breaking(ntohl(*serial) != 0);
 				break;
+			case 2:
+				result += htonl(uses_bfs_symmetry_breaking());
+				break;
+			case 3:
+				++serial;
+				if(serial.empty()) return false;
+				set_bfs_symmetry_breaking(ntohl(*serial) != 0);
+				break;
 			default:
 				return false;
 		}
@@ -135,8 +135,20 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 
 	private:
 
+	virtual bool supports_premerging() const {
+
+		return true;
+
+	}
+
 	virtual conjecture * __infer(const prefix_tree<answer> & t, unsigned int n) const {
 
+		return __infer_cancelable(t, n, NULL);
+
+	}
+
+	virtual conjecture * __infer_cancelable(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job) const {
+
 		// Check value for n
 		if(n == 0) {
 			(*this->my_logger)(LOGGER_ERROR, "The number 'n' of states has to be greater than 0.\n");
@@ -145,13 +157,13 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 
 		// Decide which encoding of the formula we want to use
 		if(!use_variables && !use_enum) {
-			return infer_Z3(t, n);
+			return infer_Z3(t, n, job);
 		} else if(use_variables && !use_enum) {
-			return infer_Z3_variables(t, n);
+			return infer_Z3_variables(t, n, job);
 		} else if(!use_variables && use_enum) {
-			return infer_Z3_enum(t, n);
+			return infer_Z3_enum(t, n, job);
 		} else {
-			return infer_Z3_variables_enum(t, n);
+			return infer_Z3_variables_enum(t, n, job);
 		}
 
 	}
@@ -162,7 +174,7 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_Z3(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_Z3(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -281,7 +293,13 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -357,7 +375,7 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_Z3_variables(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_Z3_variables(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -484,7 +502,13 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -560,7 +584,7 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_Z3_enum(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_Z3_enum(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -718,7 +742,13 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -827,7 +857,7 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 
 	}
 
-	libalf::moore_machine<answer> * infer_Z3_variables_enum(const prefix_tree<answer> & t, unsigned int n) const {
+	libalf::moore_machine<answer> * infer_Z3_variables_enum(const prefix_tree<answer> & t, unsigned int n, typename automata_inferring<answer>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -993,7 +1023,13 @@ class deterministic_inferring_Z3 : public automata_inferring<answer> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %u assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		typename automata_inferring<answer>::template context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -43,6 +43,7 @@
 #include "libalf/conjecture.h"
 #include "libalf/prefix_tree.h"
 #include "libalf/algorithm_automata_inferring.h"
+#include "libalf/minisat_bfs_symmetry_breaking.h"
 
 // MiniSat includes
 #include "libalf/minisat/Solver.h"
@@ -59,6 +60,12 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 	 */
 	bool symmetry_breaking;
 	
+	/**
+	 * Indicates whether the states of conjectures have to be numbered in BFS
+	 * order (see minisat_bfs_symmetry_breaking.h).
+	 */
+	bool bfs_symmetry_breaking;
+	
 	/**
 	 * Indicates whether the computed model should be logged (to the algorithm loglevel)
 	 */
@@ -76,6 +83,7 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 		this->set_knowledge_source(base);
 		
 		this->symmetry_breaking = symmetry_breaking;
+		this->bfs_symmetry_breaking = false;
 
 		this->log_model = false;
 	}
@@ -102,6 +110,29 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 		this->symmetry_breaking = symmetry_breaking;
 	}
 
+	/**
+	 * Returns whether the states of conjectures have to be numbered in BFS
+	 * order.
+	 *
+	 * @return Returns whether BFS symmetry breaking is used.
+	 */
+	bool uses_bfs_symmetry_breaking() {
+		return bfs_symmetry_breaking;
+	}
+
+	/**
+	 * Sets whether the states of conjectures have to be numbered in the order
+	 * a breadth-first search visits them. This removes the symmetries between
+	 * different numberings of the same automaton from the encoding and mostly
+	 * speeds up proving that there is no conjecture with fewer states.
+	 *
+	 * @param bfs_symmetry_breaking Indicates whether to use BFS symmetry
+	 *                              breaking
+	 */
+	void set_bfs_symmetry_breaking(bool bfs_symmetry_breaking) {
+		this->bfs_symmetry_breaking = bfs_symmetry_breaking;
+	}
+
 	bool is_logging_model() {
 		return log_model;
 	}
@@ -114,21 +145,360 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 	
 		os << "(Minimal) DFA inferring algorithm via transitions encoding using the MiniSat SAT Solver. ";
 		os << "Alphabet size is " << this->alphabet_size;
-		os << (symmetry_breaking ? " using symmetry breaking" : "") << ".";
+		os << (symmetry_breaking ? " using symmetry breaking" : "");
+		os << (bfs_symmetry_breaking ? " with BFS order" : "");
+		os << (this->incremental ? " (incremental)" : "") << ".";
 		
 	}
 
 	private:
 
+	/**
+	 * The encoding of infer_MiniSat() in one solver for all numbers of states.
+	 *
+	 * Variables and clauses for a state q are added when a conjecture with
+	 * more than q states is asked for. All clauses but (1) and (6) stay valid
+	 * for more states. Those are added once for each number of states n, with
+	 * an activation literal that is assumed while solving for n and set to
+	 * false afterwards. States n, n+1, ... are then free and can be set to be
+	 * unused, so the formula is satisfiable iff there is a DFA with n states.
+	 */
+	class incremental_encoding : public automata_inferring<bool>::incremental_inference {
+
+		private:
+
+		const prefix_tree<bool> & t;
+		int alphabet_size;
+		bool symmetry_breaking;
+		bool log_model;
+		logger * my_logger;
+
+		MiniSat::Solver solver;
+
+		// States that have variables
+		unsigned int state_count;
+
+		std::vector<std::vector<MiniSat::Var> > x; // x_{u, q}
+		std::vector<std::vector<std::vector<MiniSat::Var> > > d; // d(p, a) = q
+		std::vector<MiniSat::Var> f; // p \in F
+
+		unsigned long long clause_count;
+
+		public:
+
+		incremental_encoding(const prefix_tree<bool> & t, int alphabet_size, bool symmetry_breaking, bool log_model, logger * log) : t(t) {
+
+			this->alphabet_size = alphabet_size;
+			this->symmetry_breaking = symmetry_breaking;
+			this->log_model = log_model;
+			this->my_logger = log;
+
+			state_count = 0;
+			x.resize(t.node_count);
+			clause_count = 0;
+
+		}
+
+		virtual conjecture * infer(unsigned int n) {
+
+			if(n==0 || alphabet_size==0) {
+				(*my_logger)(LOGGER_ERROR, "Alphabet size or size of automaton is zero.\n");
+				return NULL;
+			}
+			(*my_logger)(LOGGER_ALGORITHM, "Running MiniSat (incremental) using the 'transition encoding' to find a solution with %u states and alphabet size %d.\n", n, alphabet_size);
+
+			while(state_count < n) {
+				add_state();
+			}
+
+			// (1) and (6) for n states, enabled by active
+			MiniSat::Var active = solver.newVar();
+
+			for(unsigned int u=0; u<t.node_count; u++) {
+
+				MiniSat::vec<MiniSat::Lit> clause;
+				clause.growTo(n + 1);
+
+				for(unsigned int q=0; q<n; q++) {
+					clause[q] = MiniSat::Lit(x[u][q]);
+				}
+				clause[n] = ~MiniSat::Lit(active);
+
+				solver.addClause(clause);
+
+				clause_count++;
+
+			}
+
+			if(symmetry_breaking) {
+				for(unsigned int p=0; p<n; p++) {
+					for(int a=0; a<alphabet_size; a++) {
+
+						MiniSat::vec<MiniSat::Lit> clause;
+						clause.growTo(n + 1);
+
+						for(unsigned int q=0; q<n; q++) {
+							clause[q] = MiniSat::Lit(d[p][a][q]);
+						}
+						clause[n] = ~MiniSat::Lit(active);
+
+						solver.addClause(clause);
+
+						clause_count++;
+
+					}
+				}
+			}
+
+			/*========================================
+			 *
+			 * Solve
+			 *
+			 *========================================*/
+			(*my_logger)(LOGGER_ALGORITHM, "%d variables and %llu clauses in total.\n", solver.nVars(), clause_count);
+			(*my_logger)(LOGGER_ALGORITHM, "Solving ... ");
+
+			MiniSat::vec<MiniSat::Lit> assumptions;
+			assumptions.push(MiniSat::Lit(active));
+
+			finite_automaton * dfa = NULL;
+			if(!solver.solve(assumptions)) {
+				(*my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
+			} else {
+				(*my_logger)(LOGGER_ALGORITHM, "Formula is satisfiable.\n");
+				dfa = construct(n);
+			}
+
+			// The search methods never ask for n again
+			solver.addUnit(~MiniSat::Lit(active));
+
+			return dfa;
+
+		}
+
+		private:
+
+		void add_state() {
+
+			unsigned int q = state_count++;
+
+			/*========================================
+			 *
+			 * Create variables
+			 *
+			 *========================================*/
+			for(unsigned int u=0; u<t.node_count; u++) {
+				x[u].push_back(solver.newVar());
+			}
+
+			d.resize(q + 1);
+			d[q].resize(alphabet_size);
+			for(unsigned int p=0; p<=q; p++) {
+				for(int a=0; a<alphabet_size; a++) {
+					while(d[p][a].size() <= q) {
+						d[p][a].push_back(solver.newVar());
+					}
+				}
+			}
+
+			f.push_back(solver.newVar());
+
+			/*========================================
+			 *
+			 * Create clauses (those with q)
+			 *
+			 *========================================*/
+
+			// (2) The variables d encode a function (not a relation)
+			for(unsigned int p=0; p<=q; p++) {
+				for(int a=0; a<alphabet_size; a++) {
+
+					for(unsigned int q1=0; q1<=q; q1++) {
+						for(unsigned int q2=0; q2<q1; q2++) {
+							if(p == q || q1 == q) {
+
+								solver.addBinary(~MiniSat::Lit(d[p][a][q1]), ~MiniSat::Lit(d[p][a][q2]));
+
+								clause_count++;
+
+							}
+						}
+					}
+
+				}
+			}
+
+			// (3) Transitions are applied correctly: (x[u][p] && x[ua][r]) => d[p][a][r]
+			// (7) Transitions are applied correctly: (x[u][p] && d[p][a][r]) => x[ua][r]
+			for(unsigned int u=0; u<t.node_count; u++) {
+				for(int a=0; a<alphabet_size; a++) {
+					if(t.edges[u][a] != prefix_tree<bool>::no_edge) {
+
+						for(unsigned int p=0; p<=q; p++) {
+							for(unsigned int r=0; r<=q; r++) {
+								if(p == q || r == q) {
+
+									solver.addTernary(~MiniSat::Lit(x[u][p]), MiniSat::Lit(d[p][a][r]), ~MiniSat::Lit(x[t.edges[u][a]][r]));
+
+									clause_count++;
+
+									if(symmetry_breaking) {
+
+										solver.addTernary(~MiniSat::Lit(x[u][p]), ~MiniSat::Lit(d[p][a][r]), MiniSat::Lit(x[t.edges[u][a]][r]));
+
+										clause_count++;
+
+									}
+
+								}
+							}
+						}
+
+					}
+				}
+			}
+
+			// (4) Classified words lead to accepting resp. rejecting states
+			for(unsigned int u=0; u<t.node_count; u++) {
+				if(t.specified[u]) {
+
+					if(t.output[u]) {
+						solver.addBinary(~MiniSat::Lit(x[u][q]), MiniSat::Lit(f[q]));
+					} else {
+						solver.addBinary(~MiniSat::Lit(x[u][q]), ~MiniSat::Lit(f[q]));
+					}
+
+					clause_count++;
+
+				}
+			}
+
+			// (5) For each prefix, at most one state is assumed
+			if(symmetry_breaking) {
+				for(unsigned int u=0; u<t.node_count; u++) {
+					for(unsigned int p=0; p<q; p++) {
+
+						solver.addBinary(~MiniSat::Lit(x[u][q]), ~MiniSat::Lit(x[u][p]));
+
+						clause_count++;
+
+					}
+				}
+			}
+
+		}
+
+		finite_automaton * construct(unsigned int n) {
+
+			// Write model
+			if(log_model) {
+
+				(*my_logger)(LOGGER_ALGORITHM, "Model:\n");
+				for(unsigned int p=0; p<n; p++) {
+					for(int a=0; a<alphabet_size; a++) {
+						for(unsigned int q=0; q<n; q++) {
+							(*my_logger)(LOGGER_ALGORITHM, "d[%u][%u][%u] = %s\n", p, a, q, (solver.model[d[p][a][q]] == MiniSat::l_True ? "1" : (solver.model[d[p][a][q]] == MiniSat::l_False ? "0" : "?")));
+						}
+					}
+				}
+				for(unsigned int q=0; q<n; q++) {
+					(*my_logger)(LOGGER_ALGORITHM, "f[%u] = %s\n", q, (solver.model[f[q]] == MiniSat::l_True ? "1" : (solver.model[f[q]] == MiniSat::l_False ? "0" : "?")));
+				}
+				for(unsigned int u=0; u<t.node_count; u++) {
+					for(unsigned int q=0; q<n; q++) {
+						(*my_logger)(LOGGER_ALGORITHM, "x[%u][%u] = %s\n", u, q, (solver.model[x[u][q]] == MiniSat::l_True ? "1" : (solver.model[x[u][q]] == MiniSat::l_False ? "0" : "?")));
+					}
+				}
+
+			}
+
+			// Transitions (states >= n are unused)
+			std::map<int, std::map<int, std::set<int> > > transitions;
+			for(unsigned int p=0; p<n; p++) {
+				for(int a=0; a<alphabet_size; a++) {
+					for(unsigned int q=0; q<n; q++) {
+						if(solver.model[d[p][a][q]] == MiniSat::l_True) {
+							transitions[p][a].insert(q);
+							break;
+						}
+					}
+
+					// If no symmetry breaking, then there might be undefined transitions
+					if(symmetry_breaking) {
+						assert(transitions[p].count(a) > 0);
+					}
+				}
+			}
+
+			// Initial state
+			std::set<int> initial;
+			for(unsigned int q=0; q<n; q++) {
+				if(solver.model[x[0][q]] == MiniSat::l_True) {
+					initial.insert(q);
+					break;
+				}
+			}
+			assert(initial.size() == 1);
+
+			// Final states
+			std::set<int> final;
+			for(unsigned int q=0; q<n; q++) {
+				if(solver.model[f[q]] == MiniSat::l_True) {
+					final.insert(q);
+				}
+			}
+
+			// Construct and return automaton
+			finite_automaton * dfa = new finite_automaton;
+			dfa->input_alphabet_size = alphabet_size;
+			dfa->state_count = n;
+			dfa->initial_states = initial;
+			dfa->set_final_states(final);
+			dfa->transitions = transitions;
+			dfa->valid = true;
+			dfa->calc_determinism();
+
+			assert(dfa->calc_validity());
+			return dfa;
+
+		}
+
+	};
+
+	virtual incremental_inference * create_incremental_inference(const prefix_tree<bool> & t) const {
+
+		// The BFS constraints are not part of the incremental encoding
+		if(bfs_symmetry_breaking) {
+			return NULL;
+		}
+
+		return new incremental_encoding(t, this->alphabet_size, symmetry_breaking, log_model, this->my_logger);
+
+	}
+
+	virtual bool supports_premerging() const {
+
+		return true;
+
+	}
+
 	virtual conjecture * __infer(const prefix_tree<bool> & t, unsigned int n) const {
 	
+		return __infer_cancelable(t, n, NULL);
+
+	}
+
+	virtual conjecture * __infer_cancelable(const prefix_tree<bool> & t, unsigned int n, automata_inferring<bool>::size_search::job * job) const {
+	
+		const volatile bool * cancel = job != NULL ? &job->cancel : NULL;
+
 		// Check value for n
 		if(n == 0) {
 			(*this->my_logger)(LOGGER_ERROR, "The number 'n' of states has to be greater than 0.\n");
 			return NULL;
 		}
 
-		return infer_MiniSat(t, n);
+		return infer_MiniSat(t, n, cancel);
 
 	}
 	
@@ -138,7 +508,7 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 		
 	}
 	
-	libalf::finite_automaton * infer_MiniSat(const prefix_tree<bool> & t, unsigned int n) const {
+	libalf::finite_automaton * infer_MiniSat(const prefix_tree<bool> & t, unsigned int n, const volatile bool * cancel = NULL) const {
 
 		/*========================================
 		 *
@@ -160,6 +530,7 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 		 *
 		 *========================================*/
 		MiniSat::Solver solver;
+		solver.interrupt = cancel;
 		
 		
 		/*========================================
@@ -335,7 +706,12 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 		}
 		
 		} // End adding redundant clauses
-		
+
+		// BFS symmetry breaking
+		if(bfs_symmetry_breaking) {
+			add_bfs_symmetry_breaking(solver, x[0], d, n, this->alphabet_size, var_count, clause_count);
+		}
+
 		/*========================================
 		 *
 		 * Solve
@@ -344,7 +720,7 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 		(*this->my_logger)(LOGGER_ALGORITHM, "Created %d variables and %d clauses.\n", var_count, clause_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ... ");
 		if(!solver.solve()) {
-			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is unsatisfiable.\n");
+			(*this->my_logger)(LOGGER_ALGORITHM, solver.interrupted() ? "Canceled.\n" : "Formula is unsatisfiable.\n");
 			return NULL;
 		} else {
 			(*this->my_logger)(LOGGER_ALGORITHM, "Formula is satisfiable.\n");
@@ -537,6 +913,14 @@ class dfa_inferring_MiniSat : public automata_inferring<bool> {
 				if(serial.empty()) return false;
 				set_symmetry_breaking(ntohl(*serial) != 0);
 				break;
+			case 2:
+				result += htonl(uses_bfs_symmetry_breaking());
+				break;
+			case 3:
+				++serial;
+				if(serial.empty()) return false;
+				set_bfs_symmetry_breaking(ntohl(*serial) != 0);
+				break;
 			default:
 				return false;
 		}
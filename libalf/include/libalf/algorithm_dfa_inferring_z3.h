@@ -134,8 +134,20 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 
 	private:
 
+	virtual bool supports_premerging() const {
+
+		return true;
+
+	}
+
 	virtual conjecture * __infer(const prefix_tree<bool> & t, unsigned int n) const {
 
+		return __infer_cancelable(t, n, NULL);
+
+	}
+
+	virtual conjecture * __infer_cancelable(const prefix_tree<bool> & t, unsigned int n, automata_inferring<bool>::size_search::job * job) const {
+
 		// Check value for n
 		if(n == 0) {
 			(*this->my_logger)(LOGGER_ERROR, "The number 'n' of states has to be greater than 0.\n");
@@ -144,13 +156,13 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 
 		// Decide which encoding of the formula we want to use
 		if(!use_variables && !use_enum) {
-			return infer_Z3(t, n);
+			return infer_Z3(t, n, job);
 		} else if(use_variables && !use_enum) {
-			return infer_Z3_variables(t, n);
+			return infer_Z3_variables(t, n, job);
 		} else if(!use_variables && use_enum) {
-			return infer_Z3_enum(t, n);
+			return infer_Z3_enum(t, n, job);
 		} else {
-			return infer_Z3_variables_enum(t, n);
+			return infer_Z3_variables_enum(t, n, job);
 		}
 
 	}
@@ -161,7 +173,7 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 
 	}
 
-	libalf::finite_automaton * infer_Z3(const prefix_tree<bool> & t, unsigned int n) const {
+	libalf::finite_automaton * infer_Z3(const prefix_tree<bool> & t, unsigned int n, automata_inferring<bool>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -268,7 +280,13 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %d assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		automata_inferring<bool>::context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -340,7 +358,7 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 
 	}
 
-	libalf::finite_automaton * infer_Z3_variables(const prefix_tree<bool> & t, unsigned int n) const {
+	libalf::finite_automaton * infer_Z3_variables(const prefix_tree<bool> & t, unsigned int n, automata_inferring<bool>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -454,7 +472,13 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %d assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		automata_inferring<bool>::context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -526,7 +550,7 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 
 	}
 
-	libalf::finite_automaton * infer_Z3_enum(const prefix_tree<bool> & t, unsigned int n) const {
+	libalf::finite_automaton * infer_Z3_enum(const prefix_tree<bool> & t, unsigned int n, automata_inferring<bool>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -660,7 +684,13 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %d assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		automata_inferring<bool>::context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
@@ -752,7 +782,7 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 
 	}
 
-	libalf::finite_automaton * infer_Z3_variables_enum(const prefix_tree<bool> & t, unsigned int n) const {
+	libalf::finite_automaton * infer_Z3_variables_enum(const prefix_tree<bool> & t, unsigned int n, automata_inferring<bool>::size_search::job * job = NULL) const {
 
 		/*========================================
 		 *
@@ -895,7 +925,13 @@ class dfa_inferring_Z3 : public automata_inferring<bool> {
 		 *========================================*/
 		(*this->my_logger)(LOGGER_DEBUG, "Created %d assertions.\n", assertion_count);
 		(*this->my_logger)(LOGGER_ALGORITHM, "Solving ...\n");
-		if(s.check() != z3::sat) {
+		automata_inferring<bool>::context_interrupter<z3::context> stop(c);
+		if(!this->register_interrupter(job, &stop)) {
+			return NULL;
+		}
+		z3::check_result satisfiable = s.check();
+		this->unregister_interrupter(job);
+		if(satisfiable != z3::sat) {
 			(*this->my_logger)(LOGGER_DEBUG, "Formula is unsatisfiable.\n");
 			return NULL;
 		}
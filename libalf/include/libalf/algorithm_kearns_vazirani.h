@@ -1600,6 +1600,7 @@ class kearns_vazirani : public learning_algorithm<answer> {
 		return true;
 	}
 
+	using learning_algorithm<answer>::add_counterexample;
 	/*
 	 * Add a counter-example to the algorithm.
 	 */
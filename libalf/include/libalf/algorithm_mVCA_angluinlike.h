@@ -1235,6 +1235,7 @@ deserialization_failed:
 			return true;
 		}}}
 
+		using learning_algorithm<answer>::add_counterexample;
 		virtual bool add_counterexample(std::list<int> counterexample)
 		{{{
 			switch(mode) {
@@ -45,7 +45,7 @@ namespace libalf {
 template <class answer>
 class rivest_schapire_table : public angluin_simple_table<answer> {
 	protected: // types
-		typedef std::list< algorithm_angluin::simple_row<answer, std::vector<answer> > > table_t;
+		typedef typename angluin_simple_table<answer>::table_t table_t;
 
 	protected: // data
 		bool counterexample_mode;
@@ -264,6 +264,7 @@ class rivest_schapire_table : public angluin_simple_table<answer> {
 
 		// (still compatible to ALG_ANGLUIN)
 
+		using angluin_simple_table<answer>::add_counterexample;
 		virtual bool add_counterexample(std::list<int> word)
 		{{{
 			std::list<int>::const_iterator li;
@@ -35,6 +35,8 @@
 # include <stdint.h>
 #endif
 
+#include <libalf/packed_word.h>
+
 namespace libalf {
 
 #define BOTTOM_CHAR -42
@@ -44,8 +46,10 @@ namespace libalf {
 
 // return ptr to new std::list with first∙second
 std::list<int>* concat(const std::list<int> &first, const std::list<int> &second);
+packed_word* concat(const packed_word &first, const packed_word &second);
 
 std::list<int> operator+(const std::list<int> & prefix, const std::list<int> & suffix);
+packed_word operator+(const packed_word & prefix, const packed_word & suffix);
 
 // simple constructors for (const-len) words.
 // call:
@@ -54,29 +58,40 @@ std::list<int> operator+(const std::list<int> & prefix, const std::list<int> & s
 std::list<int> word(const int num_letters, ...);
 
 bool is_prefix_of(const std::list<int> &prefix, const std::list<int> &word);
+bool is_prefix_of(const packed_word &prefix, const packed_word &word);
 
 bool is_suffix_of(const std::list<int> &postfix, const std::list<int> &word);
+bool is_suffix_of(const packed_word &postfix, const packed_word &word);
 
 void print_word(std::ostream &os, const std::list<int> &word);
+void print_word(std::ostream &os, const packed_word &word);
 
 void print_word(const std::list<int> &word);
 
 std::string word2string(const std::list<int> &word, char separator);
+std::string word2string(const packed_word &word, char separator);
 
 inline std::string word2string(const std::list<int> &word)
 { return word2string(word, '.'); };
+inline std::string word2string(const packed_word &word)
+{ return word2string(word, '.'); };
 
 std::basic_string<int32_t> serialize_word(const std::list<int> &word);
+std::basic_string<int32_t> serialize_word(const packed_word &word);
 
 bool deserialize_word(std::list<int32_t> &into, std::basic_string<int32_t>::const_iterator &it, std::basic_string<int32_t>::const_iterator limit);
 
 // lexicographic compare:
 // a < b iff a[i] == b[i] \forall i < j and a[j] < b[j]
 bool is_lex_smaller(const std::list<int> &a, const std::list<int> &b);
+inline bool is_lex_smaller(const packed_word &a, const packed_word &b)
+{ return a.compare_lex(b) < 0; };
 
 // graded lexicographic compare:
 // a < b iff |a|<|b| or ( |a|==|b| and lex. a < b )
 bool is_graded_lex_smaller(const std::list<int> &a, const std::list<int> &b);
+inline bool is_graded_lex_smaller(const packed_word &a, const packed_word &b)
+{ return a.size() < b.size() || (a.size() == b.size() && a.compare_lex(b) < 0); };
 
 // get next bigger/smaller word w.r.t. graded lexicographic order
 void inc_graded_lex(std::list<int> &word, int alphabet_size);
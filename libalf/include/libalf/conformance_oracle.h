@@ -0,0 +1,556 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_conformance_oracle_h__
+# define __libalf_conformance_oracle_h__
+
+#include <algorithm>
+#include <list>
+#include <set>
+#include <map>
+#include <vector>
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <libalf/conjecture.h>
+#include <libalf/knowledgebase.h>
+
+namespace libalf {
+
+/*
+ * conformance_oracle - approximates equivalence queries by testing, if no
+ * model of the target is at hand. the test words are derived from the
+ * conjecture and asked as membership queries via the knowledgebase.
+ *
+ * test suites:
+ *   RANDOM_WALK  random words, each symbol is followed by the end of the
+ *                word with probability 1/mean_length.
+ *   W_METHOD     p.u.w for all access words p of the conjecture, all u
+ *                of length up to extra_states + 1 and all w of a
+ *                characterization set W (distinguishing words of all
+ *                pairs of states, and the empty word).
+ *   WP_METHOD    like W_METHOD, but if u has length extra_states + 1,
+ *                only the words of W that distinguish the state reached
+ *                by p.u from the others are used.
+ * the W- and Wp-method find every difference if the target has at most
+ * extra_states more states than the conjecture. words are generated
+ * by length of u, so short counterexamples come first.
+ *
+ * the test suite is worked off in batches. all words of a batch that are
+ * answered in the knowledgebase are checked against the conjecture by
+ * several threads. a thread stops as soon as a counterexample at a lower
+ * position of the batch is known. words of a batch without an answer are
+ * added as queries, and check() returns. after the queries were answered,
+ * check() has to be called again with the same conjecture.
+ *
+ * the conjecture has to be deterministic. missing transitions lead to a
+ * state with output undefined, as do states without output.
+ */
+template <class answer>
+class conformance_oracle {
+	public: // types
+		typedef typename knowledgebase<answer>::node node;
+		enum test_method {
+			RANDOM_WALK = 0,
+			W_METHOD = 1,
+			WP_METHOD = 2
+		};
+		enum { min_words_per_thread = 256 };
+	protected: // types
+		class work {
+			public:
+				conformance_oracle * oracle;
+				unsigned int first;
+				unsigned int stride;
+				std::vector<unsigned int> missing;
+				pthread_t thread;
+		};
+
+	protected: // data
+		knowledgebase<answer> * base;
+		enum test_method method;
+		answer undefined;
+
+		int extra_states;
+		unsigned int random_tests;
+		unsigned int mean_length;
+		uint64_t random_state;
+		unsigned int batch_size;
+		unsigned int threads;
+
+		// the conjecture as table. state `sink' stands for missing
+		// transitions.
+		int alphabet_size;
+		int initial;
+		int sink;
+		std::vector<int> delta;
+		std::vector<answer> output;
+
+		// the test suite of the current conjecture
+		bool active;
+		std::vector<std::list<int> > access;
+		std::vector<int> access_state;
+		std::vector<std::list<int> > characterization;
+		// for WP_METHOD: indices into characterization, per state
+		std::vector<std::vector<unsigned int> > identification;
+		// position in the suite: length of u, access word, u, suffix
+		unsigned int length;
+		unsigned int access_index;
+		std::vector<int> middle;
+		unsigned int suffix_index;
+		unsigned int random_done;
+
+		word_corpus batch;
+		// smallest position of a counterexample in batch
+		volatile unsigned int found;
+
+		unsigned int tests;
+		unsigned int queries;
+
+	public: // methods
+		conformance_oracle(knowledgebase<answer> * base, enum test_method method, const answer & undefined)
+		{{{
+			this->base = base;
+			this->method = method;
+			this->undefined = undefined;
+			extra_states = 1;
+			random_tests = 10000;
+			mean_length = 20;
+			random_state = 88172645463325252ULL;
+			batch_size = 4096;
+			threads = 1;
+			tests = 0;
+			queries = 0;
+			active = false;
+		}}}
+
+		void set_extra_states(int extra_states)
+		{ this->extra_states = extra_states; }
+		// number of random words per conjecture and their mean length
+		void set_random_walk(unsigned int tests, unsigned int mean_length, uint64_t seed)
+		{{{
+			random_tests = tests;
+			this->mean_length = mean_length > 0 ? mean_length : 1;
+			random_state = seed ? seed : 88172645463325252ULL;
+		}}}
+		void set_batch_size(unsigned int batch_size)
+		{ this->batch_size = batch_size > 0 ? batch_size : 1; }
+		void set_threads(unsigned int threads)
+		{ this->threads = threads; }
+
+		// test words checked resp. queries added to the knowledgebase,
+		// over all conjectures.
+		unsigned int get_test_count() const
+		{ return tests; }
+		unsigned int get_query_count() const
+		{ return queries; }
+
+		// drop the test suite of the current conjecture.
+		void reset()
+		{ active = false; }
+
+		// returns false if queries were added to the knowledgebase. answer
+		// them and call check() again with the same conjecture. otherwise,
+		// equivalent is true if all tests passed, or false and
+		// counterexample is a word on which conjecture and knowledgebase
+		// differ. an invalid or nondeterministic conjecture is not
+		// equivalent, with an empty counterexample.
+		bool check(const moore_machine<answer> & cj, bool & equivalent, std::list<int> & counterexample)
+		{{{
+			counterexample.clear();
+			equivalent = false;
+
+			if(!active) {
+				if(!prepare(cj))
+					return true;
+				active = true;
+			}
+
+			while(true) {
+				std::vector<unsigned int> missing;
+				unsigned int i;
+
+				if(batch.size() == 0) {
+					fill_batch();
+					if(batch.size() == 0) {
+						active = false;
+						equivalent = true;
+						return true;
+					}
+				}
+
+				evaluate(missing);
+
+				if(found < batch.size()) {
+					counterexample = batch.get_word(found);
+					tests += found + 1;
+					batch.clear();
+					active = false;
+					return true;
+				}
+
+				// the filter may know some of the missing answers
+				bool pending = false;
+				for(i = 0; i < missing.size(); ++i) {
+					std::list<int> word = batch.get_word(missing[i]);
+					answer a;
+					if(!base->resolve_or_add_query(word, a)) {
+						pending = true;
+						queries++;
+					}
+				}
+				if(pending)
+					return false;
+
+				if(missing.empty()) {
+					tests += batch.size();
+					batch.clear();
+				}
+			}
+		}}}
+
+	protected: // methods
+		bool prepare(const moore_machine<answer> & cj)
+		{{{
+			transition_view transitions = cj.get_transition_view();
+			transition_view::const_iterator ti;
+			typename std::map<int, answer>::const_iterator oi;
+			int source = -1, symbol = -1;
+
+			access.clear();
+			access_state.clear();
+			characterization.clear();
+			identification.clear();
+			batch.clear();
+			length = 0;
+			access_index = 0;
+			middle.clear();
+			suffix_index = 0;
+			random_done = 0;
+
+			if(!cj.valid || cj.initial_states.size() != 1)
+				return false;
+
+			alphabet_size = cj.input_alphabet_size;
+			initial = *cj.initial_states.begin();
+			sink = cj.state_count;
+			delta.assign((sink + 1) * alphabet_size, sink);
+			for(ti = transitions.begin(); ti != transitions.end(); ++ti) {
+				// epsilon, or a second target for the same state and symbol
+				if(ti.symbol() < 0 || (ti.source() == source && ti.symbol() == symbol))
+					return false;
+				source = ti.source();
+				symbol = ti.symbol();
+				if(source >= 0 && source < sink && symbol < alphabet_size)
+					delta[source * alphabet_size + symbol] = ti.target();
+			}
+			output.assign(sink + 1, undefined);
+			for(oi = cj.output_mapping.begin(); oi != cj.output_mapping.end(); ++oi)
+				if(oi->first >= 0 && oi->first < sink)
+					output[oi->first] = oi->second;
+
+			if(method != RANDOM_WALK) {
+				find_access_words();
+				find_distinguishing_words();
+			}
+
+			return true;
+		}}}
+
+		// shortest access words of all reachable states, breadth-first
+		void find_access_words()
+		{{{
+			std::vector<int> word_of(sink + 1, -1);
+
+			word_of[initial] = 0;
+			access.push_back(std::list<int>());
+			access_state.push_back(initial);
+			for(unsigned int i = 0; i < access_state.size(); ++i) {
+				int q = access_state[i];
+				for(int a = 0; a < alphabet_size; ++a) {
+					int t = delta[q * alphabet_size + a];
+					if(t != sink && word_of[t] < 0) {
+						word_of[t] = access.size();
+						access.push_back(access[i]);
+						access.back().push_back(a);
+						access_state.push_back(t);
+					}
+				}
+			}
+		}}}
+
+		// a shortest distinguishing word for each pair of states (including
+		// the sink), found backwards from the pairs with different output.
+		void find_distinguishing_words()
+		{{{
+			int n = sink + 1;
+			std::vector<int> symbol(n * n, -2);
+			std::vector<int> next(n * n, -1);
+			std::vector<int> pred_offsets(n * alphabet_size + 1, 0);
+			std::vector<int> preds;
+			std::vector<int> queue;
+			std::map<std::list<int>, unsigned int> index;
+			typename std::map<std::list<int>, unsigned int>::iterator ii;
+
+			// predecessors per (state, symbol)
+			for(int q = 0; q < n; ++q)
+				for(int a = 0; a < alphabet_size; ++a)
+					pred_offsets[delta[q * alphabet_size + a] * alphabet_size + a]++;
+			for(int i = 1; i <= n * alphabet_size; ++i)
+				pred_offsets[i] += pred_offsets[i-1];
+			preds.resize(pred_offsets[n * alphabet_size]);
+			for(int q = n - 1; q >= 0; --q)
+				for(int a = 0; a < alphabet_size; ++a) {
+					int t = delta[q * alphabet_size + a] * alphabet_size + a;
+					preds[--pred_offsets[t]] = q;
+				}
+
+			for(int p = 0; p < n; ++p) {
+				for(int q = p + 1; q < n; ++q) {
+					if(!(output[p] == output[q])) {
+						symbol[p * n + q] = -1;
+						queue.push_back(p * n + q);
+					}
+				}
+			}
+			for(unsigned int i = 0; i < queue.size(); ++i) {
+				int p2 = queue[i] / n, q2 = queue[i] % n;
+				for(int a = 0; a < alphabet_size; ++a) {
+					int pa = p2 * alphabet_size + a, qa = q2 * alphabet_size + a;
+					for(int pi = pred_offsets[pa]; pi < pred_offsets[pa+1]; ++pi) {
+						for(int qi = pred_offsets[qa]; qi < pred_offsets[qa+1]; ++qi) {
+							int p = preds[pi], q = preds[qi];
+							if(p == q)
+								continue;
+							int pair = (p < q) ? p * n + q : q * n + p;
+							if(symbol[pair] == -2) {
+								symbol[pair] = a;
+								next[pair] = queue[i];
+								queue.push_back(pair);
+							}
+						}
+					}
+				}
+			}
+
+			// the empty word is always in W, so outputs are checked
+			characterization.push_back(std::list<int>());
+			index[std::list<int>()] = 0;
+			identification.assign(n, std::vector<unsigned int>(1, 0));
+			for(int p = 0; p < n; ++p) {
+				for(int q = p + 1; q < n; ++q) {
+					std::list<int> w;
+					int pair = p * n + q;
+					if(symbol[pair] == -2)
+						continue; // equivalent states
+					for(; symbol[pair] >= 0; pair = next[pair])
+						w.push_back(symbol[pair]);
+					ii = index.find(w);
+					if(ii == index.end()) {
+						ii = index.insert(std::make_pair(w, (unsigned int)characterization.size())).first;
+						characterization.push_back(w);
+					}
+					identification[p].push_back(ii->second);
+					identification[q].push_back(ii->second);
+				}
+			}
+			for(int q = 0; q < n; ++q) {
+				std::sort(identification[q].begin(), identification[q].end());
+				identification[q].erase(std::unique(identification[q].begin(), identification[q].end()), identification[q].end());
+			}
+		}}}
+
+		uint64_t random()
+		{{{
+			// xorshift64
+			random_state ^= random_state << 13;
+			random_state ^= random_state >> 7;
+			random_state ^= random_state << 17;
+			return random_state;
+		}}}
+
+		void fill_batch()
+		{{{
+			std::vector<int32_t> word;
+
+			batch.clear();
+
+			if(method == RANDOM_WALK) {
+				if(alphabet_size <= 0)
+					return;
+				while(batch.size() < batch_size && random_done < random_tests) {
+					word.clear();
+					do {
+						word.push_back(random() % alphabet_size);
+					} while(random() % mean_length != 0);
+					batch.add(&word[0], word.size());
+					random_done++;
+				}
+				return;
+			}
+
+			while(batch.size() < batch_size && length <= (unsigned int)extra_states + 1) {
+				const std::list<int> & p = access[access_index];
+				const std::list<int> * w;
+				int state;
+
+				// without symbols, there is no u but the empty one
+				if(length > 0 && alphabet_size <= 0)
+					break;
+
+				// state reached by p.u
+				state = access_state[access_index];
+				for(unsigned int i = 0; i < middle.size(); ++i)
+					state = delta[state * alphabet_size + middle[i]];
+
+				if(method == WP_METHOD && length == (unsigned int)extra_states + 1) {
+					if(suffix_index >= identification[state].size()) {
+						next_middle();
+						continue;
+					}
+					w = &characterization[identification[state][suffix_index]];
+				} else {
+					if(suffix_index >= characterization.size()) {
+						next_middle();
+						continue;
+					}
+					w = &characterization[suffix_index];
+				}
+
+				word.assign(p.begin(), p.end());
+				word.insert(word.end(), middle.begin(), middle.end());
+				word.insert(word.end(), w->begin(), w->end());
+				if(word.empty())
+					batch.add(NULL, 0);
+				else
+					batch.add(&word[0], word.size());
+				suffix_index++;
+			}
+		}}}
+
+		// advance to the next u (and access word, and length of u)
+		void next_middle()
+		{{{
+			int i;
+
+			suffix_index = 0;
+
+			// next u of the same length
+			for(i = middle.size() - 1; i >= 0; --i) {
+				if(middle[i] + 1 < alphabet_size) {
+					middle[i]++;
+					break;
+				}
+				middle[i] = 0;
+			}
+			if(i >= 0)
+				return;
+
+			// all u done, next access word
+			access_index++;
+			if(access_index < access.size())
+				return;
+
+			access_index = 0;
+			length++;
+			middle.assign(length, 0);
+		}}}
+
+		void evaluate(std::vector<unsigned int> & missing)
+		{{{
+			std::vector<work> jobs;
+			unsigned int n, i, started;
+
+			found = batch.size();
+
+			n = threads;
+			if(n > batch.size() / min_words_per_thread)
+				n = batch.size() / min_words_per_thread;
+			if(n < 1)
+				n = 1;
+
+			jobs.resize(n);
+			for(started = 0; started < n; started++) {
+				jobs[started].oracle = this;
+				jobs[started].first = started;
+				jobs[started].stride = n;
+				if(started > 0 && 0 != pthread_create(&jobs[started].thread, NULL, run, &jobs[started]))
+					break;
+			}
+			// the calling thread does the first share
+			run(&jobs[0]);
+
+			for(i = 1; i < started; i++)
+				pthread_join(jobs[i].thread, NULL);
+			// thread creation failed: do the rest here
+			for(i = started; i < n; i++)
+				run(&jobs[i]);
+
+			for(i = 0; i < n; i++)
+				missing.insert(missing.end(), jobs[i].missing.begin(), jobs[i].missing.end());
+			std::sort(missing.begin(), missing.end());
+		}}}
+
+		void check_words(work * w)
+		{{{
+			node * root = base->get_rootptr();
+			const int32_t * symbols = batch.symbols.empty() ? NULL : &batch.symbols[0];
+
+			for(unsigned int i = w->first; i < batch.size(); i += w->stride) {
+				// a counterexample before this one is known
+				if(i > found)
+					break;
+
+				node * n = root;
+				int state = initial;
+				for(unsigned int s = batch.offsets[i]; s < batch.offsets[i+1]; ++s) {
+					state = delta[state * alphabet_size + symbols[s]];
+					if(n != NULL)
+						n = n->find_child(symbols[s]);
+				}
+				if(n == NULL || !n->is_answered()) {
+					w->missing.push_back(i);
+					continue;
+				}
+				if(!(n->get_answer() == output[state])) {
+					unsigned int f = found;
+					while(i < f && !__sync_bool_compare_and_swap(&found, f, i))
+						f = found;
+				}
+			}
+		}}}
+
+		static void * run(void * arg)
+		{{{
+			work * w = (work*)arg;
+			w->oracle->check_words(w);
+			return NULL;
+		}}}
+};
+
+}; // end of namespace libalf
+
+#endif // __libalf_conformance_oracle_h__
+
@@ -30,9 +30,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <typeinfo>
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #include <libalf/serialize.h>
@@ -99,6 +101,290 @@ class conjecture {
 
 
 
+/*
+ * word_corpus - many words in one buffer, for classifying them in a batch
+ * (see moore_machine::run(const word_corpus&, ...) and
+ * finite_automaton::contains(const word_corpus&, ...)).
+ *
+ * word i is symbols[offsets[i] ... offsets[i+1]).
+ */
+class word_corpus {
+	public: // data
+		std::vector<int32_t> symbols;
+		std::vector<unsigned int> offsets;
+	public: // methods
+		word_corpus()
+		{ offsets.push_back(0); }
+
+		void clear()
+		{{{
+			symbols.clear();
+			offsets.clear();
+			offsets.push_back(0);
+		}}}
+		unsigned int size() const
+		{ return offsets.size() - 1; }
+		unsigned int length(unsigned int i) const
+		{ return offsets[i+1] - offsets[i]; }
+
+		void add(const std::list<int> & word)
+		{{{
+			symbols.insert(symbols.end(), word.begin(), word.end());
+			offsets.push_back(symbols.size());
+		}}}
+		void add(const int32_t * word, unsigned int length)
+		{{{
+			symbols.insert(symbols.end(), word, word + length);
+			offsets.push_back(symbols.size());
+		}}}
+		std::list<int> get_word(unsigned int i) const
+		{ return std::list<int>(symbols.begin() + offsets[i], symbols.begin() + offsets[i+1]); }
+};
+
+
+
+/*
+ * flat_transitions - the transitions of a state machine in one buffer
+ * (CSR), as an alternative to the nested maps of moore_machine and
+ * mealy_machine (see transition_storage).
+ *
+ * the transitions of a state are the entries [offsets[state],
+ * offsets[state+1]), sorted by symbol and then target. symbol -1 is an
+ * epsilon transition. a transition costs two ints instead of a node in
+ * each of three trees.
+ */
+class flat_transitions {
+	public: // data
+		std::vector<unsigned int> offsets;
+		std::vector<int> symbols;
+		std::vector<int> targets;
+	public: // methods
+		flat_transitions()
+		{ clear(); }
+
+		void clear();
+		int get_state_count() const
+		{ return offsets.size() - 1; }
+		unsigned int size() const
+		{ return targets.size(); }
+
+		// the entries of (state, symbol) are [first, limit).
+		void find(int state, int symbol, unsigned int & first, unsigned int & limit) const;
+
+		// returns false (and leaves this empty) if a state is out of range.
+		bool assign(int state_count, const std::map<int, std::map<int, std::set<int> > > & transitions);
+		void get(std::map<int, std::map<int, std::set<int> > > & transitions) const;
+
+		// building state by state: start(), then append() the entries in
+		// ascending order of (state, symbol, target), then finish().
+		// append() returns false if an entry is out of order or the state
+		// is out of range. equal entries are only allowed with
+		// allow_equal (for mealy machines, where they differ in output).
+		void start(int state_count);
+		bool append(int state, int symbol, int target, bool allow_equal = false);
+		void finish();
+
+		// all symbols in [-1, alphabet_size), all targets are states
+		bool in_range(int alphabet_size) const;
+		// no epsilon transitions and no symbol twice in a state
+		bool is_deterministic() const;
+
+		// the format of ::serialize() of the nested maps
+		std::basic_string<int32_t> serialize() const;
+		// returns false if the data is not in the format of serialize()
+		// (which includes the order). serial is left where it was then.
+		bool deserialize(int state_count, serial_stretch & serial);
+
+		unsigned long long int get_memory_usage() const;
+	protected: // data
+		int last_state; // while building
+};
+
+enum transition_storage {
+	MAP_TRANSITIONS = 0,
+	FLAT_TRANSITIONS = 1
+};
+
+/*
+ * transition_view - read-only view of the transitions of a moore_machine in
+ * either storage (see moore_machine::get_transition_view()), without
+ * copying them. the iterator gives all transitions as (source, symbol,
+ * target), ordered by source, then symbol, then target; empty target sets
+ * of the map are skipped. the view is invalidated by any change of the
+ * machine's transitions.
+ */
+class transition_view {
+	public: // types
+		typedef std::map<int, std::map<int, std::set<int> > > transition_map;
+
+		class const_iterator {
+			friend class transition_view;
+			protected: // data
+				const flat_transitions * flat;
+				const transition_map * transitions;
+				// flat: current state and entry
+				int state;
+				unsigned int index;
+				// map
+				transition_map::const_iterator mmsi;
+				std::map<int, std::set<int> >::const_iterator msi;
+				std::set<int>::const_iterator si;
+			public: // methods
+				const_iterator()
+				{ flat = NULL; transitions = NULL; state = 0; index = 0; }
+
+				int source() const
+				{ return flat ? state : mmsi->first; }
+				int symbol() const
+				{ return flat ? flat->symbols[index] : msi->first; }
+				int target() const
+				{ return flat ? flat->targets[index] : *si; }
+
+				const_iterator & operator++();
+				bool operator==(const const_iterator & other) const;
+				bool operator!=(const const_iterator & other) const
+				{ return !(*this == other); }
+			protected:
+				// map: position at the first transition of mmsi or
+				// of the next state that has one
+				void enter_state();
+				// go on to the next transition, if the current
+				// position is none
+				void skip_empty();
+		};
+
+	protected: // data
+		const flat_transitions * flat;
+		const transition_map * transitions;
+
+	public: // methods
+		transition_view(const flat_transitions & flat)
+		{ this->flat = &flat; transitions = NULL; }
+		transition_view(const transition_map & transitions)
+		{ flat = NULL; this->transitions = &transitions; }
+
+		const_iterator begin() const;
+		const_iterator end() const;
+};
+
+
+
+/*
+ * compiled_transitions - flat form of the transitions of a state machine,
+ * see moore_machine::compile().
+ *
+ * deterministic transitions are stored as a dense state x symbol -> state
+ * table. nondeterministic ones are stored as successor lists per state and
+ * symbol, and sets of states are simulated as bitsets.
+ *
+ * just as moore_machine::run(), epsilon transitions are not followed.
+ * run() stops at the first symbol that is not in [0, alphabet_size), so
+ * the caller can go on with the map-based simulation.
+ */
+class compiled_transitions {
+	public: // types
+		typedef uint64_t block;
+	protected: // data
+		bool deterministic;
+		int alphabet_size;
+		int state_count;
+		// deterministic: successor[state * alphabet_size + symbol] or -1
+		std::vector<int> successor;
+		// nondeterministic: successors of (state, symbol) are
+		// targets[offsets[state * alphabet_size + symbol] ... offsets[... + 1])
+		std::vector<int> offsets;
+		std::vector<int> targets;
+	public: // methods
+		compiled_transitions()
+		{ clear(); }
+
+		void clear();
+		bool empty() const
+		{ return state_count == 0; }
+		bool is_deterministic() const
+		{ return deterministic; }
+
+		// returns false (and stays empty) if a transition is out of range.
+		bool compile(int state_count, int alphabet_size, const std::map<int, std::map<int, std::set<int> > > & transitions);
+		bool compile(int state_count, int alphabet_size, const flat_transitions & transitions);
+
+		// deterministic only. returns the state reached from state, or -1
+		// if there is no transition.
+		int run(int state, std::list<int>::const_iterator & word, std::list<int>::const_iterator word_end) const;
+		// from states, follow the transitions given by word.
+		void run(std::set<int> & states, std::list<int>::const_iterator & word, std::list<int>::const_iterator word_end) const;
+		// deterministic only. for each word of corpus, the state reached
+		// from state, -1 if there is no transition or -2 if the word holds
+		// a symbol outside the alphabet. the words are run in lockstep and
+		// the corpus is split among threads.
+		void run(int state, const word_corpus & corpus, std::vector<int> & states, unsigned int threads = 1) const;
+		// the words [first, limit) of corpus, in the calling thread
+		void run_lockstep(int state, const word_corpus & corpus, unsigned int first, unsigned int limit, std::vector<int> & states) const;
+
+		unsigned long long int get_memory_usage() const;
+};
+
+
+
+/*
+ * partition_refiner - minimization of deterministic machines by partition
+ * refinement (Hopcroft), in O(n * |alphabet| * log n).
+ *
+ * the caller fills delta and labels (see prepare()) and calls refine().
+ * states with different labels are never merged. missing transitions lead
+ * to an implicit sink state with label sink_label, that has a self-loop
+ * for every symbol. the block of the sink is dropped from the result,
+ * except if it holds the initial state.
+ *
+ * all buffers are kept between calls, so minimizing many machines with
+ * the same refiner does not allocate once the buffers are large enough.
+ */
+class partition_refiner {
+	public: // data
+		// input: delta[state * alphabet_size + symbol] is the successor
+		// or -1, labels[state] the initial class of state.
+		std::vector<int> delta;
+		std::vector<int> labels;
+		// output: block_of[state] is the state of the minimized machine,
+		// or -1 if state is unreachable or in the dropped sink block.
+		// representative[new state] is some old state in it. new states
+		// are numbered breadth-first from the initial state, which is 0.
+		std::vector<int> block_of;
+		std::vector<int> representative;
+	protected: // data
+		int state_count;
+		int alphabet_size;
+		// reachable states get a compact index, the sink comes last
+		std::vector<int> compact;
+		std::vector<int> original;
+		std::vector<int> compact_delta;
+		// predecessors of (state, symbol) in compact indices are
+		// inv_sources[inv_offsets[state * alphabet_size + symbol] ... + 1])
+		std::vector<int> inv_offsets;
+		std::vector<int> inv_sources;
+		// the partition: block b holds elements[block_first[b] ... block_end[b]),
+		// marked ones first. position[state] is the index in elements.
+		std::vector<int> elements;
+		std::vector<int> position;
+		std::vector<int> block;
+		std::vector<int> block_first;
+		std::vector<int> block_end;
+		std::vector<int> marked;
+		std::vector<bool> waiting;
+		std::vector<int> worklist;
+		std::vector<int> touched;
+		std::vector<int> splitter;
+	public: // methods
+		// sets delta to all -1 and labels to all 0.
+		void prepare(int state_count, int alphabet_size);
+		// returns the number of states of the minimized machine.
+		int refine(int initial_state, int sink_label);
+	protected: // methods
+		int split_block(int b);
+};
+
+
+
 template <typename output_alphabet>
 class finite_state_machine: public conjecture {
 	public: // data
@@ -194,9 +480,21 @@ class moore_machine: public finite_state_machine<output_alphabet> {
 		std::map<int, output_alphabet> output_mapping; // mapping state to its output-alphabet
 		std::map<int, std::map<int, std::set<int> > > transitions; // state -> input-alphabet -> { states }
 		// using -1 as epsilon-transition (input-alphabet field)
+		// (empty if the machine uses FLAT_TRANSITIONS, see flatten(). use
+		// get_transition_view() to read the transitions in either storage)
+	protected:
+		compiled_transitions compiled; // see compile()
+		bool use_flat;
+		flat_transitions flat; // if use_flat
+
+		// output of states without an entry in output_mapping, and of
+		// missing transitions, for minimize(). without one, both are kept
+		// apart from all states with an output.
+		virtual bool get_default_output(__attribute__ ((__unused__)) output_alphabet & output) const
+		{ return false; }
 	public:
-		moore_machine()
-		{ };
+		moore_machine(enum transition_storage storage = MAP_TRANSITIONS)
+		{ use_flat = (storage == FLAT_TRANSITIONS); };
 		virtual ~moore_machine()
 		{ };
 		virtual conjecture_type get_type() const
@@ -206,6 +504,268 @@ class moore_machine: public finite_state_machine<output_alphabet> {
 			finite_state_machine<output_alphabet>::clear();
 			output_mapping.clear();
 			transitions.clear();
+			flat.clear();
+			uncompile();
+		}}}
+
+		// with FLAT_TRANSITIONS, the transitions are kept in a
+		// flat_transitions instead of the transitions map, which stays
+		// empty. the machine keeps its storage across clear(),
+		// deserialize() and read(). code that fills or reads the map
+		// directly has to call flatten() resp. expand() (or use
+		// get_transition_view() or get_transitions()).
+		bool is_flat() const
+		{ return use_flat; }
+		// move the transitions map into flat storage. returns false (and
+		// changes nothing) if a state is out of range.
+		bool flatten()
+		{{{
+			if(!flat.assign(this->state_count, transitions))
+				return false;
+			transitions.clear();
+			use_flat = true;
+			uncompile();
+			return true;
+		}}}
+		// move flat storage back into the transitions map
+		void expand()
+		{{{
+			if(use_flat) {
+				flat.get(transitions);
+				flat.clear();
+				use_flat = false;
+				uncompile();
+			}
+		}}}
+		const flat_transitions & get_flat_transitions() const
+		{ return flat; }
+		// take over transitions (leaving the old flat storage in it) and
+		// switch to flat storage. returns false (and changes nothing) if
+		// it has not exactly state_count states.
+		bool set_flat_transitions(flat_transitions & transitions)
+		{{{
+			if(transitions.get_state_count() != this->state_count)
+				return false;
+			std::swap(flat, transitions);
+			this->transitions.clear();
+			use_flat = true;
+			uncompile();
+			return true;
+		}}}
+		// the transitions, in either storage, without copying them
+		transition_view get_transition_view() const
+		{{{
+			if(use_flat)
+				return transition_view(flat);
+			else
+				return transition_view(transitions);
+		}}}
+		// a copy of the transitions, in either storage
+		void get_transitions(std::map<int, std::map<int, std::set<int> > > & into) const
+		{{{
+			if(use_flat)
+				flat.get(into);
+			else
+				into = transitions;
+		}}}
+		// add the successors of (state, symbol) to into, in either
+		// storage. symbol -1 gives the epsilon-successors.
+		void add_successors(int state, int symbol, std::set<int> & into) const
+		{{{
+			if(use_flat) {
+				unsigned int first, limit;
+
+				flat.find(state, symbol, first, limit);
+				into.insert(flat.targets.begin() + first, flat.targets.begin() + limit);
+			} else {
+				std::map<int, std::map<int, std::set<int> > >::const_iterator mmsi;
+				std::map<int, std::set<int> >::const_iterator msi;
+
+				mmsi = transitions.find(state);
+				if(mmsi == transitions.end())
+					return;
+				msi = mmsi->second.find(symbol);
+				if(msi != mmsi->second.end())
+					into.insert(msi->second.begin(), msi->second.end());
+			}
+		}}}
+		// add all states that are reachable from states via
+		// epsilon-transitions
+		void epsilon_close(std::set<int> & states) const
+		{{{
+			std::set<int>::const_iterator si;
+			std::list<int> todo(states.begin(), states.end());
+			std::set<int> next;
+
+			while(!todo.empty()) {
+				next.clear();
+				add_successors(todo.front(), -1, next);
+				todo.pop_front();
+				for(si = next.begin(); si != next.end(); ++si)
+					if(states.insert(*si).second)
+						todo.push_back(*si);
+			}
+		}}}
+
+		// build a flat transition table (see compiled_transitions) that
+		// run() uses from now on. call compile() again after changing
+		// transitions, state_count or input_alphabet_size by hand;
+		// clear() and deserialize() drop the compiled form.
+		virtual bool compile()
+		{{{
+			if(use_flat)
+				return compiled.compile(this->state_count, this->input_alphabet_size, flat);
+			else
+				return compiled.compile(this->state_count, this->input_alphabet_size, transitions);
+		}}}
+		virtual void uncompile()
+		{ compiled.clear(); }
+		bool is_compiled() const
+		{ return !compiled.empty(); }
+
+		// for each word of corpus, the state reached from the initial
+		// state, or -1. deterministic machines only, returns false
+		// otherwise. this is fast (and uses threads) only once compile()
+		// was called.
+		virtual bool run(const word_corpus & corpus, std::vector<int> & states, unsigned int threads = 1) const
+		{{{
+			std::set<int> current_states;
+			std::list<int> word;
+			int initial;
+
+			states.assign(corpus.size(), -1);
+			if(this->initial_states.size() > 1)
+				return false;
+			if(this->initial_states.empty())
+				return true;
+			initial = *this->initial_states.begin();
+
+			if(!compiled.empty()) {
+				if(!compiled.is_deterministic())
+					return false;
+				compiled.run(initial, corpus, states, threads);
+			} else {
+				std::fill(states.begin(), states.end(), -2);
+			}
+
+			// words the compiled form could not run
+			for(unsigned int i = 0; i < corpus.size(); ++i) {
+				if(states[i] == -2) {
+					current_states.clear();
+					current_states.insert(initial);
+					word = corpus.get_word(i);
+					run(current_states, word.begin(), word.end());
+					if(current_states.size() > 1)
+						return false;
+					states[i] = current_states.empty() ? -1 : *current_states.begin();
+				}
+			}
+
+			return true;
+		}}}
+		// output of the state reached by each word of corpus, or undefined
+		// if there is none. see run() above.
+		virtual bool classify(const word_corpus & corpus, std::vector<output_alphabet> & outputs, const output_alphabet & undefined, unsigned int threads = 1) const
+		{{{
+			std::vector<int> states;
+			std::vector<const output_alphabet *> state_output(this->state_count, (const output_alphabet *)NULL);
+			typename std::map<int, output_alphabet>::const_iterator oi;
+
+			outputs.assign(corpus.size(), undefined);
+			if(!run(corpus, states, threads))
+				return false;
+
+			for(oi = output_mapping.begin(); oi != output_mapping.end(); ++oi)
+				if(oi->first >= 0 && oi->first < this->state_count)
+					state_output[oi->first] = &oi->second;
+			for(unsigned int i = 0; i < corpus.size(); ++i)
+				if(states[i] >= 0 && states[i] < this->state_count && state_output[states[i]])
+					outputs[i] = *state_output[states[i]];
+
+			return true;
+		}}}
+		// replace this machine by the minimal deterministic machine with
+		// the same outputs. unreachable states are removed, states are
+		// renumbered breadth-first. returns false (and leaves the machine
+		// as it is) if it is invalid or nondeterministic. pass the same
+		// refiner to minimize many machines without reallocating.
+		virtual bool minimize()
+		{{{
+			partition_refiner refiner;
+			return minimize(refiner);
+		}}}
+		virtual bool minimize(partition_refiner & refiner)
+		{{{
+			typename std::map<int, std::map<int, std::set<int> > >::const_iterator mmsi;
+			typename std::map<int, std::set<int> >::const_iterator msi;
+			typename std::map<int, output_alphabet>::const_iterator oi;
+			std::map<int, std::map<int, std::set<int> > > new_transitions;
+			std::map<int, output_alphabet> new_output_mapping;
+			// distinct outputs. answers only have operator==, so this is searched linearly.
+			std::vector<output_alphabet> outputs;
+			output_alphabet default_output;
+			bool has_default;
+			int sink_label, count;
+
+			if(!this->valid || this->initial_states.size() != 1 || !calc_determinism())
+				return false;
+
+			refiner.prepare(this->state_count, this->input_alphabet_size);
+			if(use_flat) {
+				for(int q = 0; q < flat.get_state_count(); ++q)
+					for(unsigned int i = flat.offsets[q]; i < flat.offsets[q+1]; ++i)
+						refiner.delta[q * this->input_alphabet_size + flat.symbols[i]] = flat.targets[i];
+			} else {
+				for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi)
+					for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+						if(!msi->second.empty())
+							refiner.delta[mmsi->first * this->input_alphabet_size + msi->first] = *msi->second.begin();
+			}
+
+			// label 0 is a missing output, unless there is a default output.
+			has_default = get_default_output(default_output);
+			if(has_default)
+				outputs.push_back(default_output);
+			for(oi = output_mapping.begin(); oi != output_mapping.end(); ++oi) {
+				unsigned int l;
+				for(l = 0; l < outputs.size(); ++l)
+					if(outputs[l] == oi->second)
+						break;
+				if(l == outputs.size())
+					outputs.push_back(oi->second);
+				refiner.labels[oi->first] = has_default ? l : l + 1;
+			}
+			sink_label = has_default ? 0 : -1;
+
+			count = refiner.refine(*this->initial_states.begin(), sink_label);
+
+			uncompile();
+			if(use_flat)
+				flat.start(count);
+			for(int s = 0; s < count; ++s) {
+				int r = refiner.representative[s];
+				oi = output_mapping.find(r);
+				if(oi != output_mapping.end())
+					new_output_mapping[s] = oi->second;
+				for(int a = 0; a < this->input_alphabet_size; ++a) {
+					int t = refiner.delta[r * this->input_alphabet_size + a];
+					if(t >= 0 && refiner.block_of[t] >= 0) {
+						if(use_flat)
+							flat.append(s, a, refiner.block_of[t]);
+						else
+							new_transitions[s][a].insert(refiner.block_of[t]);
+					}
+				}
+			}
+			if(use_flat)
+				flat.finish();
+
+			transitions.swap(new_transitions);
+			output_mapping.swap(new_output_mapping);
+			this->state_count = count;
+			this->initial_states.clear();
+			this->initial_states.insert(0);
+			return true;
 		}}}
 		virtual bool calc_validity()
 		{{{
@@ -222,6 +782,12 @@ class moore_machine: public finite_state_machine<output_alphabet> {
 				if(oi->first < 0 || oi->first >= this->state_count)
 					goto invalid;
 
+			if(use_flat) {
+				if(flat.get_state_count() != this->state_count || !flat.in_range(this->input_alphabet_size))
+					goto invalid;
+				return true;
+			}
+
 			for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi) {
 				if(mmsi->first < 0 || mmsi->first >= this->state_count)
 					goto invalid;
@@ -249,10 +815,15 @@ invalid:
 			std::map<int, std::map<int, std::set<int> > >::const_iterator mmsi;
 			std::map<int, std::set<int> >::const_iterator msi;
 
-			for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi) {
-				for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
-					if(msi->first == -1 || msi->second.size() > 1)
-						goto nondet;
+			if(use_flat) {
+				if(!flat.is_deterministic())
+					goto nondet;
+			} else {
+				for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi) {
+					for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
+						if(msi->first == -1 || msi->second.size() > 1)
+							goto nondet;
+					}
 				}
 			}
 
@@ -269,7 +840,10 @@ nondet:
 				ret += 0; // size, filled in later.
 				ret += finite_state_machine<output_alphabet>::serialize();
 				ret += ::serialize(output_mapping);
-				ret += ::serialize(transitions);
+				if(use_flat)
+					ret += flat.serialize();
+				else
+					ret += ::serialize(transitions);
 				ret[0] = htonl(ret.length() - 1);
 			}
 
@@ -282,7 +856,16 @@ nondet:
 			if(!::deserialize(size, serial)) goto failed;
 			if(!finite_state_machine<output_alphabet>::deserialize(serial)) goto failed;
 			if(!::deserialize(output_mapping, serial)) goto failed;
-			if(!::deserialize(transitions, serial)) goto failed;
+			if(use_flat) {
+				// data that was not written by serialize() may be out of
+				// order, then it takes the way through the map.
+				if(!flat.deserialize(this->state_count, serial)) {
+					if(!::deserialize(transitions, serial)) goto failed;
+					if(!flatten()) goto failed;
+				}
+			} else {
+				if(!::deserialize(transitions, serial)) goto failed;
+			}
 
 			this->valid = true;
 			return true;
@@ -301,12 +884,23 @@ failed:
 			std::map<int, std::set<int> >::const_iterator msi;
 			std::set<int>::const_iterator di;
 
+			// the compiled form stops at symbols it does not know
+			if(!compiled.empty())
+				compiled.run(current_states, word, word_end);
+
 			while(word != word_end) {
 
 				if(current_states.empty())
 					break;
 
 				for(si = current_states.begin(); si != current_states.end(); ++si) {
+					if(use_flat) {
+						unsigned int first, limit;
+						flat.find(*si, *word, first, limit);
+						for(/* -- */; first < limit; ++first)
+							new_states.insert(flat.targets[first]);
+						continue;
+					}
 					mmsi = transitions.find(*si);
 					if(mmsi != transitions.end()) {
 						msi = mmsi->second.find(*word);
@@ -371,10 +965,16 @@ failed:
 				std::map<int, std::map<int, std::set<int> > >::const_iterator mmsi;
 				std::map<int, std::set<int> >::const_iterator msi;
 				std::set<int>::const_iterator si;
-				for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi)
-					for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
-						for(si = msi->second.begin(); si != msi->second.end(); ++si)
-							str << "\tq" << mmsi->first << " -> q" << *si << " [label=\"" << msi->first << "\"];\n";
+				if(use_flat) {
+					for(int q = 0; q < flat.get_state_count(); ++q)
+						for(unsigned int i = flat.offsets[q]; i < flat.offsets[q+1]; ++i)
+							str << "\tq" << q << " -> q" << flat.targets[i] << " [label=\"" << flat.symbols[i] << "\"];\n";
+				} else {
+					for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi)
+						for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+							for(si = msi->second.begin(); si != msi->second.end(); ++si)
+								str << "\tq" << mmsi->first << " -> q" << *si << " [label=\"" << msi->first << "\"];\n";
+				}
 
 				// end
 				str << "};\n";
@@ -391,9 +991,16 @@ class mealy_machine: public finite_state_machine<output_alphabet> {
 	public:
 		std::map<int, std::map<int, std::set<std::pair<int, output_alphabet> > > > transitions; // state -> input_alphabet -> std::set( <state, output_alphabet> )
 		// using -1 as epsilon-transition (input-alphabet field)
+		// (empty if the machine uses FLAT_TRANSITIONS, see flatten(). use
+		// get_transition_view() to read the transitions in either storage)
+	protected:
+		bool use_flat;
+		// if use_flat. flat_outputs[i] is the output of flat entry i.
+		flat_transitions flat;
+		std::vector<output_alphabet> flat_outputs;
 	public:
-		mealy_machine()
-		{ };
+		mealy_machine(enum transition_storage storage = MAP_TRANSITIONS)
+		{ use_flat = (storage == FLAT_TRANSITIONS); };
 		virtual ~mealy_machine()
 		{ };
 		virtual conjecture_type get_type() const
@@ -402,7 +1009,63 @@ class mealy_machine: public finite_state_machine<output_alphabet> {
 		{{{
 			finite_state_machine<output_alphabet>::clear();
 			transitions.clear();
+			flat.clear();
+			flat_outputs.clear();
 		}}}
+
+		// see moore_machine::flatten()
+		bool is_flat() const
+		{ return use_flat; }
+		bool flatten()
+		{{{
+			typename std::map<int, std::map<int, std::set<std::pair<int, output_alphabet> > > >::const_iterator ttsi;
+			typename std::map<int, std::set<std::pair<int, output_alphabet> > >::const_iterator tsi;
+			typename std::set<std::pair<int, output_alphabet> >::const_iterator si;
+
+			flat.start(this->state_count);
+			flat_outputs.clear();
+			for(ttsi = transitions.begin(); ttsi != transitions.end(); ++ttsi) {
+				for(tsi = ttsi->second.begin(); tsi != ttsi->second.end(); ++tsi) {
+					for(si = tsi->second.begin(); si != tsi->second.end(); ++si) {
+						if(!flat.append(ttsi->first, tsi->first, si->first, true)) {
+							flat.clear();
+							flat_outputs.clear();
+							return false;
+						}
+						flat_outputs.push_back(si->second);
+					}
+				}
+			}
+			flat.finish();
+			transitions.clear();
+			use_flat = true;
+			return true;
+		}}}
+		void expand()
+		{{{
+			if(use_flat) {
+				get_transitions(transitions);
+				flat.clear();
+				flat_outputs.clear();
+				use_flat = false;
+			}
+		}}}
+		const flat_transitions & get_flat_transitions() const
+		{ return flat; }
+		const std::vector<output_alphabet> & get_flat_outputs() const
+		{ return flat_outputs; }
+		void get_transitions(std::map<int, std::map<int, std::set<std::pair<int, output_alphabet> > > > & into) const
+		{{{
+			if(use_flat) {
+				into.clear();
+				for(int q = 0; q < flat.get_state_count(); ++q)
+					for(unsigned int i = flat.offsets[q]; i < flat.offsets[q+1]; ++i)
+						into[q][flat.symbols[i]].insert(std::pair<int, output_alphabet>(flat.targets[i], flat_outputs[i]));
+			} else {
+				into = transitions;
+			}
+		}}}
+
 		virtual bool calc_validity()
 		{{{
 			typename std::map<int, std::map<int, std::set<std::pair<int, output_alphabet> > > >::const_iterator ttsi;
@@ -412,6 +1075,12 @@ class mealy_machine: public finite_state_machine<output_alphabet> {
 			if(!finite_state_machine<output_alphabet>::calc_validity())
 				goto invalid;
 
+			if(use_flat) {
+				if(flat.get_state_count() != this->state_count || !flat.in_range(this->input_alphabet_size))
+					goto invalid;
+				return true;
+			}
+
 			for(ttsi = transitions.begin(); ttsi != transitions.end(); ++ttsi) {
 				if(ttsi->first < 0 || ttsi->first >= this->state_count)
 					goto invalid;
@@ -439,10 +1108,15 @@ invalid:
 			typename std::map<int, std::map<int, std::set<std::pair<int, output_alphabet> > > >::const_iterator ttsi;
 			typename std::map<int, std::set<std::pair<int, output_alphabet> > >::const_iterator tsi;
 
-			for(ttsi = transitions.begin(); ttsi != transitions.end(); ++ttsi) {
-				for(tsi = ttsi->second.begin(); tsi != ttsi->second.end(); ++tsi) {
-					if(tsi->first == -1 || tsi->second.size() > 1)
-						goto nondet;
+			if(use_flat) {
+				if(!flat.is_deterministic())
+					goto nondet;
+			} else {
+				for(ttsi = transitions.begin(); ttsi != transitions.end(); ++ttsi) {
+					for(tsi = ttsi->second.begin(); tsi != ttsi->second.end(); ++tsi) {
+						if(tsi->first == -1 || tsi->second.size() > 1)
+							goto nondet;
+					}
 				}
 			}
 
@@ -459,7 +1133,14 @@ nondet:
 			if(this->valid) {
 				ret += 0; // size, filled in later.
 				ret += finite_state_machine<output_alphabet>::serialize();
-				ret += ::serialize(transitions);
+				if(use_flat) {
+					// outputs are serialized by type, so this goes through the map
+					std::map<int, std::map<int, std::set<std::pair<int, output_alphabet> > > > t;
+					get_transitions(t);
+					ret += ::serialize(t);
+				} else {
+					ret += ::serialize(transitions);
+				}
 				ret[0] = htonl(ret.length() - 1);
 			}
 
@@ -472,6 +1153,7 @@ nondet:
 			if(!::deserialize(size, serial)) goto failed;
 			if(!finite_state_machine<output_alphabet>::deserialize(serial)) goto failed;
 			if(!::deserialize(transitions, serial)) goto failed;
+			if(use_flat && !flatten()) goto failed;
 
 			this->valid = true;
 			return true;
@@ -652,7 +1334,8 @@ class finite_automaton : public moore_machine<bool> {
 	// standard (wrapping the parent-type), but is different to be
 	// compatible with to the serialization format of libAMoRE++.
 	public:
-		finite_automaton()
+		finite_automaton(enum transition_storage storage = MAP_TRANSITIONS)
+			: moore_machine<bool>(storage)
 		{ this->omega = false; };
 		virtual ~finite_automaton()
 		{ };
@@ -668,11 +1351,41 @@ class finite_automaton : public moore_machine<bool> {
 
 		// checks if a word is accepted by this automaton.
 		virtual bool contains(const std::list<int> & word) const;
+		// contains() for each word of corpus, split among threads.
+		// deterministic automata are run in lockstep once compile() was
+		// called.
+		virtual void contains(const word_corpus & corpus, std::vector<bool> & results, unsigned int threads = 1) const;
 		virtual void get_final_states(std::set<int> & into) const;
 		virtual std::set<int> get_final_states() const;
 		virtual void set_final_states(const std::set<int> &final);
 		virtual void set_all_non_accepting();
+
+		// language inclusion via antichains (see antichain.cpp). returns
+		// true if L(this) is a subset of L(other), otherwise counterexample
+		// is a shortest word in L(this) \ L(other) (empty if it is the
+		// empty word). epsilon-transitions (symbol -1) are allowed in both
+		// automata. both automata have to be valid; this is asserted.
+		// with NDEBUG, an invalid automaton gives false and an empty
+		// counterexample.
+		virtual bool antichain_is_subset_of(const finite_automaton & other, std::list<int> & counterexample) const;
+		// like antichain_is_subset_of() in both directions (with the same
+		// precondition). the counterexample is accepted by exactly one of
+		// both automata.
+		virtual bool antichain_is_equal(const finite_automaton & other, std::list<int> & counterexample) const;
+
+		// also compiles the final states. call compile() again after
+		// changing output_mapping by hand.
+		virtual bool compile();
+		virtual void uncompile();
 	protected:
+		// compiled_final[state], if compiled
+		std::vector<bool> compiled_final;
+		void compile_final_states();
+
+		// states without output and missing transitions reject
+		virtual bool get_default_output(bool & output) const
+		{ output = false; return true; }
+
 		// parse a single, human readable transition and store it in this->transitions
 		bool parse_transition(std::string single);
 };
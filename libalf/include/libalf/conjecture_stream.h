@@ -0,0 +1,193 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_conjecture_stream_h__
+# define __libalf_conjecture_stream_h__
+
+#include <istream>
+#include <ostream>
+#include <set>
+#include <string>
+
+#include <stdint.h>
+
+#include <libalf/conjecture.h>
+
+namespace libalf {
+
+/*
+ * binary stream format for finite automata, for models that are too large
+ * for write()/read() or serialize()/deserialize(), which both build the
+ * whole automaton in one string.
+ *
+ * a stream is the magic "libalfFA", the version and flags (32 bit each),
+ * followed by chunks:
+ *	type (32 bit), payload length in bytes (32 bit), payload,
+ *	CRC-32 of type, length and payload (32 bit).
+ * all fixed-size numbers are in network byte order. chunk types are
+ *	HEAD	is dfa, alphabet size, number of states, number of initial
+ *		states and the initial states
+ *	FINL	number of states, final states
+ *	TRNS	number of transitions, transitions (source, label, destination)
+ *	END	number of final states and transitions in the stream
+ * HEAD comes first and END last, FINL and TRNS chunks may come in any
+ * order in between. with STREAM_COMPRESSED, the entries of FINL and TRNS
+ * are variable-length coded: each number takes 1-5 bytes, states are
+ * coded as difference to the previous one (destinations: to the source).
+ * sorted transitions of learned automata then take 3-4 bytes instead of 12.
+ * each chunk is coded on its own.
+ *
+ * the writer and reader buffer one chunk at a time, so the memory they use
+ * does not depend on the size of the automaton.
+ */
+
+enum conjecture_stream_flags {
+	STREAM_COMPRESSED = 1
+};
+
+class conjecture_writer {
+	protected: // data
+		std::ostream * out;
+		int fd; // if out == NULL
+		bool compress;
+		unsigned int chunk_entries;
+		bool failed;
+		bool started;
+		unsigned long long int bytes;
+
+		// pending FINL and TRNS chunks
+		std::string finals;
+		unsigned int final_count;
+		int last_final;
+		std::string transitions;
+		unsigned int transition_count;
+		int last_source;
+
+		unsigned long long int total_finals;
+		unsigned long long int total_transitions;
+	public: // methods
+		// chunk_entries is the number of final states resp. transitions
+		// per chunk.
+		conjecture_writer(std::ostream & out, bool compress = true, unsigned int chunk_entries = 65536);
+		conjecture_writer(int fd, bool compress = true, unsigned int chunk_entries = 65536);
+		// does not finish() the stream
+		virtual ~conjecture_writer()
+		{ };
+
+		// streaming: begin(), then add_final_state() and
+		// add_transition() in any order, then finish(). all return false
+		// once writing failed.
+		bool begin(bool is_dfa, int alphabet_size, int state_count, const std::set<int> & initial_states);
+		bool add_final_state(int state);
+		bool add_transition(int source, int label, int destination);
+		bool finish();
+
+		// begin(), all final states and transitions and finish()
+		bool write(const finite_automaton & automaton);
+
+		bool good() const
+		{ return !failed; }
+		unsigned long long int get_bytes_written() const
+		{ return bytes; }
+
+	protected: // methods
+		void init(bool compress, unsigned int chunk_entries);
+		bool put_chunk(uint32_t type, const std::string & payload);
+		bool put(const char * data, size_t length);
+		bool flush_finals();
+		bool flush_transitions();
+};
+
+class conjecture_reader {
+	public: // types
+		enum item {
+			ITEM_ERROR = 0,
+			ITEM_END,
+			ITEM_FINAL_STATE,
+			ITEM_TRANSITION
+		};
+	protected: // data
+		std::istream * in;
+		int fd; // if in == NULL
+		bool failed;
+		bool ended;
+		unsigned long long int bytes;
+
+		// input buffer
+		std::string buffer;
+		size_t buffer_pos;
+
+		// header
+		bool compressed;
+		bool is_dfa;
+		int alphabet_size;
+		int state_count;
+		std::set<int> initial_states;
+
+		// current FINL or TRNS chunk
+		uint32_t chunk_type;
+		std::string chunk;
+		size_t chunk_pos;
+		unsigned int chunk_left;
+		int last_state;
+
+		unsigned long long int total_finals;
+		unsigned long long int total_transitions;
+	public: // methods
+		conjecture_reader(std::istream & in);
+		conjecture_reader(int fd);
+		virtual ~conjecture_reader()
+		{ };
+
+		// streaming: read_header(), then next() until it returns
+		// ITEM_END or ITEM_ERROR. for ITEM_FINAL_STATE, the state is
+		// stored in a. for ITEM_TRANSITION, a, b, c are source, label
+		// and destination.
+		bool read_header(bool & is_dfa, int & alphabet_size, int & state_count, std::set<int> & initial_states);
+		enum item next(int & a, int & b, int & c);
+
+		// read a whole automaton, into flat storage if automaton is
+		// flat (see moore_machine::flatten()). returns false (and
+		// leaves the automaton cleared) if the stream is broken or the
+		// automaton is not valid.
+		bool read(finite_automaton & automaton);
+
+		bool good() const
+		{ return !failed; }
+		unsigned long long int get_bytes_read() const
+		{ return bytes; }
+
+	protected: // methods
+		void init();
+		bool get(char * data, size_t length);
+		bool get_chunk(uint32_t & type, std::string & payload);
+		// decode the next number of the current chunk
+		bool get_number(int32_t & value);
+		bool get_signed(int32_t & value);
+};
+
+}; // end of namespace libalf
+
+#endif // __libalf_conjecture_stream_h__
+
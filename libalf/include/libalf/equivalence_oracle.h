@@ -0,0 +1,141 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_equivalence_oracle_h__
+# define __libalf_equivalence_oracle_h__
+
+#include <list>
+#include <vector>
+
+#include <libalf/conjecture.h>
+
+namespace libalf {
+
+/*
+ * equivalence_oracle - answers equivalence queries against a fixed model
+ * for a sequence of conjectures, reusing work between queries.
+ *
+ * the model is determinized and minimized once. a query explores the
+ * product of the minimal model with the conjecture breadth-first. the
+ * oracle remembers which product states (model state, conjecture state)
+ * were found to be consistent, i.e. no difference is reachable from them.
+ *
+ * conjecture states are identified across queries by their access word
+ * (the shortest, then lexicographically least word reaching them), which
+ * does not depend on how the learning algorithm numbers its states. a
+ * state is unchanged if it was there in the previous query, with the same
+ * output and successors. if all states reachable from it are unchanged,
+ * the sub-product below it is the same as in the previous query, and a
+ * product state with it that was consistent then is not explored again.
+ * so a query only explores the part of the product that is affected by
+ * what changed in the conjecture.
+ *
+ * nondeterministic conjectures are checked with antichain_is_equal(),
+ * without reuse.
+ */
+class equivalence_oracle {
+	protected: // data
+		finite_automaton model;
+		// determinized and minimized
+		finite_automaton minimal;
+
+		// complete table of minimal. the last state rejects everything.
+		int alphabet_size;
+		int model_states;
+		std::vector<int> model_delta;
+		std::vector<bool> model_final;
+
+		// access words of conjecture states, as a tree. node 0 stands for
+		// missing transitions of the conjecture, node 1 is the empty word.
+		std::vector<int> node_child;
+		// for each node, as seen in the last query
+		std::vector<bool> node_known;
+		std::vector<bool> node_final;
+		std::vector<int> node_successor;
+		std::vector<unsigned int> node_seen;
+		// node * model_states + model state: no difference reachable
+		std::vector<bool> consistent;
+		unsigned int round;
+
+		unsigned int explored;
+		unsigned int skipped;
+
+		// buffers of equivalence_query()
+		std::vector<int> delta;
+		std::vector<bool> hypothesis_final;
+		std::vector<int> order;
+		std::vector<int> state_node;
+		std::vector<bool> dirty;
+		// conjecture state * model_states + model state: index of the
+		// product state, valid only if pair_round is the current round.
+		// so it is not cleared per query.
+		std::vector<int> pair_index;
+		std::vector<unsigned int> pair_round;
+		std::vector<int> pair_model;
+		std::vector<int> pair_conjecture;
+		std::vector<int> pair_parent;
+		std::vector<int> pair_label;
+		std::vector<int> pair_successor;
+		std::vector<bool> pair_bad;
+		std::vector<int> pred_offsets;
+		std::vector<int> preds;
+
+	public: // methods
+		// model has to be valid.
+		equivalence_oracle(const finite_automaton & model);
+
+		// returns true if the conjecture accepts the same language as the
+		// model. otherwise, counterexample is a shortest word where they
+		// differ. returns false with an empty counterexample if the
+		// conjecture is invalid or not a finite_automaton.
+		bool equivalence_query(const finite_automaton & hypothesis, std::list<int> & counterexample);
+		bool equivalence_query(const conjecture * cj, std::list<int> & counterexample);
+
+		// forget all previous queries
+		void reset();
+
+		// product states explored resp. skipped as known consistent in the
+		// last query
+		unsigned int get_explored_states() const
+		{ return explored; }
+		unsigned int get_skipped_states() const
+		{ return skipped; }
+		unsigned int get_model_state_count() const
+		{ return model_states; }
+
+	protected: // methods
+		void build_model_table(int alphabet_size);
+		// node of the access word of node followed by sigma, added if new
+		int child(int node, int sigma);
+		// fills delta, hypothesis_final. false if nondeterministic.
+		bool build_hypothesis_table(const finite_automaton & hypothesis);
+		// pair_index of (conjecture state, model state), -1 if not yet
+		// seen in this round
+		int & pair_slot(int q, int r);
+};
+
+}; // end of namespace libalf
+
+#endif // __libalf_equivalence_oracle_h__
+
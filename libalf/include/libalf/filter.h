@@ -30,16 +30,18 @@
 
 #include <sys/types.h>
 
+#include <libalf/knowledgebase_storage.h>
+
 // forward declaration for knowledgebase
 namespace libalf {
-	template <class answer> class filter;
+	template <class answer, template <class> class storage = arena_storage> class filter;
 };
 
 #include <libalf/knowledgebase.h>
 
 namespace libalf {
 
-template <class answer>
+template <class answer, template <class> class storage>
 class filter {
 	public:
 		enum type {
@@ -63,9 +65,9 @@ class filter {
 		virtual void free_all_subfilter() = 0;
 
 		virtual enum type get_type() const
-		{ return filter<answer>::FILTER_NONE; };
+		{ return filter<answer, storage>::FILTER_NONE; };
 
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const = 0;
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const = 0;
 
 		// layout for serialized filter:
 		// int size (of upcoming, including type)
@@ -77,16 +79,16 @@ class filter {
 
 //////////////////////////////////////////// logical conjunction filters
 
-template <class answer>
-class filter_subfilter_array : public filter<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_subfilter_array : public filter<answer, storage> {
 	protected:
-		std::list<filter<answer>*> subfilter_array;
+		std::list<filter<answer, storage>*> subfilter_array;
 	public:
 		virtual ~filter_subfilter_array()
 		{ };
 		virtual void free_all_subfilter()
 		{{{
-			typename std::list<filter<answer>*>::iterator li;
+			typename std::list<filter<answer, storage>*>::iterator li;
 			while( subfilter_array.end() != (li = subfilter_array.begin()) ) {
 				(*li)->free_all_subfilter();
 				delete *li;
@@ -96,7 +98,7 @@ class filter_subfilter_array : public filter<answer> {
 		virtual std::basic_string<int32_t> serialize() const
 		{{{
 			std::basic_string<int32_t> ret;
-			typename std::list<filter<answer>*>::iterator li;
+			typename std::list<filter<answer, storage>*>::iterator li;
 			ret += 0; // size, filled in later.
 			ret += htonl(this->get_type());
 			ret += htonl(subfilter_array.size());
@@ -111,23 +113,23 @@ class filter_subfilter_array : public filter<answer> {
 			
 			return false;
 		}
-		virtual void add(filter<answer> *f)
+		virtual void add(filter<answer, storage> *f)
 		{ subfilter_array.push_back(f); }
-		virtual void remove(filter<answer> *f)
+		virtual void remove(filter<answer, storage> *f)
 		{ subfilter_array.remove(f); }
 };
 
 
-template <class answer>
-class filter_and : public filter_subfilter_array<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_and : public filter_subfilter_array<answer, storage> {
 	public:
 		virtual ~filter_and()
 		{ };
-		virtual enum filter<answer>::type get_type() const
-		{ return filter<answer>::FILTER_AND; };
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const
+		virtual enum filter<answer, storage>::type get_type() const
+		{ return filter<answer, storage>::FILTER_AND; };
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const
 		{{{
-			typename std::list<filter<answer>*>::const_iterator li;
+			typename std::list<filter<answer, storage>*>::const_iterator li;
 			for(li = this->subfilter_array.begin(); li != this->subfilter_array.end(); li++) {
 				answer a;
 				if( ! (*li)->evaluate(base, word, a)) {
@@ -145,16 +147,16 @@ class filter_and : public filter_subfilter_array<answer> {
 		}}};
 };
 
-template <class answer>
-class filter_or : public filter_subfilter_array<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_or : public filter_subfilter_array<answer, storage> {
 	public:
 		virtual ~filter_or()
 		{ };
-		virtual enum filter<answer>::type get_type() const
-		{ return filter<answer>::FILTER_OR; };
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const
+		virtual enum filter<answer, storage>::type get_type() const
+		{ return filter<answer, storage>::FILTER_OR; };
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const
 		{{{
-			typename std::list<filter<answer>*>::const_iterator li;
+			typename std::list<filter<answer, storage>*>::const_iterator li;
 			bool all_known = true;
 			for(li = this->subfilter_array.begin(); li != this->subfilter_array.end(); li++) {
 				answer a;
@@ -173,10 +175,10 @@ class filter_or : public filter_subfilter_array<answer> {
 		}}};
 };
 
-template <class answer>
-class filter_not : public filter<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_not : public filter<answer, storage> {
 	protected:
-		filter<answer> * subfilter;
+		filter<answer, storage> * subfilter;
 	public:
 		virtual ~filter_not()
 		{ subfilter = NULL; };
@@ -188,9 +190,9 @@ class filter_not : public filter<answer> {
 				subfilter = NULL;
 			}
 		}}}
-		virtual enum filter<answer>::type get_type() const
-		{ return filter<answer>::FILTER_NOT; };
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const
+		virtual enum filter<answer, storage>::type get_type() const
+		{ return filter<answer, storage>::FILTER_NOT; };
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const
 		{{{
 			if(subfilter) {
 				if(subfilter->evaluate(base, word, result)) {
@@ -203,7 +205,7 @@ class filter_not : public filter<answer> {
 				return false;
 			};
 		}}}
-		virtual void set_subfilter(filter<answer> * f)
+		virtual void set_subfilter(filter<answer, storage> * f)
 		{{{
 			subfilter = f;
 		}}}
@@ -228,16 +230,16 @@ class filter_not : public filter<answer> {
 		}
 };
 
-template <class answer>
-class filter_all_equal : public filter_subfilter_array<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_all_equal : public filter_subfilter_array<answer, storage> {
 	public:
 		virtual ~filter_all_equal()
 		{ };
-		virtual enum filter<answer>::type get_type() const
-		{ return filter<answer>::FILTER_ALL_EQUAL; }
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const
+		virtual enum filter<answer, storage>::type get_type() const
+		{ return filter<answer, storage>::FILTER_ALL_EQUAL; }
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const
 		{{{
-			typename std::list<filter<answer>*>::const_iterator li;
+			typename std::list<filter<answer, storage>*>::const_iterator li;
 			answer a;
 
 			if(this->subfilter_array.empty())
@@ -260,11 +262,11 @@ class filter_all_equal : public filter_subfilter_array<answer> {
 
 //////////////////////////////////////////// word operation filter
 
-template <class answer>
-class filter_reverse : public filter<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_reverse : public filter<answer, storage> {
 	// this will reverse the queried word and send it to its subfilters.
 	protected:
-		filter<answer> * subfilter;
+		filter<answer, storage> * subfilter;
 	public:
 		virtual ~filter_reverse()
 		{ subfilter = NULL; };
@@ -276,9 +278,9 @@ class filter_reverse : public filter<answer> {
 				subfilter = NULL;
 			}
 		}}}
-		virtual enum filter<answer>::type get_type() const
-		{ return filter<answer>::FILTER_NOT; };
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const
+		virtual enum filter<answer, storage>::type get_type() const
+		{ return filter<answer, storage>::FILTER_NOT; };
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const
 		{{{
 			if(subfilter) {
 				std::list<int> reversed_word;
@@ -291,7 +293,7 @@ class filter_reverse : public filter<answer> {
 				return false;
 			};
 		}}}
-		virtual void set_subfilter(filter<answer> * f)
+		virtual void set_subfilter(filter<answer, storage> * f)
 		{{{
 			subfilter = f;
 		}}}
@@ -319,19 +321,19 @@ class filter_reverse : public filter<answer> {
 
 //////////////////////////////////////////// directly evaluating filters
 
-template <class answer>
-class filter_identity : public filter<answer> {
+template <class answer, template <class> class storage = arena_storage>
+class filter_identity : public filter<answer, storage> {
 	// this is a pretty stupid filter that will just try to resolve the given word.
 	public:
 		virtual ~filter_identity()
 		{ };
 		virtual void free_all_subfilter()
 		{ };
-		virtual enum filter<answer>::type get_type() const
-		{ return filter<answer>::FILTER_IDENTITY; };
-		virtual bool evaluate(knowledgebase<answer> & base, const std::list<int> & word, answer & result) const
+		virtual enum filter<answer, storage>::type get_type() const
+		{ return filter<answer, storage>::FILTER_IDENTITY; };
+		virtual bool evaluate(knowledgebase<answer, storage> & base, const std::list<int> & word, answer & result) const
 		{{{
-			typename knowledgebase<answer>::node * n;
+			typename knowledgebase<answer, storage>::node * n;
 			n = base.get_rootptr();
 			n = n->find_child(word.begin(), word.end());
 			if(n) {
@@ -359,29 +361,29 @@ class filter_identity : public filter<answer> {
 			if(*it != 2) return false;
 			it++;
 			if(it == limit) return false;
-			if(*it != filter<answer>::FILTER_IDENTITY) return false;
+			if(*it != filter<answer, storage>::FILTER_IDENTITY) return false;
 			return true;
 		}}}
 };
 
 //////////////////////////////////////////// helper functions
 
-template <class answer>
-filter<answer> * get_filter_from_type(typename filter<answer>::type t)
+template <class answer, template <class> class storage>
+filter<answer, storage> * get_filter_from_type(typename filter<answer, storage>::type t)
 {
 	switch (t) {
-		case filter<answer>::FILTER_AND:
-			return new filter_and<answer>;
-		case filter<answer>::FILTER_OR:
-			return new filter_or<answer>;
-		case filter<answer>::FILTER_NOT:
-			return new filter_not<answer>;
-		case filter<answer>::FILTER_ALL_EQUAL:
-			return new filter_all_equal<answer>;
-		case filter<answer>::FILTER_REVERSE:
-			return new filter_reverse<answer>;
-		case filter<answer>::FILTER_IDENTITY:
-			return new filter_identity<answer>;
+		case filter<answer, storage>::FILTER_AND:
+			return new filter_and<answer, storage>;
+		case filter<answer, storage>::FILTER_OR:
+			return new filter_or<answer, storage>;
+		case filter<answer, storage>::FILTER_NOT:
+			return new filter_not<answer, storage>;
+		case filter<answer, storage>::FILTER_ALL_EQUAL:
+			return new filter_all_equal<answer, storage>;
+		case filter<answer, storage>::FILTER_REVERSE:
+			return new filter_reverse<answer, storage>;
+		case filter<answer, storage>::FILTER_IDENTITY:
+			return new filter_identity<answer, storage>;
 		default:
 			// waaaaa!!!
 			return NULL;
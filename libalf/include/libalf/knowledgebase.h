@@ -32,6 +32,8 @@
 #include <set>
 #include <sstream>
 #include <algorithm>
+#include <new>
+#include <stdint.h>
 
 #ifdef _WIN32
 # include <winsock.h>
@@ -39,13 +41,16 @@
 # include <arpa/inet.h>
 #endif
 #include <queue>
+#include <deque>
 #include <map>
 #include <typeinfo>
 #include <sys/types.h>
 
+#include <libalf/knowledgebase_storage.h>
+
 // forward declaration for filter
 namespace libalf {
-	template <class answer> class knowledgebase;
+	template <class answer, template <class> class storage = arena_storage> class knowledgebase;
 };
 
 #include <libalf/answer.h>
@@ -80,20 +85,34 @@ namespace libalf {
  *  kb::create_query_tree() creates a new knowledgebase containing only the
  *  queries.
  *
+ *  for oracles that answer many queries at once, kb::export_queries()
+ *  writes all pending queries into a single length-prefixed buffer and
+ *  kb::import_answers() answers them from a vector in the same order.
+ *
+ *  to keep a remote copy in sync, kb::get_changes_since() returns only the
+ *  queries and answers added since the timestamp returned by its last call.
+ *
  *  kb::merge_knowledgebase() merges membership information (no queries)
  *  from another knowledgebase into this (e.g. an answered query tree
  *  created before)
+ *
+ *  storage selects how the nodes are kept (see knowledgebase_storage.h).
+ *  by default, they are not allocated one by one but constructed in an
+ *  arena of large chunks and addressed by 32-bit indices
+ *  (arena_storage). knowledgebase<answer, heap_storage> allocates every
+ *  node on its own. node pointers stay valid until the node is removed
+ *  (cleanup(), undo(), clear_queries(), clear()).
  */
-template <class answer>
+template <class answer, template <class> class storage>
 class knowledgebase
 {
 	public: // types
-
 		/** single node in knowledgebase tree */
 		class node
 		{
-			friend class knowledgebase<answer>;
-			friend class knowledgebase<answer>::iterator;
+			friend class knowledgebase<answer, storage>;
+			friend class knowledgebase<answer, storage>::iterator;
+			friend class storage<node>;
 			public: // types
 				enum status_e {
 					NODE_IGNORE = 0,
@@ -104,48 +123,85 @@ class knowledgebase
 				knowledgebase * base;
 				node * parent;
 				// for root-node, parent is NULL.
-				std::vector<node *> children;
-				// NULL is a valid placeholder for
-				// non-existing sub-trees
+				typename storage<node>::node_data data;
+				// the children of this node, kept by
+				// base->nodes. they are also linked in
+				// ascending order of their labels, so they can
+				// be walked without looking at empty slots.
 				int label;
-				// as this == parent->children[label], label
-				// is redundant. except for root, where label
-				// should be -1 == epsilon
+				// as this is the child of parent with label,
+				// label is redundant. except for root, where
+				// label should be -1 == epsilon
 				unsigned int timestamp;
 				enum status_e status;
 				answer ans;
+				// if status == NODE_REQUIRED, the node is
+				// linked into the query-list of base (in
+				// order of marking). if status ==
+				// NODE_ANSWERED, it is linked into the
+				// answer-list of base (in order of answering):
+				node * prev_linked;
+				node * next_linked;
 			protected: // internal methods
-				node* get_next(node * current_child)
-				// used in iterator++
-				{{{
-					typename std::vector<node *>::iterator ci;
-
-					// find next after current child
-					if(current_child != NULL) {
-						ci = std::find(children.begin(), children.end(), current_child);
-						if(ci == children.end())
-							ci = children.begin();
-						else
-							ci++;
+				unsigned int child_slot_count() const
+				{{{
+					return base->nodes.slot_count(this);
+				}}}
+				node * child_in_slot(unsigned int slot) const
+				{{{
+					return base->nodes.child(this, slot);
+				}}}
+				node* get_next(node * current_child, const node * subtree_root = NULL)
+				// used in iterator++. follows the links to the
+				// first child and to the next sibling, so a full
+				// iteration passes every node at most twice,
+				// independent of the size of the alphabet. the
+				// walk does not leave the subtree below
+				// subtree_root, if given.
+				{{{
+					node * n;
+
+					if(current_child == NULL) {
+						if(get_first_child() != NULL)
+							return get_first_child();
+						n = this;
 					} else {
-						ci = children.begin();
+						n = current_child;
+					}
+
+					// next sibling of n or of its closest ancestor
+					while(n != subtree_root && n->parent != NULL) {
+						if(n->get_next_sibling() != NULL)
+							return n->get_next_sibling();
+						n = n->parent;
 					}
 
-					// check children
-					for(/* nothing */; ci != children.end(); ci++)
-						if(*ci != NULL)
-							return *ci;
+					return NULL;
+				}}}
+				void link_child(node * c)
+				// insert the new child c into the list of
+				// children. its predecessor is the nearest
+				// occupied slot below c's label.
+				{{{
+					node * first = get_first_child();
 
-					// refer to parent
-					if(parent)
-						return parent->get_next(this);
-					else
-						return NULL;
+					if(first == NULL || first->label > c->label) {
+						base->nodes.set_next_sibling(c, first);
+						base->nodes.set_first_child(this, c);
+						return;
+					}
+
+					int l = c->label - 1;
+					while(child_in_slot(l) == NULL)
+						l--;
+					node * prev = child_in_slot(l);
+					base->nodes.set_next_sibling(c, prev->get_next_sibling());
+					base->nodes.set_next_sibling(prev, c);
 				}}}
 				void serialize_subtree(std::basic_string<int32_t> & into) const
 				// used during serialization
 				{{{
-					typename std::vector<node *>::const_iterator ci;
+					const node * c;
 
 					into += ::serialize(label); // label MUST be the first element (see deserialize of children)
 					into += ::serialize(timestamp);
@@ -155,16 +211,49 @@ class knowledgebase
 						into += ::serialize(ans);
 
 					int childcount = 0;
-					for(ci = children.begin(); ci != children.end(); ci++)
-						if(*ci != NULL)
-							childcount++;
+					for(c = get_first_child(); c != NULL; c = c->get_next_sibling())
+						childcount++;
 					into += ::serialize(childcount);
 
-					for(ci = children.begin(); ci != children.end(); ci++)
-						if(*ci != NULL)
-							(*ci)->serialize_subtree(into);
+					for(c = get_first_child(); c != NULL; c = c->get_next_sibling())
+						c->serialize_subtree(into);
 
 				}}}
+				void link(node * & first, node * & last)
+				// append to list [first, last] of base
+				{{{
+					prev_linked = last;
+					next_linked = NULL;
+					if(last)
+						last->next_linked = this;
+					else
+						first = this;
+					last = this;
+				}}}
+				void unlink(node * & first, node * & last)
+				// remove from list [first, last] of base in O(1)
+				{{{
+					if(prev_linked)
+						prev_linked->next_linked = next_linked;
+					else
+						first = next_linked;
+					if(next_linked)
+						next_linked->prev_linked = prev_linked;
+					else
+						last = prev_linked;
+					prev_linked = NULL;
+					next_linked = NULL;
+				}}}
+				void link_query()
+				{{{
+					link(base->first_query, base->last_query);
+					base->querycount++;
+				}}}
+				void unlink_query()
+				{{{
+					unlink(base->first_query, base->last_query);
+					base->querycount--;
+				}}}
 				bool deserialize_subtree(serial_stretch & ser)
 				{{{
 					using libalf::deserialize;
@@ -175,9 +264,12 @@ class knowledgebase
 					int st;
 					if(!::deserialize(st, ser)) return false;
 					status = (enum status_e) st;
+					if(status == NODE_REQUIRED)
+						link_query();
 
 					if(is_answered()) {
 						if(!deserialize(this->ans, ser)) return false;
+						link(base->first_answer, base->last_answer);
 						base->answercount += 1;
 					}
 
@@ -196,23 +288,17 @@ class knowledgebase
 
 			public: // public methods
 				node(knowledgebase * base)
+				// nodes are constructed by base->nodes, see
+				// knowledgebase_storage.h.
 				{{{
 					this->base = base;
 					parent = NULL;
 					label = -1;
 					status = NODE_IGNORE;
 					timestamp = 0;
+					prev_linked = NULL;
+					next_linked = NULL;
 				}}}
-				~node()
-				// reference in parent will stay ; all
-				// children will be deleted
-				{{{
-					typename std::vector<node*>::iterator ci;
-					for(ci = children.begin(); ci != children.end(); ci++)
-						if(*ci)
-							delete (*ci);
-				}}}
-
 				node * get_selfptr()
 				{{{
 					return this;
@@ -222,17 +308,27 @@ class knowledgebase
 				{{{
 					  return parent;
 				}}}
+				node * get_first_child() const
+				// child with the smallest label, or NULL
+				{{{
+					return base->nodes.first_child(this);
+				}}}
+				node * get_next_sibling() const
+				// child of parent with the next larger label, or NULL
+				{{{
+					return base->nodes.next_sibling(this);
+				}}}
 				int max_child_count() const
 				// if this returns n, there _may_ exist
 				// suffixes [0..n)
 				{{{
-					return children.size();
+					return child_slot_count();
 				}}}
 				node * find_child(int label)
 				// go to node defined by single-letter suffix
 				{{{
-					if(label >= 0 && label < (int)children.size())
-						return children[label];
+					if(label >= 0 && label < (int)child_slot_count())
+						return child_in_slot(label);
 					else
 						return NULL;
 				}}}
@@ -251,27 +347,24 @@ class knowledgebase
 				{{{
 					if(label < 0)
 						return NULL;
-					if(label >= (int)children.size()) {
-						// push back NULL until new alphabet-size is met
-						for(int c = label - children.size(); c >= 0; c--) {
-							children.push_back((node *)NULL);
-						}
-					}
 
-					if(children[label] == NULL) {
+					node * c = find_child(label);
+					if(c == NULL) {
 						// on demand create new child
-						children[label] = new node(base);
-						children[label]->parent = this;
-						children[label]->label = label;
+						c = base->nodes.create(base);
+						c->parent = this;
+						c->label = label;
+						base->nodes.set_child(this, label, c);
+						link_child(c);
 						base->nodecount++;
 					}
 
 					if(label >= base->largest_symbol)
 						base->largest_symbol = label+1;
 
-					return children[label];
+					return c;
 				}}}
-				node * find_or_create_descendant(std::list<int>::iterator infix_start, std::list<int>::iterator infix_limit)
+				node * find_or_create_descendant(std::list<int>::const_iterator infix_start, std::list<int>::const_iterator infix_limit)
 				{{{
 					node * n = this;
 
@@ -282,6 +375,24 @@ class knowledgebase
 
 					return n;
 				}}}
+				node * find_descendant(const packed_word & infix)
+				{{{
+					node * n = this;
+
+					for(unsigned int i = 0; i < infix.size() && n != NULL; ++i)
+						n = n->find_child(infix[i]);
+
+					return n;
+				}}}
+				node * find_or_create_descendant(const packed_word & infix)
+				{{{
+					node * n = this;
+
+					for(unsigned int i = 0; i < infix.size() && n != NULL; ++i)
+						n = n->find_or_create_child(infix[i]);
+
+					return n;
+				}}}
 				bool has_specific_suffix(answer specific_answer) const
 				// check if a suffix exists with a specific
 				// answer
@@ -289,12 +400,9 @@ class knowledgebase
 					if(is_answered() && get_answer() == specific_answer)
 						return true;
 
-					typename std::vector<node*>::const_iterator ci;
-
-					for(ci = children.begin(); ci != children.end(); ci++)
-						if(*ci)
-							if((*ci)->has_specific_suffix(specific_answer))
-								return true;
+					for(node * c = get_first_child(); c != NULL; c = c->get_next_sibling())
+						if(c->has_specific_suffix(specific_answer))
+							return true;
 
 					return false;
 				}}}
@@ -324,8 +432,8 @@ class knowledgebase
 				{{{
 					if(status == NODE_IGNORE) {
 						status = NODE_REQUIRED;
-						timestamp = base->timestamp;
-						base->required.push_back(this);
+						timestamp = base->fresh_timestamp();
+						link_query();
 						return true;
 					} else {
 						return (status == NODE_REQUIRED);
@@ -351,12 +459,13 @@ class knowledgebase
 						return ((answer)this->ans == (answer)ans);
 
 					if(status == NODE_REQUIRED)
-						base->required.remove(this);
+						unlink_query();
 
 					status = NODE_ANSWERED;
 					this->ans = ans;
-					this->timestamp = base->timestamp;
+					this->timestamp = base->fresh_timestamp();
 					base->timestamp++;
+					link(base->first_answer, base->last_answer);
 
 					base->answercount++;
 
@@ -366,18 +475,19 @@ class knowledgebase
 				{{{
 					  return ans;
 				}}}
+				unsigned int get_timestamp() const
+				{{{
+					return timestamp;
+				}}}
 				bool no_subqueries(bool check_self = true) const
 				// no queries with this node as prefix exist?
 				{{{
 					if(check_self && status == NODE_REQUIRED)
 						return false;
 
-					typename std::vector<node*>::const_iterator ci;
-
-					for(ci = children.begin(); ci != children.end(); ci++)
-						if(*ci)
-							if( ! (*ci)->no_subqueries(true) )
-								return false;
+					for(node * c = get_first_child(); c != NULL; c = c->get_next_sibling())
+						if( ! c->no_subqueries(true) )
+							return false;
 
 					return true;
 				}}}
@@ -397,20 +507,20 @@ class knowledgebase
 				// other.w . to allow infinite long words, use
 				// depth = -1.
 				{{{
-					typename std::vector<node*>::const_iterator ci, oci;
-
 					if(different(other))
 						return true;
 
 					if(depth == 0)
 						return false;
 
-					for(ci = children.begin(), oci = other->children.begin();
-					    ci != children.end() && oci != other->children.end();
-					    ci++, oci++)   {
-						if((*ci) == NULL || (*oci) == NULL)
+					// other may be in a different knowledgebase
+					for(node * c = get_first_child(); c != NULL; c = c->get_next_sibling()) {
+						if(c->label >= (int)other->child_slot_count())
+							break;
+						node * oc = other->child_in_slot(c->label);
+						if(oc == NULL)
 							continue;
-						if((*ci)->recursive_different(*oci, depth > 0 ? depth-1 : -1))
+						if(c->recursive_different(oc, depth > 0 ? depth-1 : -1))
 							return true;
 					}
 
@@ -460,12 +570,10 @@ class knowledgebase
 				// subtree
 				{{{
 					unsigned long long int ret;
-					typename std::vector<node*>::const_iterator ci;
 
-					ret = sizeof(this) + sizeof(node *) * children.size();
-					for(ci = children.begin(); ci != children.end(); ci++)
-						if(*ci)
-							ret += (*ci)->get_memory_usage();
+					ret = base->nodes.get_memory_usage(this);
+					for(node * c = get_first_child(); c != NULL; c = c->get_next_sibling())
+						ret += c->get_memory_usage();
 
 					return ret;
 				}}}
@@ -475,9 +583,11 @@ class knowledgebase
 				// answer)
 				{{{
 					if(status == NODE_REQUIRED)
-						base->required.remove(this);
-					if(status == NODE_ANSWERED)
+						unlink_query();
+					if(status == NODE_ANSWERED) {
+						unlink(base->first_answer, base->last_answer);
 						base->answercount--;
+					}
 
 					status = NODE_IGNORE;
 					timestamp = 0;
@@ -492,17 +602,26 @@ class knowledgebase
 					may_remove_self = ( this->status == NODE_IGNORE );
 
 					// remove all children that may be removed
-					typename std::vector<node*>::iterator ci;
-					for(ci = children.begin(); ci != children.end(); ++ci) {
-						if(*ci != NULL) {
-							if( ! (*ci)->cleanup() ) {
-								may_remove_self = false;
-							} else {
-								delete *ci;
-								*ci = NULL;
-							}
+					node * prev = NULL;
+					node * c = get_first_child();
+					while(c != NULL) {
+						node * next = c->get_next_sibling();
+						if( ! c->cleanup() ) {
+							may_remove_self = false;
+							prev = c;
+						} else {
+							if(prev)
+								base->nodes.set_next_sibling(prev, next);
+							else
+								base->nodes.set_first_child(this, next);
+							base->nodes.set_child(this, c->label, NULL);
+							base->free_subtree(c);
 						}
+						c = next;
 					}
+					// all children removed: give their slots back
+					if(may_remove_self)
+						base->nodes.release_children(this);
 
 					return may_remove_self;
 				}}}
@@ -873,54 +992,89 @@ class knowledgebase
 
 		 */
 
-		/** iterator for known OR required nodes */
+		/** iterator for known OR required nodes
+		 *
+		 *  the iterator either walks the tree (or a subtree) in
+		 *  depth-first prefix order (kb::begin()), in graded
+		 *  lexicographic order (kb::gbegin()), or it iterates only the
+		 *  queries (kb::qbegin()).
+		 *
+		 *  graded lexicographic order: a < b  iff  |a| < |b| or
+		 *  |a|==|b| && (a <[LEX] b). the iterator holds a queue of
+		 *  pending nodes for this mode, so copying it is O(width).
+		 */
 		class iterator : std::iterator<std::forward_iterator_tag, node>
 		{
+			public: // types
+				enum order_e {
+					ORDER_PREFIX = 0,
+					ORDER_QUERIES = 1,
+					ORDER_GRADED_LEX = 2
+				};
 			private:
 				knowledgebase * base;
 
 				node * current;
 
-				bool queries_only;
-				typename std::list<node*>::iterator qi;
+				enum order_e order;
+				// the iteration does not leave the subtree
+				// below subtree_root.
+				node * subtree_root;
+				// for ORDER_GRADED_LEX: pending nodes. front is current.
+				std::deque<node*> pending;
 			public:
 				iterator()
 				{{{
-					queries_only = false;
+					base = NULL;
 					current = NULL;
-					qi = base->required.end();
+					order = ORDER_PREFIX;
+					subtree_root = NULL;
 				}}}
 				iterator(const iterator & other)
 				{{{
 					base = other.base;
 					current = other.current;
-					queries_only = other.queries_only;
-					qi = other.qi;
+					order = other.order;
+					subtree_root = other.subtree_root;
+					pending = other.pending;
 				}}}
 
-				iterator(bool queries_only, typename std::list<node*>::iterator currentquery, node * current, knowledgebase * base)
+				iterator(enum order_e order, node * subtree_root, knowledgebase * base)
+				// iterate the subtree below subtree_root in prefix
+				// or graded lexicographic order. for
+				// ORDER_QUERIES, subtree_root is the first
+				// query to visit.
 				{{{
 					this->base = base;
-					this->current = current;
-					this->queries_only = queries_only;
-					this->qi = currentquery;
+					this->current = subtree_root;
+					this->order = order;
+					this->subtree_root = subtree_root;
+					if(order == ORDER_GRADED_LEX && subtree_root != NULL)
+						pending.push_back(subtree_root);
 				}}}
 
 				iterator & operator++()
-				// only valid if queries have not been changed since creation of iterator
+				// for queries, only valid if the current query has not
+				// been answered or ignored since.
 				{{{
-					if(queries_only) {
-						if(qi != base->required.end()) {
-							qi++;
-							if(qi != base->required.end())
-								current = *qi;
-							else
-								current = NULL;
-						} else {
-							// nothing
-						}
-					} else {
-						current = current->get_next(NULL);
+					switch(order) {
+						case ORDER_QUERIES:
+							if(current != NULL)
+								current = current->next_linked;
+							break;
+						case ORDER_PREFIX:
+							if(current != NULL)
+								current = current->get_next(NULL, subtree_root);
+							break;
+						case ORDER_GRADED_LEX:
+							if(!pending.empty()) {
+								node * n = pending.front();
+								pending.pop_front();
+								for(node * c = n->get_first_child(); c != NULL; c = c->get_next_sibling())
+									pending.push_back(c);
+							}
+							current = pending.empty() ? NULL : pending.front();
+							break;
 					}
 					return *this;
 				}}}
@@ -945,8 +1099,9 @@ class knowledgebase
 				{{{
 					base = it.base;
 					current = it.current;
-					queries_only = it.queries_only;
-					qi = it.qi;
+					order = it.order;
+					subtree_root = it.subtree_root;
+					pending = it.pending;
 
 					return *this;
 				}}}
@@ -962,20 +1117,27 @@ class knowledgebase
 
 
 
-		friend class knowledgebase<answer>::node;
-		friend class knowledgebase<answer>::iterator;
+		friend class knowledgebase<answer, storage>::node;
+		friend class knowledgebase<answer, storage>::iterator;
 	protected: // data
 		// full tree
 		node * root;
-		// list of all nodes that are required
-		std::list<node *> required;
+		// list of all nodes that are required (linked via
+		// node::next_linked, in order of marking)
+		node * first_query;
+		node * last_query;
+		int querycount;
+		// list of all nodes that are answered (linked via
+		// node::next_linked, in order of answering). thus the
+		// timestamps in both lists are ascending.
+		node * first_answer;
+		node * last_answer;
 
 		// filter that is tried during resolved_queries() and resolve_or_add_query()
-		filter<answer> * my_filter;
+		filter<answer, storage> * my_filter;
 
 		int nodecount; // number of nodes in tree
 		int answercount; // number of answers stored in this knowledgebase
-		// count_queries is required.size().
 		int resolved_queries; // number of queries that have been resolved from this knowledgebase
 
 		int largest_symbol; // largest symbol that ever was stored in knowledgebase.
@@ -983,6 +1145,73 @@ class knowledgebase
 			// you can enforce a check of the complete knowledgebase.
 
 		unsigned int timestamp;
+		// timestamp at the last call of get_changes_since(). new
+		// queries and answers must not get this timestamp anymore.
+		unsigned int sync_timestamp;
+
+		// constructs and links the nodes
+		storage<node> nodes;
+
+	protected: // nodes
+		void free_subtree(node * n)
+		// destroy n and all nodes below it. the slot referring to n
+		// in its parent is left to the caller.
+		{{{
+			std::vector<node *> stack;
+
+			stack.push_back(n);
+			while(!stack.empty()) {
+				n = stack.back();
+				stack.pop_back();
+				for(node * c = n->get_first_child(); c != NULL; c = c->get_next_sibling())
+					stack.push_back(c);
+				nodes.destroy(n);
+				nodecount--;
+			}
+		}}}
+
+	protected:
+		static const node * first_since(const node * last, unsigned int since)
+		// walk back from the end of a timestamp-ordered list and
+		// return the first node with timestamp >= since.
+		{{{
+			const node * first = NULL;
+
+			while(last != NULL && last->timestamp >= since) {
+				first = last;
+				last = last->prev_linked;
+			}
+
+			return first;
+		}}}
+		static bool timestamp_less(const node * a, const node * b)
+		{{{
+			return a->timestamp < b->timestamp;
+		}}}
+		static void sort_by_timestamp(node * & first, node * & last)
+		// stable sort of list [first, last] by timestamp
+		{{{
+			std::vector<node*> v;
+			node * n;
+
+			for(n = first; n != NULL; n = n->next_linked)
+				v.push_back(n);
+			if(v.size() < 2)
+				return;
+			std::stable_sort(v.begin(), v.end(), timestamp_less);
+
+			first = NULL;
+			last = NULL;
+			for(typename std::vector<node*>::iterator vi = v.begin(); vi != v.end(); ++vi)
+				(*vi)->link(first, last);
+		}}}
+		unsigned int fresh_timestamp()
+		// timestamp for a new query or answer
+		{{{
+			if(timestamp == sync_timestamp)
+				timestamp++;
+			return timestamp;
+		}}}
 
 	public: // methods
 		knowledgebase()
@@ -994,21 +1223,28 @@ class knowledgebase
 
 		~knowledgebase()
 		{{{
-			delete root;
+			free_subtree(root);
 		}}}
 
 		void clear()
-		// does not clear stats or filter, only the tree
+		// does not clear stats or filter, only the tree. the storage
+		// keeps its memory for reuse.
 		{{{
 			if(root) // check only required so we dont bang in constructors
-				delete root;
+				free_subtree(root);
+			nodes.clear();
 
 			timestamp = 1;
 			largest_symbol = 0;
 
-			required.clear();
+			first_query = NULL;
+			last_query = NULL;
+			querycount = 0;
+			first_answer = NULL;
+			last_answer = NULL;
+			sync_timestamp = 0;
 
-			root = new node(this);
+			root = nodes.create(this);
 
 			nodecount = 1;
 			answercount = 0;
@@ -1018,8 +1254,8 @@ class knowledgebase
 		void clear_queries()
 		// remove all query-marked nodes
 		{{{
-			while(!required.empty())
-				required.front()->ignore();
+			while(first_query != NULL)
+				first_query->ignore();
 			root->cleanup();
 		}}}
 
@@ -1040,12 +1276,13 @@ class knowledgebase
 		}}}
 
 		unsigned long long int get_memory_usage() const
+		// counts the nodes and child blocks in use. chunks and blocks
+		// that the arena has reserved but not used are not counted.
 		{{{
 			unsigned long long int ret;
 
 			ret = sizeof(this);
 			ret += root->get_memory_usage();
-			ret += sizeof(node*) * required.size();
 
 			return ret;
 		}}}
@@ -1053,12 +1290,12 @@ class knowledgebase
 		bool is_answered() const
 		// no information is marked as required?
 		{{{
-			return (required.size() == 0);
+			return (querycount == 0);
 		}}}
 		bool is_empty() const
 		// no information is contained?
 		{{{
-			return ( (required.size() == 0) && (answercount == 0) );
+			return ( (querycount == 0) && (answercount == 0) );
 		}}}
 
 		unsigned int get_timestamp() const
@@ -1074,9 +1311,9 @@ class knowledgebase
 		{{{
 			return answercount;
 		}}}
-		int count_queries() const // O(n) !
+		int count_queries() const // O(1)
 		{{{
-			return required.size();
+			return querycount;
 		}}}
 		int count_resolved_queries() const // O(1)
 		{{{
@@ -1086,6 +1323,11 @@ class knowledgebase
 		{{{
 			resolved_queries = 0;
 		}}}
+		void add_resolved_queries(int count)
+		// for lookups that bypass resolve_query(), e.g. parallel_table_filler
+		{{{
+			resolved_queries += count;
+		}}}
 
 		int get_largest_symbol() const
 		// return largest known symbol ( O(1) ) that was ever
@@ -1185,15 +1427,12 @@ class knowledgebase
 
 			// and add all connections
 			for(it = this->begin(); it != this->end(); it++) {
-				typename std::vector<node *>::iterator ci;
 				std::string toname;
 
 				wname = word2string( it->get_word() );
-				for(ci = it->children.begin(); ci != it->children.end(); ci++) {
-					if(*ci) {
-						toname = word2string( (*ci)->get_word() );
-						str << "\t\"k" << wname << "\" -> \"k" << toname << "\" [label=\"" << (*ci)->label << "\"];\n";
-					}
+				for(node * c = it->get_first_child(); c != NULL; c = c->get_next_sibling()) {
+					toname = word2string( c->get_word() );
+					str << "\t\"k" << wname << "\" -> \"k" << toname << "\" [label=\"" << c->label << "\"];\n";
 				}
 			}
 
@@ -1233,24 +1472,21 @@ class knowledgebase
 			}
 			// and add all connections
 			for(it = this->begin(); it != this->end(); it++) {
-				typename std::vector<node *>::iterator ci;
 				std::string toname;
 
 				word = it->get_word();
 				wname = word2string(word);
-				for(ci = it->children.begin(); ci != it->children.end(); ci++) {
-					if(*ci) {
-						word = (*ci)->get_word();
-						toname = word2string(word);
-
-						snprintf(buf, 128, "\t\"%s [%d]\" -> \"%s [%d]\" [ label = \"%d\" ];\n",
-								wname.c_str(), it->timestamp,
-								toname.c_str(), (*ci)->timestamp,
-								(*ci)->label
-							);
-						buf[127] = 0;
-						ret += buf;
-					}
+				for(node * c = it->get_first_child(); c != NULL; c = c->get_next_sibling()) {
+					word = c->get_word();
+					toname = word2string(word);
+
+					snprintf(buf, 128, "\t\"%s [%d]\" -> \"%s [%d]\" [ label = \"%d\" ];\n",
+							wname.c_str(), it->timestamp,
+							toname.c_str(), c->timestamp,
+							c->label
+						);
+					buf[127] = 0;
+					ret += buf;
 				}
 			}
 
@@ -1337,6 +1573,11 @@ class knowledgebase
 			if(((int)ntohl(*ser)) != -1) goto failed; // label of root-node must be -1.
 			if(!root->deserialize_subtree(ser)) goto failed;
 
+			// nodes were linked in tree-order. restore the order
+			// of marking and answering.
+			sort_by_timestamp(first_query, last_query);
+			sort_by_timestamp(first_answer, last_answer);
+
 			return true;
 
 		failed:
@@ -1360,14 +1601,14 @@ class knowledgebase
 
 			if(!::deserialize(size, ser)) goto failed;
 
-			while(size && !required.empty()) {
+			while(size && first_query != NULL) {
 				answer a;
 				if(!deserialize(a, ser)) goto failed;
-				required.front()->set_answer(a);
+				first_query->set_answer(a);
 				--size;
 			}
 
-			if(size == 0 && required.empty())
+			if(size == 0 && first_query == NULL)
 				return true;
 
 		failed:
@@ -1404,6 +1645,142 @@ class knowledgebase
 
 			return ret;
 		}}}
+		unsigned int export_queries(std::vector<int32_t> & buffer, unsigned int max_count = 0) const
+		// export the pending queries (all, or only the oldest max_count)
+		// in order of marking into a single contiguous buffer. the
+		// buffer is overwritten and holds, for each query, its length
+		// followed by its letters:
+		//	int length, int letter[length], int length, ...
+		// no per-word allocations are done. returns the number of
+		// exported queries. use import_answers() to answer them.
+		{{{
+			unsigned int count = 0;
+			const node * q;
+
+			buffer.clear();
+
+			for(q = first_query; q != NULL && (max_count == 0 || count < max_count); q = q->next_linked, ++count) {
+				const node * n;
+				unsigned int length = 0;
+				unsigned int pos;
+
+				for(n = q; n->parent != NULL; n = n->parent)
+					++length;
+
+				pos = buffer.size();
+				buffer.resize(pos + 1 + length);
+				buffer[pos] = length;
+				// write letters back to front
+				for(n = q; n->parent != NULL; n = n->parent)
+					buffer[pos + length--] = n->label;
+			}
+
+			return count;
+		}}}
+		template <class InputIterator>
+		bool import_answers(InputIterator first, InputIterator limit)
+		// answer the oldest pending queries with the answers in
+		// [first, limit), in order. if no queries were answered or
+		// ignored in between, these are exactly the queries of the
+		// last export_queries(). returns false if there are more
+		// answers than pending queries.
+		{{{
+			for(/* nothing */; first != limit; ++first) {
+				if(first_query == NULL)
+					return false;
+				first_query->set_answer(*first);
+			}
+			return true;
+		}}}
+		bool import_answers(const std::vector<answer> & answers)
+		{{{
+			return import_answers(answers.begin(), answers.end());
+		}}}
+
+		// incremental synchronization:
+		//
+		// mark_sync() returns a timestamp t such that all queries and
+		// answers added after the call have a timestamp >= t. pass t
+		// to get_queries_since(), get_answers_since() or
+		// get_changes_since() to only get what was added since then.
+		// as queries and answers are kept in lists ordered by
+		// timestamp, this only touches the new nodes.
+		//
+		// NOTE: only additions are reported. nodes that were ignored
+		// or removed by undo() or clear_queries() in between are not.
+
+		unsigned int mark_sync()
+		{{{
+			sync_timestamp = timestamp;
+			return timestamp + 1;
+		}}}
+		std::list<std::list<int> > get_queries_since(unsigned int since) const
+		// get list of all queries marked since the given timestamp,
+		// in order of marking.
+		{{{
+			std::list<std::list<int> > ret;
+			const node * q;
+
+			for(q = first_since(last_query, since); q != NULL; q = q->next_linked)
+				ret.push_back(q->get_word());
+
+			return ret;
+		}}}
+		std::list<std::pair<std::list<int>, answer> > get_answers_since(unsigned int since) const
+		// get list of all answers given since the given timestamp,
+		// in order of answering.
+		{{{
+			std::list<std::pair<std::list<int>, answer> > ret;
+			const node * a;
+
+			for(a = first_since(last_answer, since); a != NULL; a = a->next_linked)
+				ret.push_back(std::pair<std::list<int>, answer>(a->get_word(), a->ans));
+
+			return ret;
+		}}}
+		unsigned int get_changes_since(unsigned int since, std::list<std::list<int> > & queries, std::list<std::pair<std::list<int>, answer> > & answers)
+		// get all queries and answers added since the given timestamp
+		// (use 0 for the first call) and return the timestamp to pass
+		// to the next call.
+		{{{
+			queries = get_queries_since(since);
+			answers = get_answers_since(since);
+			return mark_sync();
+		}}}
+		unsigned int get_changes_since(unsigned int since, std::list<const node*> & queries, std::list<const node*> & answers)
+		// as above, but hands out the nodes themselves, so a copy can
+		// keep their timestamps (see
+		// mapped_knowledgebase::append_changes()).
+		{{{
+			const node * n;
+
+			queries.clear();
+			answers.clear();
+			for(n = first_since(last_query, since); n != NULL; n = n->next_linked)
+				queries.push_back(n);
+			for(n = first_since(last_answer, since); n != NULL; n = n->next_linked)
+				answers.push_back(n);
+
+			return mark_sync();
+		}}}
+		void restore_timestamps(const std::vector<std::pair<node*, unsigned int> > & stamps)
+		// set the timestamps of the given (required or answered) nodes,
+		// e.g. when rebuilding a knowledgebase from a file that keeps
+		// them, and restore the order of marking and answering. new
+		// queries and answers get later timestamps.
+		{{{
+			typename std::vector<std::pair<node*, unsigned int> >::const_iterator si;
+
+			for(si = stamps.begin(); si != stamps.end(); ++si) {
+				si->first->timestamp = si->second;
+				if(si->second >= timestamp)
+					timestamp = si->second + 1;
+			}
+
+			sort_by_timestamp(first_query, last_query);
+			sort_by_timestamp(first_answer, last_answer);
+		}}}
+
 		bool merge_knowledgebase(knowledgebase & other_tree)
 		// only merges answered information, no queries!
 		// returns false if knowledge of the trees is inconsistent.
@@ -1412,7 +1789,7 @@ class knowledgebase
 		// all new knowledge will have the same timestamp!
 		{{{
 			iterator ki;
-			int static_timestamp = timestamp; // we want one timestamp for
+			int static_timestamp = fresh_timestamp(); // we want one timestamp for
 			// the whole merge, so we have to keep it static!
 
 			// first, check if both knowledgebases are consistent
@@ -1442,6 +1819,10 @@ class knowledgebase
 		{{{
 			return root->find_or_create_descendant(word.begin(), word.end())->set_answer(acceptance);
 		}}}
+		bool add_knowledge(const packed_word & word, answer acceptance)
+		{{{
+			return root->find_or_create_descendant(word)->set_answer(acceptance);
+		}}}
 
 		/**
 		 * Add new knowledge to the knowledgebase. If the word is already in the
@@ -1481,6 +1862,24 @@ class knowledgebase
 
 			return new_queries;
 		}}}
+		int add_query(const packed_word & word, int prefix_count = 0)
+		{{{
+			node * current = root;
+			int skip_prefixes = word.size() - prefix_count;
+			int new_queries = 0;
+
+			for(unsigned int i = 0; i < word.size(); ++i, skip_prefixes--) {
+				if(skip_prefixes <= 0)
+					if(current->mark_required())
+						new_queries++;
+				current = current->find_or_create_child(word[i]);
+			}
+
+			if(current->mark_required())
+				new_queries++;
+
+			return new_queries;
+		}}}
 		bool resolve_query(std::list<int> & word, answer & acceptance)
 		// returns true if known
 		// will also try to apply the filter, if set.
@@ -1527,6 +1926,49 @@ class knowledgebase
 				return false;
 			}
 		}}}
+		bool resolve_query(const packed_word & word, answer & acceptance)
+		// as above. the word is only converted for the filter.
+		{{{
+			const node * current;
+
+			current = root->find_descendant(word);
+
+			if(current != NULL && current->is_answered()) {
+				acceptance = current->get_answer();
+				resolved_queries++;
+				return true;
+			} else {
+				if(my_filter) {
+					std::list<int> w = word.to_list();
+					return my_filter->evaluate(*this, w, acceptance);
+				} else {
+					return false;
+				}
+			}
+		}}}
+		bool resolve_or_add_query(const packed_word & word, answer & acceptance)
+		{{{
+			node * current;
+
+			current = root->find_or_create_descendant(word);
+
+			if(current->is_answered()) {
+				acceptance = current->get_answer();
+				resolved_queries++;
+				return true;
+			} else {
+				if(my_filter) {
+					std::list<int> w = word.to_list();
+					if(my_filter->evaluate(*this, w, acceptance)) {
+						current->set_answer(acceptance);
+						return true;
+					}
+				}
+
+				current->mark_required();
+				return false;
+			}
+		}}}
 		node* get_nodeptr(std::list<int> & word)
 		// get node* for a specific word
 		{{{
@@ -1545,6 +1987,15 @@ class knowledgebase
 			else
 				return false;
 		}}};
+		bool node_exists(const packed_word & word) const
+		{{{
+			return (root->find_descendant(word) != NULL);
+		}}};
+		bool knowledge_exists(const packed_word & word) const
+		{{{
+			node * n = root->find_descendant(word);
+			return n != NULL && n->is_answered();
+		}}};
 		node* get_rootptr()
 		// get node* for epsilon
 		{{{
@@ -1554,7 +2005,7 @@ class knowledgebase
 		iterator begin()
 		// begin() always begins at root node (epsilon)!
 		{{{
-			iterator it(false, required.end(), root, this);
+			iterator it(iterator::ORDER_PREFIX, root, this);
 			return it;
 		}}}
 		iterator end()
@@ -1563,15 +2014,31 @@ class knowledgebase
 			return it;
 		}}}
 
+		iterator gbegin()
+		// get begin-iterator for iteration in graded lexicographic
+		// order. begins at root node (epsilon).
+		{{{
+			iterator it(iterator::ORDER_GRADED_LEX, root, this);
+			return it;
+		}}}
+		iterator gbegin(node * subtree_root)
+		// graded lexicographic iteration of the subtree below
+		// subtree_root (i.e. all words prefixed by subtree_root)
+		{{{
+			iterator it(iterator::ORDER_GRADED_LEX, subtree_root, this);
+			return it;
+		}}}
+		iterator gend()
+		{{{
+			iterator it;
+			return it;
+		}}}
+
 		iterator qbegin()
 		// get begin-iterator for a query-iterator
 		{{{
-			if(required.empty()) {
-				return qend();
-			} else {
-				iterator it(true, required.begin(), required.front(), this);
-				return it;
-			}
+			iterator it(iterator::ORDER_QUERIES, first_query, this);
+			return it;
 		}}}
 		iterator qend()
 		{{{
@@ -1693,12 +2160,16 @@ bool deserialize(typename knowledgebase<answer>::node * & into, knowledgebase<an
  *
  *  iterate in graded lex. order:
  *  a < b  iff  |a| < |b| or |a|==|b| && (a <[LEX] b)
+ *
+ *  this is a thin wrapper around knowledgebase::iterator in graded
+ *  lexicographic order (see knowledgebase::gbegin()), kept for
+ *  compatibility.
  */
 template <class answer>
 class kIterator_lex_graded
 {
 	private:
-		std::queue<typename knowledgebase<answer>::node*> pending;
+		typename knowledgebase<answer>::iterator it;
 	public:
 		kIterator_lex_graded(typename knowledgebase<answer>::node* root)
 		{ set_root(root); }
@@ -1707,29 +2178,12 @@ class kIterator_lex_graded
 
 		void set_root(typename knowledgebase<answer>::node* root)
 		{{{
-			while(!pending.empty())
-				pending.pop();
-			pending.push(root);
+			it = typename knowledgebase<answer>::iterator(knowledgebase<answer>::iterator::ORDER_GRADED_LEX, root, NULL);
 		}}}
 
 		kIterator_lex_graded & operator++()
 		{{{
-			typename std::vector<typename knowledgebase<answer>::node*>::iterator ci;
-			typename knowledgebase<answer>::node* n;
-
-			if(pending.empty()) {
-				return *this;
-			} else {
-				n = pending.front();
-				pending.pop();
-				for(int sigma = 0; sigma < n->max_child_count(); sigma++) {
-					typename knowledgebase<answer>::node * c;
-					c = n->find_child(sigma);
-					if(c)
-						pending.push(c);
-				}
-			}
-
+			++it;
 			return *this;
 		}}}
 		kIterator_lex_graded operator++(int __attribute__ ((__unused__)) foo)
@@ -1740,24 +2194,24 @@ class kIterator_lex_graded
 		}}}
 		typename knowledgebase<answer>::node & operator*()
 		{{{
-			return *(pending.front());
+			return *it;
 		}}}
 		typename knowledgebase<answer>::node * operator->()
 		{{{
-			return pending.front();
+			return it.operator->();
 		}}}
 
 		bool end()
-		{ return pending.empty(); };
+		{ return !it.is_valid(); };
 
-		bool operator==(const kIterator_lex_graded & it)
-		{ return (*this == *it); }
-		bool operator!=(const kIterator_lex_graded & it)
-		{ return (*this != *it); }
+		bool operator==(const kIterator_lex_graded & other)
+		{ return (it == other.it); }
+		bool operator!=(const kIterator_lex_graded & other)
+		{ return (it != other.it); }
 
-		kIterator_lex_graded & operator=(const kIterator_lex_graded & it)
+		kIterator_lex_graded & operator=(const kIterator_lex_graded & other)
 		{{{
-			pending = it.pending;
+			it = other.it;
 			return *this;
 		}}}
 }; // end of kIterator_lex_graded
@@ -1775,8 +2229,8 @@ class kIterator_lex_graded
  *
  * @return Returns the given output stream as usual.
  */
-template <class answer>
-std::ostream & operator<<(std::ostream & out, libalf::knowledgebase<answer> & base)
+template <class answer, template <class> class storage>
+std::ostream & operator<<(std::ostream & out, libalf::knowledgebase<answer, storage> & base)
 {
 	out << base.visualize();
 	return out;
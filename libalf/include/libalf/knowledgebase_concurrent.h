@@ -0,0 +1,631 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_knowledgebase_concurrent_h__
+# define __libalf_knowledgebase_concurrent_h__
+
+#include <list>
+#include <deque>
+#include <vector>
+#include <string>
+#include <utility>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+# include <winsock.h>
+#else
+# include <arpa/inet.h>
+#endif
+
+#include <libalf/answer.h>
+#include <libalf/alphabet.h>
+#include <libalf/knowledgebase.h>
+
+#include <libalf/serialize.h>
+
+namespace libalf {
+
+/** Concurrent knowledgebase - knowledgebase for parallel teachers
+ *
+ *  concurrent_knowledgebase holds membership information like
+ *  knowledgebase, but all of resolve_query(), resolve_or_add_query(),
+ *  add_knowledge(), add_query() and the answering of queries may be
+ *  called from many threads at once:
+ *
+ *  - the tree is never locked. child-arrays and child-slots are installed
+ *    with a single compare-and-swap; if two threads create the same child
+ *    concurrently, one of them wins and the other discards its node.
+ *    nodes are never removed while the knowledgebase is shared.
+ *
+ *  - the status of a node only moves forward (ignore -> required ->
+ *    claimed -> answered) via compare-and-swap. an answer is written
+ *    before the node is published as answered, so lock-free readers
+ *    never see a half-written answer.
+ *
+ *  - pending queries are kept in a mutex-protected queue. a worker uses
+ *    claim_query() to atomically take a query: a claimed query is never
+ *    handed to a second worker. answer it via set_answer() or hand it
+ *    back via release_query().
+ *
+ *  as child-arrays are allocated with a fixed width, the alphabet size
+ *  has to be given at construction. words containing larger symbols are
+ *  rejected.
+ *
+ *  learning algorithms work on a knowledgebase<answer>. to let parallel
+ *  teachers answer their queries, hand the queries of the learner's
+ *  knowledgebase over via import_queries() and copy the answers back via
+ *  sync_answers(). the latter only touches the answers that were given
+ *  since its last call (they are kept in a lock-free log) and may run
+ *  while the workers are still answering.
+ *
+ *  NOTE: serialize() and clear() must only be called while
+ *        no other thread uses the knowledgebase. serialize() produces the
+ *        same format as knowledgebase::serialize() (claimed queries are
+ *        written as required).
+ *
+ *  the atomic operations use the gcc __sync builtins.
+ */
+template <class answer>
+class concurrent_knowledgebase
+{
+	public: // types
+		/** single node in concurrent_knowledgebase tree */
+		class node
+		{
+			friend class concurrent_knowledgebase<answer>;
+			public: // types
+				enum status_e {
+					NODE_IGNORE = 0,
+					NODE_REQUIRED = 1,
+					NODE_ANSWERED = 2,
+					// internal:
+					NODE_CLAIMED = 3, // a worker is evaluating the query
+					NODE_WRITING = 4  // answer is being written
+				};
+			protected: // data
+				concurrent_knowledgebase * base;
+				node * parent;
+				node * volatile * volatile children;
+				int label;
+				volatile unsigned int timestamp;
+				volatile int status;
+				answer ans;
+				// next older entry in base->answer_log
+				node * volatile next_answered;
+			public:
+				node(concurrent_knowledgebase * base, node * parent, int label)
+				{{{
+					this->base = base;
+					this->parent = parent;
+					this->children = NULL;
+					this->label = label;
+					this->timestamp = 0;
+					this->status = NODE_IGNORE;
+					this->next_answered = NULL;
+				}}}
+
+				node * get_parent() const
+				{ return parent; }
+				int get_label() const
+				{ return label; }
+				std::list<int> get_word() const
+				// get word this node represents
+				{{{
+					std::list<int> w;
+					const node * n = this;
+
+					while(n != NULL) {
+						if(n->label >= 0)
+							w.push_front(n->label);
+						n = n->parent;
+					}
+
+					return w;
+				}}}
+
+				node * find_child(int label) const
+				{{{
+					node * volatile * c = children;
+					if(label < 0 || label >= base->alphabet_size || c == NULL)
+						return NULL;
+					return c[label];
+				}}}
+				node * find_or_create_child(int label)
+				// lock-free: at most one child per slot is ever
+				// published.
+				{{{
+					node * volatile * c;
+					node * n;
+
+					if(label < 0 || label >= base->alphabet_size)
+						return NULL;
+
+					c = children;
+					if(c == NULL) {
+						node * volatile * nc = new node*[base->alphabet_size];
+						for(int i = 0; i < base->alphabet_size; ++i)
+							nc[i] = NULL;
+						if(__sync_bool_compare_and_swap(&children, (node * volatile *)NULL, nc))
+							c = nc;
+						else {
+							delete[] nc;
+							c = children;
+						}
+					}
+
+					n = c[label];
+					if(n == NULL) {
+						node * nn = new node(base, this, label);
+						if(__sync_bool_compare_and_swap(&c[label], (node*)NULL, nn)) {
+							__sync_fetch_and_add(&base->nodecount, 1);
+							n = nn;
+						} else {
+							delete nn;
+							n = c[label];
+						}
+					}
+
+					return n;
+				}}}
+
+				bool is_required() const
+				// is this node marked as unknown and required (claimed or not)?
+				{{{
+					int s = status;
+					return s == NODE_REQUIRED || s == NODE_CLAIMED;
+				}}}
+				bool is_answered() const
+				{{{
+					return status == NODE_ANSWERED;
+				}}}
+				answer get_answer() const
+				// only valid if is_answered()
+				{{{
+					return ans;
+				}}}
+				bool get_answer(answer & into) const
+				// returns false if not answered
+				{{{
+					if(status != NODE_ANSWERED)
+						return false;
+					__sync_synchronize();
+					into = ans;
+					return true;
+				}}}
+
+				bool mark_required()
+				// returns true if node is now required (or
+				// claimed), false if knowledge is already known.
+				{{{
+					// count first, so count_queries() never drops
+					// below the real number of queries.
+					__sync_fetch_and_add(&base->querycount, 1);
+					if(__sync_bool_compare_and_swap(&status, (int)NODE_IGNORE, (int)NODE_REQUIRED)) {
+						// don't overwrite the timestamp of a
+						// concurrent set_answer()
+						__sync_bool_compare_and_swap(&timestamp, 0U, (unsigned int)base->timestamp);
+						base->enqueue(this);
+						return true;
+					}
+					__sync_fetch_and_sub(&base->querycount, 1);
+					return is_required();
+				}}}
+
+				bool set_answer(answer a)
+				// return false in case of inconsistency (if this
+				// was already known and both knowledges differ).
+				// may be called by any thread, not only by the one
+				// that claimed the query.
+				{{{
+					for(;;) {
+						int s = status;
+
+						if(s == NODE_ANSWERED) {
+							__sync_synchronize();
+							return ((answer)ans == (answer)a);
+						}
+						if(s == NODE_WRITING) {
+							sched_yield();
+							continue;
+						}
+						if(__sync_bool_compare_and_swap(&status, s, (int)NODE_WRITING)) {
+							ans = a;
+							timestamp = __sync_fetch_and_add(&base->timestamp, 1);
+							if(s == NODE_REQUIRED || s == NODE_CLAIMED)
+								__sync_fetch_and_sub(&base->querycount, 1);
+							__sync_fetch_and_add(&base->answercount, 1);
+							__sync_synchronize();
+							status = NODE_ANSWERED;
+							base->log_answer(this);
+							return true;
+						}
+					}
+				}}}
+
+			protected:
+				bool claim()
+				// required -> claimed
+				{{{
+					return __sync_bool_compare_and_swap(&status, (int)NODE_REQUIRED, (int)NODE_CLAIMED);
+				}}}
+				bool release()
+				// claimed -> required
+				{{{
+					return __sync_bool_compare_and_swap(&status, (int)NODE_CLAIMED, (int)NODE_REQUIRED);
+				}}}
+		}; // end of concurrent_knowledgebase::node
+
+		friend class concurrent_knowledgebase<answer>::node;
+
+	protected: // data
+		node * root;
+		int alphabet_size;
+
+		// pending queries, in order of marking. may contain nodes that
+		// have been answered in the meantime; these are skipped in
+		// claim_query().
+		std::deque<node*> pending;
+		pthread_mutex_t pending_mutex;
+
+		volatile int nodecount;
+		volatile int answercount;
+		volatile int querycount;
+		volatile int resolved_queries;
+		volatile unsigned int timestamp;
+
+		// all answered nodes, newest first (linked via
+		// node::next_answered), and the newest one at the last
+		// sync_answers().
+		node * volatile answer_log;
+		node * synced_answer;
+
+	public: // methods
+		concurrent_knowledgebase(int alphabet_size)
+		{{{
+			this->alphabet_size = alphabet_size;
+			root = NULL;
+			pthread_mutex_init(&pending_mutex, NULL);
+			clear();
+		}}}
+
+		~concurrent_knowledgebase()
+		{{{
+			delete_tree();
+			pthread_mutex_destroy(&pending_mutex);
+		}}}
+
+		void clear()
+		// NOT thread-safe.
+		{{{
+			delete_tree();
+
+			pending.clear();
+			nodecount = 1;
+			answercount = 0;
+			querycount = 0;
+			resolved_queries = 0;
+			timestamp = 1;
+			answer_log = NULL;
+			synced_answer = NULL;
+
+			root = new node(this, NULL, -1);
+		}}}
+
+		int get_alphabet_size() const
+		{ return alphabet_size; }
+		node * get_rootptr()
+		{ return root; }
+		unsigned int get_timestamp() const
+		{ return timestamp; }
+		int count_nodes() const
+		{ return nodecount; }
+		int count_answers() const
+		{ return answercount; }
+		int count_queries() const
+		// number of required (claimed or not) nodes
+		{ return querycount; }
+		int count_resolved_queries() const
+		{ return resolved_queries; }
+		bool is_answered() const
+		{ return querycount == 0; }
+
+		node * find_descendant(std::list<int>::const_iterator infix_start, std::list<int>::const_iterator infix_limit)
+		{{{
+			node * n = root;
+			while(infix_start != infix_limit && n != NULL) {
+				n = n->find_child(*infix_start);
+				++infix_start;
+			}
+			return n;
+		}}}
+		node * find_or_create_descendant(std::list<int>::const_iterator infix_start, std::list<int>::const_iterator infix_limit)
+		{{{
+			node * n = root;
+			while(infix_start != infix_limit && n != NULL) {
+				n = n->find_or_create_child(*infix_start);
+				++infix_start;
+			}
+			return n;
+		}}}
+
+		bool add_knowledge(const std::list<int> & word, answer acceptance)
+		// will return false if knowledge for this word was already
+		// set and is != acceptance, or if the word contains a symbol
+		// outside the alphabet.
+		{{{
+			node * n = find_or_create_descendant(word.begin(), word.end());
+			if(n == NULL)
+				return false;
+			return n->set_answer(acceptance);
+		}}}
+		int add_query(const std::list<int> & word, int prefix_count = 0)
+		// returns the number of new required nodes
+		{{{
+			node * current = root;
+			std::list<int>::const_iterator wi;
+			int skip_prefixes = word.size() - prefix_count;
+			int new_queries = 0;
+
+			for(wi = word.begin(); wi != word.end() && current != NULL; wi++, skip_prefixes--) {
+				if(skip_prefixes <= 0)
+					if(current->mark_required())
+						new_queries++;
+				current = current->find_or_create_child(*wi);
+			}
+
+			if(current != NULL && current->mark_required())
+				new_queries++;
+
+			return new_queries;
+		}}}
+		bool resolve_query(const std::list<int> & word, answer & acceptance)
+		// returns true if known. lock-free.
+		{{{
+			node * n = find_descendant(word.begin(), word.end());
+
+			if(n != NULL && n->get_answer(acceptance)) {
+				__sync_fetch_and_add(&resolved_queries, 1);
+				return true;
+			}
+			return false;
+		}}}
+		bool resolve_or_add_query(const std::list<int> & word, answer & acceptance)
+		// returns true if known. otherwise marks knowledge as
+		// to-be-acquired and returns false.
+		{{{
+			node * n = find_or_create_descendant(word.begin(), word.end());
+
+			if(n == NULL)
+				return false;
+			if(n->get_answer(acceptance)) {
+				__sync_fetch_and_add(&resolved_queries, 1);
+				return true;
+			}
+			n->mark_required();
+			return false;
+		}}}
+
+		node * claim_query()
+		// atomically take the oldest pending query. returns NULL if
+		// no query is pending. the claimed node has to be answered
+		// via node::set_answer() or returned via release_query().
+		{{{
+			node * n = NULL;
+
+			pthread_mutex_lock(&pending_mutex);
+			while(!pending.empty()) {
+				node * c = pending.front();
+				pending.pop_front();
+				if(c->claim()) {
+					n = c;
+					break;
+				}
+			}
+			pthread_mutex_unlock(&pending_mutex);
+
+			return n;
+		}}}
+		int claim_queries(std::vector<node*> & into, int max_count)
+		// claim up to max_count queries at once. returns the number of
+		// claimed queries.
+		{{{
+			int count = 0;
+
+			into.clear();
+			pthread_mutex_lock(&pending_mutex);
+			while(!pending.empty() && count < max_count) {
+				node * c = pending.front();
+				pending.pop_front();
+				if(c->claim()) {
+					into.push_back(c);
+					count++;
+				}
+			}
+			pthread_mutex_unlock(&pending_mutex);
+
+			return count;
+		}}}
+		void release_query(node * n)
+		// give back a claimed query without answering it.
+		{{{
+			if(n->release())
+				enqueue(n);
+		}}}
+
+		int import_queries(knowledgebase<answer> & kb)
+		// mark all queries of kb (e.g. the knowledgebase of a learning
+		// algorithm) as required here. queries that are already known
+		// here are answered in kb right away. only the queries of kb
+		// are visited, not its tree. kb must not be used by another
+		// thread meanwhile. returns the number of queries that are
+		// now pending here.
+		{{{
+			std::list<std::list<int> > words;
+			std::list<std::list<int> >::iterator wi;
+			typename knowledgebase<answer>::iterator qi;
+			int pending_queries = 0;
+
+			// answering a query unlinks it from the query list of kb
+			for(qi = kb.qbegin(); qi != kb.qend(); ++qi)
+				words.push_back(qi->get_word());
+
+			for(wi = words.begin(); wi != words.end(); ++wi) {
+				answer a;
+				node * n = find_or_create_descendant(wi->begin(), wi->end());
+				if(n == NULL)
+					continue;
+				if(n->get_answer(a))
+					kb.add_knowledge(*wi, a);
+				else if(n->mark_required())
+					pending_queries++;
+			}
+
+			return pending_queries;
+		}}}
+		int sync_answers(knowledgebase<answer> & kb)
+		// add all answers that were given since the last call to kb.
+		// this is O(new answers) and may be called while other threads
+		// answer queries, but not from two threads at once. kb must not
+		// be used by another thread meanwhile. returns the number of
+		// answers that were added, or -1 if one of them contradicted
+		// the knowledge in kb.
+		{{{
+			std::vector<node*> fresh;
+			node * head = answer_log;
+			bool consistent = true;
+
+			for(node * n = head; n != synced_answer; n = n->next_answered)
+				fresh.push_back(n);
+			synced_answer = head;
+
+			// oldest first, so kb gets the answers in the same order
+			typename std::vector<node*>::reverse_iterator ni;
+			for(ni = fresh.rbegin(); ni != fresh.rend(); ++ni) {
+				std::list<int> w = (*ni)->get_word();
+				if(!kb.add_knowledge(w, (*ni)->get_answer()))
+					consistent = false;
+			}
+
+			return consistent ? (int)fresh.size() : -1;
+		}}}
+
+		std::basic_string<int32_t> serialize()
+		// same format as knowledgebase::serialize(). NOT thread-safe.
+		{{{
+			std::basic_string<int32_t> ret;
+			std::vector<std::pair<node*, int> > stack;
+
+			ret += 0; // sizeof, will be filled in later
+			ret += ::serialize((int)resolved_queries);
+
+			serialize_node(root, ret);
+			stack.push_back(std::pair<node*, int>(root, 0));
+			while(!stack.empty()) {
+				node * n = stack.back().first;
+				int & l = stack.back().second;
+				node * c = NULL;
+
+				while(l < alphabet_size && c == NULL)
+					c = n->find_child(l++);
+
+				if(c == NULL) {
+					stack.pop_back();
+				} else {
+					serialize_node(c, ret);
+					stack.push_back(std::pair<node*, int>(c, 0));
+				}
+			}
+
+			ret[0] = htonl(ret.size() - 1);
+
+			return ret;
+		}}}
+
+	protected:
+		void log_answer(node * n)
+		// lock-free push onto answer_log
+		{{{
+			node * h;
+
+			do {
+				h = answer_log;
+				n->next_answered = h;
+			} while(!__sync_bool_compare_and_swap(&answer_log, h, n));
+		}}}
+
+		void enqueue(node * n)
+		{{{
+			pthread_mutex_lock(&pending_mutex);
+			pending.push_back(n);
+			pthread_mutex_unlock(&pending_mutex);
+		}}}
+
+		void serialize_node(node * n, std::basic_string<int32_t> & into)
+		{{{
+			int st, childcount = 0;
+
+			st = n->status;
+			if(st == node::NODE_CLAIMED)
+				st = node::NODE_REQUIRED;
+
+			into += ::serialize(n->label);
+			into += ::serialize((unsigned int)n->timestamp);
+			into += ::serialize(st);
+			if(st == node::NODE_ANSWERED)
+				into += ::serialize(n->ans);
+
+			for(int l = 0; l < alphabet_size; l++)
+				if(n->find_child(l))
+					childcount++;
+			into += ::serialize(childcount);
+		}}}
+
+		void delete_tree()
+		{{{
+			std::vector<node*> stack;
+
+			if(root)
+				stack.push_back(root);
+			while(!stack.empty()) {
+				node * n = stack.back();
+				stack.pop_back();
+				if(n->children) {
+					for(int l = 0; l < alphabet_size; l++)
+						if(n->children[l])
+							stack.push_back((node*)n->children[l]);
+					delete[] n->children;
+				}
+				delete n;
+			}
+			root = NULL;
+		}}}
+
+}; // end of concurrent_knowledgebase
+
+}; // end of namespace libalf
+
+#endif // __libalf_knowledgebase_concurrent_h__
+
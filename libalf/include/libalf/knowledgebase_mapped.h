@@ -0,0 +1,606 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_knowledgebase_mapped_h__
+# define __libalf_knowledgebase_mapped_h__
+
+#ifndef _WIN32
+
+#include <list>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <libalf/answer.h>
+#include <libalf/knowledgebase.h>
+
+namespace libalf {
+
+/** Mapped knowledgebase - a knowledgebase file that is used in place
+ *
+ *  mapped_knowledgebase keeps membership information in a file that is
+ *  mmap()ed, so it can be queried directly after open(), without any
+ *  deserialization. new answers and queries are appended to the file.
+ *  opening a file only maps it, so restarting a session takes the same
+ *  time regardless of the size of the knowledgebase.
+ *
+ *  the file holds a header followed by fixed-size node records. a node
+ *  is always appended after its parent. the children of a node form a
+ *  singly linked list (newest first) via the record indices, so a
+ *  lookup walks at most alphabet-size records per letter. the root is
+ *  record 0, thus 0 also marks the end of a child list.
+ *
+ *  use save() to write a knowledgebase into a new file, append_changes()
+ *  to append what was added to a knowledgebase since the last call
+ *  (see knowledgebase::get_changes_since()) and load() to rebuild a
+ *  knowledgebase for the learning algorithms.
+ *
+ *  NOTE: the answers are stored as raw bytes, so answer has to be a
+ *        plain type (bool, extended_bool, int, ...). the file uses the
+ *        byte order and record layout of the host; open() rejects files
+ *        with a different layout.
+ *
+ *  NOTE: not available on _WIN32.
+ */
+template <class answer>
+class mapped_knowledgebase
+{
+	public: // types
+		typedef uint32_t node_index;
+		static const node_index no_node = 0xffffffffU;
+
+		enum status_e {
+			NODE_IGNORE = 0,
+			NODE_REQUIRED = 1,
+			NODE_ANSWERED = 2
+		};
+
+	protected: // types
+		struct file_header {
+			char magic[8];
+			uint32_t version;
+			uint32_t header_size;
+			uint32_t record_size;
+			uint32_t answer_size;
+			uint32_t nodecount;
+			uint32_t capacity; // number of records the file can hold
+			uint32_t answercount;
+			uint32_t querycount;
+			uint32_t timestamp;
+			uint32_t reserved[5];
+		};
+
+		struct record {
+			node_index parent;
+			node_index first_child;
+			node_index next_sibling;
+			uint32_t timestamp;
+			int32_t label;
+			uint8_t status;
+			answer ans;
+		};
+
+	protected: // data
+		int fd;
+		bool writable;
+		char * map;
+		size_t map_length;
+
+	public: // methods
+		mapped_knowledgebase()
+		{{{
+			fd = -1;
+			writable = false;
+			map = NULL;
+			map_length = 0;
+		}}}
+
+		~mapped_knowledgebase()
+		{{{
+			close();
+		}}}
+
+		bool open(const char * filename, bool writable = true, bool create = false)
+		// open (or create) a knowledgebase file. returns false if the
+		// file can't be opened or is not a compatible knowledgebase
+		// file.
+		{{{
+			struct stat st;
+
+			close();
+
+			fd = ::open(filename, (writable ? O_RDWR : O_RDONLY) | (create ? O_CREAT | O_TRUNC : 0), 0644);
+			if(fd < 0)
+				return false;
+			this->writable = writable;
+
+			if(create) {
+				file_header h;
+				memset(&h, 0, sizeof(h));
+				memcpy(h.magic, "LIBALFKB", 8);
+				h.version = 1;
+				h.header_size = sizeof(file_header);
+				h.record_size = sizeof(record);
+				h.answer_size = sizeof(answer);
+				h.capacity = 0;
+				h.timestamp = 1;
+				if(::write(fd, &h, sizeof(h)) != sizeof(h))
+					goto failed;
+				if(!map_file(sizeof(file_header)))
+					goto failed;
+				// root
+				if(new_record(0, -1) == no_node)
+					goto failed;
+				return true;
+			}
+
+			if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(file_header))
+				goto failed;
+			if(!map_file(st.st_size))
+				goto failed;
+			if(memcmp(header()->magic, "LIBALFKB", 8) != 0
+			   || header()->version != 1
+			   || header()->header_size != sizeof(file_header)
+			   || header()->record_size != sizeof(record)
+			   || header()->answer_size != sizeof(answer)
+			   || header()->nodecount < 1
+			   || header()->nodecount > header()->capacity
+			   || map_length < sizeof(file_header) + (size_t)header()->capacity * sizeof(record))
+				goto failed;
+
+			return true;
+
+		failed:
+			close();
+			return false;
+		}}}
+		void close()
+		{{{
+			if(map != NULL) {
+				munmap(map, map_length);
+				map = NULL;
+				map_length = 0;
+			}
+			if(fd >= 0) {
+				::close(fd);
+				fd = -1;
+			}
+		}}}
+		bool is_open() const
+		{ return map != NULL; }
+		bool sync()
+		// flush all changes to disk
+		{{{
+			if(map == NULL)
+				return false;
+			return msync(map, map_length, MS_SYNC) == 0;
+		}}}
+
+		bool reserve(node_index records)
+		// grow the file so it holds at least the given number of
+		// records.
+		{{{
+			size_t length;
+
+			if(!writable)
+				return false;
+			if(records <= header()->capacity)
+				return true;
+
+			length = sizeof(file_header) + (size_t)records * sizeof(record);
+			if(ftruncate(fd, length) != 0)
+				return false;
+			if(!map_file(length))
+				return false;
+			header()->capacity = records;
+
+			return true;
+		}}}
+
+		int count_nodes() const
+		{ return header()->nodecount; }
+		int count_answers() const
+		{ return header()->answercount; }
+		int count_queries() const
+		{ return header()->querycount; }
+		unsigned int get_timestamp() const
+		{ return header()->timestamp; }
+
+		unsigned long long int get_mapped_memory_usage() const
+		// bytes of the file mapping. these are backed by the file
+		// and can be dropped by the kernel at any time.
+		{{{
+			return map_length;
+		}}}
+		unsigned long long int get_private_memory_usage() const
+		// bytes this process owns: this object. no index or buffer is
+		// kept on the heap, all nodes live in the mapping.
+		{{{
+			return sizeof(*this);
+		}}}
+		unsigned long long int get_resident_mapped_memory_usage() const
+		// bytes of the mapping that are currently resident (found with
+		// mincore()). they are part of get_mapped_memory_usage(), not
+		// of get_private_memory_usage().
+		{{{
+			unsigned long long int ret = 0;
+			size_t pagesize = sysconf(_SC_PAGESIZE);
+			std::vector<unsigned char> resident;
+
+			if(map == NULL)
+				return 0;
+
+			resident.resize((map_length + pagesize - 1) / pagesize);
+			if(mincore(map, map_length, &resident[0]) != 0)
+				return map_length;
+			for(size_t p = 0; p < resident.size(); ++p)
+				if(resident[p] & 1)
+					ret += std::min(pagesize, map_length - p * pagesize);
+
+			return ret;
+		}}}
+		unsigned long long int get_memory_usage() const
+		// the mapping and this object
+		{{{
+			return get_mapped_memory_usage() + sizeof(*this);
+		}}}
+
+		// tree access
+
+		node_index get_root() const
+		{ return 0; }
+		bool find_child(node_index n, int label, node_index & child) const
+		{{{
+			node_index c;
+
+			for(c = rec(n)->first_child; c != 0; c = rec(c)->next_sibling) {
+				if(rec(c)->label == label) {
+					child = c;
+					return true;
+				}
+			}
+
+			return false;
+		}}}
+		bool find_descendant(std::list<int>::const_iterator infix_start, std::list<int>::const_iterator infix_limit, node_index & descendant) const
+		{{{
+			node_index n = 0;
+
+			for(/* nothing */; infix_start != infix_limit; ++infix_start)
+				if(!find_child(n, *infix_start, n))
+					return false;
+
+			descendant = n;
+			return true;
+		}}}
+		node_index find_or_create_child(node_index n, int label)
+		{{{
+			node_index c;
+
+			if(find_child(n, label, c))
+				return c;
+
+			c = new_record(n, label);
+			if(c == no_node)
+				return no_node;
+			// the record may have moved
+			rec(c)->next_sibling = rec(n)->first_child;
+			rec(n)->first_child = c;
+
+			return c;
+		}}}
+		node_index find_or_create_descendant(std::list<int>::const_iterator infix_start, std::list<int>::const_iterator infix_limit)
+		// returns no_node if the file can't grow
+		{{{
+			node_index n = 0;
+
+			for(/* nothing */; infix_start != infix_limit && n != no_node; ++infix_start)
+				n = find_or_create_child(n, *infix_start);
+
+			return n;
+		}}}
+		std::list<int> get_word(node_index n) const
+		{{{
+			std::list<int> w;
+
+			while(n != 0) {
+				w.push_front(rec(n)->label);
+				n = rec(n)->parent;
+			}
+
+			return w;
+		}}}
+		enum status_e get_status(node_index n) const
+		{ return (enum status_e)rec(n)->status; }
+		answer get_answer(node_index n) const
+		{ return rec(n)->ans; }
+		unsigned int get_timestamp(node_index n) const
+		{ return rec(n)->timestamp; }
+
+		// knowledge
+
+		bool resolve_query(const std::list<int> & word, answer & acceptance) const
+		// returns true if known. no changes to the file.
+		{{{
+			node_index n;
+
+			if(!find_descendant(word.begin(), word.end(), n) || rec(n)->status != NODE_ANSWERED)
+				return false;
+
+			acceptance = rec(n)->ans;
+			return true;
+		}}}
+		bool knowledge_exists(const std::list<int> & word) const
+		{{{
+			answer a;
+			return resolve_query(word, a);
+		}}}
+		bool set_answer(node_index n, answer acceptance)
+		// returns false in case of inconsistency
+		{{{
+			record * r = rec(n);
+
+			if(r->status == NODE_ANSWERED)
+				return ((answer)r->ans == (answer)acceptance);
+			if(r->status == NODE_REQUIRED)
+				header()->querycount--;
+
+			r->ans = acceptance;
+			r->timestamp = header()->timestamp++;
+			r->status = NODE_ANSWERED;
+			header()->answercount++;
+
+			return true;
+		}}}
+		bool mark_required(node_index n)
+		// returns true if node is now required, false if knowledge
+		// is already known.
+		{{{
+			record * r = rec(n);
+
+			if(r->status == NODE_IGNORE) {
+				r->status = NODE_REQUIRED;
+				r->timestamp = header()->timestamp;
+				header()->querycount++;
+			}
+			return r->status == NODE_REQUIRED;
+		}}}
+		bool add_knowledge(const std::list<int> & word, answer acceptance)
+		// will return false if knowledge for this word was already set
+		// and is != acceptance.
+		{{{
+			node_index n;
+
+			if(!writable)
+				return false;
+			n = find_or_create_descendant(word.begin(), word.end());
+			return n != no_node && set_answer(n, acceptance);
+		}}}
+		bool add_query(const std::list<int> & word)
+		{{{
+			node_index n;
+
+			if(!writable)
+				return false;
+			n = find_or_create_descendant(word.begin(), word.end());
+			return n != no_node && mark_required(n);
+		}}}
+		std::list<std::list<int> > get_queries() const
+		// all queries in order of their records
+		{{{
+			std::list<std::list<int> > ret;
+			node_index n, count = header()->nodecount;
+
+			for(n = 0; n < count; ++n)
+				if(rec(n)->status == NODE_REQUIRED)
+					ret.push_back(get_word(n));
+
+			return ret;
+		}}}
+
+		// conversion from/to knowledgebase
+
+		bool save(knowledgebase<answer> & kb, const char * filename)
+		// create a new file holding all knowledge and queries of kb,
+		// with their timestamps.
+		{{{
+			typename knowledgebase<answer>::iterator ki;
+			// prefix-order visits parents first, so the path to
+			// the current node is a stack.
+			std::vector<std::pair<typename knowledgebase<answer>::node*, node_index> > path;
+
+			if(!open(filename, true, true))
+				return false;
+			if(!reserve(kb.count_nodes() + 1))
+				return false;
+
+			for(ki = kb.begin(); ki != kb.end(); ++ki) {
+				typename knowledgebase<answer>::node * n = &*ki;
+				node_index i;
+
+				if(n->get_parent() == NULL) {
+					i = 0;
+				} else {
+					while(path.back().first != n->get_parent())
+						path.pop_back();
+					i = find_or_create_child(path.back().second, n->get_label());
+					if(i == no_node)
+						return false;
+				}
+				path.push_back(std::pair<typename knowledgebase<answer>::node*, node_index>(n, i));
+
+				if(n->is_answered())
+					set_answer(i, n->get_answer());
+				else if(n->is_required())
+					mark_required(i);
+				rec(i)->timestamp = n->get_timestamp();
+			}
+			header()->timestamp = kb.get_timestamp();
+
+			return true;
+		}}}
+		unsigned int append_changes(knowledgebase<answer> & kb, unsigned int since)
+		// append all queries and answers added to kb since the given
+		// timestamp (see knowledgebase::get_changes_since()), with
+		// their timestamps in kb, as save() does. returns the
+		// timestamp to pass to the next call.
+		{{{
+			std::list<const typename knowledgebase<answer>::node*> queries, answers;
+			typename std::list<const typename knowledgebase<answer>::node*>::iterator ni;
+
+			since = kb.get_changes_since(since, queries, answers);
+
+			for(ni = queries.begin(); ni != queries.end(); ++ni)
+				append_node(*ni);
+			for(ni = answers.begin(); ni != answers.end(); ++ni)
+				append_node(*ni);
+			if(writable && kb.get_timestamp() > header()->timestamp)
+				header()->timestamp = kb.get_timestamp();
+
+			return since;
+		}}}
+		bool load(knowledgebase<answer> & kb) const
+		// rebuild a knowledgebase from this file, including the
+		// timestamps of queries and answers, so
+		// knowledgebase::get_changes_since() keeps working across a
+		// restart. kb is cleared first.
+		{{{
+			std::vector<typename knowledgebase<answer>::node*> nodes;
+			std::vector<std::pair<typename knowledgebase<answer>::node*, unsigned int> > stamps;
+			node_index n, count = header()->nodecount;
+
+			kb.clear();
+			nodes.resize(count);
+			nodes[0] = kb.get_rootptr();
+
+			for(n = 0; n < count; ++n) {
+				const record * r = rec(n);
+
+				if(n != 0) {
+					if(r->parent >= n)
+						return false;
+					nodes[n] = nodes[r->parent]->find_or_create_child(r->label);
+				}
+
+				if(r->status == NODE_ANSWERED)
+					nodes[n]->set_answer(r->ans);
+				else if(r->status == NODE_REQUIRED)
+					nodes[n]->mark_required();
+				else
+					continue;
+				stamps.push_back(std::pair<typename knowledgebase<answer>::node*, unsigned int>(nodes[n], r->timestamp));
+			}
+			kb.restore_timestamps(stamps);
+
+			return true;
+		}}}
+
+	protected:
+		bool append_node(const typename knowledgebase<answer>::node * n)
+		// add the query or answer of n, with the timestamp of n
+		{{{
+			std::list<int> w = n->get_word();
+			node_index i;
+
+			if(!writable)
+				return false;
+			i = find_or_create_descendant(w.begin(), w.end());
+			if(i == no_node)
+				return false;
+			if(n->is_answered()) {
+				if(!set_answer(i, n->get_answer()))
+					return false;
+			} else {
+				// already answered in the file: keep that
+				if(!mark_required(i))
+					return false;
+			}
+			rec(i)->timestamp = n->get_timestamp();
+
+			return true;
+		}}}
+
+		file_header * header() const
+		{ return (file_header*)map; }
+		record * rec(node_index n) const
+		{ return (record*)(map + sizeof(file_header)) + n; }
+
+		bool map_file(size_t length)
+		{{{
+			void * m;
+
+			if(map != NULL)
+				munmap(map, map_length);
+			map = NULL;
+			map_length = 0;
+
+			m = mmap(NULL, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+			if(m == MAP_FAILED)
+				return false;
+
+			map = (char*)m;
+			map_length = length;
+			return true;
+		}}}
+
+		node_index new_record(node_index parent, int label)
+		// append a new record. this may remap the file, so all
+		// record pointers are invalid afterwards. returns no_node
+		// if the file can't grow.
+		{{{
+			node_index n = header()->nodecount;
+			record * r;
+
+			if(n == header()->capacity)
+				if(!reserve(n < 512 ? 1024 : n * 2))
+					return no_node;
+
+			r = rec(n);
+			memset(r, 0, sizeof(record));
+			r->parent = parent;
+			r->label = label;
+			r->status = NODE_IGNORE;
+			header()->nodecount++;
+
+			return n;
+		}}}
+
+}; // end of mapped_knowledgebase
+
+template <class answer>
+const typename mapped_knowledgebase<answer>::node_index mapped_knowledgebase<answer>::no_node;
+
+}; // end of namespace libalf
+
+#endif // _WIN32
+
+#endif // __libalf_knowledgebase_mapped_h__
+
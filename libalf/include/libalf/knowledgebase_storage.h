@@ -0,0 +1,330 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+
+#ifndef __libalf_knowledgebase_storage_h__
+# define __libalf_knowledgebase_storage_h__
+
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+
+namespace libalf {
+
+/** storage backends for the nodes of a knowledgebase
+ *
+ *  knowledgebase<answer, storage> constructs, links and destroys its nodes
+ *  only through a storage<node>. each node holds a storage<node>::node_data
+ *  with whatever the backend needs to find its children.
+ *
+ *  a node may have children for labels [0 .. slot_count(node)). its children
+ *  are also linked via first_child() and next_sibling() in ascending order
+ *  of labels; the knowledgebase keeps that order, the storage only keeps
+ *  the links.
+ *
+ *  arena_storage (the default) constructs the nodes in large chunks and
+ *  keeps the children of all nodes in one array of 32-bit indices. so
+ *  adding a word does not allocate per node, and clear() keeps the chunks
+ *  for reuse.
+ *
+ *  heap_storage allocates every node on its own, with a vector of pointers
+ *  to its children. it is kept for comparison (see
+ *  testsuites/knowledgebase_arena).
+ *
+ *  with both, node pointers stay valid until the node is removed.
+ */
+template <class node>
+class arena_storage {
+	public: // types
+		typedef uint32_t node_index;
+		static const node_index no_node = 0xffffffffU;
+
+		class node_data {
+			friend class arena_storage<node>;
+			protected:
+				node_index index;
+				// index of the node in the arena
+				node_index child_block;
+				// number of the block of children of the
+				// node, or no_node if it has none. slot
+				// (child_block * block_size + label) holds
+				// the index of the child with that label or
+				// no_node.
+				node_index first_child;
+				node_index next_sibling;
+			public:
+				node_data()
+				{{{
+					index = no_node;
+					child_block = no_node;
+					first_child = no_node;
+					next_sibling = no_node;
+				}}}
+		};
+
+	protected: // data
+		// node i lives in node_chunks[i >> node_chunk_bits].
+		// chunks are never moved, so node pointers stay valid.
+		enum { node_chunk_bits = 10 };
+		std::vector<node *> node_chunks;
+		node_index node_slots; // number of node slots ever used
+		std::vector<node_index> free_nodes;
+		// children of all nodes, one block of block_size slots per
+		// node that has children.
+		std::vector<node_index> child_slots;
+		unsigned int block_size;
+		std::vector<node_index> free_blocks;
+
+	protected: // methods
+		node * node_at(node_index i) const
+		{{{
+			return (i == no_node) ? NULL : node_chunks[i >> node_chunk_bits] + (i & ((1 << node_chunk_bits) - 1));
+		}}}
+		node_index new_block()
+		{{{
+			node_index b;
+
+			if(!free_blocks.empty()) {
+				b = free_blocks.back();
+				free_blocks.pop_back();
+			} else {
+				b = child_slots.size() / block_size;
+				child_slots.resize(child_slots.size() + block_size, no_node);
+			}
+
+			return b;
+		}}}
+		void free_block(node_index b)
+		{{{
+			std::fill(child_slots.begin() + b * block_size, child_slots.begin() + (b + 1) * block_size, no_node);
+			free_blocks.push_back(b);
+		}}}
+		void grow(unsigned int size)
+		// make every block at least size slots long. blocks keep
+		// their numbers, so only the slots are moved. this is done
+		// by doubling.
+		{{{
+			unsigned int new_size = block_size ? block_size : 2;
+			while(new_size < size)
+				new_size *= 2;
+
+			unsigned int blocks = block_size ? child_slots.size() / block_size : 0;
+			std::vector<node_index> slots(blocks * new_size, no_node);
+			for(unsigned int b = 0; b < blocks; b++)
+				std::copy(child_slots.begin() + b * block_size, child_slots.begin() + (b + 1) * block_size,
+					  slots.begin() + b * new_size);
+
+			child_slots.swap(slots);
+			block_size = new_size;
+		}}}
+
+	public: // methods
+		arena_storage()
+		{{{
+			node_slots = 0;
+			block_size = 0;
+		}}}
+		~arena_storage()
+		// all nodes have to be destroyed before
+		{{{
+			for(typename std::vector<node *>::iterator ci = node_chunks.begin(); ci != node_chunks.end(); ++ci)
+				::operator delete(*ci);
+		}}}
+
+		template <class base_type>
+		node * create(base_type * base)
+		// construct a fresh node in the arena
+		{{{
+			node_index i;
+
+			if(!free_nodes.empty()) {
+				i = free_nodes.back();
+				free_nodes.pop_back();
+			} else {
+				i = node_slots++;
+				if((i >> node_chunk_bits) >= node_chunks.size())
+					node_chunks.push_back((node*) ::operator new(sizeof(node) << node_chunk_bits));
+			}
+
+			node * n = new (node_at(i)) node(base);
+			n->data.index = i;
+			return n;
+		}}}
+		void destroy(node * n)
+		// the children of n have to be destroyed before
+		{{{
+			release_children(n);
+			free_nodes.push_back(n->data.index);
+			n->~node();
+		}}}
+		void clear()
+		// all nodes have been destroyed. the chunks are kept for
+		// reuse.
+		{{{
+			node_slots = 0;
+			free_nodes.clear();
+			child_slots.clear();
+			free_blocks.clear();
+		}}}
+
+		unsigned int slot_count(const node * n) const
+		{{{
+			return (n->data.child_block == no_node) ? 0 : block_size;
+		}}}
+		node * child(const node * n, unsigned int label) const
+		// label < slot_count(n)
+		{{{
+			return node_at(child_slots[n->data.child_block * block_size + label]);
+		}}}
+		node * first_child(const node * n) const
+		{{{
+			return node_at(n->data.first_child);
+		}}}
+		node * next_sibling(const node * n) const
+		{{{
+			return node_at(n->data.next_sibling);
+		}}}
+		void set_child(node * n, unsigned int label, node * c)
+		// c may be NULL to clear the slot. this does not move
+		// any node.
+		{{{
+			if(c == NULL && label >= slot_count(n))
+				return;
+			if(label >= block_size)
+				grow(label + 1);
+			if(n->data.child_block == no_node)
+				n->data.child_block = new_block();
+
+			child_slots[n->data.child_block * block_size + label] = c ? c->data.index : no_node;
+		}}}
+		void set_first_child(node * n, node * c)
+		{{{
+			n->data.first_child = c ? c->data.index : no_node;
+		}}}
+		void set_next_sibling(node * n, node * c)
+		{{{
+			n->data.next_sibling = c ? c->data.index : no_node;
+		}}}
+		void release_children(node * n)
+		// n has no children anymore. gives its block back.
+		{{{
+			if(n->data.child_block != no_node) {
+				free_block(n->data.child_block);
+				n->data.child_block = no_node;
+			}
+			n->data.first_child = no_node;
+		}}}
+
+		unsigned long long int get_memory_usage(const node * n) const
+		// the node and its block of children. chunks and blocks
+		// that are reserved but not used are not counted.
+		{{{
+			return sizeof(node) + sizeof(node_index) * slot_count(n);
+		}}}
+};
+
+template <class node>
+const typename arena_storage<node>::node_index arena_storage<node>::no_node;
+
+template <class node>
+class heap_storage {
+	public: // types
+		class node_data {
+			friend class heap_storage<node>;
+			protected:
+				std::vector<node *> children;
+				// NULL is a valid placeholder for
+				// non-existing sub-trees
+				node * first_child;
+				node * next_sibling;
+			public:
+				node_data()
+				{{{
+					first_child = NULL;
+					next_sibling = NULL;
+				}}}
+		};
+
+	public: // methods
+		template <class base_type>
+		node * create(base_type * base)
+		{{{
+			return new node(base);
+		}}}
+		void destroy(node * n)
+		{{{
+			delete n;
+		}}}
+		void clear()
+		{ }
+
+		unsigned int slot_count(const node * n) const
+		{{{
+			return n->data.children.size();
+		}}}
+		node * child(const node * n, unsigned int label) const
+		{{{
+			return n->data.children[label];
+		}}}
+		node * first_child(const node * n) const
+		{{{
+			return n->data.first_child;
+		}}}
+		node * next_sibling(const node * n) const
+		{{{
+			return n->data.next_sibling;
+		}}}
+		void set_child(node * n, unsigned int label, node * c)
+		{{{
+			if(label >= n->data.children.size()) {
+				if(c == NULL)
+					return;
+				n->data.children.resize(label + 1, NULL);
+			}
+			n->data.children[label] = c;
+		}}}
+		void set_first_child(node * n, node * c)
+		{{{
+			n->data.first_child = c;
+		}}}
+		void set_next_sibling(node * n, node * c)
+		{{{
+			n->data.next_sibling = c;
+		}}}
+		void release_children(node * n)
+		{{{
+			std::vector<node *>().swap(n->data.children);
+			n->data.first_child = NULL;
+		}}}
+
+		unsigned long long int get_memory_usage(const node * n) const
+		{{{
+			return sizeof(node) + sizeof(node *) * n->data.children.capacity();
+		}}}
+};
+
+}; // end of namespace libalf
+
+#endif // __libalf_knowledgebase_storage_h__
@@ -306,6 +306,12 @@ class learning_algorithm {
 
 		// in case the hypothesis is wrong, use this function to give a counter-example
 		virtual bool add_counterexample(std::list<int>) = 0;
+		bool add_counterexample(const packed_word & counterexample)
+		// NOTE: derived classes overriding the list-version need
+		// `using ...::add_counterexample;` to keep this visible.
+		{{{
+			return add_counterexample(counterexample.to_list());
+		}}};
 
 	protected:
 		// complete table in such a way that an automaton can be derived
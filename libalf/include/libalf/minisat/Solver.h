@@ -146,6 +146,7 @@ public:
              , default_params   (SearchParams(0.95, 0.999, 0.02))
              , expensive_ccmin  (true)
              , verbosity        (0)
+             , interrupt        (NULL)
              , progress_estimate(0)
              {
                 vec<Lit> dummy(2,lit_Undef);
@@ -185,6 +186,7 @@ public:
     SearchParams    default_params;     // Restart frequency etc.
     bool            expensive_ccmin;    // Controls conflict clause minimization. TRUE by default.
     int             verbosity;          // Verbosity level. 0=silent, 1=some progress report, 2=everything
+    const volatile bool* interrupt;     // If not NULL, 'solve()' gives up and returns FALSE as soon as '*interrupt' is TRUE (may be set by another thread).
 
     // Problem specification:
     //
@@ -198,6 +200,7 @@ public:
     // Solving:
     //
     bool    okay() { return ok; }       // FALSE means solver is in an conflicting state (must never be used again!)
+    bool    interrupted() const { return interrupt != NULL && *interrupt; }
     void    simplifyDB();
     bool    solve(const vec<Lit>& assumps);
     bool    solve() { vec<Lit> tmp; return solve(tmp); }
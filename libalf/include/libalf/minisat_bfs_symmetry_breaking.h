@@ -0,0 +1,234 @@
+/*
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008 - 2012 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *             and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: Daniel Neider <neider@automata.rwth-aachen.de>
+ *
+ */
+
+/*
+ * Symmetry breaking for the SAT encodings of the MiniSat-based inferring
+ * algorithms: the states of a conjecture are forced to be numbered in the
+ * order a breadth-first search visits them (Ulyantsev, Zakirzyanov and
+ * Shalyto, "BFS-based symmetry breaking predicates for DFA identification").
+ *
+ * The search starts with the initial states, which therefore are 0, 1, ...,
+ * and visits the successors of a state in the order of the smallest letter
+ * leading to them. Every automaton in which all states are reachable has
+ * exactly one such numbering (up to the order of initial states and of
+ * successors reached by the same smallest letter). As states can always be
+ * made reachable by copying a reachable state, the constraints do not change
+ * whether there is a conjecture with n states. But the solver no longer has
+ * to refute all n! numberings of each candidate, which makes the
+ * unsatisfiable steps of the search much cheaper.
+ */
+
+#ifndef __ALGORITHM_MINISAT_BFS_SYMMETRY_BREAKING__
+#define __ALGORITHM_MINISAT_BFS_SYMMETRY_BREAKING__
+
+// Standard includes
+#include <map>
+
+// MiniSat includes
+#include "libalf/minisat/Solver.h"
+
+namespace libalf {
+
+/**
+ * Adds the BFS symmetry breaking constraints to an encoding.
+ *
+ * @param solver The solver holding the encoding
+ * @param initial The variables initial[q] that are true iff q is an initial
+ *                state (the states of the empty word)
+ * @param d The variables d[p][a][q] that are true iff there is a transition
+ *          from p to q labeled with a
+ * @param n The number of states
+ * @param alphabet_size The size of the alphabet
+ * @param var_count Is increased by the number of variables created
+ * @param clause_count Is increased by the number of clauses added
+ */
+inline void add_bfs_symmetry_breaking(MiniSat::Solver & solver, std::map<int, MiniSat::Var> & initial, std::map<int, std::map<int, std::map<int, MiniSat::Var> > > & d, unsigned int n, int alphabet_size, unsigned long & var_count, unsigned long long & clause_count) {
+
+	/*========================================
+	 *
+	 * Create variables
+	 *
+	 *========================================*/
+
+	// There is a transition from i to j (i < j)
+	std::map<int, std::map<int, MiniSat::Var> > t; // t_{i, j}
+	// i is the parent of j in the BFS tree (i < j)
+	std::map<int, std::map<int, MiniSat::Var> > p; // p_{j, i}
+	// a is the smallest letter of a transition from i to j (i < j)
+	std::map<int, std::map<int, std::map<int, MiniSat::Var> > > m; // m_{i, a, j}
+
+	for(unsigned int j=0; j<n; j++) {
+		for(unsigned int i=0; i<j; i++) {
+
+			t[i][j] = solver.newVar();
+			p[j][i] = solver.newVar();
+			var_count += 2;
+
+			for(int a=0; a<alphabet_size; a++) {
+				m[i][a][j] = solver.newVar();
+				var_count++;
+			}
+
+		}
+	}
+
+
+	/*========================================
+	 *
+	 * Create clauses
+	 *
+	 *========================================*/
+
+	// (B1) State 0 is initial, and the initial states come first
+	solver.addUnit(MiniSat::Lit(initial[0]));
+	clause_count++;
+	for(unsigned int j=1; j<n; j++) {
+		solver.addBinary(~MiniSat::Lit(initial[j]), MiniSat::Lit(initial[j-1]));
+		clause_count++;
+	}
+
+	// (B2) t[i][j] <=> OR_a d[i][a][j]
+	for(unsigned int j=0; j<n; j++) {
+		for(unsigned int i=0; i<j; i++) {
+
+			MiniSat::vec<MiniSat::Lit> clause;
+			clause.push(~MiniSat::Lit(t[i][j]));
+			for(int a=0; a<alphabet_size; a++) {
+
+				clause.push(MiniSat::Lit(d[i][a][j]));
+
+				solver.addBinary(~MiniSat::Lit(d[i][a][j]), MiniSat::Lit(t[i][j]));
+				clause_count++;
+
+			}
+			solver.addClause(clause);
+			clause_count++;
+
+		}
+	}
+
+	// (B3) p[j][i] <=> !initial[j] && t[i][j] && AND_{k<i} !t[k][j]
+	for(unsigned int j=1; j<n; j++) {
+		for(unsigned int i=0; i<j; i++) {
+
+			solver.addBinary(~MiniSat::Lit(p[j][i]), ~MiniSat::Lit(initial[j]));
+			solver.addBinary(~MiniSat::Lit(p[j][i]), MiniSat::Lit(t[i][j]));
+			clause_count += 2;
+
+			MiniSat::vec<MiniSat::Lit> clause;
+			clause.push(MiniSat::Lit(p[j][i]));
+			clause.push(MiniSat::Lit(initial[j]));
+			clause.push(~MiniSat::Lit(t[i][j]));
+			for(unsigned int k=0; k<i; k++) {
+
+				clause.push(MiniSat::Lit(t[k][j]));
+
+				solver.addBinary(~MiniSat::Lit(p[j][i]), ~MiniSat::Lit(t[k][j]));
+				clause_count++;
+
+			}
+			solver.addClause(clause);
+			clause_count++;
+
+		}
+	}
+
+	// (B4) Each state that is not initial has a parent
+	for(unsigned int j=1; j<n; j++) {
+
+		MiniSat::vec<MiniSat::Lit> clause;
+		clause.push(MiniSat::Lit(initial[j]));
+		for(unsigned int i=0; i<j; i++) {
+			clause.push(MiniSat::Lit(p[j][i]));
+		}
+		solver.addClause(clause);
+		clause_count++;
+
+	}
+
+	// (B5) Parents are visited in order: p[j][i] => !p[j+1][k] for k < i
+	for(unsigned int j=1; j+1<n; j++) {
+		for(unsigned int i=0; i<j; i++) {
+			for(unsigned int k=0; k<i; k++) {
+
+				solver.addBinary(~MiniSat::Lit(p[j][i]), ~MiniSat::Lit(p[j+1][k]));
+				clause_count++;
+
+			}
+		}
+	}
+
+	if(alphabet_size < 2) {
+		return;
+	}
+
+	// (B6) m[i][a][j] <=> d[i][a][j] && AND_{b<a} !d[i][b][j]
+	for(unsigned int j=1; j<n; j++) {
+		for(unsigned int i=0; i<j; i++) {
+			for(int a=0; a<alphabet_size; a++) {
+
+				solver.addBinary(~MiniSat::Lit(m[i][a][j]), MiniSat::Lit(d[i][a][j]));
+				clause_count++;
+
+				MiniSat::vec<MiniSat::Lit> clause;
+				clause.push(MiniSat::Lit(m[i][a][j]));
+				clause.push(~MiniSat::Lit(d[i][a][j]));
+				for(int b=0; b<a; b++) {
+
+					clause.push(MiniSat::Lit(d[i][b][j]));
+
+					solver.addBinary(~MiniSat::Lit(m[i][a][j]), ~MiniSat::Lit(d[i][b][j]));
+					clause_count++;
+
+				}
+				solver.addClause(clause);
+				clause_count++;
+
+			}
+		}
+	}
+
+	// (B7) Children of the same parent are visited in the order of their
+	// smallest letters: p[j][i] && p[j+1][i] && m[i][a][j] => !m[i][b][j+1] for b < a
+	for(unsigned int j=1; j+1<n; j++) {
+		for(unsigned int i=0; i<j; i++) {
+			for(int a=1; a<alphabet_size; a++) {
+				for(int b=0; b<a; b++) {
+
+					MiniSat::vec<MiniSat::Lit> clause;
+					clause.push(~MiniSat::Lit(p[j][i]));
+					clause.push(~MiniSat::Lit(p[j+1][i]));
+					clause.push(~MiniSat::Lit(m[i][a][j]));
+					clause.push(~MiniSat::Lit(m[i][b][j+1]));
+					solver.addClause(clause);
+					clause_count++;
+
+				}
+			}
+		}
+	}
+
+}
+
+}; // End libalf namespace
+
+#endif
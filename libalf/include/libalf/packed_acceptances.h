@@ -0,0 +1,517 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_packed_acceptances_h__
+# define __libalf_packed_acceptances_h__
+
+#include <vector>
+#include <string>
+
+#include <stdint.h>
+
+#include <libalf/answer.h>
+#include <libalf/serialize.h>
+
+namespace libalf {
+
+/*
+ * packed_answer_traits<answer> describe how an answer is stored in a
+ * packed_acceptances row: in how many bits, and how to find all lanes of a
+ * block that hold true or false. lane masks have the lowest bit of each
+ * lane set. only answer types with such an encoding can be packed.
+ */
+template <class answer>
+class packed_answer_traits;
+
+template <>
+class packed_answer_traits<bool> {
+	public:
+		enum { bits = 1 };
+		static uint64_t encode(bool a)
+		{ return a ? 1 : 0; }
+		static bool decode(uint64_t code)
+		{ return code != 0; }
+		static uint64_t true_lanes(uint64_t block)
+		{ return block; }
+		static uint64_t false_lanes(uint64_t block)
+		{ return ~block; }
+		// all bits of the given lanes
+		static uint64_t lane_bits(uint64_t lanes)
+		{ return lanes; }
+		// the given lanes set to true
+		static uint64_t true_code(uint64_t lanes)
+		{ return lanes; }
+};
+
+// extended_bool uses its enum value: 00 false, 01 unknown, 10 true
+template <>
+class packed_answer_traits<extended_bool> {
+	public:
+		enum { bits = 2 };
+		static uint64_t encode(const extended_bool & a)
+		{ return a.value; }
+		static extended_bool decode(uint64_t code)
+		{ return extended_bool((enum extended_bool::e_extended_bool)code); }
+		static uint64_t true_lanes(uint64_t block)
+		{ return (block >> 1) & ~block & 0x5555555555555555ULL; }
+		static uint64_t false_lanes(uint64_t block)
+		{ return ~(block >> 1) & ~block & 0x5555555555555555ULL; }
+		static uint64_t lane_bits(uint64_t lanes)
+		{ return lanes | (lanes << 1); }
+		static uint64_t true_code(uint64_t lanes)
+		{ return lanes << 1; }
+};
+
+/*
+ * packed_acceptances - a row of answers, bit-packed into 64bit blocks.
+ *
+ * this is a drop-in replacement for std::vector<answer> as acceptance row of
+ * the observation tables (see acceptances_for<> below), for the answer types
+ * that have packed_answer_traits. besides the usual container interface it
+ * offers the operations of the tables (equality, covering, joining rows) as
+ * loops over whole blocks, which the compiler can vectorize.
+ *
+ * unused bits in the last block are always 0.
+ */
+template <class answer>
+class packed_acceptances {
+	public: // types
+		typedef answer value_type;
+		typedef uint64_t block;
+		typedef packed_answer_traits<answer> traits;
+		enum { bits = traits::bits, lanes = 64 / traits::bits };
+
+		class reference {
+			protected:
+				packed_acceptances * row;
+				unsigned int i;
+			public:
+				reference(packed_acceptances * row, unsigned int i)
+				{ this->row = row; this->i = i; }
+				operator answer() const
+				{ return row->get(i); }
+				reference & operator=(const answer & a)
+				{ row->set(i, a); return *this; }
+				reference & operator=(const reference & other)
+				{ row->set(i, other.row->get(other.i)); return *this; }
+				bool operator==(const answer & a) const
+				{ return row->get(i) == a; }
+				bool operator!=(const answer & a) const
+				{ return !(row->get(i) == a); }
+		};
+
+		class const_iterator {
+			protected:
+				const packed_acceptances * row;
+				unsigned int i;
+			public:
+				const_iterator()
+				{ row = NULL; i = 0; }
+				const_iterator(const packed_acceptances * row, unsigned int i)
+				{ this->row = row; this->i = i; }
+				answer operator*() const
+				{ return row->get(i); }
+				const_iterator & operator++()
+				{ ++i; return *this; }
+				const_iterator operator++(int)
+				{ const_iterator tmp = *this; ++i; return tmp; }
+				const_iterator & operator--()
+				{ --i; return *this; }
+				bool operator==(const const_iterator & other) const
+				{ return i == other.i && row == other.row; }
+				bool operator!=(const const_iterator & other) const
+				{ return i != other.i || row != other.row; }
+				bool operator<(const const_iterator & other) const
+				{ return i < other.i; }
+		};
+
+		class iterator {
+			protected:
+				packed_acceptances * row;
+				unsigned int i;
+			public:
+				iterator()
+				{ row = NULL; i = 0; }
+				iterator(packed_acceptances * row, unsigned int i)
+				{ this->row = row; this->i = i; }
+				reference operator*() const
+				{ return reference(row, i); }
+				iterator & operator++()
+				{ ++i; return *this; }
+				iterator operator++(int)
+				{ iterator tmp = *this; ++i; return tmp; }
+				iterator & operator--()
+				{ --i; return *this; }
+				bool operator==(const iterator & other) const
+				{ return i == other.i && row == other.row; }
+				bool operator!=(const iterator & other) const
+				{ return i != other.i || row != other.row; }
+				bool operator<(const iterator & other) const
+				{ return i < other.i; }
+				operator const_iterator() const
+				{ return const_iterator(row, i); }
+		};
+
+	protected: // data
+		std::vector<block> blocks;
+		unsigned int length;
+
+	public: // methods
+		packed_acceptances()
+		{ length = 0; }
+
+		explicit packed_acceptances(unsigned int count, const answer & a = answer())
+		{ length = 0; assign(count, a); }
+
+		unsigned int size() const
+		{ return length; }
+		bool empty() const
+		{ return length == 0; }
+
+		void clear()
+		{{{
+			blocks.clear();
+			length = 0;
+		}}}
+
+		void reserve(unsigned int count)
+		{ blocks.reserve((count + lanes - 1) / lanes); }
+
+		answer get(unsigned int i) const
+		// no range check
+		{ return traits::decode((blocks[i / lanes] >> ((i % lanes) * bits)) & lane_mask()); }
+
+		void set(unsigned int i, const answer & a)
+		// no range check
+		{{{
+			unsigned int shift = (i % lanes) * bits;
+			block & b = blocks[i / lanes];
+			b = (b & ~(lane_mask() << shift)) | (traits::encode(a) << shift);
+		}}}
+
+		answer operator[](unsigned int i) const
+		{ return get(i); }
+		reference operator[](unsigned int i)
+		{ return reference(this, i); }
+
+		answer front() const
+		{ return get(0); }
+		answer back() const
+		{ return get(length - 1); }
+
+		void push_back(const answer & a)
+		{{{
+			if(length % lanes == 0)
+				blocks.push_back(0);
+			length++;
+			set(length - 1, a);
+		}}}
+
+		void pop_back()
+		{{{
+			length--;
+			if(length % lanes == 0)
+				blocks.pop_back();
+			else
+				clear_tail();
+		}}}
+
+		void assign(unsigned int count, const answer & a)
+		{{{
+			block pattern = traits::encode(a) * (~(block)0 / lane_mask());
+
+			length = count;
+			blocks.assign((count + lanes - 1) / lanes, pattern);
+			clear_tail();
+		}}}
+
+		void resize(unsigned int count, const answer & a = answer())
+		{{{
+			if(count < length) {
+				length = count;
+				blocks.resize((count + lanes - 1) / lanes);
+				clear_tail();
+			} else {
+				reserve(count);
+				while(length < count)
+					push_back(a);
+			}
+		}}}
+
+		void swap(packed_acceptances & other)
+		{{{
+			unsigned int l = length;
+			blocks.swap(other.blocks);
+			length = other.length;
+			other.length = l;
+		}}}
+
+		const_iterator begin() const
+		{ return const_iterator(this, 0); }
+		const_iterator end() const
+		{ return const_iterator(this, length); }
+		iterator begin()
+		{ return iterator(this, 0); }
+		iterator end()
+		{ return iterator(this, length); }
+
+		bool operator==(const packed_acceptances & other) const
+		{{{
+			if(length != other.length)
+				return false;
+			for(unsigned int i = 0; i < blocks.size(); i++)
+				if(blocks[i] != other.blocks[i])
+					return false;
+			return true;
+		}}}
+		bool operator!=(const packed_acceptances & other) const
+		{ return !(*this == other); }
+
+		// there is no column where this is false and other is true.
+		// false if the sizes differ.
+		bool covers(const packed_acceptances & other) const
+		{{{
+			block noncover = 0;
+
+			if(length != other.length)
+				return false;
+			for(unsigned int i = 0; i < blocks.size(); i++)
+				noncover |= traits::false_lanes(blocks[i]) & traits::true_lanes(other.blocks[i]);
+			return noncover == 0;
+		}}}
+
+		// neither covers the other in the first min(size(), other.size())
+		// columns.
+		bool mutual_noncover(const packed_acceptances & other) const
+		{{{
+			unsigned int common = length < other.length ? length : other.length;
+			unsigned int count = (common + lanes - 1) / lanes;
+			block this_noncover = 0, other_noncover = 0;
+
+			for(unsigned int i = 0; i < count; i++) {
+				block mask = ~(block)0;
+				if(i == count - 1 && common % lanes)
+					mask = ((block)1 << ((common % lanes) * bits)) - 1;
+				this_noncover |= traits::false_lanes(blocks[i]) & traits::true_lanes(other.blocks[i]) & mask;
+				other_noncover |= traits::true_lanes(blocks[i]) & traits::false_lanes(other.blocks[i]) & mask;
+			}
+			return this_noncover != 0 && other_noncover != 0;
+		}}}
+
+		// set all columns to true where other is true
+		// (in the first min(size(), other.size()) columns)
+		void join(const packed_acceptances & other)
+		{{{
+			unsigned int count = blocks.size() < other.blocks.size() ? blocks.size() : other.blocks.size();
+
+			for(unsigned int i = 0; i < count; i++) {
+				block t = traits::true_lanes(other.blocks[i]);
+				blocks[i] = (blocks[i] & ~traits::lane_bits(t)) | traits::true_code(t);
+			}
+			clear_tail();
+		}}}
+
+		// first column where this is false and other is true, or -1
+		int first_noncover(const packed_acceptances & other) const
+		{{{
+			unsigned int count = blocks.size() < other.blocks.size() ? blocks.size() : other.blocks.size();
+
+			for(unsigned int i = 0; i < count; i++) {
+				block noncover = traits::false_lanes(blocks[i]) & traits::true_lanes(other.blocks[i]);
+				if(noncover) {
+					unsigned int col = i * lanes + __builtin_ctzll(noncover) / bits;
+					if(col < length && col < other.length)
+						return col;
+					return -1;
+				}
+			}
+			return -1;
+		}}}
+
+		const std::vector<block> & get_blocks() const
+		{ return blocks; }
+
+		size_t hash() const
+		{{{
+			size_t h = length;
+			for(unsigned int i = 0; i < blocks.size(); i++)
+				h = h * 1000003 + (size_t)(blocks[i] ^ (blocks[i] >> 32));
+			return h;
+		}}}
+
+		size_t memory_usage() const
+		{ return sizeof(*this) + blocks.capacity() * sizeof(block); }
+
+	protected:
+		static block lane_mask()
+		{ return ((block)1 << bits) - 1; }
+
+		void clear_tail()
+		{{{
+			if(length % lanes)
+				blocks.back() &= ((block)1 << ((length % lanes) * bits)) - 1;
+		}}}
+};
+
+/*
+ * acceptances_for<answer>::type is the container for the acceptances of a
+ * table row: packed_acceptances<answer> where possible, std::vector<answer>
+ * otherwise.
+ */
+template <class answer>
+class acceptances_for {
+	public:
+		typedef std::vector<answer> type;
+};
+template <>
+class acceptances_for<bool> {
+	public:
+		typedef packed_acceptances<bool> type;
+};
+template <>
+class acceptances_for<extended_bool> {
+	public:
+		typedef packed_acceptances<extended_bool> type;
+};
+
+/*
+ * operations of the observation tables on rows, for both row types.
+ * the std::vector versions compare one column at a time.
+ */
+
+// there is no column where a is false and b is true. false if the sizes differ.
+template <class answer>
+inline bool acceptances_cover(const std::vector<answer> & a, const std::vector<answer> & b)
+{{{
+	typename std::vector<answer>::const_iterator ai1, ai2;
+	for(ai1 = a.begin(), ai2 = b.begin(); ai1 != a.end() && ai2 != b.end(); ai1++, ai2++)
+		if(*ai1 == false && *ai2 == true)
+			return false;
+
+	return ( ai1 == a.end() && ai2 == b.end() );
+}}}
+template <class answer>
+inline bool acceptances_cover(const packed_acceptances<answer> & a, const packed_acceptances<answer> & b)
+{ return a.covers(b); }
+
+// neither a covers b nor b covers a. false if the sizes differ.
+template <class answer>
+inline bool acceptances_mutual_noncover(const std::vector<answer> & a, const std::vector<answer> & b)
+{{{
+	typename std::vector<answer>::const_iterator ai1, ai2;
+	bool tNCo = false, oNCt = false;
+	for(ai1 = a.begin(), ai2 = b.begin(); ai1 != a.end() && ai2 != b.end(); ai1++, ai2++) {
+		if(*ai1 == false && *ai2 == true) {
+			if(oNCt)
+				return true;
+			else
+				tNCo = true;
+		}
+		if(*ai1 == true && *ai2 == false) {
+			if(tNCo)
+				return true;
+			else
+				oNCt = true;
+		}
+	}
+
+	if( ai1 == a.end() && ai2 == b.end() )
+		return tNCo && oNCt;
+	else
+		return false;
+}}}
+template <class answer>
+inline bool acceptances_mutual_noncover(const packed_acceptances<answer> & a, const packed_acceptances<answer> & b)
+{ return a.mutual_noncover(b); }
+
+// set a to true wherever b is true
+template <class answer>
+inline void acceptances_join(std::vector<answer> & a, const std::vector<answer> & b)
+{{{
+	typename std::vector<answer>::iterator ai1;
+	typename std::vector<answer>::const_iterator ai2;
+	for(ai1 = a.begin(), ai2 = b.begin(); ai1 != a.end() && ai2 != b.end(); ai1++, ai2++)
+		if(*ai2 == true)
+			*ai1 = true;
+}}}
+template <class answer>
+inline void acceptances_join(packed_acceptances<answer> & a, const packed_acceptances<answer> & b)
+{ a.join(b); }
+
+// first column where a is false and b is true, or -1
+template <class answer>
+inline int acceptances_first_noncover(const std::vector<answer> & a, const std::vector<answer> & b)
+{{{
+	unsigned int i;
+	for(i = 0; i < a.size() && i < b.size(); i++)
+		if(a[i] == false && b[i] == true)
+			return i;
+	return -1;
+}}}
+template <class answer>
+inline int acceptances_first_noncover(const packed_acceptances<answer> & a, const packed_acceptances<answer> & b)
+{ return a.first_noncover(b); }
+
+template <class answer>
+inline size_t acceptances_memory_usage(const std::vector<answer> & a)
+{ return sizeof(a) + sizeof(answer) * a.size(); }
+template <class answer>
+inline size_t acceptances_memory_usage(const packed_acceptances<answer> & a)
+{ return a.memory_usage(); }
+
+}; // end of namespace libalf
+
+// serialized like std::vector<answer>
+template <class answer>
+std::basic_string<int32_t> serialize(const libalf::packed_acceptances<answer> & a)
+{{{
+	std::basic_string<int32_t> ret;
+
+	ret += serialize(a.size());
+	for(unsigned int i = 0; i < a.size(); i++)
+		ret += serialize(a.get(i));
+
+	return ret;
+}}}
+template <class answer>
+bool deserialize(libalf::packed_acceptances<answer> & a, serial_stretch & serial)
+{{{
+	int size;
+	answer tmp;
+
+	a.clear();
+
+	if(!deserialize(size, serial)) return false;
+	if(size < 0) return false;
+	a.reserve(size);
+	for(int i = 0; i < size; ++i) {
+		if(!deserialize(tmp, serial))
+			return false;
+		a.push_back(tmp);
+	}
+	return true;
+}}}
+
+#endif // __libalf_packed_acceptances_h__
+
@@ -0,0 +1,187 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_packed_word_h__
+# define __libalf_packed_word_h__
+
+#include <list>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace libalf {
+
+/** packed_word - contiguous word with small-buffer optimisation
+ *
+ *  a packed_word holds a word over alphabet <int> in an array of 32bit
+ *  cells instead of one heap node per letter (as std::list<int> does).
+ *  words of up to inline_cells cells are stored inside the object and
+ *  need no allocation at all.
+ *
+ *  optionally, letters are bit-packed: with bits per letter b in
+ *  {1,2,4,8,16}, 32/b letters share one cell (e.g. 64 letters over a
+ *  binary alphabet fit into the inline buffer). the packing is a hint:
+ *  if a letter does not fit, the word is repacked with enough bits.
+ *  negative letters (e.g. BOTTOM_CHAR) always use 32 bits.
+ *
+ *  equality, hash() and the (graded) lexicographic orders only depend on
+ *  the letters, not on the packing. words with the same packing are
+ *  compared cell-wise.
+ *
+ *  overloads of the common word functions (concat, operator+,
+ *  word2string, is_prefix_of, ...) are in alphabet.h; knowledgebase and
+ *  learning_algorithm::add_counterexample() accept packed_words as well.
+ *  the rows and columns of the angluin and NL* tables are still
+ *  std::list<int>.
+ */
+class packed_word {
+	public: // types
+		typedef uint32_t cell;
+		enum { inline_cells = 4 };
+
+		class const_iterator {
+			protected:
+				const packed_word * w;
+				unsigned int i;
+			public:
+				const_iterator()
+				{ w = NULL; i = 0; }
+				const_iterator(const packed_word * w, unsigned int i)
+				{ this->w = w; this->i = i; }
+				int operator*() const
+				{ return w->get(i); }
+				const_iterator & operator++()
+				{ ++i; return *this; }
+				const_iterator operator++(int)
+				{ const_iterator tmp = *this; ++i; return tmp; }
+				bool operator==(const const_iterator & other) const
+				{ return i == other.i && w == other.w; }
+				bool operator!=(const const_iterator & other) const
+				{ return i != other.i || w != other.w; }
+		};
+
+	protected: // data
+		unsigned int length; // number of letters
+		unsigned int capacity; // number of cells in data
+		unsigned char bits; // bits per letter: 1, 2, 4, 8, 16 or 32
+		unsigned char shift; // log2(letters per cell)
+		cell * data; // == inline_data if capacity == inline_cells
+		cell inline_data[inline_cells];
+
+	public: // methods
+		packed_word();
+		explicit packed_word(int alphabet_size);
+		// pack for letters 0 .. alphabet_size-1
+		explicit packed_word(const std::list<int> & word, int alphabet_size = 0);
+		packed_word(const packed_word & other);
+		~packed_word();
+
+		packed_word & operator=(const packed_word & other);
+		packed_word & operator=(const std::list<int> & word);
+
+		static int bits_for_alphabet(int alphabet_size);
+		// smallest packing for letters 0 .. alphabet_size-1. 32 if
+		// alphabet_size <= 0.
+
+		unsigned int size() const
+		{ return length; }
+		bool empty() const
+		{ return length == 0; }
+		int get_bits() const
+		{ return bits; }
+		void set_bits(int bits);
+		// repack with at least this many bits per letter
+
+		int get(unsigned int i) const
+		// no range check
+		{{{
+			if(bits == 32)
+				return (int32_t)data[i];
+			return (data[i >> shift] >> ((i & ((1u << shift) - 1)) * bits)) & ((1u << bits) - 1);
+		}}}
+		int operator[](unsigned int i) const
+		{ return get(i); }
+		int back() const
+		{ return get(length - 1); }
+		void set(unsigned int i, int letter);
+
+		void push_back(int letter)
+		{{{
+			if(bits == 32 && length < capacity) {
+				data[length++] = (cell)letter;
+				return;
+			}
+			push_back_slow(letter);
+		}}}
+		void pop_back();
+		void clear();
+		void reserve(unsigned int letters);
+		void resize(unsigned int letters, int letter = 0);
+
+		void append(const packed_word & suffix);
+		void append(const std::list<int> & suffix);
+
+		packed_word prefix(unsigned int letters) const;
+		packed_word suffix(unsigned int start) const;
+
+		const_iterator begin() const
+		{ return const_iterator(this, 0); }
+		const_iterator end() const
+		{ return const_iterator(this, length); }
+
+		std::list<int> to_list() const;
+
+		size_t hash() const;
+		// depends only on the letters
+
+		bool operator==(const packed_word & other) const;
+		bool operator!=(const packed_word & other) const
+		{ return !(*this == other); }
+		bool operator<(const packed_word & other) const;
+		// lexicographic, like std::list<int>::operator<
+
+		int compare_lex(const packed_word & other) const;
+		// <0, 0 or >0
+
+		unsigned long long int get_memory_usage() const
+		{ return sizeof(*this) + (data != inline_data ? capacity * sizeof(cell) : 0); }
+
+	protected:
+		unsigned int cells_for(unsigned int letters) const
+		{ return (letters + (1u << shift) - 1) >> shift; }
+		void grow(unsigned int cells);
+		void push_back_slow(int letter);
+		unsigned int first_difference(const packed_word & other) const;
+		// index of the first differing letter, or min(size())
+};
+
+struct packed_word_hash {
+	// hash-functor for hash tables
+	size_t operator()(const packed_word & w) const
+	{ return w.hash(); }
+};
+
+};
+
+#endif
+
@@ -0,0 +1,278 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#ifndef __libalf_parallel_fill_h__
+# define __libalf_parallel_fill_h__
+
+#include <list>
+#include <vector>
+
+#include <pthread.h>
+
+#include <libalf/alphabet.h>
+#include <libalf/knowledgebase.h>
+
+namespace libalf {
+
+/*
+ * parallel_table_filler - fill the missing columns of an observation table
+ * from a knowledgebase with several threads.
+ *
+ * fill() splits the rows among the threads. for each row, the node of the
+ * row word is looked up once, and every missing column is then looked up
+ * from that node on, without building the query words. the leading
+ * answered columns of a row are appended right away; for the rest of the
+ * row, each cell is only classified (answered, unknown or BOTTOM).
+ *
+ * complete() then does the part that changes the knowledgebase, serially:
+ * for each row that is not full, the node of the row word is created once
+ * and the unknown cells are created below it and marked as queries. the
+ * answered cells behind the first unknown one are counted as resolved but
+ * not appended, just as resolve_or_add_query() does in the serial fill.
+ *
+ * the knowledgebase is only read during fill(). it must not be changed by
+ * other threads until complete() is done. rows with a BOTTOM_CHAR word and
+ * BOTTOM_CHAR columns are filled with false. a table is filled by at most
+ * (missing cells / min_cells_per_thread) threads, as starting a thread
+ * costs about as much as looking up a thousand cells; the threshold can be
+ * changed by set_min_cells_per_thread().
+ */
+template <class answer, class table>
+class parallel_table_filler {
+	public: // types
+		typedef typename knowledgebase<answer>::node node;
+		enum { default_min_cells_per_thread = 1024 };
+	protected: // types
+		class work {
+			public:
+				parallel_table_filler * filler;
+				unsigned int first;
+				unsigned int stride;
+				int resolved;
+				pthread_t thread;
+		};
+		enum cell_state {
+			CELL_ANSWERED,
+			CELL_UNKNOWN,
+			CELL_BOTTOM
+		};
+		class cell {
+			public:
+				enum cell_state state;
+				answer ans;
+		};
+
+	protected: // data
+		knowledgebase<answer> * base;
+		std::vector<const std::list<int> *> columns;
+		// all rows with missing columns, in table order
+		std::vector<typename table::iterator> rows;
+		// for each row, the cells that fill() could not append
+		std::vector<std::vector<cell> > pending;
+		// number of missing cells in rows
+		unsigned int cells;
+		unsigned int min_cells_per_thread;
+
+	public: // methods
+		template <class columnlist>
+		parallel_table_filler(knowledgebase<answer> & base, table & t, const columnlist & column_names)
+		{{{
+			typename columnlist::const_iterator ci;
+			typename table::iterator ti;
+
+			this->base = &base;
+			cells = 0;
+			min_cells_per_thread = default_min_cells_per_thread;
+
+			columns.reserve(column_names.size());
+			for(ci = column_names.begin(); ci != column_names.end(); ++ci)
+				columns.push_back(&*ci);
+
+			for(ti = t.begin(); ti != t.end(); ++ti) {
+				if(ti->acceptance.size() < columns.size()) {
+					rows.push_back(ti);
+					cells += columns.size() - ti->acceptance.size();
+				}
+			}
+			pending.resize(rows.size());
+		}}}
+
+		// 0 lets every row have its own thread
+		void set_min_cells_per_thread(unsigned int min_cells)
+		{ min_cells_per_thread = min_cells; }
+		unsigned int get_min_cells_per_thread() const
+		{ return min_cells_per_thread; }
+
+		// returns the number of threads fill() will use (including the
+		// calling one)
+		unsigned int get_thread_count(unsigned int threads) const
+		{{{
+			if(min_cells_per_thread > 0 && threads > cells / min_cells_per_thread)
+				threads = cells / min_cells_per_thread;
+			if(threads > rows.size())
+				threads = rows.size();
+			return (threads > 0) ? threads : 1;
+		}}}
+
+		// returns the number of columns resolved from the knowledgebase.
+		int fill(unsigned int threads)
+		{{{
+			std::vector<work> jobs;
+			unsigned int i, started;
+			int resolved = 0;
+
+			threads = get_thread_count(threads);
+			if(threads == 1)
+				return fill_rows(0, 1);
+
+			jobs.resize(threads);
+			// rows are interleaved, as rows appended later tend to miss more columns.
+			for(started = 0; started < threads; started++) {
+				jobs[started].filler = this;
+				jobs[started].first = started;
+				jobs[started].stride = threads;
+				jobs[started].resolved = 0;
+				if(started > 0 && 0 != pthread_create(&jobs[started].thread, NULL, run, &jobs[started]))
+					break;
+			}
+			// the calling thread does the first share
+			run(&jobs[0]);
+
+			for(i = 1; i < started; i++)
+				pthread_join(jobs[i].thread, NULL);
+			// thread creation failed: do the rest here
+			for(i = started; i < threads; i++)
+				run(&jobs[i]);
+
+			for(i = 0; i < threads; i++)
+				resolved += jobs[i].resolved;
+
+			return resolved;
+		}}}
+
+		// add the queries for the cells fill() left. returns true if all
+		// rows are full, false if new knowledge is required. the answered
+		// cells of fill() and complete() are added to the resolved queries
+		// of the knowledgebase.
+		bool complete(int resolved)
+		{{{
+			bool full = true;
+
+			for(unsigned int r = 0; r < rows.size(); r++) {
+				typename table::iterator ti = rows[r];
+				std::vector<cell> & row_cells = pending[r];
+				unsigned int c = ti->acceptance.size();
+				typename std::vector<cell>::iterator pi;
+				bool column_skipped = false;
+				node * prefix = NULL;
+
+				for(pi = row_cells.begin(); pi != row_cells.end(); ++pi, ++c) {
+					switch(pi->state) {
+						case CELL_BOTTOM:
+							if(!column_skipped)
+								ti->acceptance.push_back(pi->ans);
+							break;
+						case CELL_ANSWERED:
+							if(!column_skipped)
+								ti->acceptance.push_back(pi->ans);
+							resolved++;
+							break;
+						case CELL_UNKNOWN:
+							if(prefix == NULL)
+								prefix = base->get_rootptr()->find_or_create_descendant(ti->index.begin(), ti->index.end());
+							prefix->find_or_create_descendant(columns[c]->begin(), columns[c]->end())->mark_required();
+							column_skipped = true;
+							full = false;
+							break;
+					}
+				}
+				std::vector<cell>().swap(row_cells);
+			}
+
+			base->add_resolved_queries(resolved);
+
+			return full;
+		}}}
+
+	protected:
+		int fill_rows(unsigned int first, unsigned int stride)
+		{{{
+			int resolved = 0;
+
+			for(unsigned int r = first; r < rows.size(); r += stride) {
+				typename table::iterator ti = rows[r];
+				std::vector<cell> & row_cells = pending[r];
+				if(!ti->index.empty() && ti->index.front() == BOTTOM_CHAR) {
+					answer a;
+					a = false;
+					while(ti->acceptance.size() < columns.size())
+						ti->acceptance.push_back(a);
+					continue;
+				}
+				node * prefix = base->get_rootptr()->find_descendant(ti->index.begin(), ti->index.end());
+
+				for(unsigned int c = ti->acceptance.size(); c < columns.size(); c++) {
+					const std::list<int> & suffix = *columns[c];
+					cell x;
+
+					if(!suffix.empty() && suffix.front() == BOTTOM_CHAR) {
+						x.state = CELL_BOTTOM;
+						x.ans = false;
+					} else {
+						node * n = (prefix == NULL) ? NULL : prefix->find_descendant(suffix.begin(), suffix.end());
+						if(n != NULL && n->is_answered()) {
+							x.state = CELL_ANSWERED;
+							x.ans = n->get_answer();
+						} else {
+							x.state = CELL_UNKNOWN;
+						}
+					}
+
+					if(row_cells.empty() && x.state != CELL_UNKNOWN) {
+						ti->acceptance.push_back(x.ans);
+						if(x.state == CELL_ANSWERED)
+							resolved++;
+					} else {
+						if(row_cells.empty())
+							row_cells.reserve(columns.size() - c);
+						row_cells.push_back(x);
+					}
+				}
+			}
+
+			return resolved;
+		}}}
+
+		static void * run(void * arg)
+		{{{
+			work * w = (work*)arg;
+			w->resolved = w->filler->fill_rows(w->first, w->stride);
+			return NULL;
+		}}}
+};
+
+}; // end of namespace libalf
+
+#endif // __libalf_parallel_fill_h__
+
@@ -43,7 +43,22 @@ namespace libalf {
  * and consistent way. You have to check it for yourself; it is meant only
  * to be used internally by someone who knows what he is doing.
  *
- * The root node always has the ID 0.
+ * The root node always has the ID 0. Nodes are numbered in depth-first order
+ * (children in the order of their letters), such that the first child of a
+ * node u always is u+1.
+ *
+ * The successor of node u on letter a is edges[u][a] (or no_edge). The edges
+ * are stored in one of two ways:
+ *
+ * - dense: a table with alphabet_size entries per node. Looking up an edge
+ *   takes constant time.
+ *
+ * - compact: the letter leading to a node and the size of the subtree below
+ *   it. The children of u are u+1, the node following the subtree of u+1,
+ *   and so on, sorted by their letters. A node on a unary path thus only
+ *   stores its letter and subtree size. Looking up an edge takes time linear
+ *   in the number of children, but memory does not grow with the alphabet
+ *   size. This is meant for samples with large alphabets or long words.
  */
 template <class answer>
 class prefix_tree {
@@ -67,6 +82,85 @@ class prefix_tree {
 	 */
 	static const unsigned int root;
 
+	/**
+	 * The edges of a prefix tree, see prefix_tree.
+	 */
+	class edge_table {
+
+		friend class prefix_tree;
+
+		private:
+
+		unsigned int alphabet_size;
+		bool compact;
+
+		// dense: successors[u * alphabet_size + a]
+		std::vector<unsigned int> successors;
+
+		// compact: letter of the edge to u and number of nodes below u
+		// (including u)
+		std::vector<int> letter;
+		std::vector<unsigned int> subtree_size;
+
+		public:
+
+		/**
+		 * The edges of one node.
+		 */
+		class row {
+
+			private:
+
+			const edge_table * table;
+			unsigned int node;
+
+			public:
+
+			row(const edge_table * table, unsigned int node) {
+				this->table = table;
+				this->node = node;
+			}
+
+			unsigned int operator[](int a) const {
+				return table->successor(node, a);
+			}
+
+		};
+
+		row operator[](unsigned int node) const {
+			return row(this, node);
+		}
+
+		/**
+		 * Returns the successor of a node on a letter.
+		 *
+		 * @param node The node
+		 * @param a The letter
+		 *
+		 * @return Returns the successor or no_edge.
+		 */
+		unsigned int successor(unsigned int node, int a) const {
+
+			if(!compact) {
+				return successors[node * alphabet_size + a];
+			}
+
+			unsigned int end = node + subtree_size[node];
+			for(unsigned int v=node+1; v<end; v+=subtree_size[v]) {
+				if(letter[v] == a) {
+					return v;
+				}
+				if(letter[v] > a) {
+					break;
+				}
+			}
+
+			return prefix_tree::no_edge;
+
+		}
+
+	};
+
 	/**
 	 * The number of nodes in the tree.
 	 */
@@ -76,7 +170,7 @@ class prefix_tree {
 	 * The edges of the tree. This a mapping from the ID of a node to the IDs of
 	 * its successor nodes.
 	 */
-	std::vector<unsigned int *> edges;
+	edge_table edges;
 	
 	/**
 	 * Indicated whether a word in the tree is specified.
@@ -93,55 +187,160 @@ class prefix_tree {
 	 *
 	 * @param sample The sample to build the prefix tree from
 	 * @param alphabet_size The size of the alphabet to use
+	 * @param compact Indicates whether to store the edges compactly
 	 */
-	prefix_tree(const std::map<std::list<int>, answer> & sample, unsigned int alphabet_size) {
+	prefix_tree(const std::map<std::list<int>, answer> & sample, unsigned int alphabet_size, bool compact = false) {
 		
 		// Assign alphabet size
 		assert(alphabet_size>0);
 		this->alphabet_size = alphabet_size;
 		
 		// Initialize empty tree
-		init();
+		init(compact);
 		
-		// Add samples
+		// The map is sorted lexicographically, i.e., words come in depth-first
+		// order. path holds the nodes of the last word.
+		std::vector<unsigned int> path(1, prefix_tree::root);
+		std::vector<int> path_letters;
 		for(typename std::map<std::list<int>, answer>::const_iterator it=sample.begin(); it!=sample.end(); it++) {
-			add(it->first, it->second);
+
+			// Length of the common prefix with the last word
+			unsigned int common = 0;
+			std::list<int>::const_iterator li = it->first.begin();
+			while(common < path_letters.size() && li != it->first.end() && *li == path_letters[common]) {
+				common++;
+				li++;
+			}
+
+			// Leave the subtrees of the last word
+			while(path_letters.size() > common) {
+				close_node(path.back());
+				path.pop_back();
+				path_letters.pop_back();
+			}
+
+			// Add the rest of the word
+			for(; li!=it->first.end(); li++) {
+				assert(*li>=0 && (unsigned int)*li<alphabet_size);
+				path.push_back(add_child(path.back(), *li));
+				path_letters.push_back(*li);
+			}
+
+			// Set classification
+			specified[path.back()] = true;
+			output[path.back()] = it->second;
+
+		}
+		while(!path.empty()) {
+			close_node(path.back());
+			path.pop_back();
 		}
 		
 	}
 	
 	/**
-	 * Creates a new prefix tree from the given samples.
+	 * Creates a new prefix tree from the given samples in one pass over the
+	 * knowledgebase.
 	 *
 	 * @param sample The sample to build the prefix tree from. The knowledgebase
 	 *               is not altered.
 	 * @param alphabet_size The size of the alphabet to use
+	 * @param compact Indicates whether to store the edges compactly
 	 */
-	prefix_tree(libalf::knowledgebase<answer> & base, unsigned int alphabet_size) {
+	prefix_tree(libalf::knowledgebase<answer> & base, unsigned int alphabet_size, bool compact = false) {
 		
 		// Assign alphabet size
 		assert(alphabet_size>0);
 		this->alphabet_size = alphabet_size;
 		
 		// Initialize empty tree
-		init();
+		init(compact);
 		
 		// Copy samples from knowledgebase
-		add_knowledge(base.get_rootptr(), prefix_tree::root);
+		add_knowledge(base.get_rootptr());
 		
 	}
 	
 	/**
-	 * Destructor.
+	 * Creates the quotient of a prefix tree with respect to a partition of
+	 * its nodes. The result is no tree anymore, but a graph with one node per
+	 * class and at most one edge per node and letter. It is stored densely.
+	 *
+	 * The partition has to be a congruence: the successors of nodes in the
+	 * same class on the same letter are in the same class, and nodes in the
+	 * same class have no different outputs. Every word of the sample then
+	 * leads to the class of its node, which carries its output.
+	 *
+	 * The class of the root becomes the root. As no_edge is the ID of the
+	 * root, no edge can lead back to it: if an edge enters the class of the
+	 * root, the root is a copy of this class, which keeps an ID of its own.
+	 *
+	 * @param t The prefix tree
+	 * @param classes The class of each node of t, from 0 to class_count-1,
+	 *                where the root is in class 0
+	 * @param class_count The number of classes
 	 */
-	~prefix_tree() {
-		
-		for(std::vector<unsigned int *>::iterator it=edges.begin(); it!=edges.end(); it++) {
-			delete[] *it;
+	prefix_tree(const prefix_tree<answer> & t, const std::vector<unsigned int> & classes, unsigned int class_count) {
+
+		assert(classes.size() == t.node_count);
+		assert(classes[prefix_tree::root] == 0);
+
+		this->alphabet_size = t.alphabet_size;
+
+		// Copy the root class if it is entered by an edge
+		unsigned int offset = 0;
+		for(unsigned int u=0; u<t.node_count && offset == 0; u++) {
+			for(unsigned int a=0; a<alphabet_size; a++) {
+				unsigned int v = t.edges[u][a];
+				if(v != prefix_tree::no_edge && classes[v] == 0) {
+					offset = 1;
+					break;
+				}
+			}
 		}
-		
+
+		node_count = class_count + offset;
+		edges.alphabet_size = alphabet_size;
+		edges.compact = false;
+		edges.successors.assign(node_count * alphabet_size, prefix_tree::no_edge);
+		specified.assign(node_count, false);
+		output.assign(node_count, answer());
+
+		for(unsigned int u=0; u<t.node_count; u++) {
+
+			unsigned int c = classes[u] + offset;
+
+			// Output
+			if(t.specified[u]) {
+				assert(!specified[c] || output[c] == t.output[u]);
+				specified[c] = true;
+				output[c] = t.output[u];
+			}
+
+			// Edges
+			for(unsigned int a=0; a<alphabet_size; a++) {
+				unsigned int v = t.edges[u][a];
+				if(v != prefix_tree::no_edge) {
+					assert(edges.successors[c * alphabet_size + a] == prefix_tree::no_edge || edges.successors[c * alphabet_size + a] == classes[v] + offset);
+					edges.successors[c * alphabet_size + a] = classes[v] + offset;
+				}
+			}
+
+		}
+
+		if(offset == 1) {
+			for(unsigned int a=0; a<alphabet_size; a++) {
+				edges.successors[a] = edges.successors[alphabet_size + a];
+			}
+			specified[prefix_tree::root] = specified[1];
+			output[prefix_tree::root] = output[1];
+		}
+
 	}
 	
+	virtual ~prefix_tree() {
+	}
+
 	/**
 	 * Returns the alphabet size of this prefix tree.
 	 *
@@ -151,6 +350,29 @@ class prefix_tree {
 		return alphabet_size;
 	}
 
+	/**
+	 * Returns whether the edges are stored compactly.
+	 *
+	 * @return Returns whether the edges are stored compactly.
+	 */
+	bool is_compact() const {
+		return edges.compact;
+	}
+
+	/**
+	 * Returns the number of bytes used by the nodes and edges of this tree
+	 * (without the outputs' own allocations).
+	 *
+	 * @return Returns the number of bytes used by this tree.
+	 */
+	size_t memory_usage() const {
+		return edges.successors.capacity() * sizeof(unsigned int)
+			+ edges.letter.capacity() * sizeof(int)
+			+ edges.subtree_size.capacity() * sizeof(unsigned int)
+			+ specified.capacity() / 8
+			+ output.capacity() * sizeof(answer);
+	}
+
 	/**
 	 * Returns a Graphviz Dot representation of this prefix tree.
 	 *
@@ -216,113 +438,136 @@ class prefix_tree {
 	/**
 	 * Creates an empty tree with only the root node.
 	 */
-	void init() {
+	void init(bool compact) {
 	
+		edges.alphabet_size = alphabet_size;
+		edges.compact = compact;
+		node_count = 0;
+
 		// Create root node with ID 0
-		unsigned int * root_edges = new unsigned int[alphabet_size];
-		for(unsigned int i=0; i<alphabet_size; i++) {
-			root_edges[i] = prefix_tree::no_edge;
+		add_child(prefix_tree::no_edge, -1);
+		
+	}
+
+	/**
+	 * Creates a new node as the last node of the tree. In compact trees,
+	 * close_node() has to be called once all nodes below the new node have
+	 * been created.
+	 *
+	 * @param parent The parent of the new node (no_edge for the root)
+	 * @param a The letter of the edge from the parent to the new node
+	 *
+	 * @return Returns the ID of the new node.
+	 */
+	unsigned int add_child(unsigned int parent, int a) {
+
+		unsigned int child = node_count;
+
+		if(edges.compact) {
+			edges.letter.push_back(a);
+			edges.subtree_size.push_back(1);
+		} else {
+			edges.successors.resize(edges.successors.size() + alphabet_size, prefix_tree::no_edge);
+			if(child != prefix_tree::root) {
+				edges.successors[parent * alphabet_size + a] = child;
+			}
 		}
-		edges.push_back(root_edges);
 		specified.push_back(false);
 		output.push_back(answer());
-		node_count = 1;
-		
+		node_count++;
+
+		return child;
+
 	}
-	
+
 	/**
-	 * Adds a new word to the prefix tree. If the word is already existing, its
-	 * classification is overridden.
+	 * Marks the end of the subtree below a node.
 	 *
-	 * @param word The word to add
-	 * @param classification The classification of the word to add
+	 * @param node The node
 	 */
-	void add(const std::list<int> & word, bool classification) {
-		
-		unsigned int current_state = 0;
-		
-		for(std::list<int>::const_iterator it=word.begin(); it!=word.end(); it++) {
-			assert(*it>=0 && (unsigned int)*it<alphabet_size);
-			
-			unsigned int child = edges[current_state][*it];
-			
-			// Create new child
-			if(child == prefix_tree::no_edge) {
-				
-				unsigned int * new_edges = new unsigned int[alphabet_size];
-				for(unsigned int i=0; i<alphabet_size; i++) {
-					new_edges[i] = prefix_tree::no_edge;
-				}
-				edges[current_state][*it] = node_count;
-				edges.push_back(new_edges);
-				specified.push_back(false);
-				output.push_back(answer());
-				child = node_count;
-				node_count++;
-				
-			}
+	void close_node(unsigned int node) {
 
-			current_state = child;
-			
+		if(edges.compact) {
+			edges.subtree_size[node] = node_count - node;
 		}
-		
-		// Set classification
-		specified[current_state] = true;
-		output[current_state] = classification;
+
 	}
 	
 	/**
-	 * Recursively traverses the knowledgebase and adds the knowledge to the
-	 * prefix tree.
+	 * A node of the knowledgebase on the stack of add_knowledge(), with its
+	 * node in the prefix tree and the letters still to visit.
+	 */
+	struct kb_frame {
+		typename libalf::knowledgebase<answer>::node * kn_node;
+		unsigned int pt_node;
+		unsigned int next;
+		unsigned int end;
+	};
+
+	/**
+	 * Traverses the knowledgebase depth-first and adds the knowledge to the
+	 * prefix tree. An explicit stack is used, such that long words do not
+	 * exhaust the call stack.
 	 *
-	 * @param current The current node in the knowledgebase
+	 * @param kn_root The root node of the knowledgebase
 	 */
-	void add_knowledge(typename libalf::knowledgebase<answer>::node * kn_node, unsigned int pt_node) {
-	
+	void add_knowledge(typename libalf::knowledgebase<answer>::node * kn_root) {
+
+		std::vector<kb_frame> stack;
+
+		kb_frame f;
+		f.kn_node = kn_root;
+		f.pt_node = prefix_tree::root;
+		f.next = 0;
+		stack.push_back(f);
+		label(stack.back());
+
+		while(!stack.empty()) {
+
+			// Find next child
+			kb_frame & top = stack.back();
+			typename libalf::knowledgebase<answer>::node * kn_child = NULL;
+			unsigned int a = 0;
+			while(kn_child == NULL && top.next < top.end) {
+				a = top.next++;
+				kn_child = top.kn_node->find_child(a);
+			}
+
+			// No children left
+			if(kn_child == NULL) {
+				close_node(top.pt_node);
+				stack.pop_back();
+				continue;
+			}
+
+			// Create child and descend
+			f.kn_node = kn_child;
+			f.pt_node = add_child(top.pt_node, a);
+			f.next = 0;
+			stack.push_back(f);
+			label(stack.back());
+
+		}
+
+	}
+
+	/**
+	 * Copies the answer of a knowledgebase node and determines which letters
+	 * can have children.
+	 */
+	void label(kb_frame & f) {
+
 		// Label current node
-		if(kn_node->is_answered()) {
+		if(f.kn_node->is_answered()) {
 		
-			specified[pt_node] = true;
-			output[pt_node] = kn_node->get_answer();
+			specified[f.pt_node] = true;
+			output[f.pt_node] = f.kn_node->get_answer();
 		
 		}
-	
-		// Process children
-		assert(kn_node->max_child_count() >= 0);
-		unsigned int min = alphabet_size <= (unsigned int)kn_node->max_child_count() ? alphabet_size : kn_node->max_child_count();
-		for(unsigned int a=0; a<min; a++) {
-		
-			typename libalf::knowledgebase<answer>::node * kn_child = kn_node->find_child(a);
-			
-			// Child exists
-			if(kn_child != NULL) {
-			
-				// Check whether new node in prefix tree needs to be created
-				unsigned int pt_child = edges[pt_node][a];
-			
-				// Create new child if necessary
-				if(pt_child == prefix_tree<answer>::no_edge) {
-					
-					unsigned int * new_edges = new unsigned int[alphabet_size];
-					for(unsigned int i=0; i<alphabet_size; i++) {
-						new_edges[i] = prefix_tree<answer>::no_edge;
-					}
-					edges[pt_node][a] = node_count;
-					edges.push_back(new_edges);
-					specified.push_back(false);
-					output.push_back(answer());
-					pt_child = node_count;
-					node_count++;
-					
-				}
 
-				// Recursive call
-				add_knowledge(kn_child, pt_child);
-			
-			}
-		
-		}
-	
+		assert(f.kn_node->max_child_count() >= 0);
+		f.end = alphabet_size <= (unsigned int)f.kn_node->max_child_count() ? alphabet_size : f.kn_node->max_child_count();
+
 	}
 
 	public:
@@ -332,7 +577,7 @@ class prefix_tree {
 		ret += 0;
 		ret += ::serialize(alphabet_size);
 		ret += ::serialize(node_count);
-		//std::vector<unsigned int *> edges
+		// edges, as a table
 		for(unsigned int i=0; i<node_count; i++) {
 			for(unsigned int j=0; j<alphabet_size; j++) {
 				ret += ::serialize(edges[i][j]);
@@ -349,9 +594,14 @@ class prefix_tree {
 		if(!::deserialize(size, serial)) return false;
 		if(!::deserialize(alphabet_size, serial)) return false;
 		if(!::deserialize(node_count, serial)) return false;
+		edges.alphabet_size = alphabet_size;
+		edges.compact = false;
+		edges.letter.clear();
+		edges.subtree_size.clear();
+		edges.successors.assign(node_count * alphabet_size, prefix_tree::no_edge);
 		for(unsigned int i=0; i<node_count; i++) {
 			for(unsigned int j=0; j<alphabet_size; j++) {
-				if(!::deserialize(edges[i][j], serial)) return false;
+				if(!::deserialize(edges.successors[i * alphabet_size + j], serial)) return false;
 			}
 		}
 		if(!::deserialize(specified, serial)) return false;
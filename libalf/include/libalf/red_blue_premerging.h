@@ -0,0 +1,479 @@
+/*
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008 - 2012 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *             and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: Daniel Neider <neider@automata.rwth-aachen.de>
+ *
+ */
+
+/*
+ * Merging of prefix tree nodes before the SAT/SMT-based inference (see
+ * automata_inferring::set_premerging()), following the red-blue framework
+ * with evidence-driven scores (EDSM) as used by Heule and Verwer, "Exact DFA
+ * identification using SAT solvers".
+ *
+ * The red nodes are the states identified so far. They are pairwise
+ * different. The blue nodes are the successors of red nodes that are
+ * neither red nor merged. Blue nodes are processed in breadth-first order:
+ * a blue node that cannot be merged with any red node becomes red. Otherwise
+ * it is merged with the red node that has the highest score, i.e., the
+ * largest number of outputs that agree after the merge, if this score
+ * reaches a minimal evidence. Blue nodes with less evidence are left alone
+ * and, together with the subtrees below them, form the unmerged frontier.
+ *
+ * Merging is not exact: a conjecture for the quotient might need more states
+ * than one for the tree. The red nodes that are pairwise different in the
+ * tree itself, however, give a lower bound on the number of states.
+ */
+
+#ifndef __libalf_red_blue_premerging_h__
+#define __libalf_red_blue_premerging_h__
+
+// Standard includes
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+#include <assert.h>
+
+// libALF includes
+#include "libalf/prefix_tree.h"
+
+namespace libalf {
+
+template <class answer>
+class red_blue_premerging {
+
+	private:
+
+	/**
+	 * A change of a trial merge, see undo().
+	 */
+	enum change_kind { PARENT, OUTPUT, EDGE };
+	struct change {
+		change_kind kind;
+		unsigned int node;
+		int letter;
+	};
+
+	const prefix_tree<answer> & t;
+
+	unsigned int min_evidence;
+
+	/**
+	 * The classes of nodes as a union-find structure. A class is represented
+	 * by the node whose parent is itself, which holds the output and the
+	 * edges of the whole class.
+	 */
+	std::vector<unsigned int> parent;
+	std::vector<bool> specified;
+	std::vector<answer> output;
+
+	/**
+	 * Edges a class has gained by merging, in addition to the tree edges of
+	 * its representative.
+	 */
+	std::map<std::pair<unsigned int, int>, unsigned int> added_edges;
+
+	std::vector<bool> red;
+	std::vector<unsigned int> red_nodes;
+	std::deque<unsigned int> blue_nodes;
+
+	/**
+	 * The targets of edges added to red classes by the last merge.
+	 */
+	std::vector<unsigned int> new_blue_nodes;
+
+	/**
+	 * While a merge is only tried, all changes are recorded and undone
+	 * afterwards.
+	 */
+	bool trial;
+	std::vector<change> trail;
+
+	unsigned int merge_count;
+
+	public:
+
+	/**
+	 * Merges the nodes of a prefix tree.
+	 *
+	 * @param t The prefix tree, which has to outlive this object
+	 * @param min_evidence The minimal score of a merge
+	 */
+	red_blue_premerging(const prefix_tree<answer> & t, unsigned int min_evidence) : t(t) {
+
+		this->min_evidence = min_evidence;
+
+		parent.resize(t.node_count);
+		for(unsigned int u=0; u<t.node_count; u++) {
+			parent[u] = u;
+		}
+		specified = t.specified;
+		output = t.output;
+		red.assign(t.node_count, false);
+		trial = false;
+		merge_count = 0;
+
+		run();
+
+	}
+
+	/**
+	 * Returns the number of merges of a blue into a red node.
+	 */
+	unsigned int get_merge_count() const {
+		return merge_count;
+	}
+
+	/**
+	 * Returns the number of red nodes.
+	 */
+	unsigned int get_red_count() const {
+		return red_nodes.size();
+	}
+
+	/**
+	 * Returns a lower bound on the number of states of every conjecture that
+	 * is consistent with the tree. This is the size of a set of red nodes
+	 * that are pairwise different already in the tree (chosen greedily).
+	 */
+	unsigned int get_lower_bound() const {
+
+		std::vector<unsigned int> clique;
+		for(unsigned int i=0; i<red_nodes.size(); i++) {
+
+			bool different_from_all = true;
+			for(unsigned int j=0; j<clique.size() && different_from_all; j++) {
+				different_from_all = different(red_nodes[i], clique[j]);
+			}
+
+			if(different_from_all) {
+				clique.push_back(red_nodes[i]);
+			}
+
+		}
+
+		return clique.size();
+
+	}
+
+	/**
+	 * Creates the quotient of the tree with respect to the merged classes.
+	 * The caller has to delete it.
+	 *
+	 * @return Returns the quotient.
+	 */
+	prefix_tree<answer> * create_quotient() {
+
+		// Number the classes in breadth-first order, starting with the root
+		const unsigned int none = t.node_count;
+		std::vector<unsigned int> number(t.node_count, none);
+		std::deque<unsigned int> queue(1, find(prefix_tree<answer>::root));
+		number[queue.front()] = 0;
+		unsigned int class_count = 1;
+
+		while(!queue.empty()) {
+
+			unsigned int c = queue.front();
+			queue.pop_front();
+
+			for(unsigned int a=0; a<t.get_alphabet_size(); a++) {
+				unsigned int s = successor(c, a);
+				if(s != prefix_tree<answer>::no_edge) {
+					s = find(s);
+					if(number[s] == none) {
+						number[s] = class_count++;
+						queue.push_back(s);
+					}
+				}
+			}
+
+		}
+
+		std::vector<unsigned int> classes(t.node_count);
+		for(unsigned int u=0; u<t.node_count; u++) {
+			classes[u] = number[find(u)];
+			assert(classes[u] != none);
+		}
+
+		return new prefix_tree<answer>(t, classes, class_count);
+
+	}
+
+	private:
+
+	/**
+	 * Processes the blue nodes until there are none left.
+	 */
+	void run() {
+
+		promote(prefix_tree<answer>::root);
+
+		while(!blue_nodes.empty()) {
+
+			unsigned int b = blue_nodes.front();
+			blue_nodes.pop_front();
+
+			// Skip nodes that have been merged since they became blue
+			if(find(b) != b || red[b]) {
+				continue;
+			}
+
+			// Score all red nodes
+			int best_evidence = -1;
+			unsigned int best_red = 0;
+			for(unsigned int i=0; i<red_nodes.size(); i++) {
+
+				trial = true;
+				int evidence = merge(red_nodes[i], b);
+				undo();
+				trial = false;
+
+				if(evidence > best_evidence) {
+					best_evidence = evidence;
+					best_red = red_nodes[i];
+				}
+
+			}
+
+			// Every merge fails
+			if(best_evidence < 0) {
+				promote(b);
+			}
+
+			// Merge, unless b is left in the frontier
+			else if((unsigned int)best_evidence >= min_evidence) {
+
+				int evidence = merge(best_red, b);
+				assert(evidence == best_evidence);
+				merge_count++;
+
+				for(unsigned int i=0; i<new_blue_nodes.size(); i++) {
+					blue_nodes.push_back(new_blue_nodes[i]);
+				}
+
+			}
+
+		}
+
+	}
+
+	/**
+	 * Makes a class red and its successors blue.
+	 */
+	void promote(unsigned int r) {
+
+		red[r] = true;
+		red_nodes.push_back(r);
+
+		for(unsigned int a=0; a<t.get_alphabet_size(); a++) {
+			unsigned int s = successor(r, a);
+			if(s != prefix_tree<answer>::no_edge && !red[find(s)]) {
+				blue_nodes.push_back(find(s));
+			}
+		}
+
+	}
+
+	/**
+	 * Merges the class of b into the class of r and, to keep the edges
+	 * deterministic, the classes of their successors on the same letters.
+	 *
+	 * @return Returns the number of outputs that agree, or -1 if two outputs
+	 *         differ (the classes are then left partially merged).
+	 */
+	int merge(unsigned int r, unsigned int b) {
+
+		int evidence = 0;
+		new_blue_nodes.clear();
+
+		std::vector<std::pair<unsigned int, unsigned int> > pending(1, std::pair<unsigned int, unsigned int>(r, b));
+		while(!pending.empty()) {
+
+			unsigned int u = find(pending.back().first);
+			unsigned int v = find(pending.back().second);
+			pending.pop_back();
+
+			if(u == v) {
+				continue;
+			}
+
+			// Red classes are never merged and stay representatives
+			if(red[v]) {
+				if(red[u]) {
+					return -1;
+				}
+				std::swap(u, v);
+			}
+
+			// Merge outputs
+			if(specified[v]) {
+				if(specified[u]) {
+					if(output[u] != output[v]) {
+						return -1;
+					}
+					evidence++;
+				} else {
+					specified[u] = true;
+					output[u] = output[v];
+					record(OUTPUT, u, -1);
+				}
+			}
+
+			parent[v] = u;
+			record(PARENT, v, -1);
+
+			// Merge edges
+			for(unsigned int a=0; a<t.get_alphabet_size(); a++) {
+
+				unsigned int sv = successor(v, a);
+				if(sv == prefix_tree<answer>::no_edge) {
+					continue;
+				}
+
+				unsigned int su = successor(u, a);
+				if(su == prefix_tree<answer>::no_edge) {
+					added_edges[std::pair<unsigned int, int>(u, a)] = sv;
+					record(EDGE, u, a);
+					if(red[u]) {
+						new_blue_nodes.push_back(sv);
+					}
+				} else {
+					pending.push_back(std::pair<unsigned int, unsigned int>(su, sv));
+				}
+
+			}
+
+		}
+
+		return evidence;
+
+	}
+
+	void record(change_kind kind, unsigned int node, int letter) {
+
+		if(trial) {
+			change c;
+			c.kind = kind;
+			c.node = node;
+			c.letter = letter;
+			trail.push_back(c);
+		}
+
+	}
+
+	/**
+	 * Reverts all changes of a trial merge.
+	 */
+	void undo() {
+
+		while(!trail.empty()) {
+
+			const change & c = trail.back();
+			switch(c.kind) {
+				case PARENT:
+					parent[c.node] = c.node;
+					break;
+				case OUTPUT:
+					specified[c.node] = false;
+					break;
+				case EDGE:
+					added_edges.erase(std::pair<unsigned int, int>(c.node, c.letter));
+					break;
+			}
+			trail.pop_back();
+
+		}
+
+	}
+
+	/**
+	 * Returns the representative of the class of u. Paths are only
+	 * compressed outside of trial merges, which could not be undone otherwise.
+	 */
+	unsigned int find(unsigned int u) {
+
+		unsigned int r = u;
+		while(parent[r] != r) {
+			r = parent[r];
+		}
+
+		if(!trial) {
+			while(parent[u] != r) {
+				unsigned int next = parent[u];
+				parent[u] = r;
+				u = next;
+			}
+		}
+
+		return r;
+
+	}
+
+	/**
+	 * Returns a node of the successor class of the class represented by u.
+	 */
+	unsigned int successor(unsigned int u, int a) const {
+
+		if(!added_edges.empty()) {
+			typename std::map<std::pair<unsigned int, int>, unsigned int>::const_iterator it = added_edges.find(std::pair<unsigned int, int>(u, a));
+			if(it != added_edges.end()) {
+				return it->second;
+			}
+		}
+
+		return t.edges[u][a];
+
+	}
+
+	/**
+	 * Checks whether two nodes of the tree are different, i.e., whether
+	 * some word leads from them to nodes with different outputs.
+	 */
+	bool different(unsigned int u, unsigned int v) const {
+
+		std::vector<std::pair<unsigned int, unsigned int> > stack(1, std::pair<unsigned int, unsigned int>(u, v));
+		while(!stack.empty()) {
+
+			u = stack.back().first;
+			v = stack.back().second;
+			stack.pop_back();
+
+			if(t.specified[u] && t.specified[v] && t.output[u] != t.output[v]) {
+				return true;
+			}
+
+			for(unsigned int a=0; a<t.get_alphabet_size(); a++) {
+				unsigned int su = t.edges[u][a];
+				unsigned int sv = t.edges[v][a];
+				if(su != prefix_tree<answer>::no_edge && sv != prefix_tree<answer>::no_edge) {
+					stack.push_back(std::pair<unsigned int, unsigned int>(su, sv));
+				}
+			}
+
+		}
+
+		return false;
+
+	}
+
+};
+
+}; // End libalf namespace
+
+#endif
@@ -58,6 +58,15 @@ list<int>* concat(const list<int> &first, const list<int> &second)
 	return l;
 }}}
 
+packed_word* concat(const packed_word &first, const packed_word &second)
+{{{
+	packed_word *w = new packed_word(first);
+
+	w->append(second);
+
+	return w;
+}}}
+
 list<int> operator+(const list<int> & prefix, const list<int> & suffix)
 {{{
 	list<int> ret;
@@ -70,6 +79,15 @@ list<int> operator+(const list<int> & prefix, const list<int> & suffix)
 	return ret;
 }}}
 
+packed_word operator+(const packed_word & prefix, const packed_word & suffix)
+{{{
+	packed_word ret(prefix);
+
+	ret.append(suffix);
+
+	return ret;
+}}}
+
 list<int> word(const int num_letters, ...)
 {{{
 	va_list listPointer;
@@ -118,6 +136,31 @@ bool is_suffix_of(const list<int> &suffix, const list<int> &word)
 	return true;
 }}}
 
+bool is_prefix_of(const packed_word &prefix, const packed_word &word)
+{{{
+	if(prefix.size() > word.size())
+		return false;
+
+	for(unsigned int i = 0; i < prefix.size(); ++i)
+		if(prefix[i] != word[i])
+			return false;
+	return true;
+}}}
+
+bool is_suffix_of(const packed_word &suffix, const packed_word &word)
+{{{
+	unsigned int offset;
+
+	if(suffix.size() > word.size())
+		return false;
+
+	offset = word.size() - suffix.size();
+	for(unsigned int i = 0; i < suffix.size(); ++i)
+		if(suffix[i] != word[offset + i])
+			return false;
+	return true;
+}}}
+
 void print_word(ostream &os, const list<int> &word)
 {{{
 	ostream_iterator<int> out(os, ".");
@@ -125,6 +168,13 @@ void print_word(ostream &os, const list<int> &word)
 	copy(word.begin(), word.end(), out);
 }}}
 
+void print_word(ostream &os, const packed_word &word)
+{{{
+	os << ".";
+	for(unsigned int i = 0; i < word.size(); ++i)
+		os << word[i] << ".";
+}}}
+
 void print_word(const list<int> &word)
 {{{
 	printf(".");
@@ -148,6 +198,22 @@ string word2string(const list<int> &word, char separator = '.')
 	return ret;
 }}}
 
+string word2string(const packed_word &word, char separator = '.')
+{{{
+	string ret;
+	char buf[32];
+
+	ret += separator;
+
+	for(unsigned int i = 0; i < word.size(); ++i) {
+		snprintf(buf, 32, "%d%c", word[i], separator);
+		buf[31] = 0;
+		ret += buf;
+	}
+
+	return ret;
+}}}
+
 basic_string<int32_t> serialize_word(const list<int> &word)
 {{{
 	basic_string<int32_t> ret;
@@ -160,6 +226,18 @@ basic_string<int32_t> serialize_word(const list<int> &word)
 	return ret;
 }}}
 
+basic_string<int32_t> serialize_word(const packed_word &word)
+{{{
+	basic_string<int32_t> ret;
+
+	ret += htonl(word.size());
+
+	for(unsigned int i = 0; i < word.size(); ++i)
+		ret += htonl(word[i]);
+
+	return ret;
+}}}
+
 bool deserialize_word(list<int32_t> &into, basic_string<int32_t>::iterator &it, basic_string<int32_t>::iterator limit)
 {{{
 	int length;
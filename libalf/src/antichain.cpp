@@ -0,0 +1,317 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * antichain-based language inclusion for finite_automaton.
+ *
+ * L(a) is a subset of L(b) iff no pair (p, S) is reachable where p is a
+ * final state of a and S is the set of states b can be in after the same
+ * word, without a final state. pairs are explored breadth-first. a pair
+ * (p, S) is dropped if a pair (p, S') with S' a subset of S was seen
+ * before, as everything rejected from S is rejected from S' as well.
+ * thus for each state p only the minimal sets are kept (the antichain).
+ *
+ * both automata are made epsilon-free on the fly: the states of a carry
+ * their epsilon-closure implicitly, the sets S are epsilon-closed.
+ */
+
+#include <set>
+#include <map>
+#include <list>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include "libalf/conjecture.h"
+
+namespace libalf {
+
+using namespace std;
+
+typedef uint64_t block;
+
+// transitions of an automaton without epsilons: successors of (state, symbol)
+// are targets[offsets[state * alphabet_size + symbol] ... offsets[... + 1]),
+// already epsilon-closed.
+class epsilon_free_transitions {
+	public:
+		int state_count;
+		int alphabet_size;
+		vector<int> offsets;
+		vector<int> targets;
+		// per state: epsilon closure contains a final state
+		vector<bool> final;
+		// epsilon closure of the initial states
+		vector<int> initial;
+
+	public:
+		epsilon_free_transitions(const finite_automaton & fa, int alphabet_size)
+		{{{
+			set<int>::const_iterator si;
+			set<int> final_states;
+			vector<set<int> > closure;
+			set<int> s;
+
+			state_count = fa.state_count;
+			this->alphabet_size = alphabet_size;
+
+			closure.resize(state_count);
+			for(int q = 0; q < state_count; ++q) {
+				closure[q].insert(q);
+				fa.epsilon_close(closure[q]);
+			}
+
+			fa.get_final_states(final_states);
+			final.assign(state_count, false);
+			for(int q = 0; q < state_count; ++q)
+				for(si = closure[q].begin(); si != closure[q].end(); ++si)
+					if(final_states.find(*si) != final_states.end())
+						final[q] = true;
+
+			s = fa.initial_states;
+			fa.epsilon_close(s);
+			initial.assign(s.begin(), s.end());
+
+			offsets.assign(state_count * alphabet_size + 1, 0);
+			for(int q = 0; q < state_count; ++q) {
+				for(int a = 0; a < alphabet_size; ++a) {
+					s.clear();
+					for(si = closure[q].begin(); si != closure[q].end(); ++si)
+						fa.add_successors(*si, a, s);
+					fa.epsilon_close(s);
+					targets.insert(targets.end(), s.begin(), s.end());
+					offsets[q * alphabet_size + a + 1] = targets.size();
+				}
+			}
+		}}}
+};
+
+// explored pair (p, S). S is stored in the block pool of the search.
+class antichain_entry {
+	public:
+		int state;
+		unsigned int set_offset;
+		int set_size;
+		block signature; // OR of all blocks of S, for quick subset rejection
+		int parent; // entry this one was reached from, or -1
+		int symbol; // symbol read from parent
+		int depth; // length of the word that reaches this entry
+		bool dead; // subsumed by a smaller set
+};
+
+class antichain_search {
+	protected:
+		const epsilon_free_transitions & a;
+		const epsilon_free_transitions & b;
+		unsigned int blocks;
+		vector<block> b_final;
+
+		vector<block> pool;
+		vector<antichain_entry> entries;
+		// live entries for each state of a
+		vector<vector<int> > index;
+		deque<int> queue;
+
+	public:
+		antichain_search(const epsilon_free_transitions & a, const epsilon_free_transitions & b)
+			: a(a), b(b)
+		{{{
+			blocks = (b.state_count + 63) / 64;
+			b_final.assign(blocks, 0);
+			for(int q = 0; q < b.state_count; ++q)
+				if(b.final[q])
+					b_final[q / 64] |= (block)1 << (q % 64);
+			index.resize(a.state_count);
+		}}}
+
+		// true if L(a) is a subset of L(b)
+		bool run(list<int> & counterexample)
+		{{{
+			vector<block> s(blocks, 0);
+			vector<block> post(blocks);
+			vector<int>::const_iterator ii;
+			int bad;
+
+			counterexample.clear();
+
+			for(ii = b.initial.begin(); ii != b.initial.end(); ++ii)
+				s[*ii / 64] |= (block)1 << (*ii % 64);
+			for(ii = a.initial.begin(); ii != a.initial.end(); ++ii) {
+				bad = insert(*ii, s, -1, -1);
+				if(bad >= 0) {
+					get_word(bad, counterexample);
+					return false;
+				}
+			}
+
+			while(!queue.empty()) {
+				int e = queue.front();
+				queue.pop_front();
+				if(entries[e].dead)
+					continue;
+
+				for(int sigma = 0; sigma < a.alphabet_size; ++sigma) {
+					int t = entries[e].state * a.alphabet_size + sigma;
+					if(a.offsets[t] == a.offsets[t+1])
+						continue;
+
+					successors(entries[e].set_offset, sigma, post);
+					for(int i = a.offsets[t]; i < a.offsets[t+1]; ++i) {
+						bad = insert(a.targets[i], post, e, sigma);
+						if(bad >= 0) {
+							get_word(bad, counterexample);
+							return false;
+						}
+					}
+				}
+			}
+
+			return true;
+		}}}
+
+	protected:
+		void successors(unsigned int set_offset, int sigma, vector<block> & post) const
+		{{{
+			fill(post.begin(), post.end(), 0);
+			for(unsigned int i = 0; i < blocks; ++i) {
+				block bits = pool[set_offset + i];
+				while(bits) {
+					int q = i * 64 + __builtin_ctzll(bits);
+					bits &= bits - 1;
+					int t = q * b.alphabet_size + sigma;
+					for(int j = b.offsets[t]; j < b.offsets[t+1]; ++j)
+						post[b.targets[j] / 64] |= (block)1 << (b.targets[j] % 64);
+				}
+			}
+		}}}
+
+		// is the set at offset a subset of s?
+		bool subset(unsigned int offset, const vector<block> & s) const
+		{{{
+			for(unsigned int i = 0; i < blocks; ++i)
+				if(pool[offset + i] & ~s[i])
+					return false;
+			return true;
+		}}}
+		bool superset(unsigned int offset, const vector<block> & s) const
+		{{{
+			for(unsigned int i = 0; i < blocks; ++i)
+				if(s[i] & ~pool[offset + i])
+					return false;
+			return true;
+		}}}
+
+		// add (state, s) unless it is subsumed. returns the new entry if
+		// it is a counterexample, -1 otherwise.
+		int insert(int state, const vector<block> & s, int parent, int symbol)
+		{{{
+			antichain_entry n;
+			vector<int> & live = index[state];
+			vector<int>::iterator li;
+			bool accepting = false;
+
+			n.state = state;
+			n.set_size = 0;
+			n.signature = 0;
+			n.parent = parent;
+			n.symbol = symbol;
+			n.depth = (parent >= 0) ? entries[parent].depth + 1 : 0;
+			n.dead = false;
+			for(unsigned int i = 0; i < blocks; ++i) {
+				n.set_size += __builtin_popcountll(s[i]);
+				n.signature |= s[i];
+				if(s[i] & b_final[i])
+					accepting = true;
+			}
+
+			// subsumed by a known smaller set?
+			for(li = live.begin(); li != live.end(); ++li) {
+				const antichain_entry & e = entries[*li];
+				if(e.set_size <= n.set_size && (e.signature & ~n.signature) == 0 && subset(e.set_offset, s))
+					return -1;
+			}
+			// drop known larger sets. an entry of a lower BFS level is
+			// kept, as its successors are reached by shorter words than
+			// those of the new entry, so dropping it could lose the
+			// shortest counterexample.
+			for(li = live.begin(); li != live.end(); /* -- */) {
+				antichain_entry & e = entries[*li];
+				if(e.depth >= n.depth && e.set_size >= n.set_size && (n.signature & ~e.signature) == 0 && superset(e.set_offset, s)) {
+					e.dead = true;
+					*li = live.back();
+					live.pop_back();
+				} else {
+					++li;
+				}
+			}
+
+			n.set_offset = pool.size();
+			pool.insert(pool.end(), s.begin(), s.end());
+			entries.push_back(n);
+			live.push_back(entries.size() - 1);
+
+			if(a.final[state] && !accepting)
+				return entries.size() - 1;
+
+			queue.push_back(entries.size() - 1);
+			return -1;
+		}}}
+
+		void get_word(int e, list<int> & word) const
+		{{{
+			word.clear();
+			while(entries[e].parent >= 0) {
+				word.push_front(entries[e].symbol);
+				e = entries[e].parent;
+			}
+		}}}
+};
+
+bool finite_automaton::antichain_is_subset_of(const finite_automaton & other, list<int> & counterexample) const
+{{{
+	counterexample.clear();
+	assert(this->valid && other.valid);
+	if(!this->valid || !other.valid)
+		return false;
+
+	int alphabet_size = max(this->input_alphabet_size, other.input_alphabet_size);
+	epsilon_free_transitions a(*this, alphabet_size);
+	epsilon_free_transitions b(other, alphabet_size);
+	antichain_search search(a, b);
+
+	return search.run(counterexample);
+}}}
+
+bool finite_automaton::antichain_is_equal(const finite_automaton & other, list<int> & counterexample) const
+{{{
+	if(!this->antichain_is_subset_of(other, counterexample))
+		return false;
+	return other.antichain_is_subset_of(*this, counterexample);
+}}}
+
+}; // end of namespace libalf
+
@@ -24,9 +24,11 @@
 
 #include <set>
 #include <map>
+#include <algorithm>
 #include <list>
 #include <queue>
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 #include <winsock.h>
@@ -34,6 +36,7 @@
 #include <stdio.h>
 #else
 #include <arpa/inet.h>
+#include <pthread.h>
 #endif
 
 #include <stdlib.h>
@@ -48,15 +51,23 @@ using namespace std;
 
 
 // helper-functions for human-readable parser:
-static string parser_split_line(string & blob)
+// the line of blob starting at pos, which is moved to the next line.
+// (blob is not cut, as that copies the rest of it for each line.)
+static string parser_split_line(const string & blob, size_t & pos)
 {{{
-	int p;
+	size_t p;
 	string tmp, ret;
 
+again:
 	// split first line off.
-	p = blob.find_first_of('\n');
-	tmp = blob.substr(0, p);
-	blob = blob.substr(p+1, string::npos);
+	p = blob.find_first_of('\n', pos);
+	if(p == string::npos) {
+		tmp = blob.substr(pos);
+		pos = blob.length();
+	} else {
+		tmp = blob.substr(pos, p - pos);
+		pos = p + 1;
+	}
 
 	// remove comments
 	tmp = tmp.substr(0, tmp.find_first_of('#'));
@@ -107,10 +118,10 @@ static string parser_split_line(string & blob)
 		ret = ret.substr(0, ret.size()-1);
 
 	// if this line is empty, try next line
-	if(ret.empty() && !blob.empty())
-		return parser_split_line(blob);
-	else
-		return ret;
+	if(ret.empty() && pos < blob.length())
+		goto again;
+
+	return ret;
 }}}
 static bool parser_get_set(string single, set<int>& s)
 {{{
@@ -141,6 +152,803 @@ static bool parser_get_set(string single, set<int>& s)
 
 
 
+// run fn(arg, first, limit) on [0, count), split into one chunk per thread.
+// without pthreads (windows), everything runs in the calling thread.
+class chunk_job {
+	public:
+		void (*fn)(void * arg, unsigned int first, unsigned int limit);
+		void * arg;
+		unsigned int first, limit;
+#ifndef _WIN32
+		pthread_t thread;
+#endif
+};
+static void * run_chunk_job(void * job)
+{{{
+	chunk_job * j = (chunk_job*)job;
+	j->fn(j->arg, j->first, j->limit);
+	return NULL;
+}}}
+static void run_in_chunks(unsigned int count, unsigned int threads, void (*fn)(void * arg, unsigned int first, unsigned int limit), void * arg)
+{{{
+	vector<chunk_job> jobs;
+	unsigned int i, started;
+
+#ifdef _WIN32
+	threads = 1;
+#endif
+	if(threads > count)
+		threads = count;
+	if(threads <= 1) {
+		fn(arg, 0, count);
+		return;
+	}
+
+	jobs.resize(threads);
+	for(i = 0; i < threads; ++i) {
+		jobs[i].fn = fn;
+		jobs[i].arg = arg;
+		jobs[i].first = (unsigned long long int)count * i / threads;
+		jobs[i].limit = (unsigned long long int)count * (i+1) / threads;
+	}
+	started = 1;
+#ifndef _WIN32
+	for(/* -- */; started < threads; ++started)
+		if(0 != pthread_create(&jobs[started].thread, NULL, run_chunk_job, &jobs[started]))
+			break;
+#endif
+	// the calling thread runs the first chunk, and all that could not be started
+	run_chunk_job(&jobs[0]);
+	for(i = started; i < threads; ++i)
+		run_chunk_job(&jobs[i]);
+#ifndef _WIN32
+	for(i = 1; i < started; ++i)
+		pthread_join(jobs[i].thread, NULL);
+#endif
+}}}
+
+
+
+
+void flat_transitions::clear()
+{{{
+	offsets.assign(1, 0);
+	symbols.clear();
+	targets.clear();
+	last_state = 0;
+}}}
+void flat_transitions::find(int state, int symbol, unsigned int & first, unsigned int & limit) const
+{{{
+	vector<int>::const_iterator b, e;
+
+	if(state < 0 || state >= get_state_count()) {
+		first = limit = 0;
+		return;
+	}
+
+	b = symbols.begin() + offsets[state];
+	e = symbols.begin() + offsets[state+1];
+	first = lower_bound(b, e, symbol) - symbols.begin();
+	limit = upper_bound(b, e, symbol) - symbols.begin();
+}}}
+bool flat_transitions::assign(int state_count, const map<int, map<int, set<int> > > & transitions)
+{{{
+	map<int, map<int, set<int> > >::const_iterator mmsi;
+	map<int, set<int> >::const_iterator msi;
+	set<int>::const_iterator si;
+
+	start(state_count);
+	for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi) {
+		for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
+			for(si = msi->second.begin(); si != msi->second.end(); ++si) {
+				if(!append(mmsi->first, msi->first, *si)) {
+					clear();
+					return false;
+				}
+			}
+		}
+	}
+	finish();
+
+	return true;
+}}}
+void flat_transitions::get(map<int, map<int, set<int> > > & transitions) const
+{{{
+	transitions.clear();
+	for(int q = 0; q < get_state_count(); ++q)
+		for(unsigned int i = offsets[q]; i < offsets[q+1]; ++i)
+			transitions[q][symbols[i]].insert(targets[i]);
+}}}
+void flat_transitions::start(int state_count)
+{{{
+	offsets.assign(state_count + 1, 0);
+	symbols.clear();
+	targets.clear();
+	last_state = 0;
+}}}
+bool flat_transitions::append(int state, int symbol, int target, bool allow_equal)
+{{{
+	if(state < 0 || state >= get_state_count() || state < last_state)
+		return false;
+
+	// offsets[state+1] counts the entries of state until finish()
+	if(state == last_state && offsets[state+1] > 0) {
+		if(symbol < symbols.back())
+			return false;
+		if(symbol == symbols.back()) {
+			if(target < targets.back() || (target == targets.back() && !allow_equal))
+				return false;
+		}
+	}
+
+	symbols.push_back(symbol);
+	targets.push_back(target);
+	offsets[state+1]++;
+	last_state = state;
+
+	return true;
+}}}
+void flat_transitions::finish()
+{{{
+	for(unsigned int i = 1; i < offsets.size(); ++i)
+		offsets[i] += offsets[i-1];
+	last_state = 0;
+}}}
+bool flat_transitions::in_range(int alphabet_size) const
+{{{
+	int state_count = get_state_count();
+
+	for(unsigned int i = 0; i < targets.size(); ++i)
+		if(symbols[i] < -1 || symbols[i] >= alphabet_size || targets[i] < 0 || targets[i] >= state_count)
+			return false;
+
+	return true;
+}}}
+bool flat_transitions::is_deterministic() const
+{{{
+	for(int q = 0; q < get_state_count(); ++q) {
+		for(unsigned int i = offsets[q]; i < offsets[q+1]; ++i) {
+			if(symbols[i] == -1)
+				return false;
+			if(i > offsets[q] && symbols[i] == symbols[i-1])
+				return false;
+		}
+	}
+
+	return true;
+}}}
+basic_string<int32_t> flat_transitions::serialize() const
+{{{
+	basic_string<int32_t> ret;
+	int states = 0;
+
+	for(int q = 0; q < get_state_count(); ++q)
+		if(offsets[q] < offsets[q+1])
+			states++;
+
+	// state -> symbol -> set of targets. written directly, as building a
+	// string per value is what makes ::serialize() of the maps slow.
+	ret.reserve(1 + 2 * states + 3 * targets.size());
+	ret.push_back(htonl(states));
+	for(int q = 0; q < get_state_count(); ++q) {
+		unsigned int i, j;
+		int count = 0;
+
+		if(offsets[q] == offsets[q+1])
+			continue;
+
+		for(i = offsets[q]; i < offsets[q+1]; ++i)
+			if(i == offsets[q] || symbols[i] != symbols[i-1])
+				count++;
+		ret.push_back(htonl(q));
+		ret.push_back(htonl(count));
+
+		for(i = offsets[q]; i < offsets[q+1]; i = j) {
+			for(j = i; j < offsets[q+1] && symbols[j] == symbols[i]; ++j)
+				;
+			ret.push_back(htonl(symbols[i]));
+			ret.push_back(htonl(j - i));
+			for(unsigned int k = i; k < j; ++k)
+				ret.push_back(htonl(targets[k]));
+		}
+	}
+
+	return ret;
+}}}
+bool flat_transitions::deserialize(int state_count, serial_stretch & serial)
+{{{
+	serial_stretch begin = serial;
+	int states, state, symbol_count, symbol, target_count, target;
+
+	if(state_count < 0)
+		goto failed;
+	start(state_count);
+
+	if(!::deserialize(states, serial)) goto failed;
+	for(/* -- */; states > 0; --states) {
+		if(!::deserialize(state, serial)) goto failed;
+		if(!::deserialize(symbol_count, serial)) goto failed;
+		for(/* -- */; symbol_count > 0; --symbol_count) {
+			if(!::deserialize(symbol, serial)) goto failed;
+			if(!::deserialize(target_count, serial)) goto failed;
+			for(/* -- */; target_count > 0; --target_count) {
+				if(!::deserialize(target, serial)) goto failed;
+				if(!append(state, symbol, target)) goto failed;
+			}
+		}
+	}
+	finish();
+
+	return true;
+failed:
+	serial = begin;
+	clear();
+	return false;
+}}}
+unsigned long long int flat_transitions::get_memory_usage() const
+{{{
+	return sizeof(*this)
+		+ offsets.capacity() * sizeof(unsigned int)
+		+ symbols.capacity() * sizeof(int)
+		+ targets.capacity() * sizeof(int);
+}}}
+
+
+
+
+transition_view::const_iterator & transition_view::const_iterator::operator++()
+{{{
+	if(flat)
+		++index;
+	else
+		++si;
+	skip_empty();
+	return *this;
+}}}
+bool transition_view::const_iterator::operator==(const const_iterator & other) const
+{{{
+	if(flat != other.flat || transitions != other.transitions)
+		return false;
+	if(flat)
+		return index == other.index;
+	if(transitions == NULL || mmsi == transitions->end() || other.mmsi == transitions->end())
+		return mmsi == other.mmsi;
+	return mmsi == other.mmsi && msi == other.msi && si == other.si;
+}}}
+void transition_view::const_iterator::enter_state()
+{{{
+	while(mmsi != transitions->end() && mmsi->second.empty())
+		++mmsi;
+	if(mmsi != transitions->end()) {
+		msi = mmsi->second.begin();
+		si = msi->second.begin();
+	}
+}}}
+void transition_view::const_iterator::skip_empty()
+{{{
+	if(flat) {
+		while(state < flat->get_state_count() && index >= flat->offsets[state+1])
+			++state;
+		return;
+	}
+
+	while(mmsi != transitions->end() && si == msi->second.end()) {
+		++msi;
+		if(msi != mmsi->second.end()) {
+			si = msi->second.begin();
+		} else {
+			++mmsi;
+			enter_state();
+		}
+	}
+}}}
+transition_view::const_iterator transition_view::begin() const
+{{{
+	const_iterator it;
+
+	it.flat = flat;
+	it.transitions = transitions;
+	if(!flat) {
+		it.mmsi = transitions->begin();
+		it.enter_state();
+	}
+	it.skip_empty();
+
+	return it;
+}}}
+transition_view::const_iterator transition_view::end() const
+{{{
+	const_iterator it;
+
+	it.flat = flat;
+	it.transitions = transitions;
+	if(flat) {
+		it.state = flat->get_state_count();
+		it.index = flat->size();
+	} else {
+		it.mmsi = transitions->end();
+	}
+
+	return it;
+}}}
+
+
+
+
+void compiled_transitions::clear()
+{{{
+	deterministic = true;
+	alphabet_size = 0;
+	state_count = 0;
+	successor.clear();
+	offsets.clear();
+	targets.clear();
+}}}
+bool compiled_transitions::compile(int state_count, int alphabet_size, const map<int, map<int, set<int> > > & transitions)
+{{{
+	map<int, map<int, set<int> > >::const_iterator mmsi;
+	map<int, set<int> >::const_iterator msi;
+	set<int>::const_iterator si;
+
+	clear();
+
+	if(state_count < 1 || alphabet_size < 1)
+		return false;
+
+	// check ranges and determinism (epsilon transitions are ignored)
+	for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi) {
+		if(mmsi->first < 0 || mmsi->first >= state_count)
+			return false;
+		for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
+			if(msi->first < -1 || msi->first >= alphabet_size)
+				return false;
+			for(si = msi->second.begin(); si != msi->second.end(); ++si)
+				if(*si < 0 || *si >= state_count)
+					return false;
+			if(msi->first >= 0 && msi->second.size() > 1)
+				deterministic = false;
+		}
+	}
+
+	if(deterministic) {
+		successor.assign(state_count * alphabet_size, -1);
+		for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi)
+			for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+				if(msi->first >= 0 && !msi->second.empty())
+					successor[mmsi->first * alphabet_size + msi->first] = *msi->second.begin();
+	} else {
+		offsets.assign(state_count * alphabet_size + 1, 0);
+		// count, then place
+		for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi)
+			for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+				if(msi->first >= 0)
+					offsets[mmsi->first * alphabet_size + msi->first + 1] = msi->second.size();
+		for(unsigned int i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i-1];
+		targets.resize(offsets.back());
+		for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi)
+			for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+				if(msi->first >= 0)
+					copy(msi->second.begin(), msi->second.end(), targets.begin() + offsets[mmsi->first * alphabet_size + msi->first]);
+	}
+
+	this->state_count = state_count;
+	this->alphabet_size = alphabet_size;
+
+	return true;
+}}}
+bool compiled_transitions::compile(int state_count, int alphabet_size, const flat_transitions & transitions)
+{{{
+	unsigned int i;
+
+	clear();
+
+	if(state_count < 1 || alphabet_size < 1)
+		return false;
+	if(transitions.get_state_count() != state_count || !transitions.in_range(alphabet_size))
+		return false;
+
+	// epsilon transitions are ignored
+	deterministic = true;
+	for(int q = 0; q < state_count; ++q)
+		for(i = transitions.offsets[q] + 1; i < transitions.offsets[q+1]; ++i)
+			if(transitions.symbols[i] >= 0 && transitions.symbols[i] == transitions.symbols[i-1])
+				deterministic = false;
+
+	if(deterministic) {
+		successor.assign(state_count * alphabet_size, -1);
+		for(int q = 0; q < state_count; ++q)
+			for(i = transitions.offsets[q]; i < transitions.offsets[q+1]; ++i)
+				if(transitions.symbols[i] >= 0)
+					successor[q * alphabet_size + transitions.symbols[i]] = transitions.targets[i];
+	} else {
+		// entries are sorted, so the targets of (state, symbol) are
+		// placed in order
+		offsets.assign(state_count * alphabet_size + 1, 0);
+		for(int q = 0; q < state_count; ++q)
+			for(i = transitions.offsets[q]; i < transitions.offsets[q+1]; ++i)
+				if(transitions.symbols[i] >= 0)
+					offsets[q * alphabet_size + transitions.symbols[i] + 1]++;
+		for(i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i-1];
+		for(int q = 0; q < state_count; ++q)
+			for(i = transitions.offsets[q]; i < transitions.offsets[q+1]; ++i)
+				if(transitions.symbols[i] >= 0)
+					targets.push_back(transitions.targets[i]);
+	}
+
+	this->state_count = state_count;
+	this->alphabet_size = alphabet_size;
+
+	return true;
+}}}
+int compiled_transitions::run(int state, list<int>::const_iterator & word, list<int>::const_iterator word_end) const
+{{{
+	while(word != word_end) {
+		if(*word < 0 || *word >= alphabet_size)
+			break;
+		state = successor[state * alphabet_size + *word];
+		++word;
+		if(state < 0)
+			break;
+	}
+
+	return state;
+}}}
+void compiled_transitions::run(set<int> & states, list<int>::const_iterator & word, list<int>::const_iterator word_end) const
+{{{
+	if(word == word_end || states.empty())
+		return;
+
+	if(deterministic && states.size() == 1) {
+		int state = *states.begin();
+		states.clear();
+		if(state >= 0 && state < state_count) {
+			state = run(state, word, word_end);
+			if(state >= 0)
+				states.insert(state);
+		}
+		return;
+	}
+
+	int blocks = (state_count + 63) / 64;
+	vector<block> current(blocks, 0), next(blocks);
+	set<int>::const_iterator si;
+	bool any = false;
+
+	// states without transitions drop out, just as in the map-based run()
+	for(si = states.begin(); si != states.end(); ++si) {
+		if(*si >= 0 && *si < state_count) {
+			current[*si / 64] |= (block)1 << (*si % 64);
+			any = true;
+		}
+	}
+
+	while(any && word != word_end) {
+		int sym = *word;
+		if(sym < 0 || sym >= alphabet_size)
+			break;
+
+		next.assign(blocks, 0);
+		any = false;
+		for(int b = 0; b < blocks; ++b) {
+			block bits = current[b];
+			while(bits) {
+				int state = b * 64 + __builtin_ctzll(bits);
+				bits &= bits - 1;
+				if(deterministic) {
+					int d = successor[state * alphabet_size + sym];
+					if(d >= 0) {
+						next[d / 64] |= (block)1 << (d % 64);
+						any = true;
+					}
+				} else {
+					int t = state * alphabet_size + sym;
+					for(int i = offsets[t]; i < offsets[t+1]; ++i) {
+						next[targets[i] / 64] |= (block)1 << (targets[i] % 64);
+						any = true;
+					}
+				}
+			}
+		}
+		current.swap(next);
+		++word;
+	}
+
+	states.clear();
+	for(int b = 0; b < blocks; ++b) {
+		block bits = current[b];
+		while(bits) {
+			states.insert(b * 64 + __builtin_ctzll(bits));
+			bits &= bits - 1;
+		}
+	}
+}}}
+class compiled_corpus_run {
+	public:
+		const compiled_transitions * compiled;
+		int state;
+		const word_corpus * corpus;
+		vector<int> * states;
+};
+static void compiled_corpus_chunk(void * arg, unsigned int first, unsigned int limit)
+{{{
+	compiled_corpus_run * r = (compiled_corpus_run*)arg;
+	r->compiled->run_lockstep(r->state, *r->corpus, first, limit, *r->states);
+}}}
+void compiled_transitions::run(int state, const word_corpus & corpus, vector<int> & states, unsigned int threads) const
+{{{
+	compiled_corpus_run r;
+
+	states.resize(corpus.size());
+
+	r.compiled = this;
+	r.state = state;
+	r.corpus = &corpus;
+	r.states = &states;
+	run_in_chunks(corpus.size(), threads, compiled_corpus_chunk, &r);
+}}}
+void compiled_transitions::run_lockstep(int initial, const word_corpus & corpus, unsigned int first, unsigned int limit, vector<int> & states) const
+{{{
+	// a group of words is run one symbol per word and step, so the
+	// table lookups of different words overlap.
+	enum { lanes = 16 };
+	int state[lanes];
+	unsigned int pos[lanes], end[lanes];
+	const int32_t * symbols = corpus.symbols.empty() ? NULL : &corpus.symbols[0];
+	const int * table = &successor[0];
+
+	if(initial < 0 || initial >= state_count) {
+		for(unsigned int w = first; w < limit; ++w)
+			states[w] = -1;
+		return;
+	}
+
+	for(unsigned int base = first; base < limit; base += lanes) {
+		unsigned int n = (limit - base < (unsigned int)lanes) ? limit - base : (unsigned int)lanes;
+		unsigned int maxlen = 0;
+		unsigned int l;
+
+		for(l = 0; l < n; ++l) {
+			state[l] = initial;
+			pos[l] = corpus.offsets[base + l];
+			end[l] = corpus.offsets[base + l + 1];
+			if(end[l] - pos[l] > maxlen)
+				maxlen = end[l] - pos[l];
+		}
+
+		for(unsigned int step = 0; step < maxlen; ++step) {
+			for(l = 0; l < n; ++l) {
+				if(pos[l] < end[l] && state[l] >= 0) {
+					int sym = symbols[pos[l]++];
+					if(sym < 0 || sym >= alphabet_size)
+						state[l] = -2;
+					else
+						state[l] = table[state[l] * alphabet_size + sym];
+				}
+			}
+		}
+
+		for(l = 0; l < n; ++l)
+			states[base + l] = state[l];
+	}
+}}}
+unsigned long long int compiled_transitions::get_memory_usage() const
+{{{
+	return sizeof(*this) + sizeof(int) * (successor.capacity() + offsets.capacity() + targets.capacity());
+}}}
+
+
+// orders states by a key, e.g. their label
+class key_less {
+	public:
+		const vector<int> & key;
+		key_less(const vector<int> & key) : key(key)
+		{ };
+		bool operator()(int a, int b) const
+		{ return key[a] < key[b]; }
+};
+
+void partition_refiner::prepare(int state_count, int alphabet_size)
+{{{
+	this->state_count = state_count;
+	this->alphabet_size = alphabet_size;
+	delta.assign(state_count * alphabet_size, -1);
+	labels.assign(state_count, 0);
+}}}
+int partition_refiner::refine(int initial_state, int sink_label)
+{{{
+	int n, sink, largest, b, i, q, a, t;
+	bool need_sink = false;
+
+	// reachable states, breadth-first
+	compact.assign(state_count, -1);
+	original.clear();
+	compact[initial_state] = 0;
+	original.push_back(initial_state);
+	for(i = 0; i < (int)original.size(); ++i) {
+		q = original[i];
+		for(a = 0; a < alphabet_size; ++a) {
+			t = delta[q * alphabet_size + a];
+			if(t < 0) {
+				need_sink = true;
+			} else if(compact[t] < 0) {
+				compact[t] = original.size();
+				original.push_back(t);
+			}
+		}
+	}
+	n = original.size();
+	sink = -1;
+	if(need_sink)
+		sink = n++;
+
+	compact_delta.resize(n * alphabet_size);
+	for(q = 0; q < n; ++q) {
+		for(a = 0; a < alphabet_size; ++a) {
+			if(q == sink) {
+				t = sink;
+			} else {
+				t = delta[original[q] * alphabet_size + a];
+				t = (t < 0) ? sink : compact[t];
+			}
+			compact_delta[q * alphabet_size + a] = t;
+		}
+	}
+
+	// inverse transitions, by counting sort
+	inv_offsets.assign(n * alphabet_size + 1, 0);
+	for(i = 0; i < n * alphabet_size; ++i)
+		inv_offsets[compact_delta[i] * alphabet_size + i % alphabet_size + 1]++;
+	for(i = 0; i < n * alphabet_size; ++i)
+		inv_offsets[i + 1] += inv_offsets[i];
+	inv_sources.resize(n * alphabet_size);
+	splitter.assign(inv_offsets.begin(), inv_offsets.end() - 1);
+	for(i = 0; i < n * alphabet_size; ++i)
+		inv_sources[splitter[compact_delta[i] * alphabet_size + i % alphabet_size]++] = i / alphabet_size;
+
+	// initial partition: one block per label
+	position.resize(n);
+	elements.resize(n);
+	for(q = 0; q < n; ++q) {
+		position[q] = (q == sink) ? sink_label : labels[original[q]];
+		elements[q] = q;
+	}
+	sort(elements.begin(), elements.end(), key_less(position));
+
+	block.resize(n);
+	block_first.clear();
+	block_end.clear();
+	for(i = 0; i < n; ++i) {
+		if(i == 0 || position[elements[i]] != position[elements[i-1]]) {
+			if(i > 0)
+				block_end.push_back(i);
+			block_first.push_back(i);
+		}
+	}
+	block_end.push_back(n);
+	for(b = 0; b < (int)block_first.size(); ++b) {
+		for(i = block_first[b]; i < block_end[b]; ++i) {
+			block[elements[i]] = b;
+			position[elements[i]] = i;
+		}
+	}
+
+	marked.assign(n, 0);
+	waiting.assign(n, false);
+	worklist.clear();
+	touched.clear();
+
+	// it suffices to split by all initial blocks but one
+	largest = 0;
+	for(b = 1; b < (int)block_first.size(); ++b)
+		if(block_end[b] - block_first[b] > block_end[largest] - block_first[largest])
+			largest = b;
+	for(b = 0; b < (int)block_first.size(); ++b) {
+		if(b != largest) {
+			worklist.push_back(b);
+			waiting[b] = true;
+		}
+	}
+
+	while(!worklist.empty()) {
+		int s = worklist.back();
+		worklist.pop_back();
+		waiting[s] = false;
+		splitter.assign(elements.begin() + block_first[s], elements.begin() + block_end[s]);
+
+		for(a = 0; a < alphabet_size; ++a) {
+			vector<int>::const_iterator si;
+			for(si = splitter.begin(); si != splitter.end(); ++si) {
+				int first = inv_offsets[*si * alphabet_size + a];
+				int limit = inv_offsets[*si * alphabet_size + a + 1];
+				for(int j = first; j < limit; ++j) {
+					int p = inv_sources[j];
+					int m;
+					b = block[p];
+					m = block_first[b] + marked[b];
+					if(position[p] < m)
+						continue;
+					// move p to the marked part of its block
+					elements[position[p]] = elements[m];
+					position[elements[m]] = position[p];
+					elements[m] = p;
+					position[p] = m;
+					if(marked[b]++ == 0)
+						touched.push_back(b);
+				}
+			}
+
+			for(si = touched.begin(); si != touched.end(); ++si) {
+				if(marked[*si] < block_end[*si] - block_first[*si])
+					split_block(*si);
+				marked[*si] = 0;
+			}
+			touched.clear();
+		}
+	}
+
+	// number the blocks breadth-first. the sink block is dropped.
+	int dropped = -1;
+	if(sink >= 0 && block[sink] != block[0])
+		dropped = block[sink];
+
+	// marked is the new number of each block, touched a compact representative
+	marked.assign(block_first.size(), -1);
+	touched.clear();
+	marked[block[0]] = 0;
+	touched.push_back(0);
+	for(i = 0; i < (int)touched.size(); ++i) {
+		for(a = 0; a < alphabet_size; ++a) {
+			t = compact_delta[touched[i] * alphabet_size + a];
+			b = block[t];
+			if(b == dropped || marked[b] >= 0)
+				continue;
+			marked[b] = touched.size();
+			q = elements[block_first[b]];
+			if(q == sink)
+				q = elements[block_first[b] + 1];
+			touched.push_back(q);
+		}
+	}
+
+	representative.resize(touched.size());
+	for(i = 0; i < (int)touched.size(); ++i)
+		representative[i] = original[touched[i]];
+
+	block_of.assign(state_count, -1);
+	for(q = 0; q < n; ++q)
+		if(q != sink && block[q] != dropped)
+			block_of[original[q]] = marked[block[q]];
+
+	return touched.size();
+}}}
+int partition_refiner::split_block(int b)
+{{{
+	int nb = block_first.size();
+	int smaller;
+
+	// the marked part becomes the new block
+	block_first.push_back(block_first[b]);
+	block_end.push_back(block_first[b] + marked[b]);
+	block_first[b] = block_end[nb];
+	for(int i = block_first[nb]; i < block_end[nb]; ++i)
+		block[elements[i]] = nb;
+
+	if(waiting[b]) {
+		worklist.push_back(nb);
+		waiting[nb] = true;
+	} else {
+		smaller = (block_end[nb] - block_first[nb] <= block_end[b] - block_first[b]) ? nb : b;
+		worklist.push_back(smaller);
+		waiting[smaller] = true;
+	}
+
+	return nb;
+}}}
+
+
+
 
 bool finite_automaton::calc_validity()
 {{{
@@ -184,18 +992,30 @@ basic_string<int32_t> finite_automaton::serialize() const
 		map<int, set<int> >::const_iterator msi;
 		set<int>::const_iterator si;
 
-		for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi) {
-			for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
-				for(si = msi->second.begin(); si != msi->second.end(); ++si) {
-					++transition_count;
-					transition_ser += ::serialize(mmsi->first); // src
-					transition_ser += ::serialize(msi->first); // label
-					transition_ser += ::serialize(*si); // dst
+		if(use_flat) {
+			ret += ::serialize((int)flat.size());
+			ret.reserve(ret.length() + 3 * flat.size() + 1);
+			for(int q = 0; q < flat.get_state_count(); ++q) {
+				for(unsigned int i = flat.offsets[q]; i < flat.offsets[q+1]; ++i) {
+					ret.push_back(htonl(q)); // src
+					ret.push_back(htonl(flat.symbols[i])); // label
+					ret.push_back(htonl(flat.targets[i])); // dst
 				}
 			}
+		} else {
+			for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi) {
+				for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
+					for(si = msi->second.begin(); si != msi->second.end(); ++si) {
+						++transition_count;
+						transition_ser += ::serialize(mmsi->first); // src
+						transition_ser += ::serialize(msi->first); // label
+						transition_ser += ::serialize(*si); // dst
+					}
+				}
+			}
+			ret += ::serialize(transition_count);
+			ret += transition_ser;
 		}
-		ret += ::serialize(transition_count);
-		ret += transition_ser;
 
 		ret[0] = htonl(ret.length() - 1);
 	}
@@ -208,6 +1028,7 @@ bool finite_automaton::deserialize(serial_stretch & serial)
 	int transition_count;
 	int i;
 	int src, label, dst;
+	bool in_order = false;
 
 	set<int> final;
 	set<int>::const_iterator si;
@@ -226,12 +1047,31 @@ bool finite_automaton::deserialize(serial_stretch & serial)
 		output_mapping[*si] = true;
 	// transitions
 	if(!::deserialize(transition_count, serial)) goto invalid;
+	if(use_flat) {
+		// serialize() writes them in order, so they are appended
+		// directly. otherwise they are collected in the map first.
+		in_order = (this->state_count >= 0);
+		if(in_order)
+			flat.start(this->state_count);
+	}
 	for(i = 0; i < transition_count; ++i) {
 		if(!::deserialize(src, serial)) goto invalid;
 		if(!::deserialize(label, serial)) goto invalid;
 		if(!::deserialize(dst, serial)) goto invalid;
+		if(in_order && flat.append(src, label, dst))
+			continue;
+		if(in_order) {
+			in_order = false;
+			flat.finish();
+			flat.get(this->transitions);
+			flat.clear();
+		}
 		this->transitions[src][label].insert(dst);
 	}
+	if(in_order)
+		flat.finish();
+	else if(use_flat && !flatten())
+		goto invalid;
 
 	this->valid = true;
 	return true;
@@ -283,13 +1123,22 @@ string finite_automaton::write() const
 
 		ret += "\n[transitions]\n";
 
-		for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi) {
-			for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
-				for(si = msi->second.begin(); si != msi->second.end(); ++si) {
-					snprintf(buf, 256, "\t%d, %d, %d;\n", mmsi->first, msi->first, *si);
+		if(use_flat) {
+			for(int q = 0; q < flat.get_state_count(); ++q) {
+				for(unsigned int i = flat.offsets[q]; i < flat.offsets[q+1]; ++i) {
+					snprintf(buf, 256, "\t%d, %d, %d;\n", q, flat.symbols[i], flat.targets[i]);
 					ret += buf;
 				}
 			}
+		} else {
+			for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi) {
+				for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi) {
+					for(si = msi->second.begin(); si != msi->second.end(); ++si) {
+						snprintf(buf, 256, "\t%d, %d, %d;\n", mmsi->first, msi->first, *si);
+						ret += buf;
+					}
+				}
+			}
 		}
 	}
 
@@ -310,9 +1159,10 @@ bool finite_automaton::read(string input)
 
 	// split lines
 	string line, single, token;
+	size_t input_pos = 0;
 	while(1) {
-		line = parser_split_line(input);
-		if(input.empty() && line.empty())
+		line = parser_split_line(input, input_pos);
+		if(input_pos >= input.length() && line.empty())
 			break;
 
 		// split semi-colons
@@ -438,6 +1288,9 @@ bool finite_automaton::read(string input)
 	}
 
 	this->valid = set_is_det && set_alphabet_size && set_state_count;
+	// parse_transition() fills the map
+	if(this->valid && use_flat && !flatten())
+		this->valid = false;
 
 end:
 	if(!valid)
@@ -508,10 +1361,16 @@ string finite_automaton::visualize() const
 		map<int, map<int, set<int> > >::const_iterator mmsi;
 		map<int, set<int> >::const_iterator msi;
 		set<int>::const_iterator si;
-		for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi)
-			for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
-				for(si = msi->second.begin(); si != msi->second.end(); ++si)
-					str << "\tq" << mmsi->first << " -> q" << *si << " [label=\"" << msi->first << "\"];\n";
+		if(use_flat) {
+			for(int q = 0; q < flat.get_state_count(); ++q)
+				for(unsigned int i = flat.offsets[q]; i < flat.offsets[q+1]; ++i)
+					str << "\tq" << q << " -> q" << flat.targets[i] << " [label=\"" << flat.symbols[i] << "\"];\n";
+		} else {
+			for(mmsi = this->transitions.begin(); mmsi != this->transitions.end(); ++mmsi)
+				for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+					for(si = msi->second.begin(); si != msi->second.end(); ++si)
+						str << "\tq" << mmsi->first << " -> q" << *si << " [label=\"" << msi->first << "\"];\n";
+		}
 
 		// end
 		str << "}\n";
@@ -528,8 +1387,24 @@ bool finite_automaton::contains(const list<int> & word) const
 	set<int> current_states;
 	set<int>::const_iterator si;
 
-	current_states = this->initial_states;
-	run(current_states, word.begin(), word.end());
+	if(!compiled.empty() && compiled.is_deterministic() && initial_states.size() == 1) {
+		list<int>::const_iterator wi = word.begin();
+		int state = *initial_states.begin();
+
+		if(state >= 0 && state < state_count) {
+			state = compiled.run(state, wi, word.end());
+			if(state < 0)
+				return false;
+			if(wi == word.end())
+				return compiled_final[state];
+			// stopped at a symbol outside the alphabet
+			current_states.insert(state);
+			run(current_states, wi, word.end());
+		}
+	} else {
+		current_states = this->initial_states;
+		run(current_states, word.begin(), word.end());
+	}
 
 	// check if a final state was reached
 	map<int, bool>::const_iterator fi;
@@ -543,6 +1418,49 @@ bool finite_automaton::contains(const list<int> & word) const
 
 	return false;
 }}}
+class corpus_contains_run {
+	public:
+		const finite_automaton * automaton;
+		const word_corpus * corpus;
+		vector<char> * results;
+};
+static void corpus_contains_chunk(void * arg, unsigned int first, unsigned int limit)
+{{{
+	corpus_contains_run * r = (corpus_contains_run*)arg;
+
+	for(unsigned int i = first; i < limit; ++i)
+		(*r->results)[i] = r->automaton->contains(r->corpus->get_word(i));
+}}}
+void finite_automaton::contains(const word_corpus & corpus, vector<bool> & results, unsigned int threads) const
+{{{
+	results.assign(corpus.size(), false);
+	if(!this->valid)
+		return;
+
+	if(!compiled.empty() && compiled.is_deterministic() && initial_states.size() == 1) {
+		vector<int> states;
+
+		compiled.run(*initial_states.begin(), corpus, states, threads);
+		for(unsigned int i = 0; i < corpus.size(); ++i) {
+			if(states[i] >= 0)
+				results[i] = compiled_final[states[i]];
+			else if(states[i] == -2)
+				// a symbol outside the alphabet
+				results[i] = contains(corpus.get_word(i));
+		}
+	} else {
+		// std::vector<bool> can not be written by several threads
+		vector<char> res(corpus.size(), 0);
+		corpus_contains_run r;
+
+		r.automaton = this;
+		r.corpus = &corpus;
+		r.results = &res;
+		run_in_chunks(corpus.size(), threads, corpus_contains_chunk, &r);
+		for(unsigned int i = 0; i < corpus.size(); ++i)
+			results[i] = res[i];
+	}
+}}}
 void finite_automaton::get_final_states(set<int> & into) const
 {{{
 	map<int, bool>::const_iterator oi;
@@ -565,6 +1483,8 @@ void finite_automaton::set_final_states(const set<int> &final)
 	this->set_all_non_accepting();
 	for(si = final.begin(); si != final.end(); ++si)
 		this->output_mapping[*si] = true;
+	if(!compiled.empty())
+		compile_final_states();
 }}}
 
 void finite_automaton::set_all_non_accepting()
@@ -572,6 +1492,29 @@ void finite_automaton::set_all_non_accepting()
 	this->output_mapping.clear();
 	for(int i = 0; i < this->state_count; ++i)
 		output_mapping[i] = false;
+	if(!compiled.empty())
+		compile_final_states();
+}}}
+bool finite_automaton::compile()
+{{{
+	if(!moore_machine<bool>::compile())
+		return false;
+	compile_final_states();
+	return true;
+}}}
+void finite_automaton::uncompile()
+{{{
+	moore_machine<bool>::uncompile();
+	compiled_final.clear();
+}}}
+void finite_automaton::compile_final_states()
+{{{
+	map<int, bool>::const_iterator oi;
+
+	compiled_final.assign(this->state_count, false);
+	for(oi = output_mapping.begin(); oi != output_mapping.end(); ++oi)
+		if(oi->first >= 0 && oi->first < this->state_count)
+			compiled_final[oi->first] = oi->second;
 }}}
 bool finite_automaton::parse_transition(string single)
 {{{
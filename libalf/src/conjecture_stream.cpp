@@ -0,0 +1,628 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#include <set>
+#include <map>
+#include <string>
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "libalf/conjecture_stream.h"
+
+namespace libalf {
+
+using namespace std;
+
+static const char stream_magic[8] = { 'l', 'i', 'b', 'a', 'l', 'f', 'F', 'A' };
+static const uint32_t stream_version = 1;
+
+static const uint32_t chunk_head = 0x48454144; // "HEAD"
+static const uint32_t chunk_final = 0x46494e4c; // "FINL"
+static const uint32_t chunk_transitions = 0x54524e53; // "TRNS"
+static const uint32_t chunk_end = 0x454e4420; // "END "
+
+// a larger chunk is taken as a broken stream, instead of allocating it
+static const uint32_t max_chunk_length = 64 * 1024 * 1024;
+
+// CRC-32 (IEEE 802.3), as zlib and PNG use it
+class crc32_table {
+	public:
+		uint32_t entry[256];
+		crc32_table()
+		{{{
+			for(uint32_t i = 0; i < 256; ++i) {
+				uint32_t c = i;
+				for(int k = 0; k < 8; ++k)
+					c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+				entry[i] = c;
+			}
+		}}}
+};
+static crc32_table crc_table;
+
+static uint32_t crc32_update(uint32_t crc, const char * data, size_t length)
+{{{
+	crc = ~crc;
+	for(size_t i = 0; i < length; ++i)
+		crc = crc_table.entry[(crc ^ (unsigned char)data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}}}
+
+static void put_uint32(string & s, uint32_t v)
+{{{
+	char b[4];
+	b[0] = v >> 24;
+	b[1] = v >> 16;
+	b[2] = v >> 8;
+	b[3] = v;
+	s.append(b, 4);
+}}}
+static uint32_t get_uint32(const char * b)
+{{{
+	return ((uint32_t)(unsigned char)b[0] << 24) | ((uint32_t)(unsigned char)b[1] << 16)
+		| ((uint32_t)(unsigned char)b[2] << 8) | (uint32_t)(unsigned char)b[3];
+}}}
+static void set_uint32(string & s, size_t pos, uint32_t v)
+{{{
+	s[pos] = v >> 24;
+	s[pos+1] = v >> 16;
+	s[pos+2] = v >> 8;
+	s[pos+3] = v;
+}}}
+
+// 7 bits per byte, least significant first. the high bit marks that more
+// bytes follow.
+static void put_varint(string & s, uint32_t v)
+{{{
+	while(v >= 0x80) {
+		s.push_back((char)(v | 0x80));
+		v >>= 7;
+	}
+	s.push_back((char)v);
+}}}
+// small differences of either sign become small numbers
+static uint32_t zigzag(uint32_t difference)
+{{{
+	return (difference << 1) ^ (uint32_t)((int32_t)difference >> 31);
+}}}
+static uint32_t unzigzag(uint32_t z)
+{{{
+	return (z >> 1) ^ (0 - (z & 1));
+}}}
+
+
+
+void conjecture_writer::init(bool compress, unsigned int chunk_entries)
+{{{
+	this->compress = compress;
+	this->chunk_entries = chunk_entries > 0 ? chunk_entries : 1;
+	failed = false;
+	started = false;
+	bytes = 0;
+	final_count = 0;
+	transition_count = 0;
+	total_finals = 0;
+	total_transitions = 0;
+}}}
+conjecture_writer::conjecture_writer(ostream & out, bool compress, unsigned int chunk_entries)
+{{{
+	this->out = &out;
+	this->fd = -1;
+	init(compress, chunk_entries);
+}}}
+conjecture_writer::conjecture_writer(int fd, bool compress, unsigned int chunk_entries)
+{{{
+	this->out = NULL;
+	this->fd = fd;
+	init(compress, chunk_entries);
+}}}
+bool conjecture_writer::put(const char * data, size_t length)
+{{{
+	if(failed)
+		return false;
+
+	bytes += length;
+
+	if(out) {
+		out->write(data, length);
+		if(!out->good())
+			failed = true;
+	} else {
+		while(length > 0) {
+			ssize_t n = ::write(fd, data, length);
+			if(n < 0) {
+				if(errno == EINTR)
+					continue;
+				failed = true;
+				break;
+			}
+			data += n;
+			length -= n;
+		}
+	}
+	return !failed;
+}}}
+bool conjecture_writer::put_chunk(uint32_t type, const string & payload)
+{{{
+	string head;
+	uint32_t crc;
+	string tail;
+
+	put_uint32(head, type);
+	put_uint32(head, payload.length());
+	crc = crc32_update(0, head.data(), head.length());
+	crc = crc32_update(crc, payload.data(), payload.length());
+	put_uint32(tail, crc);
+
+	return put(head.data(), head.length()) && put(payload.data(), payload.length()) && put(tail.data(), tail.length());
+}}}
+bool conjecture_writer::begin(bool is_dfa, int alphabet_size, int state_count, const set<int> & initial_states)
+{{{
+	string s;
+	set<int>::const_iterator si;
+
+	if(failed || started)
+		return false;
+	started = true;
+
+	s.append(stream_magic, 8);
+	put_uint32(s, stream_version);
+	put_uint32(s, compress ? STREAM_COMPRESSED : 0);
+	if(!put(s.data(), s.length()))
+		return false;
+
+	s.clear();
+	put_uint32(s, is_dfa ? 1 : 0);
+	put_uint32(s, alphabet_size);
+	put_uint32(s, state_count);
+	put_uint32(s, initial_states.size());
+	for(si = initial_states.begin(); si != initial_states.end(); ++si)
+		put_uint32(s, *si);
+
+	return put_chunk(chunk_head, s);
+}}}
+bool conjecture_writer::flush_finals()
+{{{
+	bool ok;
+
+	if(final_count == 0)
+		return !failed;
+	set_uint32(finals, 0, final_count);
+	ok = put_chunk(chunk_final, finals);
+	final_count = 0;
+	finals.clear();
+
+	return ok;
+}}}
+bool conjecture_writer::flush_transitions()
+{{{
+	bool ok;
+
+	if(transition_count == 0)
+		return !failed;
+	set_uint32(transitions, 0, transition_count);
+	ok = put_chunk(chunk_transitions, transitions);
+	transition_count = 0;
+	transitions.clear();
+
+	return ok;
+}}}
+bool conjecture_writer::add_final_state(int state)
+{{{
+	if(failed || !started)
+		return false;
+
+	if(final_count == 0) {
+		put_uint32(finals, 0); // count, set by flush_finals()
+		last_final = 0;
+	}
+	if(compress)
+		put_varint(finals, zigzag((uint32_t)state - (uint32_t)last_final));
+	else
+		put_uint32(finals, state);
+	last_final = state;
+	++total_finals;
+
+	if(++final_count >= chunk_entries)
+		return flush_finals();
+	return true;
+}}}
+bool conjecture_writer::add_transition(int source, int label, int destination)
+{{{
+	if(failed || !started)
+		return false;
+
+	if(transition_count == 0) {
+		put_uint32(transitions, 0); // count, set by flush_transitions()
+		last_source = 0;
+	}
+	if(compress) {
+		put_varint(transitions, zigzag((uint32_t)source - (uint32_t)last_source));
+		put_varint(transitions, zigzag(label));
+		put_varint(transitions, zigzag((uint32_t)destination - (uint32_t)source));
+	} else {
+		put_uint32(transitions, source);
+		put_uint32(transitions, label);
+		put_uint32(transitions, destination);
+	}
+	last_source = source;
+	++total_transitions;
+
+	if(++transition_count >= chunk_entries)
+		return flush_transitions();
+	return true;
+}}}
+bool conjecture_writer::finish()
+{{{
+	string s;
+
+	if(failed || !started)
+		return false;
+	if(!flush_finals() || !flush_transitions())
+		return false;
+
+	put_uint32(s, total_finals);
+	put_uint32(s, total_transitions);
+	if(!put_chunk(chunk_end, s))
+		return false;
+	started = false;
+
+	if(out) {
+		out->flush();
+		if(!out->good())
+			failed = true;
+	}
+
+	return !failed;
+}}}
+bool conjecture_writer::write(const finite_automaton & automaton)
+{{{
+	map<int, bool>::const_iterator oi;
+
+	if(!automaton.valid)
+		return false;
+
+	if(!begin(automaton.is_deterministic, automaton.input_alphabet_size, automaton.state_count, automaton.initial_states))
+		return false;
+
+	for(oi = automaton.output_mapping.begin(); oi != automaton.output_mapping.end(); ++oi)
+		if(oi->second)
+			if(!add_final_state(oi->first))
+				return false;
+
+	transition_view transitions = automaton.get_transition_view();
+	for(transition_view::const_iterator ti = transitions.begin(); ti != transitions.end(); ++ti)
+		if(!add_transition(ti.source(), ti.symbol(), ti.target()))
+			return false;
+
+	return finish();
+}}}
+
+
+
+void conjecture_reader::init()
+{{{
+	failed = false;
+	ended = false;
+	bytes = 0;
+	buffer_pos = 0;
+	compressed = false;
+	chunk_type = 0;
+	chunk_pos = 0;
+	chunk_left = 0;
+	last_state = 0;
+	total_finals = 0;
+	total_transitions = 0;
+}}}
+conjecture_reader::conjecture_reader(istream & in)
+{{{
+	this->in = &in;
+	this->fd = -1;
+	init();
+}}}
+conjecture_reader::conjecture_reader(int fd)
+{{{
+	this->in = NULL;
+	this->fd = fd;
+	init();
+}}}
+bool conjecture_reader::get(char * data, size_t length)
+{{{
+	while(length > 0) {
+		size_t n;
+
+		if(buffer_pos == buffer.length()) {
+			// refill
+			buffer.resize(65536);
+			buffer_pos = 0;
+			if(in) {
+				in->read(&buffer[0], buffer.length());
+				n = in->gcount();
+			} else {
+				ssize_t r;
+				do {
+					r = ::read(fd, &buffer[0], buffer.length());
+				} while(r < 0 && errno == EINTR);
+				n = (r < 0) ? 0 : r;
+			}
+			buffer.resize(n);
+			if(n == 0) {
+				failed = true;
+				return false;
+			}
+		}
+
+		n = buffer.length() - buffer_pos;
+		if(n > length)
+			n = length;
+		memcpy(data, buffer.data() + buffer_pos, n);
+		buffer_pos += n;
+		data += n;
+		length -= n;
+		bytes += n;
+	}
+
+	return true;
+}}}
+bool conjecture_reader::get_chunk(uint32_t & type, string & payload)
+{{{
+	char head[8], tail[4];
+	uint32_t length, crc;
+
+	if(failed || !get(head, 8))
+		goto broken;
+	type = get_uint32(head);
+	length = get_uint32(head + 4);
+	if(length > max_chunk_length)
+		goto broken;
+
+	payload.resize(length);
+	if(length > 0 && !get(&payload[0], length))
+		goto broken;
+	if(!get(tail, 4))
+		goto broken;
+
+	crc = crc32_update(0, head, 8);
+	crc = crc32_update(crc, payload.data(), payload.length());
+	if(crc != get_uint32(tail))
+		goto broken;
+
+	return true;
+broken:
+	failed = true;
+	return false;
+}}}
+bool conjecture_reader::get_number(int32_t & value)
+{{{
+	if(compressed) {
+		uint32_t v = 0;
+		for(int shift = 0; shift < 35; shift += 7) {
+			unsigned char b;
+			if(chunk_pos >= chunk.length())
+				return false;
+			b = chunk[chunk_pos++];
+			v |= (uint32_t)(b & 0x7f) << shift;
+			if(!(b & 0x80)) {
+				value = v;
+				return true;
+			}
+		}
+		return false;
+	} else {
+		if(chunk_pos + 4 > chunk.length())
+			return false;
+		value = get_uint32(chunk.data() + chunk_pos);
+		chunk_pos += 4;
+		return true;
+	}
+}}}
+bool conjecture_reader::get_signed(int32_t & value)
+{{{
+	if(!get_number(value))
+		return false;
+	if(compressed)
+		value = unzigzag(value);
+	return true;
+}}}
+bool conjecture_reader::read_header(bool & is_dfa, int & alphabet_size, int & state_count, set<int> & initial_states)
+{{{
+	char start[16];
+	uint32_t type, count;
+
+	initial_states.clear();
+
+	if(!get(start, 16))
+		goto broken;
+	if(memcmp(start, stream_magic, 8) != 0 || get_uint32(start + 8) != stream_version)
+		goto broken;
+	if(get_uint32(start + 12) & ~(uint32_t)STREAM_COMPRESSED)
+		goto broken;
+	compressed = get_uint32(start + 12) & STREAM_COMPRESSED;
+
+	if(!get_chunk(type, chunk) || type != chunk_head || chunk.length() < 16)
+		goto broken;
+	this->is_dfa = get_uint32(chunk.data()) != 0;
+	this->alphabet_size = get_uint32(chunk.data() + 4);
+	this->state_count = get_uint32(chunk.data() + 8);
+	count = get_uint32(chunk.data() + 12);
+	if(chunk.length() != 16 + 4 * (size_t)count)
+		goto broken;
+	this->initial_states.clear();
+	for(uint32_t i = 0; i < count; ++i)
+		this->initial_states.insert((int32_t)get_uint32(chunk.data() + 16 + 4 * i));
+
+	is_dfa = this->is_dfa;
+	alphabet_size = this->alphabet_size;
+	state_count = this->state_count;
+	initial_states = this->initial_states;
+
+	return true;
+broken:
+	failed = true;
+	return false;
+}}}
+enum conjecture_reader::item conjecture_reader::next(int & a, int & b, int & c)
+{{{
+	int32_t v1, v2, v3;
+	enum item it;
+
+	if(failed)
+		return ITEM_ERROR;
+	if(ended)
+		return ITEM_END;
+
+	while(chunk_left == 0) {
+		if(!get_chunk(chunk_type, chunk))
+			goto broken;
+		chunk_pos = 0;
+		last_state = 0;
+
+		if(chunk_type == chunk_end) {
+			if(chunk.length() != 8 || get_uint32(chunk.data()) != (uint32_t)total_finals
+					|| get_uint32(chunk.data() + 4) != (uint32_t)total_transitions)
+				goto broken;
+			ended = true;
+			return ITEM_END;
+		}
+		if(chunk_type != chunk_final && chunk_type != chunk_transitions)
+			goto broken;
+		if(chunk.length() < 4)
+			goto broken;
+		chunk_left = get_uint32(chunk.data());
+		chunk_pos = 4;
+	}
+
+	if(chunk_type == chunk_final) {
+		if(!get_signed(v1))
+			goto broken;
+		if(compressed)
+			v1 = (uint32_t)last_state + (uint32_t)v1;
+		last_state = v1;
+		a = v1;
+		++total_finals;
+		it = ITEM_FINAL_STATE;
+	} else {
+		if(!get_signed(v1) || !get_signed(v2) || !get_signed(v3))
+			goto broken;
+		if(compressed) {
+			v1 = (uint32_t)last_state + (uint32_t)v1;
+			v3 = (uint32_t)v1 + (uint32_t)v3;
+		}
+		last_state = v1;
+		a = v1;
+		b = v2;
+		c = v3;
+		++total_transitions;
+		it = ITEM_TRANSITION;
+	}
+
+	// a chunk has to be used up exactly
+	if(--chunk_left == 0 && chunk_pos != chunk.length())
+		goto broken;
+
+	return it;
+
+broken:
+	failed = true;
+	return ITEM_ERROR;
+}}}
+bool conjecture_reader::read(finite_automaton & automaton)
+{{{
+	bool dfa;
+	int asize, states;
+	set<int> initial;
+	flat_transitions flat;
+	bool in_order;
+	enum item it;
+	int a, b, c;
+
+	automaton.clear();
+	if(!read_header(dfa, asize, states, initial))
+		goto broken;
+	if(states < 0 || asize < 0)
+		goto broken;
+
+	automaton.is_deterministic = dfa;
+	automaton.input_alphabet_size = asize;
+	automaton.state_count = states;
+	automaton.initial_states = initial;
+	automaton.set_all_non_accepting();
+
+	// transitions that come in order are appended to flat storage
+	// directly, as in finite_automaton::deserialize().
+	in_order = automaton.is_flat();
+	if(in_order)
+		flat.start(states);
+
+	while(ITEM_END != (it = next(a, b, c))) {
+		switch(it) {
+			case ITEM_FINAL_STATE:
+				if(a < 0 || a >= states)
+					goto broken;
+				automaton.output_mapping[a] = true;
+				break;
+			case ITEM_TRANSITION:
+				if(in_order && flat.append(a, b, c))
+					break;
+				if(in_order) {
+					in_order = false;
+					flat.finish();
+					flat.get(automaton.transitions);
+					flat.clear();
+				}
+				automaton.transitions[a][b].insert(c);
+				break;
+			default:
+				goto broken;
+		}
+	}
+
+	if(in_order) {
+		flat.finish();
+		if(!automaton.set_flat_transitions(flat))
+			goto broken;
+	} else if(automaton.is_flat()) {
+		if(!automaton.flatten())
+			goto broken;
+	}
+
+	automaton.valid = true;
+	if(!automaton.calc_validity())
+		goto broken;
+
+	return true;
+broken:
+	automaton.clear();
+	return false;
+}}}
+
+}; // end of namespace libalf
+
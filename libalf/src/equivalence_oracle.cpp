@@ -0,0 +1,386 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+#include <set>
+#include <map>
+#include <list>
+#include <vector>
+
+#include "libalf/equivalence_oracle.h"
+
+namespace libalf {
+
+using namespace std;
+
+// subset construction. only reachable, non-empty sets become states.
+static void determinize(const finite_automaton & nfa, finite_automaton & dfa)
+{{{
+	map<set<int>, int> ids;
+	map<set<int>, int>::iterator ii;
+	vector<set<int> > sets;
+	set<int>::const_iterator si;
+	set<int> final_states, s;
+
+	nfa.get_final_states(final_states);
+
+	s = nfa.initial_states;
+	nfa.epsilon_close(s);
+	ids[s] = 0;
+	sets.push_back(s);
+
+	dfa.transitions.clear();
+	dfa.output_mapping.clear();
+
+	for(unsigned int id = 0; id < sets.size(); ++id) {
+		for(si = sets[id].begin(); si != sets[id].end(); ++si)
+			if(final_states.find(*si) != final_states.end())
+				dfa.output_mapping[id] = true;
+
+		for(int a = 0; a < nfa.input_alphabet_size; ++a) {
+			s.clear();
+			for(si = sets[id].begin(); si != sets[id].end(); ++si)
+				nfa.add_successors(*si, a, s);
+			if(s.empty())
+				continue;
+			nfa.epsilon_close(s);
+
+			ii = ids.find(s);
+			if(ii == ids.end()) {
+				ii = ids.insert(make_pair(s, (int)sets.size())).first;
+				sets.push_back(s);
+			}
+			dfa.transitions[id][a].insert(ii->second);
+		}
+	}
+
+	dfa.input_alphabet_size = nfa.input_alphabet_size;
+	dfa.state_count = sets.size();
+	dfa.initial_states.clear();
+	dfa.initial_states.insert(0);
+	dfa.is_deterministic = true;
+	dfa.valid = true;
+}}}
+
+// marks every element from which a marked element is reachable. the
+// successors of element i are successor[i * width ... (i+1) * width), -1
+// for none.
+static void mark_predecessors(const vector<int> & successor, int width, vector<bool> & marked, vector<int> & offsets, vector<int> & preds)
+{{{
+	int count = marked.size();
+	list<int> todo;
+
+	// predecessors as CSR: count, sum up to the ends, fill from the back
+	offsets.assign(count + 1, 0);
+	for(unsigned int i = 0; i < successor.size(); ++i)
+		if(successor[i] >= 0)
+			offsets[successor[i]]++;
+	for(int e = 1; e <= count; ++e)
+		offsets[e] += offsets[e-1];
+	preds.resize(offsets[count]);
+	for(int i = successor.size() - 1; i >= 0; --i)
+		if(successor[i] >= 0)
+			preds[--offsets[successor[i]]] = i / width;
+
+	for(int e = 0; e < count; ++e)
+		if(marked[e])
+			todo.push_back(e);
+	while(!todo.empty()) {
+		int e = todo.front();
+		todo.pop_front();
+		for(int i = offsets[e]; i < offsets[e+1]; ++i) {
+			if(!marked[preds[i]]) {
+				marked[preds[i]] = true;
+				todo.push_back(preds[i]);
+			}
+		}
+	}
+}}}
+
+equivalence_oracle::equivalence_oracle(const finite_automaton & model)
+	: model(model)
+{{{
+	determinize(model, minimal);
+	minimal.minimize();
+	build_model_table(minimal.input_alphabet_size);
+	reset();
+}}}
+
+void equivalence_oracle::reset()
+{{{
+	node_child.assign(2 * alphabet_size, -1);
+	node_known.assign(2, false);
+	node_known[0] = true; // missing transitions never change
+	node_final.assign(2, false);
+	node_successor.assign(2 * alphabet_size, -1);
+	node_seen.assign(2, 0);
+	consistent.assign(2 * model_states, false);
+	// stamps of older rounds would become valid again
+	pair_index.clear();
+	pair_round.clear();
+	round = 0;
+	explored = 0;
+	skipped = 0;
+}}}
+
+void equivalence_oracle::build_model_table(int alphabet_size)
+{{{
+	map<int, map<int, set<int> > >::const_iterator mmsi;
+	map<int, set<int> >::const_iterator msi;
+	map<int, bool>::const_iterator oi;
+	int dead = minimal.state_count;
+
+	this->alphabet_size = alphabet_size;
+	model_states = dead + 1;
+
+	model_delta.assign(model_states * alphabet_size, dead);
+	for(mmsi = minimal.transitions.begin(); mmsi != minimal.transitions.end(); ++mmsi)
+		for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+			if(msi->first >= 0 && msi->first < alphabet_size && !msi->second.empty())
+				model_delta[mmsi->first * alphabet_size + msi->first] = *msi->second.begin();
+
+	model_final.assign(model_states, false);
+	for(oi = minimal.output_mapping.begin(); oi != minimal.output_mapping.end(); ++oi)
+		if(oi->second)
+			model_final[oi->first] = true;
+}}}
+
+int equivalence_oracle::child(int node, int sigma)
+{{{
+	int c = node_child[node * alphabet_size + sigma];
+
+	if(c < 0) {
+		c = node_known.size();
+		node_child[node * alphabet_size + sigma] = c;
+		node_child.resize(node_child.size() + alphabet_size, -1);
+		node_known.push_back(false);
+		node_final.push_back(false);
+		node_successor.resize(node_successor.size() + alphabet_size, -1);
+		node_seen.push_back(0);
+		consistent.resize(consistent.size() + model_states, false);
+	}
+
+	return c;
+}}}
+
+int & equivalence_oracle::pair_slot(int q, int r)
+{{{
+	unsigned int i = q * model_states + r;
+
+	if(pair_round[i] != round) {
+		pair_round[i] = round;
+		pair_index[i] = -1;
+	}
+
+	return pair_index[i];
+}}}
+
+bool equivalence_oracle::build_hypothesis_table(const finite_automaton & hypothesis)
+{{{
+	transition_view transitions = hypothesis.get_transition_view();
+	transition_view::const_iterator ti;
+	map<int, bool>::const_iterator oi;
+	int sink = hypothesis.state_count;
+	int source = -1, symbol = -1;
+
+	// missing transitions go to an extra state that rejects everything
+	delta.assign((sink + 1) * alphabet_size, sink);
+	for(ti = transitions.begin(); ti != transitions.end(); ++ti) {
+		// epsilon, or a second target for the same state and symbol
+		if(ti.symbol() < 0 || (ti.source() == source && ti.symbol() == symbol))
+			return false;
+		source = ti.source();
+		symbol = ti.symbol();
+		if(source >= 0 && source < sink && symbol < alphabet_size)
+			delta[source * alphabet_size + symbol] = ti.target();
+	}
+
+	hypothesis_final.assign(sink + 1, false);
+	for(oi = hypothesis.output_mapping.begin(); oi != hypothesis.output_mapping.end(); ++oi)
+		if(oi->second)
+			hypothesis_final[oi->first] = true;
+
+	return true;
+}}}
+
+bool equivalence_oracle::equivalence_query(const conjecture * cj, list<int> & counterexample)
+{{{
+	const finite_automaton * hypothesis = dynamic_cast<const finite_automaton*>(cj);
+
+	if(!hypothesis) {
+		counterexample.clear();
+		return false;
+	}
+
+	return equivalence_query(*hypothesis, counterexample);
+}}}
+
+bool equivalence_oracle::equivalence_query(const finite_automaton & hypothesis, list<int> & counterexample)
+{{{
+	int sink, bad;
+	unsigned int i;
+
+	counterexample.clear();
+	explored = 0;
+	skipped = 0;
+
+	if(!hypothesis.valid)
+		return false;
+
+	if(hypothesis.input_alphabet_size > alphabet_size) {
+		build_model_table(hypothesis.input_alphabet_size);
+		reset();
+	}
+
+	if(hypothesis.initial_states.size() != 1 || !build_hypothesis_table(hypothesis))
+		return model.antichain_is_equal(hypothesis, counterexample);
+
+	round++;
+	sink = hypothesis.state_count;
+
+	// access words, breadth-first with symbols in order
+	state_node.assign(sink + 1, -1);
+	state_node[sink] = 0;
+	order.clear();
+	order.push_back(*hypothesis.initial_states.begin());
+	state_node[order.front()] = 1;
+	for(i = 0; i < order.size(); ++i) {
+		int q = order[i];
+		for(int a = 0; a < alphabet_size; ++a) {
+			int t = delta[q * alphabet_size + a];
+			if(state_node[t] < 0) {
+				state_node[t] = child(state_node[q], a);
+				order.push_back(t);
+			}
+		}
+	}
+
+	// compare the states with the last query. unchanged states that reach
+	// a changed one are dirty as well.
+	dirty.assign(sink + 1, false);
+	for(i = 0; i < order.size(); ++i) {
+		int q = order[i];
+		int node = state_node[q];
+
+		if(!node_known[node] || node_final[node] != hypothesis_final[q])
+			dirty[q] = true;
+		for(int a = 0; a < alphabet_size; ++a) {
+			int succ = state_node[delta[q * alphabet_size + a]];
+			if(node_successor[node * alphabet_size + a] != succ) {
+				node_successor[node * alphabet_size + a] = succ;
+				dirty[q] = true;
+			}
+		}
+		node_known[node] = true;
+		node_final[node] = hypothesis_final[q];
+		node_seen[node] = round;
+	}
+	for(unsigned int node = 1; node < node_known.size(); ++node) {
+		if(node_known[node] && node_seen[node] != round) {
+			node_known[node] = false;
+			for(int r = 0; r < model_states; ++r)
+				consistent[node * model_states + r] = false;
+		}
+	}
+	mark_predecessors(delta, alphabet_size, dirty, pred_offsets, preds);
+	for(i = 0; i < order.size(); ++i) {
+		if(dirty[order[i]]) {
+			int node = state_node[order[i]];
+			for(int r = 0; r < model_states; ++r)
+				consistent[node * model_states + r] = false;
+		}
+	}
+
+	// the product, breadth-first. pairs that are known to be consistent
+	// are not expanded. all others are, even after a difference was found,
+	// so that the consistent ones can be remembered.
+	if(pair_index.size() < (unsigned int)(model_states * (sink + 1))) {
+		pair_index.resize(model_states * (sink + 1), -1);
+		pair_round.resize(model_states * (sink + 1), 0);
+	}
+	pair_model.clear();
+	pair_conjecture.clear();
+	pair_parent.clear();
+	pair_label.clear();
+	pair_successor.clear();
+	pair_bad.clear();
+	bad = -1;
+
+	pair_slot(order.front(), 0) = 0;
+	pair_model.push_back(0);
+	pair_conjecture.push_back(order.front());
+	pair_parent.push_back(-1);
+	pair_label.push_back(-1);
+
+	for(i = 0; i < pair_model.size(); ++i) {
+		int r = pair_model[i];
+		int q = pair_conjecture[i];
+
+		pair_bad.push_back(false);
+		pair_successor.resize(pair_successor.size() + alphabet_size, -1);
+
+		if(!dirty[q] && consistent[state_node[q] * model_states + r]) {
+			skipped++;
+			continue;
+		}
+		explored++;
+
+		if(model_final[r] != hypothesis_final[q]) {
+			pair_bad[i] = true;
+			if(bad < 0)
+				bad = i;
+		}
+
+		for(int a = 0; a < alphabet_size; ++a) {
+			int rs = model_delta[r * alphabet_size + a];
+			int qs = delta[q * alphabet_size + a];
+			int & p = pair_slot(qs, rs);
+			if(p < 0) {
+				p = pair_model.size();
+				pair_model.push_back(rs);
+				pair_conjecture.push_back(qs);
+				pair_parent.push_back(i);
+				pair_label.push_back(a);
+			}
+			pair_successor[i * alphabet_size + a] = p;
+		}
+	}
+
+	// everything that can not reach a difference is consistent
+	mark_predecessors(pair_successor, alphabet_size, pair_bad, pred_offsets, preds);
+	for(i = 0; i < pair_model.size(); ++i)
+		if(!pair_bad[i])
+			consistent[state_node[pair_conjecture[i]] * model_states + pair_model[i]] = true;
+
+	if(bad < 0)
+		return true;
+
+	while(pair_parent[bad] >= 0) {
+		counterexample.push_front(pair_label[bad]);
+		bad = pair_parent[bad];
+	}
+	return false;
+}}}
+
+}; // end of namespace libalf
+
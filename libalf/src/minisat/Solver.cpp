@@ -665,6 +665,11 @@ namespace libalf {
 					varDecayActivity();
 					claDecayActivity();
 
+					if(interrupted()) {
+						cancelUntil(root_level);
+						return l_Undef;
+					}
+
 				} else {
 					// NO CONFLICT
 
@@ -790,7 +795,7 @@ namespace libalf {
 				reportf("==============================================================================\n");
 			}
 
-			while(status == l_Undef) {
+			while(status == l_Undef && !interrupted()) {
 				if(verbosity >= 1)
 					reportf("| %9d | %7d %8d | %7d %7d %8d %7.1f | %6.3f %% |\n", (int) stats.conflicts,
 						nClauses(), (int) stats.clauses_literals, (int) nof_learnts, nLearnts(),
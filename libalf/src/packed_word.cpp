@@ -0,0 +1,375 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *	   Daniel Neider <neider@automata.rwth-aachen.de
+ *
+ */
+#include <string.h>
+
+#include "libalf/packed_word.h"
+
+namespace libalf {
+
+using namespace std;
+
+packed_word::packed_word()
+{{{
+	length = 0;
+	capacity = inline_cells;
+	bits = 32;
+	shift = 0;
+	data = inline_data;
+	memset(inline_data, 0, sizeof(inline_data));
+}}}
+
+packed_word::packed_word(int alphabet_size)
+{{{
+	length = 0;
+	capacity = inline_cells;
+	bits = 32;
+	shift = 0;
+	data = inline_data;
+	memset(inline_data, 0, sizeof(inline_data));
+
+	set_bits(bits_for_alphabet(alphabet_size));
+}}}
+
+packed_word::packed_word(const list<int> & word, int alphabet_size)
+{{{
+	length = 0;
+	capacity = inline_cells;
+	bits = 32;
+	shift = 0;
+	data = inline_data;
+	memset(inline_data, 0, sizeof(inline_data));
+
+	set_bits(bits_for_alphabet(alphabet_size));
+	append(word);
+}}}
+
+packed_word::packed_word(const packed_word & other)
+{{{
+	length = 0;
+	capacity = inline_cells;
+	bits = 32;
+	shift = 0;
+	data = inline_data;
+	memset(inline_data, 0, sizeof(inline_data));
+
+	*this = other;
+}}}
+
+packed_word::~packed_word()
+{{{
+	if(data != inline_data)
+		delete[] data;
+}}}
+
+packed_word & packed_word::operator=(const packed_word & other)
+{{{
+	if(&other == this)
+		return *this;
+
+	clear();
+	bits = other.bits;
+	shift = other.shift;
+	grow(other.cells_for(other.length));
+	memcpy(data, other.data, other.cells_for(other.length) * sizeof(cell));
+	length = other.length;
+
+	return *this;
+}}}
+
+packed_word & packed_word::operator=(const list<int> & word)
+{{{
+	clear();
+	append(word);
+
+	return *this;
+}}}
+
+int packed_word::bits_for_alphabet(int alphabet_size)
+{{{
+	int b;
+
+	if(alphabet_size <= 0)
+		return 32;
+
+	for(b = 1; b < 32; b *= 2)
+		if(alphabet_size - 1 < (1 << b))
+			return b;
+
+	return 32;
+}}}
+
+void packed_word::set_bits(int new_bits)
+{{{
+	unsigned int i;
+	int b;
+
+	// smallest valid packing >= new_bits
+	for(b = 1; b < 32 && b < new_bits; b *= 2)
+		/* nothing */ ;
+	// that holds all current letters
+	for(i = 0; i < length && b < 32; ++i) {
+		int l = get(i);
+		if(l < 0)
+			b = 32;
+		else
+			while(b < 32 && l >= (1 << b))
+				b *= 2;
+	}
+
+	if(b == bits)
+		return;
+
+	if(length == 0) {
+		bits = b;
+		for(shift = 0; (32 >> shift) > b; ++shift)
+			/* nothing */ ;
+		return;
+	}
+
+	packed_word tmp;
+	tmp.set_bits(b);
+	tmp.reserve(length);
+	for(i = 0; i < length; ++i)
+		tmp.push_back(get(i));
+	*this = tmp;
+}}}
+
+void packed_word::set(unsigned int i, int letter)
+{{{
+	unsigned int offset;
+	cell mask;
+
+	if(bits == 32) {
+		data[i] = (cell)letter;
+		return;
+	}
+	if(letter < 0 || letter >= (1 << bits)) {
+		set_bits(letter < 0 ? 32 : bits_for_alphabet(letter + 1));
+		set(i, letter);
+		return;
+	}
+
+	offset = (i & ((1u << shift) - 1)) * bits;
+	mask = ((1u << bits) - 1) << offset;
+	data[i >> shift] = (data[i >> shift] & ~mask) | ((cell)letter << offset);
+}}}
+
+void packed_word::grow(unsigned int cells)
+{{{
+	cell * n;
+
+	if(cells <= capacity)
+		return;
+	if(cells < capacity * 2)
+		cells = capacity * 2;
+
+	n = new cell[cells];
+	memcpy(n, data, cells_for(length) * sizeof(cell));
+	memset(n + cells_for(length), 0, (cells - cells_for(length)) * sizeof(cell));
+	if(data != inline_data)
+		delete[] data;
+	data = n;
+	capacity = cells;
+}}}
+
+void packed_word::push_back_slow(int letter)
+{{{
+	if(bits != 32 && (letter < 0 || letter >= (1 << bits)))
+		set_bits(letter < 0 ? 32 : bits_for_alphabet(letter + 1));
+
+	grow(cells_for(length + 1));
+	length++;
+	set(length - 1, letter);
+}}}
+
+void packed_word::pop_back()
+{{{
+	if(length == 0)
+		return;
+	// keep unused bits zero
+	set(length - 1, 0);
+	length--;
+}}}
+
+void packed_word::clear()
+{{{
+	memset(data, 0, cells_for(length) * sizeof(cell));
+	length = 0;
+}}}
+
+void packed_word::reserve(unsigned int letters)
+{{{
+	grow(cells_for(letters));
+}}}
+
+void packed_word::resize(unsigned int letters, int letter)
+{{{
+	while(length > letters)
+		pop_back();
+	if(letters > length)
+		reserve(letters);
+	while(length < letters)
+		push_back(letter);
+}}}
+
+void packed_word::append(const packed_word & suffix)
+{{{
+	unsigned int n = suffix.length;
+
+	if(bits == 32 && suffix.bits == 32) {
+		grow(length + n);
+		memcpy(data + length, suffix.data, n * sizeof(cell));
+		length += n;
+		return;
+	}
+
+	reserve(length + n);
+	for(unsigned int i = 0; i < n; ++i)
+		push_back(suffix.get(i));
+}}}
+
+void packed_word::append(const list<int> & suffix)
+{{{
+	list<int>::const_iterator li;
+
+	reserve(length + suffix.size());
+	for(li = suffix.begin(); li != suffix.end(); ++li)
+		push_back(*li);
+}}}
+
+packed_word packed_word::prefix(unsigned int letters) const
+{{{
+	packed_word ret;
+	unsigned int cells;
+
+	if(letters > length)
+		letters = length;
+
+	ret.bits = bits;
+	ret.shift = shift;
+	cells = cells_for(letters);
+	ret.grow(cells);
+	memcpy(ret.data, data, cells * sizeof(cell));
+	ret.length = letters;
+
+	// clear letters after the prefix
+	if(bits != 32 && (letters & ((1u << shift) - 1)) != 0)
+		ret.data[cells - 1] &= (((cell)1) << ((letters & ((1u << shift) - 1)) * bits)) - 1;
+
+	return ret;
+}}}
+
+packed_word packed_word::suffix(unsigned int start) const
+{{{
+	packed_word ret;
+
+	ret.bits = bits;
+	ret.shift = shift;
+	if(start < length) {
+		ret.reserve(length - start);
+		for(unsigned int i = start; i < length; ++i)
+			ret.push_back(get(i));
+	}
+
+	return ret;
+}}}
+
+list<int> packed_word::to_list() const
+{{{
+	list<int> ret;
+
+	for(unsigned int i = 0; i < length; ++i)
+		ret.push_back(get(i));
+
+	return ret;
+}}}
+
+size_t packed_word::hash() const
+{{{
+	// FNV-1a over the letters
+	uint64_t h = 14695981039346656037ULL;
+
+	if(bits == 32) {
+		for(unsigned int i = 0; i < length; ++i) {
+			h ^= data[i];
+			h *= 1099511628211ULL;
+		}
+	} else {
+		for(unsigned int i = 0; i < length; ++i) {
+			h ^= (cell)get(i);
+			h *= 1099511628211ULL;
+		}
+	}
+	h ^= length;
+	h *= 1099511628211ULL;
+
+	return (size_t)(h ^ (h >> 32));
+}}}
+
+unsigned int packed_word::first_difference(const packed_word & other) const
+{{{
+	unsigned int n = length < other.length ? length : other.length;
+	unsigned int i = 0;
+
+	if(bits == other.bits) {
+		unsigned int c, full = n >> shift;
+		for(c = 0; c < full && data[c] == other.data[c]; ++c)
+			/* nothing */ ;
+		i = c << shift;
+	}
+	for(/* nothing */; i < n; ++i)
+		if(get(i) != other.get(i))
+			break;
+
+	return i;
+}}}
+
+bool packed_word::operator==(const packed_word & other) const
+{{{
+	if(length != other.length)
+		return false;
+	if(bits == other.bits)
+		return memcmp(data, other.data, cells_for(length) * sizeof(cell)) == 0;
+	return first_difference(other) == length;
+}}}
+
+int packed_word::compare_lex(const packed_word & other) const
+{{{
+	unsigned int i = first_difference(other);
+
+	if(i < length && i < other.length)
+		return get(i) < other.get(i) ? -1 : 1;
+	if(length == other.length)
+		return 0;
+	return length < other.length ? -1 : 1;
+}}}
+
+bool packed_word::operator<(const packed_word & other) const
+{{{
+	return compare_lex(other) < 0;
+}}}
+
+}
+
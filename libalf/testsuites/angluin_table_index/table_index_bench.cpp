@@ -0,0 +1,257 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// scaling benchmark for the hash-indexed rows of angluin_simple_table.
+//
+// learns random DFAs (as online_performance_tester does) of growing size
+// with angluin_simple_table, and with a variant that searches rows
+// linearly and compares all pairs of rows (the behaviour before the
+// index). both have to ask the same queries and give the same number of
+// conjectures.
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <iostream>
+#include <list>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <liblangen/dfa_randomgenerator.h>
+
+#include <amore++/finite_automaton.h>
+#include <amore++/nondeterministic_finite_automaton.h>
+#include <amore++/deterministic_finite_automaton.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_angluin.h>
+
+#include "amore_alf_glue.h"
+
+using namespace std;
+using namespace liblangen;
+using namespace libalf;
+
+template <class answer>
+class linear_angluin_table : public angluin_simple_table<answer> {
+	protected:
+		typedef typename angluin_simple_table<answer>::table_t table_t;
+	public:
+		linear_angluin_table(knowledgebase<answer> *base, logger *log, int alphabet_size)
+			: angluin_simple_table<answer>(base, log, alphabet_size)
+		{ };
+	protected:
+		virtual bool use_row_classes()
+		{ return false; }
+
+		virtual typename table_t::iterator search_upper_table(const std::list<int> &word)
+		{{{
+			typename table_t::iterator uti;
+
+			for(uti = this->upper_table.begin(); uti != this->upper_table.end(); uti++)
+				if(word == uti->index)
+					return uti;
+			return this->upper_table.end();
+		}}}
+
+		virtual typename table_t::iterator search_lower_table(const std::list<int> &word)
+		{{{
+			typename table_t::iterator lti;
+
+			for(lti = this->lower_table.begin(); lti != this->lower_table.end(); lti++)
+				if(word == lti->index)
+					return lti;
+			return this->lower_table.end();
+		}}}
+};
+
+unsigned long long int usecs()
+{{{
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_utime.tv_sec * 1000000ULL + ru.ru_utime.tv_usec;
+}}}
+
+class result {
+	public:
+		unsigned int membership_queries;
+		unsigned int eq_queries;
+		unsigned int upper_rows;
+		unsigned int lower_rows;
+		unsigned long long int usecs;
+		bool learned;
+};
+
+template <class ALGORITHM>
+result learn(amore::finite_automaton * model)
+{{{
+	result r;
+	knowledgebase<bool> kb;
+	ALGORITHM alg(&kb, NULL, model->get_alphabet_size());
+	unsigned long long int start;
+
+	r.membership_queries = 0;
+	r.eq_queries = 0;
+	r.learned = false;
+
+	// only time spent in the algorithm is counted
+	r.usecs = 0;
+	for(unsigned int iteration = 0; iteration <= model->get_state_count(); iteration++) {
+		conjecture * cj;
+		list<int> counterexample;
+
+		while(true) {
+			start = usecs();
+			cj = alg.advance();
+			r.usecs += usecs() - start;
+			if(cj != NULL)
+				break;
+			r.membership_queries += amore_alf_glue::automaton_answer_knowledgebase(*model, kb);
+		}
+
+		r.eq_queries++;
+		if(amore_alf_glue::automaton_equivalence_query(*model, cj, counterexample)) {
+			delete cj;
+			r.learned = true;
+			break;
+		}
+		delete cj;
+
+		start = usecs();
+		alg.add_counterexample(counterexample);
+		r.usecs += usecs() - start;
+	}
+
+	generic_statistics stats = alg.get_statistics();
+	int rows = 0;
+	stats.get_integer_property("size.table.upper_rows", rows);
+	r.upper_rows = rows;
+	stats.get_integer_property("size.table.lower_rows", rows);
+	r.lower_rows = rows;
+
+	return r;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	unsigned int num_testcases = 2;
+	unsigned int alphabet_size = 2;
+	unsigned int min_model_size = 100;
+	unsigned int max_model_size = 800;
+	unsigned int steps_model_size = 100;
+	int errors = 0;
+
+	if(argc == 6) {
+		num_testcases    = atoi(argv[1]);
+		alphabet_size    = atoi(argv[2]);
+		min_model_size   = atoi(argv[3]);
+		max_model_size   = atoi(argv[4]);
+		steps_model_size = atoi(argv[5]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: number of testcases per msize\n"
+			"\t2: alphabet size\n"
+			"\t3: minimal model size\n"
+			"\t4: maximal model size\n"
+			"\t5: steps model size\n";
+		return 1;
+	}
+
+	dfa_randomgenerator dfarg;
+	finite_automaton fa;
+
+	printf("asize %u, model size %u..%u += %u, %u testcases each\n\n",
+			alphabet_size, min_model_size, max_model_size, steps_model_size, num_testcases);
+	printf("mSize   rows (upper+lower)   mQueries   linear usecs   indexed usecs   speedup\n");
+	printf("(usecs: user time in advance() and add_counterexample())\n");
+
+	for(unsigned int model_size = min_model_size; model_size <= max_model_size; model_size += steps_model_size) {
+		unsigned long long int linear_usecs = 0, indexed_usecs = 0;
+		unsigned int rows = 0, membership_queries = 0;
+
+		for(unsigned int c = 0; c < num_testcases; c++) {
+			amore::finite_automaton * model;
+			set<int> final_states;
+
+			do {
+				fa.clear();
+				final_states.clear();
+				model = NULL;
+				if(!dfarg.generate(alphabet_size, model_size, fa.is_deterministic, fa.input_alphabet_size, fa.state_count, fa.initial_states, final_states, fa.transitions))
+					continue;
+				fa.set_final_states(final_states);
+				model = amore_alf_glue::automaton_libalf2amore(fa);
+				if(model) {
+					model->minimize();
+					if(model->get_state_count() != model_size) {
+						delete model;
+						model = NULL;
+					}
+				}
+			} while(model == NULL);
+
+			result linear = learn< linear_angluin_table<bool> >(model);
+			result indexed = learn< angluin_simple_table<bool> >(model);
+
+			if(!linear.learned || !indexed.learned) {
+				printf("model size %u: failed to learn model!\n", model_size);
+				errors++;
+			}
+			if(   linear.membership_queries != indexed.membership_queries
+			   || linear.eq_queries != indexed.eq_queries
+			   || linear.upper_rows != indexed.upper_rows
+			   || linear.lower_rows != indexed.lower_rows) {
+				printf("model size %u: indexed table differs from linear table! (mQ %u/%u, eQ %u/%u, rows %u+%u/%u+%u)\n",
+						model_size,
+						linear.membership_queries, indexed.membership_queries,
+						linear.eq_queries, indexed.eq_queries,
+						linear.upper_rows, linear.lower_rows, indexed.upper_rows, indexed.lower_rows);
+				errors++;
+			}
+
+			linear_usecs += linear.usecs;
+			indexed_usecs += indexed.usecs;
+			rows += indexed.upper_rows + indexed.lower_rows;
+			membership_queries += indexed.membership_queries;
+
+			delete model;
+		}
+
+		printf("%5u   %18u   %8u   %12llu   %13llu   %6.1fx\n",
+				model_size, rows / num_testcases, membership_queries / num_testcases,
+				linear_usecs / num_testcases, indexed_usecs / num_testcases,
+				indexed_usecs ? (double)linear_usecs / indexed_usecs : 0.0);
+		fflush(stdout);
+	}
+
+	dfarg.discard_tables();
+
+	if(errors)
+		printf("\n%d errors.\n", errors);
+
+	return errors ? 1 : 0;
+}}}
+
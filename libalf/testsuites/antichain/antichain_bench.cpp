@@ -0,0 +1,314 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2010 David R. Piegdon <david-i2@piegdon.de>
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for finite_automaton::antichain_is_subset_of().
+//
+// compares the antichain check against a plain product of the first
+// automaton with the subset construction of the second one, on random
+// NFAs of liblangen. both have to agree, and every counterexample has to
+// be accepted by the first and rejected by the second automaton and be
+// as short as the shortest one the product finds. as these are rare on
+// the large pairs, many small random pairs are checked at the end.
+//
+// pairs are both unrelated random NFAs (usually not included) and an NFA
+// with a copy that got some additional transitions (always included). the
+// check is repeated on copies with flat transition storage (see
+// moore_machine::flatten()), which have to give the same result.
+//
+// first, the empty word as counterexample and the assertion on invalid
+// automata are checked.
+
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+#include <utility>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/conjecture.h>
+#include <liblangen/nfa_randomgenerator.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_nfa(nfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, 2, 0.1, 0.3, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+// one state, accepting epsilon (and all words) or nothing
+void single_state(finite_automaton & fa, bool accepting)
+{{{
+	fa.clear();
+	fa.input_alphabet_size = 2;
+	fa.state_count = 1;
+	fa.initial_states.insert(0);
+	fa.transitions[0][0].insert(0);
+	fa.transitions[0][1].insert(0);
+	fa.output_mapping[0] = accepting;
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+// returns the number of errors
+int check_edge_cases()
+{{{
+	finite_automaton all, none, invalid;
+	list<int> counterexample;
+	int errors = 0;
+
+	single_state(all, true);
+	single_state(none, false);
+
+	counterexample.push_back(0);
+	if(all.antichain_is_subset_of(none, counterexample) || !counterexample.empty()) {
+		printf("the empty word is not found as counterexample!\n");
+		errors++;
+	}
+	counterexample.push_back(0);
+	if(all.antichain_is_equal(none, counterexample) || !counterexample.empty()) {
+		printf("antichain_is_equal() does not find the empty word as counterexample!\n");
+		errors++;
+	}
+	if(!none.antichain_is_subset_of(all, counterexample) || !all.antichain_is_equal(all, counterexample)) {
+		printf("counterexample of length %zu for a valid inclusion!\n", counterexample.size());
+		errors++;
+	}
+
+#ifndef NDEBUG
+	// an invalid automaton must not pass as "the empty word is a counterexample"
+	single_state(invalid, true);
+	invalid.valid = false;
+	for(int direction = 0; direction < 2; direction++) {
+		pid_t child = fork();
+		if(child == 0) {
+			// no core dump of the expected abort
+			signal(SIGABRT, SIG_DFL);
+			close(2);
+			if(direction == 0)
+				all.antichain_is_subset_of(invalid, counterexample);
+			else
+				invalid.antichain_is_equal(all, counterexample);
+			_exit(0);
+		}
+		int status = 0;
+		if(child < 0 || waitpid(child, &status, 0) != child || !WIFSIGNALED(status) || WTERMSIG(status) != SIGABRT) {
+			printf("an invalid automaton is not caught by the assertion!\n");
+			errors++;
+		}
+	}
+#endif
+
+	return errors;
+}}}
+
+// copy of fa with some random additional transitions, so L(fa) is a subset
+void add_transitions(const finite_automaton & fa, finite_automaton & bigger, int count)
+{{{
+	bigger = fa;
+	for(int i = 0; i < count; ++i)
+		bigger.transitions[rand() % fa.state_count][rand() % fa.input_alphabet_size].insert(rand() % fa.state_count);
+	bigger.calc_determinism();
+}}}
+
+// product of a with the subset construction of b, without subsumption.
+// returns true if L(a) is a subset of L(b). explored gets the number of
+// pairs, shortest the length of a shortest counterexample.
+bool product_is_subset_of(const finite_automaton & a, const finite_automaton & b, unsigned int & explored, unsigned int & shortest)
+{{{
+	typedef pair<int, set<int> > product_state;
+	set<product_state> seen;
+	// breadth-first, so the first bad pair is a shortest counterexample
+	list<pair<product_state, unsigned int> > todo;
+	set<int>::const_iterator si;
+
+	set<int> b_initial = b.initial_states;
+	for(si = a.initial_states.begin(); si != a.initial_states.end(); ++si)
+		if(seen.insert(product_state(*si, b_initial)).second)
+			todo.push_back(make_pair(product_state(*si, b_initial), 0U));
+
+	while(!todo.empty()) {
+		product_state p = todo.front().first;
+		unsigned int depth = todo.front().second;
+		todo.pop_front();
+
+		bool b_accepts = false;
+		for(si = p.second.begin(); si != p.second.end(); ++si)
+			if(b.output_mapping.find(*si)->second)
+				b_accepts = true;
+		if(a.output_mapping.find(p.first)->second && !b_accepts) {
+			explored = seen.size();
+			shortest = depth;
+			return false;
+		}
+
+		for(int sigma = 0; sigma < a.input_alphabet_size; ++sigma) {
+			list<int> symbol(1, sigma);
+			set<int> a_succ, b_succ;
+			a_succ.insert(p.first);
+			b_succ = p.second;
+			a.run(a_succ, symbol.begin(), symbol.end());
+			b.run(b_succ, symbol.begin(), symbol.end());
+			for(si = a_succ.begin(); si != a_succ.end(); ++si)
+				if(seen.insert(product_state(*si, b_succ)).second)
+					todo.push_back(make_pair(product_state(*si, b_succ), depth + 1));
+		}
+	}
+
+	explored = seen.size();
+	return true;
+}}}
+
+// returns the number of errors
+int bench(const finite_automaton & a, const finite_automaton & b, const char * name)
+{{{
+	unsigned long long int start, antichain_usecs, product_usecs;
+	list<int> counterexample, flat_counterexample;
+	finite_automaton a_flat(a), b_flat(b);
+	unsigned int explored, shortest;
+	bool antichain_result, product_result;
+	int errors = 0;
+
+	start = usecs();
+	antichain_result = a.antichain_is_subset_of(b, counterexample);
+	antichain_usecs = usecs() - start;
+
+	start = usecs();
+	product_result = product_is_subset_of(a, b, explored, shortest);
+	product_usecs = usecs() - start;
+
+	if(antichain_result != product_result) {
+		printf("results differ!\n");
+		errors++;
+	}
+	if(!antichain_result && (!a.contains(counterexample) || b.contains(counterexample))) {
+		printf("bad counterexample!\n");
+		errors++;
+	}
+	if(!antichain_result && !product_result && counterexample.size() != shortest) {
+		printf("counterexample of length %d, but the shortest has length %u!\n", (int)counterexample.size(), shortest);
+		errors++;
+	}
+
+	a_flat.flatten();
+	b_flat.flatten();
+	if(a_flat.antichain_is_subset_of(b_flat, flat_counterexample) != antichain_result
+	   || flat_counterexample.size() != counterexample.size()) {
+		printf("results on flat storage differ!\n");
+		errors++;
+	}
+
+	printf("%-9s %6d %6d   %-8s %4d   %10llu   %10llu %9u\n", name, a.state_count, b.state_count,
+			antichain_result ? "subset" : "no",
+			antichain_result ? 0 : (int)counterexample.size(),
+			antichain_usecs, product_usecs, explored);
+	fflush(stdout);
+
+	return errors;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 40;
+	int errors = 0;
+	nfa_randomgenerator rg;
+
+	if(argc == 3) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states\n";
+		return 1;
+	}
+
+	srand(1);
+
+	errors += check_edge_cases();
+
+	printf("asize %d\n\n", alphabet_size);
+	printf("pair      states states   result  |ce|   antichain us   product us     pairs\n");
+
+	for(int state_count = 5; state_count <= max_states; state_count += 5) {
+		finite_automaton a, b;
+
+		random_nfa(rg, a, alphabet_size, state_count);
+		random_nfa(rg, b, alphabet_size, state_count);
+		errors += bench(a, b, "random");
+
+		add_transitions(a, b, state_count / 2);
+		errors += bench(a, b, "superset");
+	}
+
+	// many small pairs, where subsumption across BFS levels is common
+	int checked = 0, not_shortest = 0;
+	for(int i = 0; i < 20000; ++i) {
+		finite_automaton a, b;
+		list<int> counterexample;
+		unsigned int explored, shortest;
+
+		random_nfa(rg, a, alphabet_size, 3 + i % 6);
+		random_nfa(rg, b, alphabet_size, 3 + i % 6);
+		if(a.antichain_is_subset_of(b, counterexample))
+			continue;
+		if(product_is_subset_of(a, b, explored, shortest) || counterexample.size() != shortest)
+			not_shortest++;
+		checked++;
+	}
+	printf("\n%d of %d counterexamples of small pairs are not shortest\n", not_shortest, checked);
+	errors += not_shortest;
+
+	return errors ? 1 : 0;
+}}}
@@ -0,0 +1,204 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for conformance_oracle.
+//
+// learns random DFAs of liblangen with angluin_simple_table, using the
+// conformance_oracle with each test method instead of an equivalence
+// check against the model. the model only answers membership queries.
+// reports the queries of the learner and of the oracle, and checks the
+// result against the model with antichain_is_equal(). the W- and
+// Wp-method have to find a difference whenever the minimal model has at
+// most extra_states more states than the conjecture.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_angluin.h>
+#include <libalf/conformance_oracle.h>
+#include <liblangen/dfa_randomgenerator.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_dfa(dfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+void answer_queries(knowledgebase<bool> & kb, const finite_automaton & model)
+{{{
+	knowledgebase<bool>::iterator qi = kb.qbegin();
+
+	while(qi != kb.qend()) {
+		qi->set_answer(model.contains(qi->get_word()));
+		qi = kb.qbegin();
+	}
+}}}
+
+class result {
+	public:
+		unsigned int rounds;
+		unsigned int learner_queries;
+		unsigned int oracle_queries;
+		unsigned int tests;
+		unsigned long long int usecs;
+		bool learned;
+		bool missed; // the W-/Wp-method missed a difference it must find
+};
+
+result learn(const finite_automaton & model, int model_states, enum conformance_oracle<bool>::test_method method, unsigned int threads, int extra_states)
+{{{
+	result r;
+	knowledgebase<bool> kb;
+	ostream_logger log(&cerr, LOGGER_ERROR);
+	angluin_simple_table<bool> learner(&kb, &log, model.input_alphabet_size);
+	conformance_oracle<bool> oracle(&kb, method, false);
+	unsigned long long int start;
+	bool done = false;
+
+	oracle.set_threads(threads);
+	oracle.set_extra_states(extra_states);
+	oracle.set_random_walk(20000, 2 * model.state_count, 1);
+
+	r.rounds = 0;
+	r.learner_queries = 0;
+	r.learned = false;
+	r.missed = false;
+
+	start = usecs();
+	while(!done) {
+		conjecture * cj;
+		list<int> ce;
+		bool equivalent;
+
+		while(NULL == (cj = learner.advance())) {
+			r.learner_queries += kb.count_queries();
+			answer_queries(kb, model);
+		}
+		finite_automaton * hypothesis = dynamic_cast<finite_automaton*>(cj);
+		r.rounds++;
+
+		while(!oracle.check(*hypothesis, equivalent, ce))
+			answer_queries(kb, model);
+
+		if(equivalent) {
+			list<int> word;
+			r.learned = model.antichain_is_equal(*hypothesis, word);
+			if(!r.learned && method != conformance_oracle<bool>::RANDOM_WALK
+					&& model_states - hypothesis->state_count <= extra_states)
+				r.missed = true;
+			done = true;
+		} else {
+			learner.add_counterexample(ce);
+		}
+		delete cj;
+	}
+	r.usecs = usecs() - start;
+	r.oracle_queries = oracle.get_query_count();
+	r.tests = oracle.get_test_count();
+
+	return r;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 40;
+	unsigned int threads = 4;
+	int extra_states = 1;
+	int errors = 0;
+	dfa_randomgenerator rg;
+	const char * names[] = { "random walk", "W-method", "Wp-method" };
+
+	if(argc == 5) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+		threads       = atoi(argv[3]);
+		extra_states  = atoi(argv[4]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states\n"
+			"\t3: threads of the oracle\n"
+			"\t4: extra states for the W- and Wp-method\n";
+		return 1;
+	}
+
+	printf("states  method       rounds  learner queries  oracle queries     tests        us  learned\n");
+
+	for(int state_count = 10; state_count <= max_states; state_count += 10) {
+		finite_automaton model, minimal;
+		random_dfa(rg, model, alphabet_size, state_count);
+		minimal = model;
+		minimal.minimize();
+
+		for(int m = conformance_oracle<bool>::RANDOM_WALK; m <= conformance_oracle<bool>::WP_METHOD; ++m) {
+			result r = learn(model, minimal.state_count, (enum conformance_oracle<bool>::test_method)m, threads, extra_states);
+
+			printf("%6d  %-11s  %6u  %15u  %14u  %8u  %8llu  %s\n",
+					state_count, names[m], r.rounds, r.learner_queries, r.oracle_queries,
+					r.tests, r.usecs, r.learned ? "yes" : "no");
+			fflush(stdout);
+
+			if(r.missed) {
+				printf("%s missed a difference!\n", names[m]);
+				errors++;
+			}
+		}
+	}
+
+	return errors ? 1 : 0;
+}}}
+
@@ -0,0 +1,158 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2010 David R. Piegdon <david-i2@piegdon.de>
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for finite_automaton::contains() with and without a compiled
+// transition table, and for the batch contains() on a word_corpus.
+//
+// builds random deterministic and nondeterministic automata and classifies
+// the same random words with the map-based and the compiled simulation,
+// and as one corpus. all have to agree on every word.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <set>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/conjecture.h>
+
+using namespace std;
+using namespace libalf;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+// every state gets out_degree transitions per symbol (1: deterministic)
+void random_automaton(finite_automaton & fa, int state_count, int alphabet_size, int out_degree)
+{{{
+	set<int> final_states;
+
+	fa.clear();
+	fa.input_alphabet_size = alphabet_size;
+	fa.state_count = state_count;
+	fa.initial_states.insert(0);
+	for(int s = 0; s < state_count; ++s) {
+		if(rand() % 2)
+			final_states.insert(s);
+		for(int a = 0; a < alphabet_size; ++a)
+			for(int d = 0; d < out_degree; ++d)
+				fa.transitions[s][a].insert(rand() % state_count);
+	}
+	fa.set_final_states(final_states);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+// returns the number of words where both simulations disagree
+int bench(const char * name, finite_automaton & fa, vector<list<int> > & words, word_corpus & corpus, unsigned int threads)
+{{{
+	vector<bool> map_result(words.size()), compiled_result(words.size()), batch_result;
+	unsigned long long int start, map_usecs, compiled_usecs, batch_usecs;
+	int errors = 0;
+
+	fa.uncompile();
+	start = usecs();
+	for(unsigned int i = 0; i < words.size(); ++i)
+		map_result[i] = fa.contains(words[i]);
+	map_usecs = usecs() - start;
+
+	fa.compile();
+	start = usecs();
+	for(unsigned int i = 0; i < words.size(); ++i)
+		compiled_result[i] = fa.contains(words[i]);
+	compiled_usecs = usecs() - start;
+
+	start = usecs();
+	fa.contains(corpus, batch_result, threads);
+	batch_usecs = usecs() - start;
+
+	for(unsigned int i = 0; i < words.size(); ++i)
+		if(map_result[i] != compiled_result[i] || map_result[i] != batch_result[i])
+			errors++;
+
+	printf("%-5s %6d   %14.0f   %14.0f   %14.0f   %6.1fx\n", name, fa.state_count,
+			map_usecs ? words.size() * 1000000.0 / map_usecs : 0.0,
+			compiled_usecs ? words.size() * 1000000.0 / compiled_usecs : 0.0,
+			batch_usecs ? words.size() * 1000000.0 / batch_usecs : 0.0,
+			batch_usecs ? (double)map_usecs / batch_usecs : 0.0);
+	if(errors)
+		printf("%d words classified differently!\n", errors);
+	fflush(stdout);
+
+	return errors;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 4;
+	int word_count = 10000;
+	int word_length = 32;
+	unsigned int threads = 4;
+	int errors = 0;
+
+	if(argc == 5) {
+		alphabet_size = atoi(argv[1]);
+		word_count    = atoi(argv[2]);
+		word_length   = atoi(argv[3]);
+		threads       = atoi(argv[4]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: number of words\n"
+			"\t3: length of words\n"
+			"\t4: number of threads for the batch\n";
+		return 1;
+	}
+
+	srand(1);
+
+	vector<list<int> > words(word_count);
+	word_corpus corpus;
+	for(int i = 0; i < word_count; ++i) {
+		for(int l = 0; l < word_length; ++l)
+			words[i].push_back(rand() % alphabet_size);
+		corpus.add(words[i]);
+	}
+
+	printf("asize %d, %d words of length %d, %u threads for the batch\n\n", alphabet_size, word_count, word_length, threads);
+	printf("type  states   map words/sec   compiled w/sec      batch w/sec   speedup\n");
+
+	for(int state_count = 10; state_count <= 1000; state_count *= 10) {
+		finite_automaton fa;
+
+		random_automaton(fa, state_count, alphabet_size, 1);
+		errors += bench("DFA", fa, words, corpus, threads);
+		random_automaton(fa, state_count, alphabet_size, 2);
+		errors += bench("NFA", fa, words, corpus, threads);
+	}
+
+	return errors ? 1 : 0;
+}}}
@@ -0,0 +1,369 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for FLAT_TRANSITIONS.
+//
+// compares the map and the flat transition storage of conjectures as RPNI
+// builds them from random samples of a random DFA: heap used by a
+// deserialized copy, and the time of serialize(), deserialize(),
+// calc_validity(), calc_determinism(), visualize() and contains() without
+// compile(). both storages have to give the same serialization,
+// visualization and answers, and get_transition_view() has to give the
+// transitions of the map in both.
+//
+// RPNI itself is too slow for large samples, so the first row is a real
+// RPNI conjecture of few samples, and the large ones are the prefix tree
+// acceptors RPNI starts from (i.e. the conjecture without any merge).
+
+#include <sys/time.h>
+#include <malloc.h>
+
+#include <iostream>
+#include <list>
+#include <set>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_RPNI.h>
+
+using namespace std;
+using namespace libalf;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+size_t heap_used()
+{{{
+	struct mallinfo2 mi = mallinfo2();
+	return mi.uordblks + mi.hblkhd;
+}}}
+
+void random_dfa(vector<int> & delta, vector<bool> & final, int states, int alphabet_size)
+{{{
+	delta.resize(states * alphabet_size);
+	final.resize(states);
+	for(int s = 0; s < states; ++s) {
+		final[s] = rand() % 2;
+		for(int a = 0; a < alphabet_size; ++a)
+			delta[s * alphabet_size + a] = rand() % states;
+	}
+}}}
+
+list<int> random_word(int alphabet_size, int max_length)
+{{{
+	list<int> word;
+	int length = rand() % (max_length + 1);
+	for(int i = 0; i < length; ++i)
+		word.push_back(rand() % alphabet_size);
+	return word;
+}}}
+
+class timing {
+	public:
+		unsigned long long int serialize, deserialize, validity, determinism, visualize, contains;
+		size_t heap;
+};
+
+typedef set<pair<int, pair<int, int> > > transition_set;
+
+// the transitions of get_transition_view(). returns false if they are not in
+// order or one is seen twice.
+bool view_transitions(const finite_automaton & fa, transition_set & into)
+{{{
+	transition_view view = fa.get_transition_view();
+	transition_view::const_iterator ti;
+
+	into.clear();
+	for(ti = view.begin(); ti != view.end(); ++ti) {
+		pair<int, pair<int, int> > t(ti.source(), make_pair(ti.symbol(), ti.target()));
+		if(!into.empty() && !(*into.rbegin() < t))
+			return false;
+		into.insert(t);
+	}
+	return true;
+}}}
+
+bool map_transitions(const map<int, map<int, set<int> > > & transitions, transition_set & into)
+{{{
+	map<int, map<int, set<int> > >::const_iterator mmsi;
+	map<int, set<int> >::const_iterator msi;
+	set<int>::const_iterator si;
+
+	into.clear();
+	for(mmsi = transitions.begin(); mmsi != transitions.end(); ++mmsi)
+		for(msi = mmsi->second.begin(); msi != mmsi->second.end(); ++msi)
+			for(si = msi->second.begin(); si != msi->second.end(); ++si)
+				into.insert(make_pair(mmsi->first, make_pair(msi->first, *si)));
+	return true;
+}}}
+
+timing measure(finite_automaton & fa, const list<list<int> > & words, int repeat, basic_string<int32_t> & ser, string & dot, vector<bool> & answers)
+{{{
+	timing t;
+	unsigned long long int start;
+	list<list<int> >::const_iterator wi;
+
+	start = usecs();
+	for(int r = 0; r < repeat; ++r)
+		ser = fa.serialize();
+	t.serialize = usecs() - start;
+
+	{
+		finite_automaton copy(fa.is_flat() ? FLAT_TRANSITIONS : MAP_TRANSITIONS);
+		serial_stretch s(ser);
+		size_t before = heap_used();
+		copy.deserialize(s);
+		t.heap = heap_used() - before;
+	}
+
+	start = usecs();
+	for(int r = 0; r < repeat; ++r) {
+		finite_automaton copy(fa.is_flat() ? FLAT_TRANSITIONS : MAP_TRANSITIONS);
+		serial_stretch s(ser);
+		copy.deserialize(s);
+	}
+	t.deserialize = usecs() - start;
+
+	start = usecs();
+	for(int r = 0; r < repeat; ++r)
+		fa.calc_validity();
+	t.validity = usecs() - start;
+
+	start = usecs();
+	for(int r = 0; r < repeat; ++r)
+		fa.calc_determinism();
+	t.determinism = usecs() - start;
+
+	start = usecs();
+	for(int r = 0; r < repeat; ++r)
+		dot = fa.visualize();
+	t.visualize = usecs() - start;
+
+	answers.clear();
+	start = usecs();
+	for(wi = words.begin(); wi != words.end(); ++wi)
+		answers.push_back(fa.contains(*wi));
+	t.contains = usecs() - start;
+
+	return t;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 4;
+	int max_samples = 100000;
+	int repeat = 5;
+	int errors = 0;
+
+	// the view skips states without transitions and empty target sets
+	{
+		finite_automaton fa;
+		transition_set expected, seen;
+
+		fa.state_count = 5;
+		fa.transitions[0][0].insert(1);
+		fa.transitions[0][1];
+		fa.transitions[1];
+		fa.transitions[2][-1].insert(3);
+		fa.transitions[2][-1].insert(4);
+		fa.transitions[3][1];
+		fa.transitions[4][0].insert(0);
+		map_transitions(fa.transitions, expected);
+		if(!view_transitions(fa, seen) || seen != expected || expected.size() != 4) {
+			printf("get_transition_view() of a sparse map differs!\n");
+			errors++;
+		}
+		if(!fa.flatten() || !view_transitions(fa, seen) || seen != expected) {
+			printf("get_transition_view() of flat storage differs!\n");
+			errors++;
+		}
+		fa.expand();
+		fa.transitions.clear();
+		if(!view_transitions(fa, seen) || !seen.empty()) {
+			printf("get_transition_view() of no transitions is not empty!\n");
+			errors++;
+		}
+	}
+
+	if(argc == 4) {
+		alphabet_size = atoi(argv[1]);
+		max_samples   = atoi(argv[2]);
+		repeat        = atoi(argv[3]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of samples\n"
+			"\t3: repetitions of each operation\n";
+		return 1;
+	}
+
+	srand(1);
+
+	printf("asize %d, times in us for %d repetitions (contains: 100000 words once)\n\n", alphabet_size, repeat);
+	printf("samples   states  transitions  storage      heap  serialize  deserialize  validity  determinism  visualize  contains\n");
+
+	for(int samples = 100; samples <= max_samples; samples *= 10) {
+		vector<int> delta;
+		vector<bool> final;
+		list<list<int> > words;
+		conjecture * cj = NULL;
+		finite_automaton * fa;
+		finite_automaton pta;
+		finite_automaton flat(FLAT_TRANSITIONS);
+		basic_string<int32_t> map_ser, flat_ser;
+		string map_dot, flat_dot;
+		vector<bool> map_answers, flat_answers;
+		set<int> accepting;
+		timing tm, tf;
+
+		random_dfa(delta, final, 1000, alphabet_size);
+		for(int i = 0; i < 100000; ++i)
+			words.push_back(random_word(alphabet_size, 20));
+
+		if(samples == 100) {
+			knowledgebase<bool> kb;
+			ostream_logger log(&cerr, LOGGER_ERROR);
+			RPNI<bool> rpni(&kb, &log, alphabet_size);
+
+			for(int i = 0; i < samples; ++i) {
+				list<int> word = random_word(alphabet_size, 20);
+				list<int>::iterator li;
+				int state = 0;
+				for(li = word.begin(); li != word.end(); ++li)
+					state = delta[state * alphabet_size + *li];
+				kb.add_knowledge(word, final[state]);
+			}
+			cj = rpni.advance();
+			fa = dynamic_cast<finite_automaton*>(cj);
+			if(!fa) {
+				printf("RPNI gave no finite automaton!\n");
+				return 1;
+			}
+		} else {
+			// prefix tree acceptor
+			pta.input_alphabet_size = alphabet_size;
+			pta.state_count = 1;
+			pta.initial_states.insert(0);
+			for(int i = 0; i < samples; ++i) {
+				list<int> word = random_word(alphabet_size, 20);
+				list<int>::iterator li;
+				int state = 0, node = 0;
+				for(li = word.begin(); li != word.end(); ++li) {
+					set<int> & succ = pta.transitions[node][*li];
+					if(succ.empty())
+						succ.insert(pta.state_count++);
+					node = *succ.begin();
+					state = delta[state * alphabet_size + *li];
+				}
+				if(final[state])
+					accepting.insert(node);
+			}
+			pta.set_final_states(accepting);
+			pta.calc_determinism();
+			pta.valid = true;
+			fa = &pta;
+		}
+
+		flat = *fa;
+		if(!flat.flatten()) {
+			printf("flatten() failed!\n");
+			return 1;
+		}
+
+		tm = measure(*fa, words, repeat, map_ser, map_dot, map_answers);
+		tf = measure(flat, words, repeat, flat_ser, flat_dot, flat_answers);
+
+		printf("%7d  %7d  %11u  map      %9zu  %9llu  %11llu  %8llu  %11llu  %9llu  %8llu\n",
+				samples, fa->state_count, flat.get_flat_transitions().size(), tm.heap,
+				tm.serialize, tm.deserialize, tm.validity, tm.determinism, tm.visualize, tm.contains);
+		printf("%7s  %7s  %11s  flat     %9zu  %9llu  %11llu  %8llu  %11llu  %9llu  %8llu\n",
+				"", "", "", tf.heap,
+				tf.serialize, tf.deserialize, tf.validity, tf.determinism, tf.visualize, tf.contains);
+		fflush(stdout);
+
+		if(map_ser != flat_ser) {
+			printf("serializations differ!\n");
+			errors++;
+		}
+		if(map_dot != flat_dot) {
+			printf("visualizations differ!\n");
+			errors++;
+		}
+		if(map_answers != flat_answers) {
+			printf("contains() differs!\n");
+			errors++;
+		}
+		{
+			transition_set expected, in_map, in_flat;
+			map_transitions(fa->transitions, expected);
+			if(!view_transitions(*fa, in_map) || !view_transitions(flat, in_flat) || in_map != expected || in_flat != expected) {
+				printf("get_transition_view() differs!\n");
+				errors++;
+			}
+		}
+
+		// both storages read what the other one wrote
+		{
+			finite_automaton a(FLAT_TRANSITIONS), b;
+			serial_stretch s1(map_ser), s2(flat_ser);
+			if(!a.deserialize(s1) || !b.deserialize(s2) || a.serialize() != map_ser || b.serialize() != map_ser) {
+				printf("deserialization differs!\n");
+				errors++;
+			}
+			if(!a.read(fa->write()) || !a.is_flat() || a.write() != fa->write()) {
+				printf("write()/read() differs!\n");
+				errors++;
+			}
+			if(!a.minimize() || !b.minimize() || a.serialize() != b.serialize()) {
+				printf("minimize() differs!\n");
+				errors++;
+			}
+			if(!a.compile() || !b.compile()) {
+				printf("compile() failed!\n");
+				errors++;
+			} else {
+				list<list<int> >::const_iterator wi;
+				for(wi = words.begin(); wi != words.end(); ++wi) {
+					if(a.contains(*wi) != b.contains(*wi)) {
+						printf("compiled contains() differs!\n");
+						errors++;
+						break;
+					}
+				}
+			}
+		}
+
+		if(cj)
+			delete cj;
+	}
+
+	return errors ? 1 : 0;
+}}}
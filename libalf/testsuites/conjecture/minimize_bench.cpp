@@ -0,0 +1,151 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2010 David R. Piegdon <david-i2@piegdon.de>
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for moore_machine::minimize().
+//
+// builds random DFAs that are unrolled copies of a smaller DFA (so they
+// minimize to at most that size), minimizes them with a fresh and with a
+// shared partition_refiner and checks the result is equivalent (via
+// antichain_is_equal()) and does not change when minimized again.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/conjecture.h>
+
+using namespace std;
+using namespace libalf;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+// copies copies of a random partial DFA with core states. transitions
+// lead to the same state in a random copy.
+void random_redundant_dfa(finite_automaton & fa, int core, int copies, int alphabet_size)
+{{{
+	set<int> final_states;
+	vector<bool> core_final(core);
+	vector<int> core_delta(core * alphabet_size);
+
+	for(int s = 0; s < core; ++s) {
+		core_final[s] = rand() % 2;
+		for(int a = 0; a < alphabet_size; ++a)
+			core_delta[s * alphabet_size + a] = (rand() % 10) ? rand() % core : -1;
+	}
+
+	fa.clear();
+	fa.input_alphabet_size = alphabet_size;
+	fa.state_count = core * copies;
+	fa.initial_states.insert(0);
+	for(int s = 0; s < fa.state_count; ++s) {
+		if(core_final[s % core])
+			final_states.insert(s);
+		for(int a = 0; a < alphabet_size; ++a) {
+			int t = core_delta[(s % core) * alphabet_size + a];
+			if(t >= 0)
+				fa.transitions[s][a].insert(t + core * (rand() % copies));
+		}
+	}
+	fa.set_final_states(final_states);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 4;
+	int core = 50;
+	int runs = 20;
+	int errors = 0;
+	partition_refiner refiner;
+
+	if(argc == 4) {
+		alphabet_size = atoi(argv[1]);
+		core          = atoi(argv[2]);
+		runs          = atoi(argv[3]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: number of states of the minimal DFA (at most)\n"
+			"\t3: number of DFAs per size\n";
+		return 1;
+	}
+
+	srand(1);
+
+	printf("asize %d, %d DFAs per size\n\n", alphabet_size, runs);
+	printf("   states  minimal   fresh us/DFA   shared us/DFA\n");
+
+	for(int copies = 1; copies <= 1000; copies *= 10) {
+		unsigned long long int fresh_usecs = 0, shared_usecs = 0, start;
+		int minimal = 0;
+
+		for(int r = 0; r < runs; ++r) {
+			finite_automaton fa, m1, m2;
+			list<int> counterexample;
+
+			random_redundant_dfa(fa, core, copies, alphabet_size);
+			m1 = fa;
+			m2 = fa;
+
+			start = usecs();
+			m1.minimize();
+			fresh_usecs += usecs() - start;
+
+			start = usecs();
+			m2.minimize(refiner);
+			shared_usecs += usecs() - start;
+
+			if(m1.state_count != m2.state_count || m1.transitions != m2.transitions) {
+				printf("fresh and shared refiner differ!\n");
+				errors++;
+			}
+			if(copies <= 10 && !m1.antichain_is_equal(fa, counterexample)) {
+				printf("minimized DFA is not equivalent!\n");
+				errors++;
+			}
+			m1.minimize(refiner);
+			if(m1.state_count != m2.state_count || m1.transitions != m2.transitions) {
+				printf("minimizing twice changes the DFA!\n");
+				errors++;
+			}
+			minimal += m2.state_count;
+		}
+
+		printf("%9d %8.1f %14.1f %15.1f\n", core * copies, (double)minimal / runs,
+				(double)fresh_usecs / runs, (double)shared_usecs / runs);
+		fflush(stdout);
+	}
+
+	return errors ? 1 : 0;
+}}}
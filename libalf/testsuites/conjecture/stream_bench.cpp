@@ -0,0 +1,276 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// round-trip test and benchmark for conjecture_writer/conjecture_reader.
+//
+// writes random DFAs and NFAs (with epsilon transitions) to streams and
+// files, raw and compressed, with small chunks, and checks the read
+// automaton has the same serialization. broken and truncated streams have
+// to be rejected. then compares the throughput for a large DFA with the
+// text format (write()/read()) and the serial format
+// (serialize()/deserialize()).
+
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <sstream>
+#include <list>
+#include <set>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/conjecture.h>
+#include <libalf/conjecture_stream.h>
+
+using namespace std;
+using namespace libalf;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_automaton(finite_automaton & fa, int states, int alphabet_size, bool nondeterministic)
+{{{
+	set<int> final_states;
+
+	fa.clear();
+	fa.input_alphabet_size = alphabet_size;
+	fa.state_count = states;
+	fa.initial_states.insert(0);
+	if(nondeterministic && states > 1)
+		fa.initial_states.insert(states - 1);
+	for(int s = 0; s < states; ++s) {
+		if(rand() % 2)
+			final_states.insert(s);
+		for(int a = (nondeterministic ? -1 : 0); a < alphabet_size; ++a) {
+			int targets = nondeterministic ? rand() % 3 : (rand() % 10 ? 1 : 0);
+			for(int t = 0; t < targets; ++t)
+				fa.transitions[s][a].insert(rand() % states);
+		}
+	}
+	fa.set_final_states(final_states);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+bool round_trip(const finite_automaton & fa, bool compress, unsigned int chunk_entries, bool flat, string & data)
+{{{
+	stringstream str;
+	conjecture_writer writer(str, compress, chunk_entries);
+	finite_automaton back(flat ? FLAT_TRANSITIONS : MAP_TRANSITIONS);
+
+	if(!writer.write(fa))
+		return false;
+	data = str.str();
+	if(writer.get_bytes_written() != data.length())
+		return false;
+
+	conjecture_reader reader(str);
+	if(!reader.read(back))
+		return false;
+	if(back.is_flat() != flat || reader.get_bytes_read() != data.length())
+		return false;
+
+	return back.serialize() == fa.serialize();
+}}}
+
+bool rejects(const string & data)
+{{{
+	stringstream str(data);
+	conjecture_reader reader(str);
+	finite_automaton fa;
+
+	return !reader.read(fa) && !fa.valid;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int states = 200000;
+	int alphabet_size = 4;
+	int errors = 0;
+
+	if(argc == 3) {
+		states        = atoi(argv[1]);
+		alphabet_size = atoi(argv[2]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: number of states of the large DFA\n"
+			"\t2: alphabet size\n";
+		return 1;
+	}
+
+	srand(1);
+
+	// round trips
+	for(int r = 0; r < 200; ++r) {
+		finite_automaton fa;
+		string data;
+		bool nfa = r % 2;
+		bool compress = (r / 2) % 2;
+		bool flat = (r / 4) % 2;
+
+		random_automaton(fa, 1 + rand() % 50, 1 + rand() % 5, nfa);
+		if(!round_trip(fa, compress, 1 + rand() % 20, flat, data)) {
+			printf("round trip %d failed!\n", r);
+			errors++;
+			continue;
+		}
+
+		// a flipped bit is caught by the checksum, a cut off stream
+		// by the missing end chunk.
+		string broken = data;
+		broken[rand() % broken.length()] ^= 1 << (rand() % 8);
+		if(!rejects(broken)) {
+			printf("broken stream %d was read!\n", r);
+			errors++;
+		}
+		if(!rejects(data.substr(0, rand() % data.length()))) {
+			printf("truncated stream %d was read!\n", r);
+			errors++;
+		}
+	}
+
+	// flat automata are written from their flat storage
+	{
+		finite_automaton fa, flat;
+		string data;
+		random_automaton(fa, 100, 3, true);
+		flat = fa;
+		flat.flatten();
+		if(!round_trip(flat, true, 16, false, data) || !round_trip(flat, false, 16, true, data)) {
+			printf("round trip of a flat automaton failed!\n");
+			errors++;
+		}
+	}
+
+	// the text format: lines may come without a final newline
+	{
+		finite_automaton fa, back;
+		string text;
+		random_automaton(fa, 30, 2, true);
+		text = fa.write();
+		text.erase(text.length() - 1);
+		if(!back.read(text) || back.serialize() != fa.serialize()) {
+			printf("read() without final newline failed!\n");
+			errors++;
+		}
+	}
+
+	// throughput
+	{
+		finite_automaton fa, back, flat_back(FLAT_TRANSITIONS);
+		unsigned long long int start, t_write, t_read;
+		string text;
+		basic_string<int32_t> ser;
+		char filename[] = "/tmp/stream_bench.XXXXXX";
+		int fd;
+
+		random_automaton(fa, states, alphabet_size, false);
+		printf("\nDFA with %d states, alphabet size %d\n\n", states, alphabet_size);
+		printf("format                        bytes   write us    read us\n");
+
+		start = usecs();
+		text = fa.write();
+		t_write = usecs() - start;
+		start = usecs();
+		back.read(text);
+		t_read = usecs() - start;
+		printf("text (write/read)        %10zu %10llu %10llu\n", text.length(), t_write, t_read);
+		if(back.serialize() != fa.serialize()) {
+			printf("read() failed!\n");
+			errors++;
+		}
+
+		start = usecs();
+		ser = fa.serialize();
+		t_write = usecs() - start;
+		start = usecs();
+		{
+			serial_stretch s(ser);
+			back.deserialize(s);
+		}
+		t_read = usecs() - start;
+		printf("serial                   %10zu %10llu %10llu\n", ser.length() * sizeof(int32_t), t_write, t_read);
+
+		for(int compress = 0; compress <= 1; ++compress) {
+			stringstream str;
+			conjecture_writer writer(str, compress);
+
+			start = usecs();
+			writer.write(fa);
+			t_write = usecs() - start;
+			start = usecs();
+			conjecture_reader reader(str);
+			if(!reader.read(back)) {
+				printf("reader failed!\n");
+				errors++;
+			}
+			t_read = usecs() - start;
+			printf("stream %-10s        %10llu %10llu %10llu\n", compress ? "compressed" : "raw",
+					writer.get_bytes_written(), t_write, t_read);
+
+			stringstream str2(str.str());
+			conjecture_reader flat_reader(str2);
+			start = usecs();
+			flat_reader.read(flat_back);
+			t_read = usecs() - start;
+			printf("  into flat storage                         %10llu\n", t_read);
+			if(back.serialize() != ser || flat_back.serialize() != ser) {
+				printf("streams differ!\n");
+				errors++;
+			}
+		}
+
+		fd = mkstemp(filename);
+		if(fd < 0) {
+			printf("could not create %s\n", filename);
+			errors++;
+		} else {
+			conjecture_writer writer(fd);
+			start = usecs();
+			writer.write(fa);
+			t_write = usecs() - start;
+			lseek(fd, 0, SEEK_SET);
+			conjecture_reader reader(fd);
+			start = usecs();
+			if(!reader.read(flat_back) || flat_back.serialize() != ser) {
+				printf("file round trip failed!\n");
+				errors++;
+			}
+			t_read = usecs() - start;
+			printf("file, compressed         %10llu %10llu %10llu\n", writer.get_bytes_written(), t_write, t_read);
+			close(fd);
+			unlink(filename);
+		}
+	}
+
+	return errors ? 1 : 0;
+}}}
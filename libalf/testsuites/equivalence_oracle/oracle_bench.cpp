@@ -0,0 +1,187 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for equivalence_oracle.
+//
+// learns random NFAs of liblangen with angluin_simple_table. every
+// conjecture is checked by one oracle that is kept over the whole run
+// (incremental), by a new oracle for each conjecture and by
+// antichain_is_equal(). all have to agree, and counterexamples have to be
+// shortest words on which model and conjecture differ. a further oracle
+// checks copies of model and conjectures with flat transition storage (see
+// moore_machine::flatten()).
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_angluin.h>
+#include <libalf/equivalence_oracle.h>
+#include <liblangen/nfa_randomgenerator.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_nfa(nfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, 2, 0.1, 0.3, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 12;
+	int samples = 5;
+	int errors = 0;
+	nfa_randomgenerator rg;
+
+	if(argc == 4) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+		samples       = atoi(argv[3]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states of the NFAs\n"
+			"\t3: NFAs per size\n";
+		return 1;
+	}
+
+	printf("states  minimal  rounds   incremental us  fresh us  antichain us   explored   skipped\n");
+
+	for(int state_count = 4; state_count <= max_states; state_count += 4) {
+		for(int sample = 0; sample < samples; ++sample) {
+			unsigned long long int start, t_incremental = 0, t_fresh = 0, t_antichain = 0;
+			unsigned long long int explored = 0, skipped = 0;
+			finite_automaton model;
+			knowledgebase<bool> kb;
+			ostream_logger log(&cerr, LOGGER_ERROR);
+			int rounds = 0;
+			bool done = false;
+
+			random_nfa(rg, model, alphabet_size, state_count);
+			equivalence_oracle oracle(model);
+			finite_automaton flat_model(model);
+			flat_model.flatten();
+			equivalence_oracle flat_oracle(flat_model);
+			angluin_simple_table<bool> learner(&kb, &log, alphabet_size);
+
+			while(!done) {
+				conjecture * cj;
+				list<int> ce, fresh_ce, antichain_ce, flat_ce;
+				bool equal, fresh_equal, antichain_equal, flat_equal;
+
+				while(NULL == (cj = learner.advance())) {
+					knowledgebase<bool>::iterator qi;
+					for(qi = kb.qbegin(); qi != kb.qend(); ++qi)
+						qi->set_answer(model.contains(qi->get_word()));
+				}
+				finite_automaton * hypothesis = dynamic_cast<finite_automaton*>(cj);
+				rounds++;
+
+				start = usecs();
+				equal = oracle.equivalence_query(*hypothesis, ce);
+				t_incremental += usecs() - start;
+				explored += oracle.get_explored_states();
+				skipped += oracle.get_skipped_states();
+
+				start = usecs();
+				equivalence_oracle fresh(model);
+				fresh_equal = fresh.equivalence_query(*hypothesis, fresh_ce);
+				t_fresh += usecs() - start;
+
+				start = usecs();
+				antichain_equal = model.antichain_is_equal(*hypothesis, antichain_ce);
+				t_antichain += usecs() - start;
+
+				finite_automaton flat_hypothesis(*hypothesis);
+				flat_hypothesis.flatten();
+				flat_equal = flat_oracle.equivalence_query(flat_hypothesis, flat_ce);
+				if(flat_equal != equal || flat_ce.size() != ce.size()) {
+					printf("results on flat storage differ!\n");
+					errors++;
+				}
+
+				if(equal != fresh_equal || equal != antichain_equal) {
+					printf("results differ!\n");
+					errors++;
+				} else if(!equal) {
+					// antichain_is_equal() checks both inclusions one
+					// after the other, so its counterexample may be longer
+					if(ce.size() != fresh_ce.size() || ce.size() > antichain_ce.size()) {
+						printf("counterexample is not a shortest one!\n");
+						errors++;
+					}
+					if(model.contains(ce) == hypothesis->contains(ce)) {
+						printf("bad counterexample!\n");
+						errors++;
+					}
+				}
+
+				delete cj;
+				if(equal || ce.empty() || rounds > 1000)
+					done = true;
+				else
+					learner.add_counterexample(ce);
+			}
+
+			printf("%6d  %7d  %6d   %14llu  %8llu  %12llu   %8llu  %8llu\n",
+					state_count, oracle.get_model_state_count() - 1, rounds,
+					t_incremental, t_fresh, t_antichain, explored, skipped);
+			fflush(stdout);
+		}
+	}
+
+	return errors ? 1 : 0;
+}}}
+
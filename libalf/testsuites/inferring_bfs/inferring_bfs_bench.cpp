@@ -0,0 +1,217 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for BFS symmetry breaking (set_bfs_symmetry_breaking()).
+//
+// samples random words from random DFAs of liblangen and searches the
+// minimal DFA (dfa_inferring_MiniSat) and the minimal NFA
+// (nfa_inferring_MiniSat), with and without BFS symmetry breaking. both
+// have to find the same number of states and an automaton that is
+// consistent with the sample. reports the time of the last unsatisfiable
+// step (minimal number of states - 1) and of the whole search.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_dfa_inferring_minisat.h>
+#include <libalf/algorithm_nfa_inferring_minisat.h>
+#include <liblangen/dfa_randomgenerator.h>
+#include <liblangen/prng.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_dfa(dfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+void random_sample(knowledgebase<bool> & kb, const finite_automaton & model, int samples, int max_length)
+{{{
+	for(int i = 0; i < samples; ++i) {
+		list<int> word;
+		int length = prng::random_int(max_length + 1);
+		for(int j = 0; j < length; ++j)
+			word.push_back(prng::random_int(model.input_alphabet_size));
+		kb.add_knowledge(word, model.contains(word));
+	}
+}}}
+
+bool consistent(knowledgebase<bool> & kb, const finite_automaton & fa)
+{{{
+	knowledgebase<bool>::iterator ki;
+
+	for(ki = kb.begin(); ki != kb.end(); ++ki)
+		if(ki->is_answered() && ki->get_answer() != fa.contains(ki->get_word()))
+			return false;
+	return true;
+}}}
+
+class result {
+	public:
+		int states; // -1 if the automaton is not consistent with the sample
+		bool unsat; // there is no automaton with states - 1 states
+		unsigned long long int search_usecs;
+		unsigned long long int unsat_usecs;
+};
+
+template <class algorithm>
+result infer(algorithm & alg, knowledgebase<bool> & kb, bool bfs)
+{{{
+	result r;
+	unsigned long long int start;
+
+	alg.set_bfs_symmetry_breaking(bfs);
+
+	start = usecs();
+	conjecture * cj = alg.infer_linear();
+	r.search_usecs = usecs() - start;
+
+	finite_automaton * fa = dynamic_cast<finite_automaton*>(cj);
+	r.states = -1;
+	if(fa != NULL && consistent(kb, *fa))
+		r.states = fa->state_count;
+	delete cj;
+
+	r.unsat = true;
+	r.unsat_usecs = 0;
+	if(r.states > 1) {
+		start = usecs();
+		cj = alg.infer(r.states - 1);
+		r.unsat_usecs = usecs() - start;
+		r.unsat = (cj == NULL);
+		delete cj;
+	}
+
+	return r;
+}}}
+
+template <class algorithm>
+int compare(algorithm & alg, knowledgebase<bool> & kb, int model_states, const char * type)
+{{{
+	int errors = 0;
+	result r[2];
+
+	for(int bfs = 0; bfs < 2; ++bfs)
+		r[bfs] = infer(alg, kb, bfs);
+
+	if(r[0].states < 0 || r[1].states < 0) {
+		printf("inferred automaton is not consistent with the sample!\n");
+		errors++;
+	} else if(r[0].states != r[1].states) {
+		printf("BFS symmetry breaking found %d instead of %d states!\n", r[1].states, r[0].states);
+		errors++;
+	}
+	if(!r[0].unsat || !r[1].unsat) {
+		printf("there is a smaller automaton than the one found!\n");
+		errors++;
+	}
+
+	printf("%5d   %4s   %6d   %11llu   %11llu   %10llu   %10llu\n",
+			model_states, type, r[0].states, r[0].unsat_usecs, r[1].unsat_usecs,
+			r[0].search_usecs, r[1].search_usecs);
+	fflush(stdout);
+
+	return errors;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 6; // the NFA search of 7 states alone takes about a minute
+	int samples = 60;
+	int max_length = 10;
+	bool nfa = true;
+	int errors = 0;
+	dfa_randomgenerator rg;
+	ostream_logger log(&cerr, LOGGER_ERROR, false);
+
+	if(argc == 6) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+		samples       = atoi(argv[3]);
+		max_length    = atoi(argv[4]);
+		nfa           = atoi(argv[5]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states of the model\n"
+			"\t3: number of sampled words\n"
+			"\t4: maximal length of sampled words\n"
+			"\t5: also infer NFAs (0 or 1)\n";
+		return 1;
+	}
+
+	printf("                        last UNSAT step          whole search\n");
+	printf("model   type   states        us   BFS us        us   BFS us\n");
+
+	for(int state_count = 2; state_count <= max_states; ++state_count) {
+		finite_automaton model;
+		knowledgebase<bool> kb;
+
+		random_dfa(rg, model, alphabet_size, state_count);
+		random_sample(kb, model, samples, max_length);
+
+		dfa_inferring_MiniSat dfa_alg(&kb, &log, alphabet_size);
+		errors += compare(dfa_alg, kb, state_count, "DFA");
+
+		if(nfa) {
+			nfa_inferring_MiniSat nfa_alg(&kb, &log, alphabet_size);
+			errors += compare(nfa_alg, kb, state_count, "NFA");
+		}
+	}
+
+	return errors ? 1 : 0;
+}}}
+
@@ -0,0 +1,166 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for the incremental mode of dfa_inferring_MiniSat.
+//
+// samples random words from random DFAs of liblangen and infers a minimal
+// DFA with infer_linear() and infer_binarysearch(), once with a new solver
+// for each number of states and once incremental. both have to find the
+// same number of states and a DFA that is consistent with the sample.
+// infer_binarysearch() ignores set_incremental(), so its two columns should
+// only differ by noise.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_dfa_inferring_minisat.h>
+#include <liblangen/dfa_randomgenerator.h>
+#include <liblangen/prng.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_dfa(dfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+void random_sample(knowledgebase<bool> & kb, const finite_automaton & model, int samples, int max_length)
+{{{
+	for(int i = 0; i < samples; ++i) {
+		list<int> word;
+		int length = prng::random_int(max_length + 1);
+		for(int j = 0; j < length; ++j)
+			word.push_back(prng::random_int(model.input_alphabet_size));
+		kb.add_knowledge(word, model.contains(word));
+	}
+}}}
+
+// returns the number of states, or -1 if the DFA is not consistent with the sample
+int infer(dfa_inferring_MiniSat & alg, knowledgebase<bool> & kb, bool binarysearch, unsigned long long int & time)
+{{{
+	unsigned long long int start = usecs();
+	conjecture * cj = binarysearch ? alg.infer_binarysearch() : alg.infer_linear();
+	time = usecs() - start;
+
+	finite_automaton * dfa = dynamic_cast<finite_automaton*>(cj);
+	int states = -1;
+	if(dfa != NULL && is_consistent(kb, *dfa))
+		states = dfa->state_count;
+	delete cj;
+
+	return states;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 8;
+	int samples = 60;
+	int max_length = 10;
+	int errors = 0;
+	dfa_randomgenerator rg;
+	ostream_logger log(&cerr, LOGGER_ERROR, false);
+
+	if(argc == 5) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+		samples       = atoi(argv[3]);
+		max_length    = atoi(argv[4]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states of the model\n"
+			"\t3: number of sampled words\n"
+			"\t4: maximal length of sampled words\n";
+		return 1;
+	}
+
+	printf("model   search   states     fresh us   incremental us\n");
+
+	for(int state_count = 2; state_count <= max_states; ++state_count) {
+		finite_automaton model;
+		knowledgebase<bool> kb;
+
+		random_dfa(rg, model, alphabet_size, state_count);
+		random_sample(kb, model, samples, max_length);
+
+		dfa_inferring_MiniSat alg(&kb, &log, alphabet_size);
+
+		for(int binarysearch = 0; binarysearch < 2; ++binarysearch) {
+			unsigned long long int t[2];
+			int states[2];
+
+			for(int incremental = 0; incremental < 2; ++incremental) {
+				alg.set_incremental(incremental);
+				states[incremental] = infer(alg, kb, binarysearch, t[incremental]);
+			}
+
+			if(states[0] < 0 || states[1] < 0) {
+				printf("inferred DFA is not consistent with the sample!\n");
+				errors++;
+			} else if(states[0] != states[1]) {
+				printf("incremental inference found %d instead of %d states!\n", states[1], states[0]);
+				errors++;
+			}
+
+			printf("%5d   %6s   %6d   %10llu   %14llu\n",
+					state_count, binarysearch ? "binary" : "linear", states[0], t[0], t[1]);
+			fflush(stdout);
+		}
+	}
+
+	return errors ? 1 : 0;
+}}}
+
@@ -0,0 +1,223 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for premerging (set_premerging()).
+//
+// samples random words from random DFAs of liblangen and merges the prefix
+// tree with red_blue_premerging. checks that every word of the sample leads
+// to a node with the same output in the quotient. then searches the minimal
+// DFA (dfa_inferring_MiniSat) with and without premerging. both have to find
+// the same number of states and an automaton that is consistent with the
+// sample. reports the nodes of the tree and of the quotient (the number of
+// x variables per state), the lower bound and the time of both searches.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/algorithm_dfa_inferring_minisat.h>
+#include <libalf/red_blue_premerging.h>
+#include <liblangen/dfa_randomgenerator.h>
+#include <liblangen/prng.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_dfa(dfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+void random_sample(knowledgebase<bool> & kb, const finite_automaton & model, int samples, int max_length)
+{{{
+	for(int i = 0; i < samples; ++i) {
+		list<int> word;
+		int length = prng::random_int(max_length + 1);
+		for(int j = 0; j < length; ++j)
+			word.push_back(prng::random_int(model.input_alphabet_size));
+		kb.add_knowledge(word, model.contains(word));
+	}
+}}}
+
+bool consistent(knowledgebase<bool> & kb, const finite_automaton & fa)
+{{{
+	knowledgebase<bool>::iterator ki;
+
+	for(ki = kb.begin(); ki != kb.end(); ++ki)
+		if(ki->is_answered() && ki->get_answer() != fa.contains(ki->get_word()))
+			return false;
+	return true;
+}}}
+
+bool quotient_keeps_sample(knowledgebase<bool> & kb, const prefix_tree<bool> & q)
+{{{
+	knowledgebase<bool>::iterator ki;
+
+	for(ki = kb.begin(); ki != kb.end(); ++ki) {
+		if(!ki->is_answered())
+			continue;
+
+		list<int> word = ki->get_word();
+		list<int>::iterator wi;
+		unsigned int node = prefix_tree<bool>::root;
+		for(wi = word.begin(); wi != word.end(); ++wi) {
+			node = q.edges[node][*wi];
+			if(node == prefix_tree<bool>::no_edge)
+				return false;
+		}
+		if(!q.specified[node] || q.output[node] != ki->get_answer())
+			return false;
+	}
+	return true;
+}}}
+
+class result {
+	public:
+		int states; // -1 if the automaton is not consistent with the sample
+		unsigned long long int search_usecs;
+};
+
+result infer(dfa_inferring_MiniSat & alg, knowledgebase<bool> & kb, bool premerging)
+{{{
+	result r;
+	unsigned long long int start;
+
+	alg.set_premerging(premerging);
+
+	start = usecs();
+	conjecture * cj = alg.infer_linear();
+	r.search_usecs = usecs() - start;
+
+	finite_automaton * fa = dynamic_cast<finite_automaton*>(cj);
+	r.states = -1;
+	if(fa != NULL && consistent(kb, *fa))
+		r.states = fa->state_count;
+	delete cj;
+
+	return r;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 2;
+	int max_states = 8;
+	int samples = 400;
+	int max_length = 12;
+	unsigned int evidence = 3;
+	int errors = 0;
+	dfa_randomgenerator rg;
+	ostream_logger log(&cerr, LOGGER_ERROR, false);
+
+	if(argc == 6) {
+		alphabet_size = atoi(argv[1]);
+		max_states    = atoi(argv[2]);
+		samples       = atoi(argv[3]);
+		max_length    = atoi(argv[4]);
+		evidence      = atoi(argv[5]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: maximal number of states of the model\n"
+			"\t3: number of sampled words\n"
+			"\t4: maximal length of sampled words\n"
+			"\t5: minimal evidence of a merge\n";
+		return 1;
+	}
+
+	printf("                    nodes           lower           search\n");
+	printf("model   states    tree  quotient    bound         us   premerged us\n");
+
+	for(int state_count = 2; state_count <= max_states; ++state_count) {
+		finite_automaton model;
+		knowledgebase<bool> kb;
+
+		random_dfa(rg, model, alphabet_size, state_count);
+		random_sample(kb, model, samples, max_length);
+
+		prefix_tree<bool> t(kb, alphabet_size);
+		red_blue_premerging<bool> merging(t, evidence);
+		prefix_tree<bool> * q = merging.create_quotient();
+		if(!quotient_keeps_sample(kb, *q)) {
+			printf("quotient does not keep the sample!\n");
+			errors++;
+		}
+
+		dfa_inferring_MiniSat alg(&kb, &log, alphabet_size);
+		alg.set_premerging_evidence(evidence);
+		result r[2];
+		for(int premerging = 0; premerging < 2; ++premerging)
+			r[premerging] = infer(alg, kb, premerging);
+
+		if(r[0].states < 0 || r[1].states < 0) {
+			printf("inferred automaton is not consistent with the sample!\n");
+			errors++;
+		} else if(r[0].states != r[1].states) {
+			printf("premerging found %d instead of %d states!\n", r[1].states, r[0].states);
+			errors++;
+		}
+		if(r[0].states >= 0 && merging.get_lower_bound() > (unsigned int)r[0].states) {
+			printf("lower bound %u exceeds the minimal number of states!\n", merging.get_lower_bound());
+			errors++;
+		}
+
+		printf("%5d   %6d   %5u   %8u   %6u   %9llu   %12llu\n",
+				state_count, r[0].states, t.node_count, q->node_count, merging.get_lower_bound(),
+				r[0].search_usecs, r[1].search_usecs);
+		fflush(stdout);
+
+		delete q;
+	}
+
+	return errors ? 1 : 0;
+}}}
+
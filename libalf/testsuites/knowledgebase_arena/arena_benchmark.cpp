@@ -0,0 +1,183 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * arena_benchmark: insert/lookup throughput and memory of knowledgebase,
+ * and the number of heap allocations it does per node, for both storage
+ * backends. with heap_storage every node is an object of its own with a
+ * vector of children; with arena_storage (the default) the nodes live in
+ * an arena, so allocations per node should be far below one. each
+ * backend runs twice, the second round after clear(). the resident
+ * size grown is only meaningful for the first backend of a process, so
+ * the backend can be chosen by an optional fourth parameter.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <libalf/knowledgebase.h>
+
+using namespace std;
+using namespace libalf;
+
+static unsigned long long allocations = 0;
+
+void * operator new(size_t size)
+{{{
+	allocations++;
+	void * p = malloc(size ? size : 1);
+	if(!p)
+		throw std::bad_alloc();
+	return p;
+}}}
+
+void operator delete(void * p) throw()
+{{{
+	free(p);
+}}}
+
+void operator delete(void * p, size_t __attribute__ ((__unused__)) size) throw()
+{{{
+	free(p);
+}}}
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+long resident_kbytes()
+{{{
+	long pages_total = 0, pages_resident = 0;
+	FILE * f = fopen("/proc/self/statm", "r");
+
+	if(!f)
+		return -1;
+	if(fscanf(f, "%ld %ld", &pages_total, &pages_resident) != 2)
+		pages_resident = -1;
+	fclose(f);
+
+	return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+}}}
+
+void generate_words(vector<list<int> > & words, int count, int alphabet_size, int max_length)
+{{{
+	srand(1234);
+	words.resize(count);
+	for(int i = 0; i < count; i++) {
+		int length = 1 + rand() % max_length;
+		for(int j = 0; j < length; j++)
+			words[i].push_back(rand() % alphabet_size);
+	}
+}}}
+
+template <class kb_t>
+void run(const char * name, kb_t & kb, vector<list<int> > & words)
+{{{
+	long double t_insert, t_lookup;
+	long rss_before, rss_after;
+	unsigned long long allocations_before, insert_allocations;
+	int found = 0;
+
+	rss_before = resident_kbytes();
+	allocations_before = allocations;
+
+	t_insert = exact_time();
+	for(unsigned int i = 0; i < words.size(); i++)
+		kb.add_knowledge(words[i], (i % 3) == 0);
+	t_insert = exact_time() - t_insert;
+
+	insert_allocations = allocations - allocations_before;
+	rss_after = resident_kbytes();
+
+	t_lookup = exact_time();
+	for(int round = 0; round < 4; round++) {
+		for(unsigned int i = 0; i < words.size(); i++) {
+			bool a;
+			if(kb.resolve_query(words[i], a))
+				found++;
+		}
+	}
+	t_lookup = exact_time() - t_lookup;
+
+	printf("%-8s nodes %9d  insert %10.0Lf words/s  lookup %10.0Lf words/s  allocations/node %6.3f  get_memory_usage %8llu kB  resident %7ld kB\n",
+			name, kb.count_nodes(),
+			words.size() / t_insert, (4 * words.size()) / t_lookup,
+			(double)insert_allocations / kb.count_nodes(),
+			kb.get_memory_usage() / 1024, rss_after - rss_before);
+	fflush(stdout);
+
+	if(found != 4 * (int)words.size())
+		printf("%s: lookup failed for %d words!\n", name, 4 * (int)words.size() - found);
+}}}
+
+int main(int argc, char**argv)
+{{{
+	if(argc != 4 && argc != 5) {
+		cout << "please give the following parameters:\n"
+			"\t1: number of words\n"
+			"\t2: alphabet size\n"
+			"\t3: maximal word length\n"
+			"\t[4: storage, heap or arena. default: both]\n";
+		return 1;
+	}
+
+	int count = atoi(argv[1]);
+	int alphabet_size = atoi(argv[2]);
+	int max_length = atoi(argv[3]);
+	string backend = (argc == 5) ? argv[4] : "";
+
+	vector<list<int> > words;
+	generate_words(words, count, alphabet_size, max_length);
+
+	printf("%d words, alphabet size %d, length 1..%d\n", count, alphabet_size, max_length);
+	fflush(stdout);
+
+	if(backend != "arena") {
+		knowledgebase<bool, heap_storage> kb;
+		run("heap", kb, words);
+		kb.clear();
+		run("heap/2", kb, words);
+	}
+	if(backend != "heap") {
+		knowledgebase<bool> kb;
+		run("arena", kb, words);
+		kb.clear();
+		run("arena/2", kb, words);
+	}
+
+	return 0;
+}}}
+
@@ -0,0 +1,175 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * arena_consistency: check the storage backends of knowledgebase. random
+ * knowledge is added (the alphabet is grown in between, which relocates
+ * the blocks of children of the arena), compared against a std::map and
+ * checked again after clear_queries(), serialization and clear(), which
+ * reuse freed nodes and blocks.
+ */
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdlib.h>
+
+#include <libalf/knowledgebase.h>
+
+using namespace std;
+using namespace libalf;
+
+list<int> random_word(int alphabet_size, int max_length)
+{{{
+	list<int> w;
+	int length = rand() % (max_length + 1);
+
+	for(int i = 0; i < length; i++)
+		w.push_back(rand() % alphabet_size);
+
+	return w;
+}}}
+
+template <class kb_t>
+int check(kb_t & kb, map<list<int>, bool> & reference, const char * when)
+{{{
+	int errors = 0;
+	set<list<int> > prefixes;
+	map<list<int>, bool>::iterator ri;
+
+	prefixes.insert(list<int>());
+	for(ri = reference.begin(); ri != reference.end(); ++ri) {
+		list<int> w = ri->first;
+		bool a = !ri->second;
+		if(!kb.resolve_query(w, a) || a != ri->second)
+			errors++;
+		while(!w.empty()) {
+			prefixes.insert(w);
+			w.pop_back();
+		}
+	}
+
+	if(kb.count_answers() != (int)reference.size()) {
+		cout << when << ": " << kb.count_answers() << " answers, expected " << reference.size() << "\n";
+		errors++;
+	}
+	// all nodes must be reachable by the iterator
+	int iterated = 0;
+	for(typename kb_t::iterator it = kb.begin(); it != kb.end(); ++it)
+		iterated++;
+	if(iterated != kb.count_nodes()) {
+		cout << when << ": iterated over " << iterated << " of " << kb.count_nodes() << " nodes\n";
+		errors++;
+	}
+	if(kb.count_queries() == 0 && kb.count_nodes() != (int)prefixes.size()) {
+		cout << when << ": " << kb.count_nodes() << " nodes, expected " << prefixes.size() << "\n";
+		errors++;
+	}
+
+	return errors;
+}}}
+
+template <class kb_t>
+void fill(kb_t & kb, map<list<int>, bool> & reference, int count, int alphabet_size, int max_length)
+{{{
+	for(int i = 0; i < count; i++) {
+		list<int> w = random_word(alphabet_size, max_length);
+		bool a = (rand() % 2) == 0;
+		map<list<int>, bool>::iterator ri = reference.find(w);
+		if(ri != reference.end())
+			a = ri->second;
+		kb.add_knowledge(w, a);
+		reference[w] = a;
+	}
+}}}
+
+template <class kb_t>
+int check_storage(const char * name)
+{{{
+	kb_t kb;
+	map<list<int>, bool> reference;
+	int errors = 0;
+
+	srand(4711);
+
+	fill(kb, reference, 5000, 3, 12);
+	errors += check(kb, reference, "small alphabet");
+
+	// grow the alphabet, so all blocks of children are relocated
+	fill(kb, reference, 3000, 40, 6);
+	errors += check(kb, reference, "large alphabet");
+
+	// add queries and remove them again. the freed nodes are reused.
+	set<list<int> > queries;
+	for(int i = 0; i < 2000; i++) {
+		list<int> w = random_word(50, 8);
+		if(reference.find(w) == reference.end()) {
+			kb.add_query(w);
+			queries.insert(w);
+		}
+	}
+	if(kb.count_queries() != (int)queries.size()) {
+		cout << kb.count_queries() << " queries, expected " << queries.size() << "\n";
+		errors++;
+	}
+	kb.clear_queries();
+	errors += check(kb, reference, "clear_queries");
+	fill(kb, reference, 2000, 50, 8);
+	errors += check(kb, reference, "refill");
+
+	// serialization round trip
+	basic_string<int32_t> s = kb.serialize();
+	kb_t kb2;
+	serial_stretch ser(s);
+	if(!kb2.deserialize(ser) || kb2.serialize() != s) {
+		cout << "serialization round trip failed\n";
+		errors++;
+	}
+	errors += check(kb2, reference, "deserialized");
+
+	// clear keeps the storage for reuse
+	kb.clear();
+	reference.clear();
+	if(kb.count_nodes() != 1)
+		errors++;
+	fill(kb, reference, 5000, 7, 10);
+	errors += check(kb, reference, "after clear");
+
+	if(errors)
+		cout << name << ": " << errors << " errors.\n";
+	else
+		cout << name << " storage of knowledgebase is consistent.\n";
+
+	return errors;
+}}}
+
+int main()
+{{{
+	int errors = 0;
+
+	errors += check_storage<knowledgebase<bool> >("arena");
+	errors += check_storage<knowledgebase<bool, heap_storage> >("heap");
+
+	return errors ? 1 : 0;
+}}}
@@ -0,0 +1,161 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * batch_queries: answer queries via knowledgebase::export_queries() and
+ * knowledgebase::import_answers() and compare the throughput with
+ * answering one query at a time via qbegin().
+ */
+
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <libalf/knowledgebase.h>
+
+using namespace std;
+using namespace libalf;
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+// the "model": words with an even number of 1s.
+template <class InputIterator>
+bool model_accepts(InputIterator first, InputIterator limit)
+{{{
+	bool even = true;
+	for(/* nothing */; first != limit; ++first)
+		if(*first == 1)
+			even = !even;
+	return even;
+}}}
+
+void add_queries(knowledgebase<bool> & kb, int count)
+{{{
+	srand(815);
+	for(int i = 0; i < count; i++) {
+		list<int> w;
+		int length = rand() % 24;
+		for(int j = 0; j < length; j++)
+			w.push_back(rand() % 3);
+		kb.add_query(w);
+	}
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int count = 200000;
+	int errors = 0;
+	long double t;
+
+	if(argc > 1)
+		count = atoi(argv[1]);
+
+	// batched
+	knowledgebase<bool> kb1;
+	add_queries(kb1, count);
+	int queries = kb1.count_queries();
+
+	t = exact_time();
+	vector<int32_t> buffer;
+	vector<bool> answers;
+	unsigned int exported = kb1.export_queries(buffer);
+	vector<int32_t>::iterator bi = buffer.begin();
+	while(bi != buffer.end()) {
+		int length = *bi++;
+		answers.push_back(model_accepts(bi, bi + length));
+		bi += length;
+	}
+	if(!kb1.import_answers(answers))
+		errors++;
+	t = exact_time() - t;
+	printf("batched:      %d queries, %.0Lf queries/s\n", queries, queries / t);
+
+	if((int)exported != queries || !kb1.is_answered())
+		errors++;
+
+	// one at a time
+	knowledgebase<bool> kb2;
+	add_queries(kb2, count);
+
+	t = exact_time();
+	knowledgebase<bool>::iterator qi;
+	while((qi = kb2.qbegin()) != kb2.qend()) {
+		list<int> w = qi->get_word();
+		qi->set_answer(model_accepts(w.begin(), w.end()));
+	}
+	t = exact_time() - t;
+	printf("single query: %d queries, %.0Lf queries/s\n", queries, queries / t);
+
+	// both must hold the same knowledge
+	if(kb1.count_answers() != kb2.count_answers())
+		errors++;
+	knowledgebase<bool>::iterator ki;
+	for(ki = kb2.begin(); ki != kb2.end(); ++ki) {
+		if(ki->is_answered()) {
+			list<int> w = ki->get_word();
+			bool a;
+			if(!kb1.resolve_query(w, a) || a != ki->get_answer())
+				errors++;
+		}
+	}
+
+	// partial export answers the oldest queries first
+	knowledgebase<bool> kb3;
+	add_queries(kb3, 100);
+	list<list<int> > all_queries = kb3.get_queries();
+	if(kb3.export_queries(buffer, 10) != 10)
+		errors++;
+	answers.assign(10, true);
+	kb3.import_answers(answers);
+	list<list<int> >::iterator li = all_queries.begin();
+	for(int i = 0; i < 10; ++i, ++li) {
+		bool a;
+		if(!kb3.resolve_query(*li, a))
+			errors++;
+	}
+	if(kb3.count_queries() != (int)all_queries.size() - 10)
+		errors++;
+	answers.resize(all_queries.size());
+	if(kb3.import_answers(answers))
+		errors++; // too many answers
+
+	if(errors) {
+		cout << errors << " errors.\n";
+		return 1;
+	}
+
+	cout << "batch interface ok.\n";
+	return 0;
+}}}
+
@@ -0,0 +1,227 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * concurrent_scaling: measure the throughput of concurrent_knowledgebase
+ * for 1..N threads and compare it to knowledgebase<bool> behind a single
+ * mutex. every thread first resolves-or-adds its share of a word pool,
+ * then claims and answers queries and finally resolves all its words
+ * again.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <pthread.h>
+
+#include <libalf/knowledgebase.h>
+#include <libalf/knowledgebase_concurrent.h>
+
+using namespace std;
+using namespace libalf;
+
+typedef concurrent_knowledgebase<bool> ckb;
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+bool model_accepts(const list<int> & w)
+{{{
+	bool even = true;
+	for(list<int>::const_iterator i = w.begin(); i != w.end(); ++i)
+		if(*i == 1)
+			even = !even;
+	return even;
+}}}
+
+struct worker_data {
+	ckb * cbase;
+	knowledgebase<bool> * lbase;
+	pthread_mutex_t * lock;
+	pthread_barrier_t * answered;
+	vector<list<int> > * words;
+	int first, limit;
+	int known;
+};
+
+void * concurrent_worker(void * arg)
+{{{
+	worker_data * d = (worker_data*) arg;
+	vector<ckb::node*> claimed;
+	bool a;
+
+	for(int i = d->first; i < d->limit; ++i)
+		d->cbase->resolve_or_add_query((*d->words)[i], a);
+
+	while(d->cbase->claim_queries(claimed, 64) > 0)
+		for(vector<ckb::node*>::iterator ni = claimed.begin(); ni != claimed.end(); ++ni)
+			(*ni)->set_answer(model_accepts((*ni)->get_word()));
+
+	// other workers may still be answering their claimed queries
+	pthread_barrier_wait(d->answered);
+
+	d->known = 0;
+	for(int i = d->first; i < d->limit; ++i)
+		if(d->cbase->resolve_query((*d->words)[i], a))
+			d->known++;
+
+	return NULL;
+}}}
+
+void * locked_worker(void * arg)
+{{{
+	worker_data * d = (worker_data*) arg;
+	bool a;
+
+	for(int i = d->first; i < d->limit; ++i) {
+		pthread_mutex_lock(d->lock);
+		d->lbase->resolve_or_add_query((*d->words)[i], a);
+		pthread_mutex_unlock(d->lock);
+	}
+
+	for(;;) {
+		list<int> w;
+		pthread_mutex_lock(d->lock);
+		knowledgebase<bool>::iterator qi = d->lbase->qbegin();
+		if(qi == d->lbase->qend()) {
+			pthread_mutex_unlock(d->lock);
+			break;
+		}
+		// the single lock forces a worker to hold the query until
+		// it is answered.
+		w = qi->get_word();
+		qi->set_answer(model_accepts(w));
+		pthread_mutex_unlock(d->lock);
+	}
+
+	pthread_barrier_wait(d->answered);
+
+	d->known = 0;
+	for(int i = d->first; i < d->limit; ++i) {
+		pthread_mutex_lock(d->lock);
+		if(d->lbase->resolve_query((*d->words)[i], a))
+			d->known++;
+		pthread_mutex_unlock(d->lock);
+	}
+
+	return NULL;
+}}}
+
+long double run(bool concurrent, int threads, vector<list<int> > & words, int & known)
+{{{
+	ckb cbase(2);
+	knowledgebase<bool> lbase;
+	pthread_mutex_t lock;
+	pthread_barrier_t answered;
+	vector<worker_data> data(threads);
+	vector<pthread_t> tids(threads);
+	long double start;
+
+	pthread_mutex_init(&lock, NULL);
+	pthread_barrier_init(&answered, NULL, threads);
+	for(int t = 0; t < threads; ++t) {
+		data[t].cbase = &cbase;
+		data[t].lbase = &lbase;
+		data[t].lock = &lock;
+		data[t].answered = &answered;
+		data[t].words = &words;
+		data[t].first = words.size() * t / threads;
+		data[t].limit = words.size() * (t+1) / threads;
+	}
+
+	start = exact_time();
+	for(int t = 0; t < threads; ++t)
+		pthread_create(&tids[t], NULL, concurrent ? concurrent_worker : locked_worker, &data[t]);
+	known = 0;
+	for(int t = 0; t < threads; ++t) {
+		pthread_join(tids[t], NULL);
+		known += data[t].known;
+	}
+	start = exact_time() - start;
+	pthread_barrier_destroy(&answered);
+	pthread_mutex_destroy(&lock);
+
+	return start;
+}}}
+
+int main(int argc, char**argv)
+{
+	int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	int wordcount = 400000;
+	int errors = 0;
+
+	if(argc > 1)
+		max_threads = atoi(argv[1]);
+	if(max_threads < 1)
+		max_threads = 1;
+	if(argc > 2)
+		wordcount = atoi(argv[2]);
+
+	vector<list<int> > words;
+	unsigned int seed = 1;
+	for(int i = 0; i < wordcount; ++i) {
+		list<int> w;
+		int len = 4 + rand_r(&seed) % 16;
+		for(int j = 0; j < len; ++j)
+			w.push_back(rand_r(&seed) % 2);
+		words.push_back(w);
+	}
+
+	printf("%d words, up to %d threads\n", wordcount, max_threads);
+	printf("threads  concurrent [s]  ops/s        single mutex [s]  ops/s\n");
+	for(int threads = 1; threads <= max_threads; /* nothing */) {
+		int ck, lk;
+		long double ct = run(true, threads, words, ck);
+		long double lt = run(false, threads, words, lk);
+
+		if(ck != wordcount || lk != wordcount) {
+			printf("not all words known after answering: %d / %d\n", ck, lk);
+			errors++;
+		}
+
+		printf("%7d  %14.3Lf  %11.0Lf  %16.3Lf  %11.0Lf\n", threads,
+				ct, 2 * wordcount / ct, lt, 2 * wordcount / lt);
+
+		// 1, 2, 4, ..., max_threads
+		if(threads < max_threads && threads * 2 > max_threads)
+			threads = max_threads;
+		else
+			threads *= 2;
+	}
+
+	return errors ? 1 : 0;
+}
+
@@ -0,0 +1,231 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * concurrent_stress: many threads concurrently add queries and knowledge to
+ * one concurrent_knowledgebase while claiming and answering queries.
+ * checks that no query is evaluated twice, that all answers are consistent
+ * and that the result serializes into a valid knowledgebase.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <pthread.h>
+
+#include <libalf/knowledgebase.h>
+#include <libalf/knowledgebase_concurrent.h>
+
+using namespace std;
+using namespace libalf;
+
+typedef concurrent_knowledgebase<bool> ckb;
+
+// the "model": words with an even number of 1s.
+bool model_accepts(const list<int> & w)
+{{{
+	bool even = true;
+	for(list<int>::const_iterator i = w.begin(); i != w.end(); ++i)
+		if(*i == 1)
+			even = !even;
+	return even;
+}}}
+
+struct worker_data {
+	ckb * base;
+	const vector<list<int> > * words;
+	unsigned int seed;
+	int ops;
+	vector<ckb::node*> evaluated;
+	int errors;
+};
+
+void answer_some(worker_data * d, int count)
+{{{
+	vector<ckb::node*> claimed;
+
+	d->base->claim_queries(claimed, count);
+	for(vector<ckb::node*>::iterator ni = claimed.begin(); ni != claimed.end(); ++ni) {
+		// give some queries back to see them claimed by another worker
+		if(rand_r(&d->seed) % 16 == 0) {
+			d->base->release_query(*ni);
+			continue;
+		}
+		d->evaluated.push_back(*ni);
+		if(!(*ni)->set_answer(model_accepts((*ni)->get_word())))
+			d->errors++;
+	}
+}}}
+
+void * produce(void * arg)
+{{{
+	worker_data * d = (worker_data*) arg;
+	int n = d->words->size();
+
+	for(int i = 0; i < d->ops; ++i) {
+		const list<int> & w = (*d->words)[rand_r(&d->seed) % n];
+		bool a;
+
+		switch(rand_r(&d->seed) % 4) {
+			case 0:
+				if(!d->base->add_knowledge(w, model_accepts(w)))
+					d->errors++;
+				break;
+			case 1:
+				d->base->add_query(w, 2);
+				break;
+			case 2:
+				if(d->base->resolve_query(w, a) && a != model_accepts(w))
+					d->errors++;
+				break;
+			default:
+				if(d->base->resolve_or_add_query(w, a) && a != model_accepts(w))
+					d->errors++;
+				break;
+		}
+
+		if(i % 8 == 0)
+			answer_some(d, 4);
+	}
+
+	return NULL;
+}}}
+
+void * drain(void * arg)
+{{{
+	worker_data * d = (worker_data*) arg;
+
+	while(d->base->count_queries() > 0)
+		answer_some(d, 16);
+
+	return NULL;
+}}}
+
+int main(int argc, char**argv)
+{
+	int threads = 8;
+	int wordcount = 20000;
+	int ops = 100000;
+	int errors = 0;
+
+	if(argc > 1)
+		threads = atoi(argv[1]);
+	if(threads < 1)
+		threads = 1;
+
+	// build a pool of words. short words occur often, so the threads
+	// constantly race on the same nodes.
+	vector<list<int> > words;
+	unsigned int seed = 1;
+	for(int i = 0; i < wordcount; ++i) {
+		list<int> w;
+		int len = rand_r(&seed) % 12;
+		for(int j = 0; j < len; ++j)
+			w.push_back(rand_r(&seed) % 3);
+		words.push_back(w);
+	}
+
+	ckb base(3);
+	vector<worker_data> data(threads);
+	vector<pthread_t> tids(threads);
+
+	for(int t = 0; t < threads; ++t) {
+		data[t].base = &base;
+		data[t].words = &words;
+		data[t].seed = t + 1;
+		data[t].ops = ops;
+		data[t].errors = 0;
+	}
+
+	for(int t = 0; t < threads; ++t)
+		pthread_create(&tids[t], NULL, produce, &data[t]);
+	for(int t = 0; t < threads; ++t)
+		pthread_join(tids[t], NULL);
+	for(int t = 0; t < threads; ++t)
+		pthread_create(&tids[t], NULL, drain, &data[t]);
+	for(int t = 0; t < threads; ++t)
+		pthread_join(tids[t], NULL);
+
+	// every query must have been evaluated at most once
+	vector<ckb::node*> all;
+	for(int t = 0; t < threads; ++t) {
+		errors += data[t].errors;
+		all.insert(all.end(), data[t].evaluated.begin(), data[t].evaluated.end());
+	}
+	sort(all.begin(), all.end());
+	if(adjacent_find(all.begin(), all.end()) != all.end()) {
+		printf("a query was evaluated by two workers!\n");
+		errors++;
+	}
+
+	if(base.count_queries() != 0) {
+		printf("%d queries left after draining!\n", base.count_queries());
+		errors++;
+	}
+
+	// all words must be known now, except those only resolved
+	int known = 0;
+	for(vector<list<int> >::iterator wi = words.begin(); wi != words.end(); ++wi) {
+		bool a;
+		if(base.resolve_query(*wi, a)) {
+			known++;
+			if(a != model_accepts(*wi)) {
+				printf("wrong answer stored!\n");
+				errors++;
+			}
+		}
+	}
+
+	// compare with a sequential knowledgebase built from the serialized data
+	basic_string<int32_t> ser = base.serialize();
+	serial_stretch ss(ser);
+	knowledgebase<bool> seq;
+	if(!seq.deserialize(ss) || !ss.empty()) {
+		printf("failed to deserialize!\n");
+		errors++;
+	}
+	if(seq.count_nodes() != base.count_nodes() || seq.count_answers() != base.count_answers() || seq.count_queries() != 0) {
+		printf("counter mismatch: nodes %d/%d answers %d/%d queries %d\n",
+				seq.count_nodes(), base.count_nodes(),
+				seq.count_answers(), base.count_answers(), seq.count_queries());
+		errors++;
+	}
+	for(knowledgebase<bool>::iterator ki = seq.begin(); ki != seq.end(); ++ki) {
+		if(ki->is_answered() && ki->get_answer() != model_accepts(ki->get_word())) {
+			printf("wrong answer after deserialization!\n");
+			errors++;
+			break;
+		}
+	}
+
+	printf("%d threads: %d nodes, %d answers, %d evaluated queries, %d of %d words known, %d errors\n",
+			threads, base.count_nodes(), base.count_answers(), (int)all.size(), known, wordcount, errors);
+
+	return errors ? 1 : 0;
+}
+
@@ -0,0 +1,173 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+/*
+ * concurrent_sync: a learner-like loop on a knowledgebase<bool>. every
+ * round adds new queries to it, hands them to worker threads via
+ * concurrent_knowledgebase::import_queries() and copies the answers back
+ * via sync_answers(), also while the workers are still answering.
+ * checks that all queries of the knowledgebase get the right answer and
+ * compares the time of sync_answers() with a full serialize() /
+ * deserialize() every round.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <sys/time.h>
+
+#include <pthread.h>
+
+#include <libalf/knowledgebase.h>
+#include <libalf/knowledgebase_concurrent.h>
+
+using namespace std;
+using namespace libalf;
+
+typedef concurrent_knowledgebase<bool> ckb;
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+// the "model": words with an even number of 1s.
+bool model_accepts(const list<int> & w)
+{{{
+	bool even = true;
+	for(list<int>::const_iterator i = w.begin(); i != w.end(); ++i)
+		if(*i == 1)
+			even = !even;
+	return even;
+}}}
+
+void * drain(void * arg)
+{{{
+	ckb * base = (ckb*) arg;
+	vector<ckb::node*> claimed;
+
+	while(base->count_queries() > 0) {
+		if(base->claim_queries(claimed, 16) == 0) {
+			sched_yield();
+			continue;
+		}
+		for(vector<ckb::node*>::iterator ni = claimed.begin(); ni != claimed.end(); ++ni)
+			(*ni)->set_answer(model_accepts((*ni)->get_word()));
+	}
+
+	return NULL;
+}}}
+
+int main(int argc, char**argv)
+{
+	int threads = 4;
+	int rounds = 50;
+	int queries_per_round = 2000;
+	int errors = 0;
+	long double t_sync = 0, t_full = 0;
+
+	if(argc > 1)
+		threads = atoi(argv[1]);
+	if(threads < 1)
+		threads = 1;
+
+	knowledgebase<bool> kb;
+	ckb base(3);
+	vector<pthread_t> tids(threads);
+	unsigned int seed = 1;
+
+	for(int r = 0; r < rounds; ++r) {
+		// the learner asks new queries
+		for(int i = 0; i < queries_per_round; ++i) {
+			list<int> w;
+			int len = rand_r(&seed) % 16;
+			for(int j = 0; j < len; ++j)
+				w.push_back(rand_r(&seed) % 3);
+			bool a;
+			if(!kb.resolve_query(w, a))
+				kb.add_query(w);
+		}
+
+		base.import_queries(kb);
+		for(int t = 0; t < threads; ++t)
+			pthread_create(&tids[t], NULL, drain, &base);
+
+		// pick up answers while the workers are busy
+		long double t = exact_time();
+		while(base.count_queries() > 0) {
+			if(base.sync_answers(kb) < 0)
+				errors++;
+			sched_yield();
+		}
+		t_sync += exact_time() - t;
+
+		for(int t = 0; t < threads; ++t)
+			pthread_join(tids[t], NULL);
+
+		t = exact_time();
+		if(base.sync_answers(kb) < 0)
+			errors++;
+		t_sync += exact_time() - t;
+
+		if(kb.count_queries() != 0) {
+			printf("round %d: %d queries left in the knowledgebase!\n", r, kb.count_queries());
+			errors++;
+		}
+
+		// what a full copy would cost instead
+		t = exact_time();
+		basic_string<int32_t> ser = base.serialize();
+		serial_stretch ss(ser);
+		knowledgebase<bool> copy;
+		if(!copy.deserialize(ss))
+			errors++;
+		t_full += exact_time() - t;
+	}
+
+	for(knowledgebase<bool>::iterator ki = kb.begin(); ki != kb.end(); ++ki) {
+		if(ki->is_answered() && ki->get_answer() != model_accepts(ki->get_word())) {
+			printf("wrong answer in the knowledgebase!\n");
+			errors++;
+			break;
+		}
+	}
+	if(kb.count_answers() != base.count_answers()) {
+		printf("%d answers in the knowledgebase, %d in the concurrent one!\n", kb.count_answers(), base.count_answers());
+		errors++;
+	}
+
+	printf("%d threads, %d rounds, %d answers\n", threads, rounds, kb.count_answers());
+	printf("sync_answers():          %.3Lf ms/round\n", 1000 * t_sync / rounds);
+	printf("serialize/deserialize(): %.3Lf ms/round\n", 1000 * t_full / rounds);
+	printf("%d errors\n", errors);
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * iterator_order: check the iteration orders of knowledgebase::iterator
+ * and time full iterations over sparse trees with large alphabets. a full
+ * walk must not depend on the size of the alphabet.
+ */
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <libalf/knowledgebase.h>
+
+using namespace std;
+using namespace libalf;
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+void fill(knowledgebase<bool> & kb, int words, int alphabet_size, int max_length)
+{{{
+	for(int i = 0; i < words; i++) {
+		list<int> w;
+		int length = rand() % (max_length + 1);
+		for(int j = 0; j < length; j++)
+			w.push_back(rand() % alphabet_size);
+		kb.add_knowledge(w, (rand() % 2) == 0);
+	}
+}}}
+
+void chain(knowledgebase<bool> & kb, int length, int alphabet_size)
+// a path of length nodes below label 0, where each node also has a leaf
+// below label alphabet_size-1. so every block of children has
+// alphabet_size slots, but only two of them are used.
+{{{
+	list<int> w;
+
+	for(int i = 0; i < length; i++) {
+		w.push_back(alphabet_size - 1);
+		kb.add_knowledge(w, true);
+		w.back() = 0;
+	}
+	kb.add_knowledge(w, false);
+}}}
+
+long double walk_time(knowledgebase<bool> & kb)
+// fastest of 20 full walks in prefix order
+{{{
+	knowledgebase<bool>::iterator ki;
+	long double best = 0;
+
+	for(int round = 0; round < 20; round++) {
+		long double t = exact_time();
+		for(ki = kb.begin(); ki != kb.end(); ++ki)
+			;
+		t = exact_time() - t;
+		if(round == 0 || t < best)
+			best = t;
+	}
+
+	return best;
+}}}
+
+int check_orders(knowledgebase<bool> & kb)
+{{{
+	knowledgebase<bool>::iterator ki;
+	list<int> last, w;
+	int count, errors = 0;
+
+	// prefix order is lexicographic order
+	count = 0;
+	for(ki = kb.begin(); ki != kb.end(); ++ki, ++count) {
+		w = ki->get_word();
+		if(count > 0 && !is_lex_smaller(last, w))
+			errors++;
+		last = w;
+	}
+	if(count != kb.count_nodes()) {
+		cout << "prefix order: visited " << count << " of " << kb.count_nodes() << " nodes\n";
+		errors++;
+	}
+
+	count = 0;
+	for(ki = kb.gbegin(); ki != kb.gend(); ++ki, ++count) {
+		w = ki->get_word();
+		if(count > 0 && !is_graded_lex_smaller(last, w))
+			errors++;
+		last = w;
+	}
+	if(count != kb.count_nodes()) {
+		cout << "graded order: visited " << count << " of " << kb.count_nodes() << " nodes\n";
+		errors++;
+	}
+
+	// subtree iteration stays below the subtree root
+	knowledgebase<bool>::node * sub = kb.get_rootptr()->find_child(1);
+	if(sub) {
+		int in_subtree = 0, visited = 0, gvisited = 0;
+		for(ki = kb.begin(); ki != kb.end(); ++ki)
+			if(sub->is_prefix_of(&*ki))
+				in_subtree++;
+		for(ki = knowledgebase<bool>::iterator(knowledgebase<bool>::iterator::ORDER_PREFIX, sub, &kb); ki != kb.end(); ++ki)
+			visited++;
+		for(ki = kb.gbegin(sub); ki != kb.gend(); ++ki)
+			gvisited++;
+		if(visited != in_subtree || gvisited != in_subtree) {
+			cout << "subtree iteration visited " << visited << "/" << gvisited << " of " << in_subtree << " nodes\n";
+			errors++;
+		}
+	}
+
+	// compatibility wrapper
+	kIterator_lex_graded<bool> klg(kb.get_rootptr());
+	for(ki = kb.gbegin(); ki != kb.gend(); ++ki, ++klg)
+		if(klg.end() || &*klg != &*ki)
+			errors++;
+	if(!klg.end())
+		errors++;
+
+	return errors;
+}}}
+
+int main()
+{{{
+	int errors = 0;
+
+	srand(42);
+
+	{
+		knowledgebase<bool> kb;
+		fill(kb, 2000, 3, 10);
+		errors += check_orders(kb);
+	}
+
+	{
+		knowledgebase<bool> kb;
+		fill(kb, 20000, 1000, 8);
+		errors += check_orders(kb);
+
+		long double t;
+		int count = 0;
+		knowledgebase<bool>::iterator ki;
+
+		t = exact_time();
+		for(int round = 0; round < 10; round++)
+			for(ki = kb.begin(); ki != kb.end(); ++ki)
+				count++;
+		t = exact_time() - t;
+		printf("prefix order: %d nodes, alphabet size 1000: %.0Lf nodes/s\n", kb.count_nodes(), count / t);
+
+		count = 0;
+		t = exact_time();
+		for(int round = 0; round < 10; round++)
+			for(ki = kb.gbegin(); ki != kb.gend(); ++ki)
+				count++;
+		t = exact_time() - t;
+		printf("graded order: %d nodes, alphabet size 1000: %.0Lf nodes/s\n", kb.count_nodes(), count / t);
+	}
+
+	{
+		// a full walk is linear in the number of nodes: both trees
+		// have the same shape, but the blocks of children in the
+		// second one have 32768 slots instead of 2.
+		knowledgebase<bool> small, large;
+		chain(small, 256, 2);
+		chain(large, 256, 32768);
+		errors += check_orders(large);
+
+		long double ts = walk_time(small);
+		long double tl = walk_time(large);
+		printf("sparse tree of %d nodes: %.1Lf us with 2 symbols, %.1Lf us with 32768 symbols\n",
+				large.count_nodes(), ts * 1000000, tl * 1000000);
+		if(tl > 10 * ts + 0.0005) {
+			cout << "the walk depends on the size of the alphabet!\n";
+			errors++;
+		}
+	}
+
+	if(errors) {
+		cout << errors << " errors.\n";
+		return 1;
+	}
+
+	cout << "iteration orders ok.\n";
+	return 0;
+}}}
+
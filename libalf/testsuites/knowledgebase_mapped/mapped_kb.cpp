@@ -0,0 +1,260 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * mapped_kb: checkpoint a knowledgebase into a mapped_knowledgebase file,
+ * "restart" by mapping it again and compare both with the serialize()d
+ * checkpoint that has to be written, read and deserialized.
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <libalf/knowledgebase.h>
+#include <libalf/knowledgebase_mapped.h>
+
+using namespace std;
+using namespace libalf;
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+// the "model": words with an even number of 1s.
+bool model_accepts(const list<int> & w)
+{{{
+	bool even = true;
+	for(list<int>::const_iterator i = w.begin(); i != w.end(); ++i)
+		if(*i == 1)
+			even = !even;
+	return even;
+}}}
+
+list<int> random_word()
+{{{
+	list<int> w;
+	int length = rand() % 20;
+	for(int j = 0; j < length; j++)
+		w.push_back(rand() % 3);
+	return w;
+}}}
+
+int compare(knowledgebase<bool> & kb, mapped_knowledgebase<bool> & mkb)
+{{{
+	int errors = 0;
+	knowledgebase<bool>::iterator ki;
+
+	if(kb.count_answers() != mkb.count_answers() || kb.count_queries() != mkb.count_queries())
+		errors++;
+
+	for(ki = kb.begin(); ki != kb.end(); ++ki) {
+		list<int> w = ki->get_word();
+		mapped_knowledgebase<bool>::node_index n;
+		bool a;
+
+		if(ki->is_answered()) {
+			if(!mkb.resolve_query(w, a) || a != ki->get_answer())
+				errors++;
+		} else {
+			if(mkb.resolve_query(w, a))
+				errors++;
+			if(ki->is_required() && (!mkb.find_descendant(w.begin(), w.end(), n) || mkb.get_status(n) != mapped_knowledgebase<bool>::NODE_REQUIRED))
+				errors++;
+		}
+	}
+
+	return errors;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int count = 500000;
+	int errors = 0;
+	long double t;
+	const char * serfile = "mapped_kb.ser.tmp";
+	const char * mapfile = "mapped_kb.map.tmp";
+
+	if(argc > 1)
+		count = atoi(argv[1]);
+
+	srand(815);
+	knowledgebase<bool> kb;
+	for(int i = 0; i < count; ++i) {
+		list<int> w = random_word();
+		if(i % 10 == 0)
+			kb.add_query(w);
+		else
+			kb.add_knowledge(w, model_accepts(w));
+	}
+	printf("knowledgebase: %d nodes, %d answers, %d queries\n", kb.count_nodes(), kb.count_answers(), kb.count_queries());
+
+	// checkpoint via serialize()
+	t = exact_time();
+	{
+		basic_string<int32_t> ser = kb.serialize();
+		FILE * f = fopen(serfile, "w");
+		if(!f || fwrite(ser.data(), sizeof(int32_t), ser.size(), f) != ser.size())
+			errors++;
+		if(f)
+			fclose(f);
+	}
+	printf("serialize() checkpoint:    %8.3Lf s\n", exact_time() - t);
+
+	// checkpoint via mapped_knowledgebase
+	t = exact_time();
+	{
+		mapped_knowledgebase<bool> mkb;
+		if(!mkb.save(kb, mapfile) || !mkb.sync())
+			errors++;
+	}
+	printf("mapped checkpoint:         %8.3Lf s\n", exact_time() - t);
+
+	// restart via deserialize()
+	t = exact_time();
+	{
+		basic_string<int32_t> ser;
+		int32_t buf[4096];
+		size_t got;
+		FILE * f = fopen(serfile, "r");
+		while(f && (got = fread(buf, sizeof(int32_t), 4096, f)) > 0)
+			ser.append(buf, got);
+		if(f)
+			fclose(f);
+		serial_stretch ss(ser);
+		knowledgebase<bool> kb2;
+		if(!kb2.deserialize(ss) || kb2.count_nodes() != kb.count_nodes())
+			errors++;
+	}
+	printf("deserialize() restart:     %8.3Lf s\n", exact_time() - t);
+
+	// restart via mapping
+	mapped_knowledgebase<bool> mkb;
+	t = exact_time();
+	if(!mkb.open(mapfile))
+		errors++;
+	printf("mapped restart:            %8.6Lf s\n", exact_time() - t);
+	printf("mapped: %llu bytes mapped (%llu resident), %llu bytes private\n",
+			mkb.get_mapped_memory_usage(), mkb.get_resident_mapped_memory_usage(), mkb.get_private_memory_usage());
+
+	// lookups directly on the mapping
+	t = exact_time();
+	errors += compare(kb, mkb);
+	printf("compare all nodes:         %8.3Lf s\n", exact_time() - t);
+
+	// append new knowledge as it arrives
+	unsigned int since = kb.mark_sync();
+	vector<list<int> > added;
+	for(int i = 0; i < count / 10; ++i) {
+		list<int> w = random_word();
+		w.push_back(2);
+		w.push_back(2);
+		kb.add_knowledge(w, model_accepts(w));
+		added.push_back(w);
+	}
+	// answer some old queries
+	knowledgebase<bool>::iterator qi;
+	for(int i = 0; i < 100 && (qi = kb.qbegin()) != kb.qend(); ++i) {
+		list<int> w = qi->get_word();
+		qi->set_answer(model_accepts(w));
+	}
+	unsigned int kb_since = since;
+	t = exact_time();
+	since = mkb.append_changes(kb, since);
+	mkb.close();
+	printf("append %d answers:      %8.3Lf s\n", count / 10 + 100, exact_time() - t);
+
+	// and read them after reopening read-only
+	if(!mkb.open(mapfile, false))
+		errors++;
+	errors += compare(kb, mkb);
+	if(mkb.add_knowledge(added.front(), true))
+		errors++; // read-only
+
+	// rebuild a knowledgebase from the file
+	knowledgebase<bool> kb3;
+	if(!mkb.load(kb3))
+		errors++;
+	if(kb3.count_nodes() != mkb.count_nodes())
+		errors++;
+	errors += compare(kb3, mkb);
+	// with the timestamps of the file, which are those of kb, also for
+	// the appended answers
+	for(knowledgebase<bool>::iterator ki = kb3.begin(); ki != kb3.end(); ++ki) {
+		list<int> w = ki->get_word();
+		mapped_knowledgebase<bool>::node_index n;
+		knowledgebase<bool>::node * kn;
+		if(!ki->is_answered() && !ki->is_required())
+			continue;
+		if(!mkb.find_descendant(w.begin(), w.end(), n) || mkb.get_timestamp(n) != ki->get_timestamp())
+			errors++;
+		kn = kb.get_rootptr()->find_descendant(w.begin(), w.end());
+		if(kn == NULL || kn->get_timestamp() != ki->get_timestamp())
+			errors++;
+	}
+	// so a cursor of kb from before the restart still works
+	{
+		list<pair<list<int>, bool> > a = kb.get_answers_since(kb_since), a3 = kb3.get_answers_since(kb_since);
+		list<list<int> > q = kb.get_queries_since(kb_since), q3 = kb3.get_queries_since(kb_since);
+		a.sort(); a3.sort();
+		q.sort(); q3.sort();
+		if(a != a3 || q != q3)
+			errors++;
+	}
+	mkb.close();
+
+	// corrupt files are rejected
+	{
+		FILE * f = fopen(mapfile, "r+");
+		if(f) {
+			fputs("garbage", f);
+			fclose(f);
+		}
+		if(mkb.open(mapfile, false))
+			errors++;
+	}
+
+	unlink(serfile);
+	unlink(mapfile);
+
+	if(errors) {
+		cout << errors << " errors.\n";
+		return 1;
+	}
+
+	cout << "mapped knowledgebase ok.\n";
+	return 0;
+}}}
+
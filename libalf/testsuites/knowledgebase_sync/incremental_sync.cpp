@@ -0,0 +1,212 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * incremental_sync: keep a mirror of a knowledgebase up to date via
+ * knowledgebase::get_changes_since() over many learning rounds and compare
+ * the time per round with copying all queries via get_queries().
+ */
+
+#include <iostream>
+#include <list>
+#include <utility>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <libalf/knowledgebase.h>
+
+using namespace std;
+using namespace libalf;
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+// the "model": words with an even number of 1s.
+bool model_accepts(const list<int> & w)
+{{{
+	bool even = true;
+	for(list<int>::const_iterator i = w.begin(); i != w.end(); ++i)
+		if(*i == 1)
+			even = !even;
+	return even;
+}}}
+
+void add_queries(knowledgebase<bool> & kb, int count)
+{{{
+	for(int i = 0; i < count; i++) {
+		list<int> w;
+		int length = rand() % 24;
+		for(int j = 0; j < length; j++)
+			w.push_back(rand() % 3);
+		kb.add_query(w);
+	}
+}}}
+
+void answer_queries(knowledgebase<bool> & kb, int count)
+// answer the oldest count queries
+{{{
+	knowledgebase<bool>::iterator qi;
+	while(count-- > 0 && (qi = kb.qbegin()) != kb.qend()) {
+		list<int> w = qi->get_word();
+		qi->set_answer(model_accepts(w));
+	}
+}}}
+
+int apply_changes(knowledgebase<bool> & mirror, list<list<int> > & queries, list<pair<list<int>, bool> > & answers)
+{{{
+	int errors = 0;
+
+	for(list<list<int> >::iterator qi = queries.begin(); qi != queries.end(); ++qi)
+		mirror.add_query(*qi);
+	for(list<pair<list<int>, bool> >::iterator ai = answers.begin(); ai != answers.end(); ++ai)
+		if(!mirror.add_knowledge(ai->first, ai->second))
+			errors++;
+
+	return errors;
+}}}
+
+int compare(knowledgebase<bool> & a, knowledgebase<bool> & b)
+{{{
+	int errors = 0;
+
+	if(a.get_queries() != b.get_queries())
+		errors++;
+	if(a.count_answers() != b.count_answers())
+		errors++;
+
+	knowledgebase<bool>::iterator ki;
+	for(ki = a.begin(); ki != a.end(); ++ki) {
+		if(ki->is_answered()) {
+			list<int> w = ki->get_word();
+			bool ans;
+			if(!b.resolve_query(w, ans) || ans != ki->get_answer())
+				errors++;
+		}
+	}
+
+	return errors;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int rounds = 200;
+	int per_round = 1000;
+	int errors = 0;
+	long double tfull = 0, tinc = 0, t;
+
+	if(argc > 1)
+		rounds = atoi(argv[1]);
+
+	srand(815);
+
+	knowledgebase<bool> kb, mirror;
+	unsigned int since = 0;
+	list<list<int> > queries;
+	list<pair<list<int>, bool> > answers;
+
+	for(int r = 0; r < rounds; ++r) {
+		// the learner adds queries, the teacher answers most of them
+		add_queries(kb, per_round);
+		answer_queries(kb, kb.count_queries() * 9 / 10);
+		if(r % 4 == 0)
+			add_queries(kb, per_round / 10);
+
+		// full copy of all queries and answers
+		t = exact_time();
+		list<list<int> > all_queries = kb.get_queries();
+		list<pair<list<int>, bool> > all_answers;
+		knowledgebase<bool>::iterator ki;
+		for(ki = kb.begin(); ki != kb.end(); ++ki)
+			if(ki->is_answered())
+				all_answers.push_back(pair<list<int>, bool>(ki->get_word(), ki->get_answer()));
+		tfull += exact_time() - t;
+
+		t = exact_time();
+		since = kb.get_changes_since(since, queries, answers);
+		tinc += exact_time() - t;
+
+		errors += apply_changes(mirror, queries, answers);
+	}
+
+	errors += compare(kb, mirror);
+	errors += compare(mirror, kb);
+
+	printf("%d rounds, %d nodes, %d answers, %d queries\n", rounds, kb.count_nodes(), kb.count_answers(), kb.count_queries());
+	printf("full copy:           %.3Lf ms/round\n", tfull * 1000 / rounds);
+	printf("get_changes_since(): %.3Lf ms/round\n", tinc * 1000 / rounds);
+
+	// nothing changed: nothing reported
+	since = kb.get_changes_since(since, queries, answers);
+	if(!queries.empty() || !answers.empty())
+		errors++;
+	since = kb.get_changes_since(since, queries, answers);
+	if(!queries.empty() || !answers.empty())
+		errors++;
+
+	// changes after deserialization are still incremental
+	basic_string<int32_t> ser = kb.serialize();
+	serial_stretch ss(ser);
+	knowledgebase<bool> kb2;
+	if(!kb2.deserialize(ss))
+		errors++;
+	since = kb2.mark_sync();
+	if(!kb2.get_queries_since(since).empty() || !kb2.get_answers_since(since).empty())
+		errors++;
+	// the query-list is ordered by timestamp again. queries with the
+	// same timestamp stay in tree-order.
+	queries = kb2.get_queries_since(0);
+	if(queries.size() != (size_t)kb.count_queries())
+		errors++;
+	knowledgebase<bool>::iterator qi;
+	unsigned int last_ts = 0;
+	for(qi = kb2.qbegin(); qi != kb2.qend(); ++qi) {
+		if(qi->get_timestamp() < last_ts)
+			errors++;
+		last_ts = qi->get_timestamp();
+	}
+	// knowledge added after deserialization is reported
+	// (longer than all words added before)
+	list<int> w(25, 2);
+	kb2.add_query(w);
+	kb2.add_knowledge(w, model_accepts(w));
+	if(kb2.get_queries_since(since).size() != 0 || kb2.get_answers_since(since).size() != 1)
+		errors++;
+
+	if(errors) {
+		cout << errors << " errors.\n";
+		return 1;
+	}
+
+	cout << "incremental sync ok.\n";
+	return 0;
+}}}
+
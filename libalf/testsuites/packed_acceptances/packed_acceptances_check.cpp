@@ -0,0 +1,158 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// checks packed_acceptances<bool> and packed_acceptances<extended_bool>
+// against std::vector<answer> on random rows.
+
+#include <iostream>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/packed_acceptances.h>
+
+using namespace std;
+using namespace libalf;
+
+int errors = 0;
+
+void check(bool ok, const char * what, int round)
+{{{
+	if(!ok) {
+		printf("round %d: %s failed\n", round, what);
+		errors++;
+	}
+}}}
+
+bool random_answer(bool)
+{ return rand() % 2; }
+extended_bool random_answer(extended_bool)
+{ return extended_bool((enum extended_bool::e_extended_bool)(rand() % 3)); }
+
+template <class answer>
+void random_row(unsigned int length, vector<answer> & v, packed_acceptances<answer> & p)
+{{{
+	v.clear();
+	p.clear();
+	for(unsigned int i = 0; i < length; i++) {
+		answer a = random_answer(answer());
+		v.push_back(a);
+		p.push_back(a);
+	}
+}}}
+
+template <class answer>
+bool same(const vector<answer> & v, const packed_acceptances<answer> & p)
+{{{
+	typename packed_acceptances<answer>::const_iterator pi;
+	unsigned int i;
+
+	if(v.size() != p.size())
+		return false;
+	for(i = 0, pi = p.begin(); pi != p.end(); ++i, ++pi)
+		if(!(v[i] == *pi) || !(v[i] == p[i]))
+			return false;
+	return i == v.size();
+}}}
+
+template <class answer>
+void test(const char * name)
+{{{
+	vector<answer> v1, v2;
+	packed_acceptances<answer> p1, p2;
+
+	printf("%s: ", name);
+
+	for(int round = 0; round < 2000; round++) {
+		// lengths around the block borders
+		unsigned int length = rand() % 200;
+		random_row(length, v1, p1);
+		check(same(v1, p1), "push_back", round);
+
+		// a second row: either a copy with few changes, or random
+		if(rand() % 2) {
+			v2 = v1;
+			p2 = p1;
+			for(int c = rand() % 3; c > 0 && length > 0; c--) {
+				unsigned int i = rand() % length;
+				answer a = random_answer(answer());
+				v2[i] = a;
+				p2[i] = a;
+			}
+			check(same(v2, p2), "set", round);
+		} else {
+			random_row(rand() % 3 ? length : rand() % 200, v2, p2);
+		}
+
+		check((v1 == v2) == (p1 == p2), "==", round);
+		check(acceptances_cover(v1, v2) == acceptances_cover(p1, p2), "cover", round);
+		check(acceptances_cover(v2, v1) == acceptances_cover(p2, p1), "cover", round);
+		check(acceptances_mutual_noncover(v1, v2) == acceptances_mutual_noncover(p1, p2), "mutual_noncover", round);
+		check(acceptances_first_noncover(v1, v2) == acceptances_first_noncover(p1, p2), "first_noncover", round);
+
+		acceptances_join(v1, v2);
+		acceptances_join(p1, p2);
+		check(same(v1, p1), "join", round);
+
+		// serialized like std::vector
+		check(::serialize(v2) == ::serialize(p2), "serialize", round);
+		std::basic_string<int32_t> s = ::serialize(v2);
+		serial_stretch ser(s);
+		packed_acceptances<answer> p3;
+		check(::deserialize(p3, ser) && p3 == p2 && ser.empty(), "deserialize", round);
+
+		// shrinking keeps unused bits clear
+		unsigned int cut = v1.size() ? rand() % v1.size() : 0;
+		while(v1.size() > cut) {
+			v1.pop_back();
+			p1.pop_back();
+		}
+		p3 = packed_acceptances<answer>();
+		for(unsigned int i = 0; i < v1.size(); i++)
+			p3.push_back(v1[i]);
+		check(same(v1, p1) && p1 == p3, "pop_back", round);
+		p1.resize(cut / 2);
+		p3.resize(cut / 2);
+		check(p1 == p3, "resize", round);
+
+		answer a = random_answer(answer());
+		v1.assign(length, a);
+		p1.assign(length, a);
+		check(same(v1, p1), "assign", round);
+	}
+
+	printf("%s\n", errors ? "FAILED" : "ok");
+}}}
+
+int main()
+{{{
+	srand(1);
+
+	test<bool>("packed_acceptances<bool>");
+	test<extended_bool>("packed_acceptances<extended_bool>");
+
+	return errors ? 1 : 0;
+}}}
+
@@ -0,0 +1,238 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * packed_word_bench: compare std::list<int> and packed_word on the hot
+ * paths of Angluin's L* (row prefix + column suffix, then lookup in the
+ * knowledgebase) and Kearns & Vazirani (sifting an access string through
+ * distinguishing suffixes; sorting and comparing words). counts heap
+ * allocations by replacing the global operator new.
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <libalf/alphabet.h>
+#include <libalf/packed_word.h>
+#include <libalf/knowledgebase.h>
+
+using namespace std;
+using namespace libalf;
+
+static unsigned long long allocations = 0;
+
+void * operator new(size_t size)
+{{{
+	void * p;
+
+	allocations++;
+	p = malloc(size ? size : 1);
+	if(p == NULL)
+		throw std::bad_alloc();
+	return p;
+}}}
+
+void operator delete(void * p) throw()
+{{{
+	free(p);
+}}}
+
+void operator delete(void * p, size_t) throw()
+{{{
+	free(p);
+}}}
+
+long double exact_time()
+{{{
+	struct timeval tmp;
+
+	gettimeofday(&tmp, NULL);
+	long double result = tmp.tv_sec + ((long double) tmp.tv_usec) / 1000000.0;
+
+	return result;
+}}}
+
+list<int> random_word(int alphabet_size, int min_length, int max_length)
+{{{
+	list<int> w;
+	int length = min_length + rand() % (max_length - min_length + 1);
+	for(int i = 0; i < length; i++)
+		w.push_back(rand() % alphabet_size);
+	return w;
+}}}
+
+void report(const char * what, long double t, unsigned long long allocs, int ops)
+{{{
+	printf("  %-10s %8.3Lf s  %10.0Lf ops/s  %6.2f allocations/op\n", what, t, ops / t, (double)allocs / ops);
+}}}
+
+int main(int argc, char**argv)
+{
+	int asize = 2;
+	int rows = 2000, columns = 40, repeat = 5;
+	long double t;
+	unsigned long long a;
+	int known;
+
+	if(argc > 1)
+		asize = atoi(argv[1]);
+
+	srand(815);
+	vector<list<int> > lprefixes, lsuffixes;
+	vector<packed_word> pprefixes, psuffixes;
+	for(int i = 0; i < rows; ++i) {
+		lprefixes.push_back(random_word(asize, 4, 14));
+		pprefixes.push_back(packed_word(lprefixes.back(), asize));
+	}
+	for(int i = 0; i < columns; ++i) {
+		lsuffixes.push_back(random_word(asize, 0, 6));
+		psuffixes.push_back(packed_word(lsuffixes.back(), asize));
+	}
+
+	knowledgebase<bool> kb;
+	for(int r = 0; r < rows; ++r)
+		for(int c = 0; c < columns; ++c)
+			if(rand() % 4) {
+				list<int> w = lprefixes[r] + lsuffixes[c];
+				kb.add_knowledge(w, rand() % 2);
+			}
+
+	int ops = rows * columns * repeat;
+	printf("alphabet size %d, packed with %d bits per letter\n", asize, pprefixes[0].get_bits());
+
+	// Angluin: fill table cells
+	printf("angluin: row prefix + column suffix, resolve_query (%d cells)\n", ops);
+	known = 0;
+	a = allocations; t = exact_time();
+	for(int i = 0; i < repeat; ++i)
+		for(int r = 0; r < rows; ++r)
+			for(int c = 0; c < columns; ++c) {
+				list<int> w = lprefixes[r] + lsuffixes[c];
+				bool ans;
+				if(kb.resolve_query(w, ans))
+					known++;
+			}
+	report("list", exact_time() - t, allocations - a, ops);
+
+	int known2 = 0;
+	a = allocations; t = exact_time();
+	packed_word w;
+	for(int i = 0; i < repeat; ++i)
+		for(int r = 0; r < rows; ++r)
+			for(int c = 0; c < columns; ++c) {
+				w = pprefixes[r];
+				w.append(psuffixes[c]);
+				bool ans;
+				if(kb.resolve_query(w, ans))
+					known2++;
+			}
+	report("packed", exact_time() - t, allocations - a, ops);
+	if(known != known2) {
+		printf("results differ!\n");
+		return 1;
+	}
+
+	// Kearns & Vazirani: sift access strings through a path of
+	// distinguishing suffixes
+	printf("kearns-vazirani: sift access string through %d suffixes (%d sifts)\n", columns, rows * repeat);
+	known = 0;
+	a = allocations; t = exact_time();
+	for(int i = 0; i < repeat; ++i)
+		for(int r = 0; r < rows; ++r) {
+			int c = 0;
+			while(c < columns) {
+				list<int> q = lprefixes[r];
+				q.insert(q.end(), lsuffixes[c].begin(), lsuffixes[c].end());
+				bool ans = false;
+				kb.resolve_query(q, ans);
+				c = 2 * c + (ans ? 2 : 1);
+				known++;
+			}
+		}
+	report("list", exact_time() - t, allocations - a, known);
+
+	known2 = 0;
+	a = allocations; t = exact_time();
+	for(int i = 0; i < repeat; ++i)
+		for(int r = 0; r < rows; ++r) {
+			int c = 0;
+			while(c < columns) {
+				w = pprefixes[r];
+				w.append(psuffixes[c]);
+				bool ans = false;
+				kb.resolve_query(w, ans);
+				c = 2 * c + (ans ? 2 : 1);
+				known2++;
+			}
+		}
+	report("packed", exact_time() - t, allocations - a, known2);
+
+	// comparisons: sort all prefixes in graded-lex order and look for
+	// duplicates
+	printf("sort %d words graded-lex, compare neighbours\n", rows);
+	int dups = 0;
+	a = allocations; t = exact_time();
+	for(int i = 0; i < repeat * 10; ++i) {
+		vector<list<int> > v(lprefixes);
+		sort(v.begin(), v.end(), (bool (*)(const list<int>&, const list<int>&))is_graded_lex_smaller);
+		for(unsigned int j = 1; j < v.size(); ++j)
+			if(v[j-1] == v[j])
+				dups++;
+	}
+	report("list", exact_time() - t, allocations - a, repeat * 10);
+
+	int dups2 = 0;
+	a = allocations; t = exact_time();
+	for(int i = 0; i < repeat * 10; ++i) {
+		vector<packed_word> v(pprefixes);
+		sort(v.begin(), v.end(), (bool (*)(const packed_word&, const packed_word&))is_graded_lex_smaller);
+		for(unsigned int j = 1; j < v.size(); ++j)
+			if(v[j-1] == v[j])
+				dups2++;
+	}
+	report("packed", exact_time() - t, allocations - a, repeat * 10);
+	if(dups != dups2) {
+		printf("results differ!\n");
+		return 1;
+	}
+
+	unsigned long long lbytes = 0, pbytes = 0, letters = 0;
+	for(int r = 0; r < rows; ++r) {
+		letters += lprefixes[r].size();
+		// a list node holds two pointers and the letter
+		lbytes += sizeof(list<int>) + lprefixes[r].size() * (2 * sizeof(void*) + sizeof(void*));
+		pbytes += pprefixes[r].get_memory_usage();
+	}
+	printf("memory per word (avg. %.1f letters): list %.1f bytes, packed %.1f bytes\n",
+			(double)letters / rows, (double)lbytes / rows, (double)pbytes / rows);
+
+	return 0;
+}
+
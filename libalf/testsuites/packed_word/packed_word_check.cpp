@@ -0,0 +1,179 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+/*
+ * packed_word_check: compare packed_word with std::list<int> for random
+ * words and all packings.
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alphabet.h>
+#include <libalf/packed_word.h>
+#include <libalf/knowledgebase.h>
+#include <libalf/algorithm_angluin.h>
+
+using namespace std;
+using namespace libalf;
+
+int errors = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("line %d: check failed: %s\n", __LINE__, #cond); errors++; } } while(0)
+
+list<int> random_word(int alphabet_size, int max_length)
+{{{
+	list<int> w;
+	int length = rand() % (max_length + 1);
+	for(int i = 0; i < length; i++)
+		w.push_back(rand() % alphabet_size);
+	return w;
+}}}
+
+void check_pair(const list<int> & la, const list<int> & lb, int asize)
+{{{
+	packed_word a(la, asize), b(lb, asize);
+	packed_word a32(la), b32(lb);
+
+	CHECK(a.to_list() == la);
+	CHECK(a == a32);
+	CHECK(a.hash() == a32.hash());
+	CHECK((a == b) == (la == lb));
+	CHECK((a == b32) == (la == lb));
+	CHECK((a < b) == (la < lb));
+	CHECK((a < b32) == (la < lb));
+	CHECK(is_lex_smaller(a, b) == is_lex_smaller(la, lb));
+	CHECK(is_graded_lex_smaller(a, b) == is_graded_lex_smaller(la, lb));
+	CHECK(is_graded_lex_smaller(a32, b) == is_graded_lex_smaller(la, lb));
+	CHECK(is_prefix_of(a, b) == is_prefix_of(la, lb));
+	CHECK(is_suffix_of(a, b) == is_suffix_of(la, lb));
+	CHECK((a + b).to_list() == la + lb);
+	CHECK((a32 + b).to_list() == la + lb);
+	packed_word * c = concat(a, b);
+	CHECK(*c == a + b);
+	delete c;
+	CHECK(word2string(a) == word2string(la));
+	CHECK(serialize_word(a) == serialize_word(la));
+
+	for(unsigned int i = 0; i <= la.size(); ++i) {
+		list<int> p, s;
+		list<int>::const_iterator li = la.begin();
+		for(unsigned int j = 0; j < la.size(); ++j, ++li)
+			(j < i ? p : s).push_back(*li);
+		CHECK(a.prefix(i).to_list() == p);
+		CHECK(a.prefix(i) == packed_word(p));
+		CHECK(a.suffix(i).to_list() == s);
+	}
+
+	packed_word d(a);
+	d.pop_back();
+	list<int> ld(la);
+	if(!ld.empty())
+		ld.pop_back();
+	CHECK(d.to_list() == ld);
+	CHECK(d == packed_word(ld));
+}}}
+
+int main()
+{
+	srand(4711);
+
+	int sizes[] = { 1, 2, 3, 4, 5, 16, 17, 300, 70000 };
+	for(unsigned int s = 0; s < sizeof(sizes) / sizeof(int); ++s)
+		for(int i = 0; i < 300; ++i)
+			check_pair(random_word(sizes[s], 80), random_word(sizes[s], 80), sizes[s]);
+
+	// equal prefixes: the interesting case for cell-wise comparison
+	for(int i = 0; i < 300; ++i) {
+		list<int> a = random_word(2, 70);
+		list<int> b = a;
+		b.push_back(rand() % 2);
+		check_pair(a, b, 2);
+		check_pair(b, a, 2);
+	}
+
+	// packing grows when needed
+	packed_word w(2);
+	CHECK(w.get_bits() == 1);
+	for(int i = 0; i < 40; ++i)
+		w.push_back(i % 2);
+	w.push_back(5);
+	CHECK(w.get_bits() == 4);
+	w.push_back(BOTTOM_CHAR);
+	CHECK(w.get_bits() == 32);
+	CHECK(w.back() == BOTTOM_CHAR);
+	CHECK(w[40] == 5 && w[39] == 1 && w.size() == 42);
+	w.set(0, 1000);
+	CHECK(w[0] == 1000);
+	w.resize(3);
+	CHECK(w.size() == 3);
+	w.set_bits(1);
+	CHECK(w.get_bits() == 16); // smallest packing that holds 1000
+	w.set(0, 1);
+	w.set_bits(1);
+	CHECK(w.get_bits() == 1);
+	CHECK(w.to_list() == word(3, 1, 1, 0));
+
+	// knowledgebase overloads
+	knowledgebase<bool> kb;
+	for(int i = 0; i < 1000; ++i) {
+		list<int> l = random_word(3, 12);
+		packed_word p(l, 3);
+		bool a1, a2;
+		if(i % 3 == 0) {
+			kb.add_knowledge(p, (l.size() % 2) == 0);
+		} else if(i % 3 == 1) {
+			kb.add_query(p, 1);
+		} else {
+			CHECK(kb.resolve_query(p, a1) == kb.resolve_query(l, a2));
+		}
+		CHECK(kb.knowledge_exists(p) == kb.knowledge_exists(l));
+		CHECK(kb.node_exists(p) == kb.node_exists(l));
+		if(kb.resolve_query(l, a1)) {
+			CHECK(kb.resolve_or_add_query(p, a2) && a1 == a2);
+		}
+	}
+
+	// add_counterexample() on a derived class
+	knowledgebase<bool> kb1, kb2;
+	angluin_simple_table<bool> t1(&kb1, NULL, 2), t2(&kb2, NULL, 2);
+	t1.advance();
+	t2.advance();
+	list<int> ce = word(3, 1, 0, 1);
+	CHECK(t1.add_counterexample(packed_word(ce, 2)) == t2.add_counterexample(ce));
+	CHECK(kb1.count_queries() == kb2.count_queries());
+
+	if(errors) {
+		cout << errors << " errors.\n";
+		return 1;
+	}
+
+	cout << "packed_word ok.\n";
+	return 0;
+}
+
@@ -0,0 +1,121 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// observation tables for the parallel_fill testsuite: rows and columns are
+// random words, a knowledgebase knows the answers of some of their
+// concatenations. fill_serially() is what the learning algorithms do
+// without fill threads.
+
+#ifndef __parallel_fill_fill_table_h__
+# define __parallel_fill_fill_table_h__
+
+#include <list>
+#include <vector>
+#include <stdlib.h>
+
+#include <libalf/knowledgebase.h>
+
+class fill_row {
+	public:
+		std::list<int> index;
+		std::vector<bool> acceptance;
+};
+
+typedef std::list<fill_row> fill_table;
+typedef std::vector<std::list<int> > fill_columns;
+
+inline std::list<int> random_word(int alphabet_size, int max_length)
+{{{
+	std::list<int> w;
+	int length = rand() % (max_length + 1);
+	for(int i = 0; i < length; i++)
+		w.push_back(rand() % alphabet_size);
+	return w;
+}}}
+
+// the language the knowledgebase is taken from
+inline bool model_answer(const std::list<int> & w)
+{{{
+	unsigned int h = w.size();
+	for(std::list<int>::const_iterator wi = w.begin(); wi != w.end(); ++wi)
+		h = h * 7 + *wi;
+	return (h % 3) == 0;
+}}}
+
+// answer each cell of the table with probability known_percent/100
+inline void make_table(libalf::knowledgebase<bool> & kb, fill_table & t, fill_columns & columns,
+		int rows, int column_count, int alphabet_size, int known_percent)
+{{{
+	columns.clear();
+	columns.push_back(std::list<int>());
+	while((int)columns.size() < column_count)
+		columns.push_back(random_word(alphabet_size, 4));
+
+	t.clear();
+	for(int r = 0; r < rows; r++) {
+		fill_row row;
+		row.index = random_word(alphabet_size, 6);
+		t.push_back(row);
+
+		for(fill_columns::iterator ci = columns.begin(); ci != columns.end(); ++ci) {
+			if(rand() % 100 < known_percent) {
+				std::list<int> w = row.index;
+				w.insert(w.end(), ci->begin(), ci->end());
+				kb.add_knowledge(w, model_answer(w));
+			}
+		}
+	}
+}}}
+
+inline bool fill_serially(libalf::knowledgebase<bool> & kb, fill_table & t, fill_columns & columns)
+{{{
+	bool complete = true;
+
+	for(fill_table::iterator ti = t.begin(); ti != t.end(); ++ti) {
+		bool column_skipped = false;
+		for(unsigned int c = ti->acceptance.size(); c < columns.size(); c++) {
+			std::list<int> w = ti->index;
+			bool a;
+			w.insert(w.end(), columns[c].begin(), columns[c].end());
+			if(kb.resolve_or_add_query(w, a)) {
+				if(!column_skipped)
+					ti->acceptance.push_back(a);
+			} else {
+				column_skipped = true;
+				complete = false;
+			}
+		}
+	}
+
+	return complete;
+}}}
+
+inline void answer_queries(libalf::knowledgebase<bool> & kb)
+{{{
+	std::list<std::list<int> > queries = kb.get_queries();
+	for(std::list<std::list<int> >::iterator qi = queries.begin(); qi != queries.end(); ++qi)
+		kb.add_knowledge(*qi, model_answer(*qi));
+}}}
+
+#endif // __parallel_fill_fill_table_h__
@@ -0,0 +1,118 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for parallel_table_filler, the parallel column filling of
+// angluin_simple_table and NLstar_table.
+//
+// fills random tables from a knowledgebase that knows most of their cells:
+// serially as the algorithms do without fill threads, and with the filler
+// using one thread and n threads. each fill starts from a fresh copy of
+// the table and knowledgebase. the filler uses fewer threads on small
+// tables (see parallel_table_filler::default_min_cells_per_thread); the
+// number of threads it starts is printed.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/knowledgebase.h>
+#include <libalf/parallel_fill.h>
+
+#include "fill_table.h"
+
+using namespace std;
+using namespace libalf;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+// threads == 0: serial fill
+unsigned long long int time_fill(basic_string<int32_t> & serialized_kb, fill_table & table, fill_columns & columns, unsigned int threads)
+{{{
+	knowledgebase<bool> kb;
+	serial_stretch ser(serialized_kb);
+	fill_table t = table;
+	unsigned long long int start;
+
+	kb.deserialize(ser);
+
+	start = usecs();
+	if(threads == 0) {
+		fill_serially(kb, t, columns);
+	} else {
+		parallel_table_filler<bool, fill_table> filler(kb, t, columns);
+		filler.complete(filler.fill(threads));
+	}
+	return usecs() - start;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	unsigned int threads = 4;
+	int known_percent = 90;
+
+	if(argc == 3) {
+		threads       = atoi(argv[1]);
+		known_percent = atoi(argv[2]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: number of fill threads\n"
+			"\t2: percentage of cells known to the knowledgebase\n";
+		return 1;
+	}
+
+	static const int sizes[][2] = { {10, 8}, {40, 8}, {40, 32}, {200, 32}, {1000, 32}, {5000, 64} };
+
+	printf("%u fill threads, %d%% of the cells known\n\n", threads, known_percent);
+	printf(" rows  columns   serial usecs   filler usecs (1 thread)   filler usecs (%u threads)   threads started\n", threads);
+
+	srand(1234);
+	for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		knowledgebase<bool> kb;
+		fill_table table;
+		fill_columns columns;
+
+		make_table(kb, table, columns, sizes[i][0], sizes[i][1], 4, known_percent);
+		basic_string<int32_t> serialized_kb = kb.serialize();
+		parallel_table_filler<bool, fill_table> filler(kb, table, columns);
+
+		printf("%5d  %7d   %12llu   %23llu   %24llu   %15u\n",
+				sizes[i][0], sizes[i][1],
+				time_fill(serialized_kb, table, columns, 0),
+				time_fill(serialized_kb, table, columns, 1),
+				time_fill(serialized_kb, table, columns, threads),
+				filler.get_thread_count(threads));
+		fflush(stdout);
+	}
+
+	return 0;
+}}}
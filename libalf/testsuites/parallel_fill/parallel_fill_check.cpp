@@ -0,0 +1,131 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *           and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// parallel_fill_check: fill small tables with parallel_table_filler and
+// several threads (the threshold is lowered, so that threads are started
+// at all) and compare the rows, the queries and the resolved count
+// against the serial fill. two rounds, so that the second one starts from
+// partially filled rows.
+
+#include <iostream>
+#include <list>
+#include <set>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/knowledgebase.h>
+#include <libalf/parallel_fill.h>
+
+#include "fill_table.h"
+
+using namespace std;
+using namespace libalf;
+
+// returns the number of errors
+int check(unsigned int threads, int rows, int column_count, int known_percent)
+{{{
+	knowledgebase<bool> serial_kb, parallel_kb;
+	fill_table serial_table, parallel_table;
+	fill_columns columns;
+	int errors = 0;
+
+	make_table(serial_kb, serial_table, columns, rows, column_count, 3, known_percent);
+	basic_string<int32_t> s = serial_kb.serialize();
+	serial_stretch ser(s);
+	parallel_kb.deserialize(ser);
+	parallel_table = serial_table;
+
+	for(int round = 1; round <= 2; round++) {
+		parallel_table_filler<bool, fill_table> filler(parallel_kb, parallel_table, columns);
+		bool serial_complete, parallel_complete;
+
+		filler.set_min_cells_per_thread(1);
+		if(filler.get_thread_count(threads) < 2) {
+			printf("%u threads, %d rows, round %d: filler does not start any thread\n", threads, rows, round);
+			errors++;
+		}
+
+		int serial_resolved = serial_kb.count_resolved_queries();
+		int parallel_resolved = parallel_kb.count_resolved_queries();
+		serial_complete = fill_serially(serial_kb, serial_table, columns);
+		parallel_complete = filler.complete(filler.fill(threads));
+
+		fill_table::iterator si, pi;
+		int row_errors = 0;
+		for(si = serial_table.begin(), pi = parallel_table.begin(); si != serial_table.end(); ++si, ++pi)
+			if(si->acceptance != pi->acceptance)
+				row_errors++;
+		if(row_errors) {
+			printf("%u threads, %d rows, round %d: %d rows differ\n", threads, rows, round, row_errors);
+			errors++;
+		}
+		if(serial_complete != parallel_complete) {
+			printf("%u threads, %d rows, round %d: table is %s, but serially %s\n", threads, rows, round,
+					parallel_complete ? "complete" : "incomplete", serial_complete ? "complete" : "incomplete");
+			errors++;
+		}
+		serial_resolved = serial_kb.count_resolved_queries() - serial_resolved;
+		parallel_resolved = parallel_kb.count_resolved_queries() - parallel_resolved;
+		if(serial_resolved != parallel_resolved) {
+			printf("%u threads, %d rows, round %d: %d resolved queries, serially %d\n", threads, rows, round,
+					parallel_resolved, serial_resolved);
+			errors++;
+		}
+		list<list<int> > sq = serial_kb.get_queries(), pq = parallel_kb.get_queries();
+		if(set<list<int> >(sq.begin(), sq.end()) != set<list<int> >(pq.begin(), pq.end())
+		   || serial_kb.count_nodes() != parallel_kb.count_nodes()) {
+			printf("%u threads, %d rows, round %d: %d queries and %d nodes, serially %d and %d\n", threads, rows, round,
+					parallel_kb.count_queries(), parallel_kb.count_nodes(), serial_kb.count_queries(), serial_kb.count_nodes());
+			errors++;
+		}
+
+		answer_queries(serial_kb);
+		answer_queries(parallel_kb);
+	}
+
+	return errors;
+}}}
+
+int main()
+{{{
+	int errors = 0;
+
+	srand(1234);
+
+	for(unsigned int threads = 2; threads <= 8; threads *= 2) {
+		errors += check(threads, 12, 5, 60);
+		errors += check(threads, 40, 9, 90);
+		errors += check(threads, 3, 2, 0);
+	}
+
+	if(errors) {
+		printf("%d errors.\n", errors);
+		return 1;
+	}
+
+	printf("parallel fill matches the serial fill.\n");
+	return 0;
+}}}
@@ -0,0 +1,207 @@
+/* $Id$
+ * vim: fdm=marker
+ *
+ * This file is part of libalf.
+ *
+ * libalf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libalf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libalf.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * (c) 2008,2009,2010 Lehrstuhl Softwaremodellierung und Verifikation (I2), RWTH Aachen University
+ *                and Lehrstuhl Logik und Theorie diskreter Systeme (I7), RWTH Aachen University
+ * Author: David R. Piegdon <david-i2@piegdon.de>
+ *
+ */
+
+// benchmark for compact prefix trees.
+//
+// builds prefix trees with dense and with compact edges from random samples
+// (long words over a large alphabet) and compares their nodes, edges and
+// memory. then infers minimal DFAs from samples of random liblangen DFAs
+// with dfa_inferring_MiniSat on dense and on compact prefix trees, which
+// have to be identical.
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libalf/alf.h>
+#include <libalf/prefix_tree.h>
+#include <libalf/algorithm_dfa_inferring_minisat.h>
+#include <liblangen/dfa_randomgenerator.h>
+#include <liblangen/prng.h>
+
+using namespace std;
+using namespace libalf;
+using namespace liblangen;
+
+unsigned long long int usecs()
+{{{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}}}
+
+void random_dfa(dfa_randomgenerator & rg, finite_automaton & fa, int alphabet_size, int state_count)
+{{{
+	bool is_dfa;
+	int asize, states;
+	set<int> initial, final;
+	map<int, map<int, set<int> > > transitions;
+
+	rg.generate(alphabet_size, state_count, is_dfa, asize, states, initial, final, transitions);
+
+	fa.clear();
+	fa.input_alphabet_size = asize;
+	fa.state_count = states;
+	fa.initial_states = initial;
+	fa.transitions = transitions;
+	fa.set_final_states(final);
+	fa.calc_determinism();
+	fa.valid = true;
+}}}
+
+void random_words(knowledgebase<bool> & kb, int alphabet_size, int samples, int max_length)
+{{{
+	for(int i = 0; i < samples; ++i) {
+		list<int> word;
+		int length = prng::random_int(max_length + 1);
+		for(int j = 0; j < length; ++j)
+			word.push_back(prng::random_int(alphabet_size));
+		kb.add_knowledge(word, prng::random_int(2));
+	}
+}}}
+
+void random_sample(knowledgebase<bool> & kb, const finite_automaton & model, int samples, int max_length)
+{{{
+	for(int i = 0; i < samples; ++i) {
+		list<int> word;
+		int length = prng::random_int(max_length + 1);
+		for(int j = 0; j < length; ++j)
+			word.push_back(prng::random_int(model.input_alphabet_size));
+		kb.add_knowledge(word, model.contains(word));
+	}
+}}}
+
+bool identical(const prefix_tree<bool> & a, const prefix_tree<bool> & b)
+{{{
+	if(a.node_count != b.node_count)
+		return false;
+	for(unsigned int u = 0; u < a.node_count; ++u) {
+		if(a.specified[u] != b.specified[u] || (a.specified[u] && a.output[u] != b.output[u]))
+			return false;
+		for(unsigned int c = 0; c < a.get_alphabet_size(); ++c)
+			if(a.edges[u][c] != b.edges[u][c])
+				return false;
+	}
+	return true;
+}}}
+
+bool same_dfa(conjecture * a, conjecture * b)
+{{{
+	finite_automaton * fa = dynamic_cast<finite_automaton*>(a);
+	finite_automaton * fb = dynamic_cast<finite_automaton*>(b);
+
+	return fa != NULL && fb != NULL && fa->state_count == fb->state_count
+		&& fa->initial_states == fb->initial_states
+		&& fa->get_final_states() == fb->get_final_states()
+		&& fa->transitions == fb->transitions;
+}}}
+
+int main(int argc, char**argv)
+{{{
+	int alphabet_size = 200;
+	int samples = 2000;
+	int max_length = 100;
+	int errors = 0;
+	dfa_randomgenerator rg;
+	ostream_logger log(&cerr, LOGGER_ERROR, false);
+
+	if(argc == 4) {
+		alphabet_size = atoi(argv[1]);
+		samples       = atoi(argv[2]);
+		max_length    = atoi(argv[3]);
+	} else if(argc != 1) {
+		cout << "please give no or the following parameters:\n"
+			"\t1: alphabet size\n"
+			"\t2: number of sampled words\n"
+			"\t3: maximal length of sampled words\n";
+		return 1;
+	}
+
+	// building prefix trees
+	printf("alphabet      nodes   dense bytes   compact bytes   dense us   compact us\n");
+	for(int asize = 2; asize <= alphabet_size; asize *= 4) {
+		knowledgebase<bool> kb;
+		unsigned long long int start, t[2];
+
+		random_words(kb, asize, samples, max_length);
+
+		start = usecs();
+		prefix_tree<bool> dense(kb, asize);
+		t[0] = usecs() - start;
+
+		start = usecs();
+		prefix_tree<bool> compact(kb, asize, true);
+		t[1] = usecs() - start;
+
+		if(!identical(dense, compact)) {
+			printf("compact prefix tree differs!\n");
+			errors++;
+		}
+
+		printf("%8d   %8u   %11zu   %13zu   %8llu   %10llu\n",
+				asize, dense.node_count, dense.memory_usage(), compact.memory_usage(), t[0], t[1]);
+		fflush(stdout);
+	}
+
+	// inference
+	printf("\nmodel   states   dense us   compact us\n");
+	for(int state_count = 2; state_count <= 7; ++state_count) {
+		finite_automaton model;
+		knowledgebase<bool> kb;
+		unsigned long long int start, t[2];
+		conjecture * cj[2];
+
+		random_dfa(rg, model, 2, state_count);
+		random_sample(kb, model, 60, 10);
+
+		dfa_inferring_MiniSat alg(&kb, &log, 2);
+		for(int compact = 0; compact < 2; ++compact) {
+			alg.set_compact_prefix_tree(compact);
+			start = usecs();
+			cj[compact] = alg.infer_linear();
+			t[compact] = usecs() - start;
+		}
+
+		if(!same_dfa(cj[0], cj[1])) {
+			printf("inference on compact prefix tree differs!\n");
+			errors++;
+		}
+
+		printf("%5d   %6d   %8llu   %10llu\n",
+				state_count, dynamic_cast<finite_automaton*>(cj[0])->state_count, t[0], t[1]);
+		fflush(stdout);
+
+		delete cj[0];
+		delete cj[1];
+	}
+
+	return errors ? 1 : 0;
+}}}
+